@@ -3,6 +3,7 @@
 #include <argparse/argparse.hpp>
 #include <QApplication>
 #include "CommandLineParser.h"
+#include "data/DecodedStepCache.hpp"
 
 
 bool CommandLineParser::parse(int argc, char* argv[])
@@ -48,6 +49,30 @@ bool CommandLineParser::parse(int argc, char* argv[])
             .help("Silent mode: Skip displaying information dialogs (default behaviour)")
             .flag();
 
+        program.add_argument(ARG_READER_THREADS)
+            .help("Number of threads used for reading simulation steps (0 = hardware concurrency)")
+            .scan<'i', int>();
+
+        program.add_argument(ARG_STEP_CACHE_MB)
+            .help("Memory budget in MB of the cache of recently displayed steps (0 = disabled)")
+            .scan<'i', int>();
+
+        program.add_argument(ARG_STEP_CACHE_STATISTICS)
+            .help("Print hits and misses of the cache of recently displayed steps when it is cleared")
+            .flag();
+
+        program.add_argument(ARG_NO_CONSOLIDATED_INDEX)
+            .help("Do not write or read the consolidated index of steps, index files of nodes are parsed on every opening")
+            .flag();
+
+        program.add_argument(ARG_NO_INDEX_RECOVERY)
+            .help("Do not rebuild missing index files from data files")
+            .flag();
+
+        program.add_argument(ARG_CHECK_STALE_INDEX_FILES)
+            .help("Rebuild index files which do not cover all steps of data files")
+            .flag();
+
         try
         {
             program.parse_args(argc, argv);
@@ -95,7 +120,25 @@ bool CommandLineParser::parse(int argc, char* argv[])
         if (auto st = program.present<int>(ARG_STEP))
             step = *st;
 
+        if (auto threads = program.present<int>(ARG_READER_THREADS))
+        {
+            if (*threads < 0)
+                throw std::invalid_argument(std::format("{} must not be negative", ARG_READER_THREADS));
+            readerThreads = static_cast<unsigned>(*threads);
+        }
+
+        if (auto megabytes = program.present<int>(ARG_STEP_CACHE_MB))
+        {
+            if (*megabytes < 0)
+                throw std::invalid_argument(std::format("{} must not be negative", ARG_STEP_CACHE_MB));
+            stepCacheMB = static_cast<std::size_t>(*megabytes);
+        }
+
         exitAfterLastStep = program.is_used(ARG_EXIT_AFTER_LAST);
+        reportStepCacheStatistics = program.is_used(ARG_STEP_CACHE_STATISTICS);
+        useConsolidatedIndex = ! program.is_used(ARG_NO_CONSOLIDATED_INDEX);
+        recoverIndexFiles = ! program.is_used(ARG_NO_INDEX_RECOVERY);
+        checkStaleIndexFiles = program.is_used(ARG_CHECK_STALE_INDEX_FILES);
 
         if (const bool requestedSilent = program.is_used(ARG_SILENT))
         {
@@ -129,6 +172,12 @@ void CommandLineParser::printHelp() const
               << std::format("  {: <{}} Go to specific step directly\n", ARG_STEP, WIDTH)
               << std::format("  {: <{}} Exit after last step\n", ARG_EXIT_AFTER_LAST, WIDTH)
               << std::format("  {: <{}} Suppress error dialogs and messages (default)\n", ARG_SILENT, WIDTH)
+              << std::format("  {: <{}} Threads for reading steps (default: hardware concurrency)\n", ARG_READER_THREADS, WIDTH)
+              << std::format("  {: <{}} Memory budget of cache of displayed steps in MB (default: {})\n", ARG_STEP_CACHE_MB, WIDTH, DecodedStepCacheSettings::defaultBudgetInMegabytes)
+              << std::format("  {: <{}} Print hits and misses of cache of displayed steps\n", ARG_STEP_CACHE_STATISTICS, WIDTH)
+              << std::format("  {: <{}} Parse index files on every opening (no consolidated index)\n", ARG_NO_CONSOLIDATED_INDEX, WIDTH)
+              << std::format("  {: <{}} Do not rebuild missing index files from data files\n", ARG_NO_INDEX_RECOVERY, WIDTH)
+              << std::format("  {: <{}} Rebuild index files not covering all steps of data files\n", ARG_CHECK_STALE_INDEX_FILES, WIDTH)
               << std::format("  {: <{}} Show this help message\n\n", "-h, --help", WIDTH)
               << "Examples:\n"
               << std::format("  {} config.txt\n", appName)
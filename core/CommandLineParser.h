@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <optional>
 #include <string>
 #include <vector>
@@ -22,6 +23,12 @@
  * - step=<number>: Go to specific step directly
  * - generateImagePath=<path>: Generate image for current step and save to file
  * - silent: Suppress error dialogs (default and deprecated)
+ * - readerThreads=<number>: Number of threads used for reading simulation steps (0 = hardware concurrency)
+ * - stepCacheMB=<number>: Memory budget (in MB) of the cache of decoded steps (0 = disabled)
+ * - stepCacheStatistics: Print hits and misses of the cache of decoded steps when it is cleared
+ * - noConsolidatedIndex: Do not write or read the consolidated index of steps (index files are always parsed)
+ * - noIndexRecovery: Do not rebuild missing index files from data files
+ * - checkStaleIndexFiles: Rebuild index files which do not cover all steps of data files
  * - configFile: Path to configuration file (positional argument) */
 class CommandLineParser
 {
@@ -35,6 +42,12 @@ public:
     static constexpr const char ARG_STEP[] = "--step";
     static constexpr const char ARG_EXIT_AFTER_LAST[] = "--exitAfterLastStep";
     static constexpr const char ARG_SILENT[] = "--silent";
+    static constexpr const char ARG_READER_THREADS[] = "--readerThreads";
+    static constexpr const char ARG_STEP_CACHE_MB[] = "--stepCacheMB";
+    static constexpr const char ARG_STEP_CACHE_STATISTICS[] = "--stepCacheStatistics";
+    static constexpr const char ARG_NO_CONSOLIDATED_INDEX[] = "--noConsolidatedIndex";
+    static constexpr const char ARG_NO_INDEX_RECOVERY[] = "--noIndexRecovery";
+    static constexpr const char ARG_CHECK_STALE_INDEX_FILES[] = "--checkStaleIndexFiles";
 
     /** @brief Parse command-line arguments.
      * @param argc Number of arguments
@@ -67,6 +80,30 @@ public:
     {
         return configFile;
     }
+    const std::optional<unsigned>& getReaderThreads() const
+    {
+        return readerThreads;
+    }
+    const std::optional<std::size_t>& getStepCacheMB() const
+    {
+        return stepCacheMB;
+    }
+    bool shouldReportStepCacheStatistics() const
+    {
+        return reportStepCacheStatistics;
+    }
+    bool shouldUseConsolidatedIndex() const
+    {
+        return useConsolidatedIndex;
+    }
+    bool shouldRecoverIndexFiles() const
+    {
+        return recoverIndexFiles;
+    }
+    bool shouldCheckStaleIndexFiles() const
+    {
+        return checkStaleIndexFiles;
+    }
     
     /// @brief Check if the positional argument is a directory (for model loading) or config file.
     /// @return true if it's a directory, false if it's a config file
@@ -90,6 +127,12 @@ private:
     std::optional<std::string> generateImagePath;
     std::optional<int> step;
     std::optional<std::string> configFile;
+    std::optional<unsigned> readerThreads;
+    std::optional<std::size_t> stepCacheMB;
     bool isDirectory = false;  ///< true if configFile is actually a model directory
     bool exitAfterLastStep = false;
+    bool reportStepCacheStatistics = false;
+    bool useConsolidatedIndex = true;
+    bool recoverIndexFiles = true;
+    bool checkStaleIndexFiles = false;
 };
@@ -0,0 +1,235 @@
+/** @file ThreadPool.cpp
+ * @brief Implementation of the ThreadPool class. */
+
+#include <algorithm>
+#include <exception>
+
+#include "ThreadPool.h"
+
+
+namespace
+{
+/// Pool and index of the worker running on current thread (nullptr for threads which are not workers)
+thread_local const ThreadPool* currentThreadPool = nullptr;
+thread_local std::size_t currentWorkerIndex = 0;
+/// Pool whose parallelFor() is running on current thread, nested calls do not lock its reconfiguration again
+thread_local const ThreadPool* parallelForPool = nullptr;
+
+/// State of one parallelFor() call shared by its tasks
+struct Batch
+{
+    std::atomic<std::size_t> remainingTasks;
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr firstException;
+};
+} // namespace
+
+
+ThreadPool& ThreadPool::instance()
+{
+    static ThreadPool instance(defaultThreadCount());
+    return instance;
+}
+
+unsigned ThreadPool::defaultThreadCount()
+{
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+ThreadPool::ThreadPool(unsigned count)
+{
+    startWorkers(count);
+}
+
+ThreadPool::~ThreadPool()
+{
+    stopWorkers();
+}
+
+void ThreadPool::setThreadCount(unsigned count)
+{
+    if (0 == count)
+        count = defaultThreadCount();
+
+    std::unique_lock lock(reconfigurationMutex);
+    if (count == threadCount())
+        return;
+
+    stopWorkers();
+    startWorkers(count);
+}
+
+void ThreadPool::startWorkers(unsigned count)
+{
+    stopping = false;
+
+    queues.clear();
+    for (unsigned i = 0; i < count; ++i)
+        queues.push_back(std::make_unique<WorkerQueue>());
+
+    workers.reserve(count);
+    for (unsigned i = 0; i < count; ++i)
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+void ThreadPool::stopWorkers()
+{
+    {
+        std::lock_guard lock(wakeUpMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+    workers.clear();
+}
+
+void ThreadPool::workerLoop(unsigned workerIndex)
+{
+    currentThreadPool = this;
+    currentWorkerIndex = workerIndex;
+
+    while (true)
+    {
+        if (tryRunPendingTask(workerIndex))
+            continue;
+
+        std::unique_lock lock(wakeUpMutex);
+        wakeUp.wait(lock, [this] { return stopping || pendingTasks > 0; });
+        if (stopping && 0 == pendingTasks)
+            return;
+    }
+}
+
+void ThreadPool::submit(Task task)
+{
+    // tasks submitted by a worker go to its own queue (they are usually related to its current work)
+    const std::size_t queueIndex = (currentThreadPool == this) ? currentWorkerIndex : nextQueue++ % queues.size();
+
+    {
+        // counted under the lock of the queue after pushing: workers do not look for a task, which is not there yet,
+        // and the task can not be taken (and uncounted) before it is counted
+        std::lock_guard lock(queues[queueIndex]->mutex);
+        queues[queueIndex]->tasks.push_back(std::move(task));
+        ++pendingTasks;
+    }
+
+    {
+        std::lock_guard lock(wakeUpMutex);
+    }
+    wakeUp.notify_one();
+}
+
+bool ThreadPool::tryRunPendingTask(std::size_t preferredQueue)
+{
+    const std::size_t queuesCount = queues.size();
+    for (std::size_t i = 0; i < queuesCount; ++i)
+    {
+        auto& queue = *queues[(preferredQueue + i) % queuesCount];
+
+        Task task;
+        {
+            std::lock_guard lock(queue.mutex);
+            if (queue.tasks.empty())
+                continue;
+
+            if (0 == i) // own queue - newest task (the data are probably still in cache)
+            {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            }
+            else // stealing - the oldest task
+            {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+        }
+        --pendingTasks;
+
+        task();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::parallelFor(std::size_t tasksCount, const std::function<void(std::size_t)>& function)
+{
+    if (0 == tasksCount)
+        return;
+
+    // workers and queues are not replaced while tasks of the batch are submitted and taken
+    std::shared_lock<std::shared_mutex> reconfigurationLock;
+    const ThreadPool* const outerParallelForPool = parallelForPool;
+    if (currentThreadPool != this && parallelForPool != this)
+        reconfigurationLock = std::shared_lock(reconfigurationMutex);
+    parallelForPool = this;
+    struct RestoreParallelForPool
+    {
+        const ThreadPool* pool;
+        ~RestoreParallelForPool() { parallelForPool = pool; }
+    } restoreParallelForPool{ outerParallelForPool };
+
+    if (1 == tasksCount || workers.empty())
+    {
+        std::exception_ptr firstException;
+        for (std::size_t taskIndex = 0; taskIndex < tasksCount; ++taskIndex)
+        {
+            try
+            {
+                function(taskIndex);
+            }
+            catch (...)
+            {
+                if (! firstException)
+                    firstException = std::current_exception();
+            }
+        }
+        if (firstException)
+            std::rethrow_exception(firstException);
+        return;
+    }
+
+    auto batch = std::make_shared<Batch>();
+    batch->remainingTasks = tasksCount;
+
+    for (std::size_t taskIndex = 0; taskIndex < tasksCount; ++taskIndex)
+    {
+        submit([batch, &function, taskIndex]
+        {
+            try
+            {
+                function(taskIndex);
+            }
+            catch (...)
+            {
+                std::lock_guard lock(batch->mutex);
+                if (! batch->firstException)
+                    batch->firstException = std::current_exception();
+            }
+
+            if (1 == batch->remainingTasks.fetch_sub(1))
+            {
+                std::lock_guard lock(batch->mutex);
+                batch->finished.notify_all();
+            }
+        });
+    }
+
+    // The calling thread helps instead of waiting idle. When there is nothing to take
+    // all remaining tasks of the batch are already being executed by workers.
+    const std::size_t preferredQueue = (currentThreadPool == this) ? currentWorkerIndex : nextQueue.load() % queues.size();
+    while (batch->remainingTasks > 0)
+    {
+        if (! tryRunPendingTask(preferredQueue))
+        {
+            std::unique_lock lock(batch->mutex);
+            batch->finished.wait(lock, [&batch] { return 0 == batch->remainingTasks; });
+        }
+    }
+
+    std::lock_guard lock(batch->mutex);
+    if (batch->firstException)
+        std::rethrow_exception(batch->firstException);
+}
@@ -0,0 +1,101 @@
+/** @file ThreadPool.h
+ * @brief Persistent, bounded pool of worker threads with work stealing.
+ *
+ * The pool is used for decoding simulation steps (ModelReader), where previously one std::async
+ * thread was created for every node on every step change. Threads of the pool are created once,
+ * their number is bounded (by default it is the hardware concurrency) and can be configured
+ * with command line option --readerThreads. */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+/** @class ThreadPool
+ * @brief Pool of worker threads, each worker has its own queue of tasks and steals from other queues when idle.
+ *
+ * Work is submitted as batches with parallelFor(), the calling thread is not blocked idle:
+ * it executes pending tasks too until the whole batch is finished. Thanks to that parallelFor() can
+ * also be called from inside of a task.
+ *
+ * Example usage:
+ * @code
+ * ThreadPool::instance().parallelFor(nodesCount, [&](std::size_t node) {
+ *     processNode(node);
+ * });
+ * @endcode */
+class ThreadPool
+{
+public:
+    /// @brief Get singleton instance (workers are started at first use)
+    static ThreadPool& instance();
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// @brief Number of worker threads
+    unsigned threadCount() const
+    {
+        return static_cast<unsigned>(workers.size());
+    }
+
+    /** @brief Changes number of worker threads.
+     * Waits until all running parallelFor() calls are done, then restarts the workers (it must not be called from a task).
+     * @param count Number of threads, 0 means hardware concurrency */
+    void setThreadCount(unsigned count);
+
+    /** @brief Calls function(taskIndex) for every taskIndex in [0, tasksCount) using threads of the pool.
+     *
+     * The function returns when all tasks are done. If any task throws, the first exception
+     * is rethrown (after the remaining tasks are finished).
+     * @param tasksCount Number of tasks
+     * @param function   Callable with signature void(std::size_t taskIndex) */
+    void parallelFor(std::size_t tasksCount, const std::function<void(std::size_t)>& function);
+
+    /// @brief Default number of threads (hardware concurrency, at least 1)
+    static unsigned defaultThreadCount();
+
+private:
+    using Task = std::function<void()>;
+
+    /// @brief Queue of one worker, the owner takes tasks from back, thieves from front
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    explicit ThreadPool(unsigned count);
+
+    void startWorkers(unsigned count);
+    void stopWorkers();
+
+    void workerLoop(unsigned workerIndex);
+
+    void submit(Task task);
+
+    /// @brief Takes one task (own queue first, then steals) and executes it. Returns false if there was no task.
+    bool tryRunPendingTask(std::size_t preferredQueue);
+
+    std::vector<std::thread> workers;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+    std::mutex wakeUpMutex;
+    std::condition_variable wakeUp;
+    std::atomic<std::size_t> pendingTasks = 0;
+    std::atomic<std::size_t> nextQueue = 0;
+    bool stopping = false;
+
+    /// Held shared by parallelFor() (workers and queues are used), exclusively by setThreadCount() (they are replaced)
+    std::shared_mutex reconfigurationMutex;
+};
@@ -56,3 +56,86 @@ struct ColumnAndRow
         return row;
     }
 };
+
+/** @struct GridRegion
+ * @brief Rectangular part of the grid of cells: columns [firstColumn, endColumn) and rows [firstRow, endRow). */
+struct GridRegion
+{
+    int firstColumn = 0;
+    int firstRow = 0;
+    int endColumn = 0; ///< One past the last column
+    int endRow = 0;    ///< One past the last row
+
+    bool operator==(const GridRegion&) const = default;
+
+    bool empty() const
+    {
+        return firstColumn >= endColumn || firstRow >= endRow;
+    }
+
+    bool intersects(const GridRegion& other) const
+    {
+        return ! empty() && ! other.empty()
+               && firstColumn < other.endColumn && other.firstColumn < endColumn
+               && firstRow < other.endRow && other.firstRow < endRow;
+    }
+};
+
+/** @struct VolumeSize
+ * @brief Dimensions (or offsets) of a part of the grid of 3D models: columns, rows and slices.
+ *
+ * Header of a step of 3D model in text data file is "C-R-S", for 2D models ("C-R") there is one slice. */
+struct VolumeSize
+{
+    int column = 0;
+    int row = 0;
+    int slice = 0;
+
+    bool operator==(const VolumeSize&) const = default;
+};
+
+/** @struct SliceRange
+ * @brief Slices [first, end) of the grid of 3D models (e.g. slices which are decoded). */
+struct SliceRange
+{
+    int first = 0;
+    int end = 0; ///< One past the last slice
+
+    bool operator==(const SliceRange&) const = default;
+
+    bool empty() const
+    {
+        return first >= end;
+    }
+
+    int size() const
+    {
+        return empty() ? 0 : end - first;
+    }
+
+    bool contains(int slice) const
+    {
+        return first <= slice && slice < end;
+    }
+
+    bool contains(const SliceRange& other) const
+    {
+        return other.empty() || (first <= other.first && other.end <= end);
+    }
+
+    /// @return Common slices of the ranges (empty range if there are none)
+    SliceRange intersection(const SliceRange& other) const
+    {
+        const SliceRange common{ .first = first > other.first ? first : other.first, .end = end < other.end ? end : other.end };
+        return common.empty() ? SliceRange{} : common;
+    }
+};
+
+/** @enum GridRenderingMode
+ * @brief How colors of cells of 2D grid are drawn. */
+enum class GridRenderingMode
+{
+    Points, ///< Cell centers are points of the grid, colors are interpolated between them (fast)
+    Cells,  ///< One color per cell with sharp boundaries of cells (high quality, slower for large grids)
+    Texture ///< Colors are textures on a few quads, only changed tiles are uploaded between steps (very large grids)
+};
@@ -0,0 +1,45 @@
+/** @file ActiveTiles.cpp
+ * @brief Implementation of the ActiveTiles class. */
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "ActiveTiles.h"
+
+
+ActiveTiles::ActiveTiles(const SubstateColumn& column)
+    : tileColumnsCount{ column.tileColumns() }
+    , tileRowsCount{ column.tileRows() }
+    , tiles(static_cast<std::size_t>(tileColumnsCount) * static_cast<std::size_t>(tileRowsCount), 0)
+{
+}
+
+void ActiveTiles::addValuesInRange(const SubstateColumn& column, double lowerBound, double upperBound, double skippedValue)
+{
+    if (column.tileColumns() != tileColumnsCount || column.tileRows() != tileRowsCount)
+        throw std::invalid_argument("Tiles of columns of different dimensions can not be combined");
+
+    if (std::isnan(lowerBound) || std::isnan(upperBound))
+        return; // no value is in the range
+
+    const bool hasSkippedValue = ! std::isnan(skippedValue);
+    for (int tileRow = 0; tileRow < tileRowsCount; ++tileRow)
+    {
+        for (int tileColumn = 0; tileColumn < tileColumnsCount; ++tileColumn)
+        {
+            const auto range = column.tileValueRange(tileRow, tileColumn);
+            if (! range || range->max <= lowerBound || range->min >= upperBound)
+                continue;
+            if (hasSkippedValue && range->min == skippedValue && range->max == skippedValue)
+                continue;
+
+            tiles[static_cast<std::size_t>(tileRow) * static_cast<std::size_t>(tileColumnsCount) + static_cast<std::size_t>(tileColumn)] = 1;
+        }
+    }
+}
+
+std::size_t ActiveTiles::activeTilesCount() const
+{
+    return static_cast<std::size_t>(std::ranges::count_if(tiles, [](unsigned char tile) { return tile != 0; }));
+}
@@ -0,0 +1,60 @@
+/** @file ActiveTiles.h
+ * @brief Declaration of the ActiveTiles class - parts of the grid with something to display. */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "data/SubstateColumns.h"
+
+
+/** @class ActiveTiles
+ * @brief Tiles of the grid (squares of SubstateColumn::tileSize cells), which contain cells to be processed.
+ *
+ * Flow simulations keep most of the grid at "no data" (SubstateInfo::noValue) for most of the run.
+ * Tiles, which can not contain any displayed cell, are found only from ranges of values of tiles
+ * (SubstateColumn::tileValueRange()), so colouring, 3D mesh and grid lines on 3D surface process cells
+ * of active tiles only and the time of a frame scales with the active area. */
+class ActiveTiles
+{
+public:
+    static constexpr int tileSize = SubstateColumn::tileSize;
+
+    /// @brief Creates tiles of the column's grid, all of them inactive
+    explicit ActiveTiles(const SubstateColumn& column);
+
+    /** @brief Marks active tiles, which have a value of the column in the open interval (lowerBound, upperBound).
+     * @param skippedValue Value, which is not considered (e.g. enabled noValue), NaN if none */
+    void addValuesInRange(const SubstateColumn& column, double lowerBound, double upperBound, double skippedValue);
+
+    int tileColumns() const
+    {
+        return tileColumnsCount;
+    }
+
+    int tileRows() const
+    {
+        return tileRowsCount;
+    }
+
+    /// @return false also for tiles outside of the grid
+    bool isActiveTile(int tileRow, int tileColumn) const
+    {
+        if (tileRow < 0 || tileColumn < 0 || tileRow >= tileRowsCount || tileColumn >= tileColumnsCount)
+            return false;
+        return tiles[static_cast<std::size_t>(tileRow) * static_cast<std::size_t>(tileColumnsCount) + static_cast<std::size_t>(tileColumn)] != 0;
+    }
+
+    bool isActiveCell(int row, int column) const
+    {
+        return isActiveTile(row / tileSize, column / tileSize);
+    }
+
+    std::size_t activeTilesCount() const;
+
+private:
+    int tileColumnsCount = 0;
+    int tileRowsCount = 0;
+    std::vector<unsigned char> tiles; ///< Row after row, not 0 for active tile
+};
@@ -0,0 +1,295 @@
+/** @file CellGrid.hpp
+ * @brief Declaration of the CellGrid class - contiguous row-major grid of cells. */
+
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <utility>
+
+#include "data/GridArena.h"
+
+
+/** @class CellGridView
+ * @brief Read-only view of row-major cells with a stride (cells of CellGrid or records in memory mapped binary file).
+ *
+ * It can be read the same way as CellGrid (view.size(), view[row][column]), the owner of the memory
+ * (e.g. the mapping of the file) is kept alive by the view. */
+template<class Cell>
+class CellGridView
+{
+public:
+    CellGridView() = default;
+
+    CellGridView(const Cell* cells, int columns, int rows, std::size_t stride, std::shared_ptr<const void> owner = nullptr)
+        : cellsData{ cells }
+        , columnsCount{ columns }
+        , rowsCount{ rows }
+        , rowStride{ stride }
+        , owner{ std::move(owner) }
+    {
+    }
+
+    int columns() const
+    {
+        return columnsCount;
+    }
+
+    int rows() const
+    {
+        return rowsCount;
+    }
+
+    std::size_t stride() const
+    {
+        return rowStride;
+    }
+
+    std::size_t size() const
+    {
+        return static_cast<std::size_t>(rowsCount);
+    }
+
+    bool empty() const
+    {
+        return 0 == rowsCount;
+    }
+
+    std::span<const Cell> operator[](std::size_t row) const
+    {
+        return { cellsData + row * rowStride, static_cast<std::size_t>(columnsCount) };
+    }
+
+private:
+    const Cell* cellsData = nullptr;
+    int columnsCount = 0;
+    int rowsCount = 0;
+    std::size_t rowStride = 0;
+    std::shared_ptr<const void> owner;
+};
+
+
+/** @class CellGrid
+ * @brief Two dimensional grid of cells stored row after row in one memory block taken from GridArena.
+ *
+ * It replaces vector of rows: there is one allocation for the whole grid, neighbouring rows are next
+ * to each other in memory and accessing m[row][column] does not chase pointer of the row.
+ * The memory block is returned into the arena when the grid is destroyed or resized, so reloading
+ * or switching models reuses it.
+ *
+ * Rows are accessed through views (std::span) starting at row * stride(), so code written for vector of rows
+ * (m.size(), m[row].size(), m[row][column]) works unchanged.
+ *
+ * @tparam Cell Type of cells (it does not need to be trivially copyable, cells are constructed in place) */
+template<class Cell>
+class CellGrid
+{
+    static_assert(alignof(Cell) <= GridArena::alignment, "Cells are placed in blocks of GridArena");
+
+public:
+    using value_type = Cell;
+    using RowView = std::span<Cell>;
+    using ConstRowView = std::span<const Cell>;
+
+    CellGrid() = default;
+
+    CellGrid(int columns, int rows)
+    {
+        resize(columns, rows);
+    }
+
+    CellGrid(const CellGrid& other)
+    {
+        copyFrom(other);
+    }
+
+    CellGrid(CellGrid&& other) noexcept
+        : block{ std::exchange(other.block, {}) }
+        , columnsCount{ std::exchange(other.columnsCount, 0) }
+        , rowsCount{ std::exchange(other.rowsCount, 0) }
+    {
+    }
+
+    CellGrid& operator=(const CellGrid& other)
+    {
+        if (this != &other)
+            copyFrom(other);
+        return *this;
+    }
+
+    CellGrid& operator=(CellGrid&& other) noexcept
+    {
+        if (this != &other)
+        {
+            destroyCells();
+            GridArena::instance().release(std::exchange(block, std::exchange(other.block, {})));
+            columnsCount = std::exchange(other.columnsCount, 0);
+            rowsCount = std::exchange(other.rowsCount, 0);
+        }
+        return *this;
+    }
+
+    ~CellGrid()
+    {
+        destroyCells();
+        GridArena::instance().release(block);
+    }
+
+    /** @brief Changes dimensions of the grid, all cells are value-initialized again.
+     *
+     * Nothing is done if dimensions are the same (like resizing vector of rows to the same size). */
+    void resize(int columns, int rows);
+
+    int columns() const
+    {
+        return columnsCount;
+    }
+
+    int rows() const
+    {
+        return rowsCount;
+    }
+
+    /// @brief Distance (in cells) between beginnings of neighbouring rows
+    std::size_t stride() const
+    {
+        return static_cast<std::size_t>(columnsCount);
+    }
+
+    /// @brief Number of rows (like size() of vector of rows)
+    std::size_t size() const
+    {
+        return static_cast<std::size_t>(rowsCount);
+    }
+
+    bool empty() const
+    {
+        return 0 == rowsCount;
+    }
+
+    std::size_t cellsCount() const
+    {
+        return static_cast<std::size_t>(columnsCount) * static_cast<std::size_t>(rowsCount);
+    }
+
+    RowView operator[](std::size_t row)
+    {
+        return { data() + row * stride(), static_cast<std::size_t>(columnsCount) };
+    }
+
+    ConstRowView operator[](std::size_t row) const
+    {
+        return { data() + row * stride(), static_cast<std::size_t>(columnsCount) };
+    }
+
+    Cell* data()
+    {
+        return reinterpret_cast<Cell*>(block.data);
+    }
+
+    const Cell* data() const
+    {
+        return reinterpret_cast<const Cell*>(block.data);
+    }
+
+    /// @brief All cells row after row
+    std::span<Cell> cells()
+    {
+        return { data(), cellsCount() };
+    }
+
+    std::span<const Cell> cells() const
+    {
+        return { data(), cellsCount() };
+    }
+
+    /// @brief Read-only view of the cells (valid until the grid is resized or destroyed)
+    CellGridView<Cell> view() const
+    {
+        return { data(), columnsCount, rowsCount, stride() };
+    }
+
+    bool hasSameDimensions(const CellGrid& other) const
+    {
+        return columnsCount == other.columnsCount && rowsCount == other.rowsCount;
+    }
+
+    /// @brief Number of bytes of the memory block (it can be bigger than needed for the cells)
+    std::size_t allocatedBytes() const
+    {
+        return block.capacity;
+    }
+
+    friend bool operator==(const CellGrid& first, const CellGrid& second)
+        requires std::equality_comparable<Cell>
+    {
+        return first.hasSameDimensions(second) && std::ranges::equal(first.cells(), second.cells());
+    }
+
+private:
+    /// @brief Makes sure the block can hold cellsCount cells (cells have to be destroyed already)
+    void prepareBlock(std::size_t cellsCount);
+
+    void destroyCells()
+    {
+        std::destroy_n(data(), cellsCount());
+        columnsCount = rowsCount = 0;
+    }
+
+    void copyFrom(const CellGrid& other);
+
+    GridArena::Block block;
+    int columnsCount = 0;
+    int rowsCount = 0;
+};
+
+
+template<class Cell>
+void CellGrid<Cell>::resize(int columns, int rows)
+{
+    columns = std::max(columns, 0);
+    rows = std::max(rows, 0);
+    if (columns == columnsCount && rows == rowsCount)
+        return;
+
+    destroyCells();
+    const auto newCellsCount = static_cast<std::size_t>(columns) * static_cast<std::size_t>(rows);
+    prepareBlock(newCellsCount);
+
+    std::uninitialized_value_construct_n(data(), newCellsCount);
+    columnsCount = columns;
+    rowsCount = rows;
+}
+
+template<class Cell>
+void CellGrid<Cell>::copyFrom(const CellGrid& other)
+{
+    if (hasSameDimensions(other))
+    {
+        std::ranges::copy(other.cells(), data());
+        return;
+    }
+
+    destroyCells();
+    prepareBlock(other.cellsCount());
+
+    std::uninitialized_copy_n(other.data(), other.cellsCount(), data());
+    columnsCount = other.columnsCount;
+    rowsCount = other.rowsCount;
+}
+
+template<class Cell>
+void CellGrid<Cell>::prepareBlock(std::size_t cellsCount)
+{
+    const auto bytes = cellsCount * sizeof(Cell);
+    const bool blockFits = block.capacity >= bytes && block.capacity / 2 <= bytes;
+    if (blockFits)
+        return;
+
+    auto& arena = GridArena::instance();
+    arena.release(std::exchange(block, {}));
+    block = arena.acquire(bytes);
+}
@@ -0,0 +1,115 @@
+/** @file CellVolume.hpp
+ * @brief Declaration of the CellVolume class - contiguous grid of cells of 3D models. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+
+#include "core/types.h" // SliceRange
+#include "data/CellGrid.hpp"
+
+
+/** @class CellVolume
+ * @brief Three dimensional grid of cells stored slice after slice (each slice row after row) in one memory block.
+ *
+ * Only a range of slices can be stored (e.g. the displayed ones), so a big 3D model does not need memory
+ * for slices which are not decoded. Slices are addressed by their numbers in the whole grid.
+ * Cells are kept in CellGrid with rows of all stored slices one after another, so the volume can be read
+ * and filled like a matrix too (volume[rowIndex(slice, row)][column]).
+ *
+ * @tparam Cell Type of cells */
+template<class Cell>
+class CellVolume
+{
+public:
+    using value_type = Cell;
+
+    CellVolume() = default;
+
+    /** @brief Changes dimensions of the volume and slices which are stored.
+     *
+     * Cells are value-initialized again only when the number of stored cells changes (like CellGrid::resize()).
+     * @param slicesToStore Slices which are stored, it is clamped to slices of the volume */
+    void resize(int columns, int rows, int slices, SliceRange slicesToStore)
+    {
+        slicesCount = std::max(slices, 0);
+        stored = slicesToStore.intersection({ .first = 0, .end = slicesCount });
+        rowsCount = std::max(rows, 0);
+        grid.resize(columns, rowsCount * stored.size());
+    }
+
+    int columns() const
+    {
+        return grid.columns();
+    }
+
+    int rows() const
+    {
+        return rowsCount;
+    }
+
+    /// @brief Number of slices of the whole volume (also of slices which are not stored)
+    int slices() const
+    {
+        return slicesCount;
+    }
+
+    SliceRange storedSlices() const
+    {
+        return stored;
+    }
+
+    /// @brief Index of the row of the stored slice in the matrix of all stored rows (see operator[])
+    std::size_t rowIndex(int slice, int row) const
+    {
+        return static_cast<std::size_t>(slice - stored.first) * static_cast<std::size_t>(rowsCount) + static_cast<std::size_t>(row);
+    }
+
+    /// @brief Number of stored rows (rows of all stored slices), the volume is read as a matrix then
+    std::size_t size() const
+    {
+        return grid.size();
+    }
+
+    std::span<Cell> operator[](std::size_t storedRow)
+    {
+        return grid[storedRow];
+    }
+
+    std::span<const Cell> operator[](std::size_t storedRow) const
+    {
+        return grid[storedRow];
+    }
+
+    Cell& operator()(int column, int row, int slice)
+    {
+        return grid[rowIndex(slice, row)][column];
+    }
+
+    const Cell& operator()(int column, int row, int slice) const
+    {
+        return grid[rowIndex(slice, row)][column];
+    }
+
+    /// @brief Read-only view of the stored slice (valid until the volume is resized or destroyed)
+    CellGridView<Cell> slice(int slice) const
+    {
+        return { grid.data() + rowIndex(slice, 0) * grid.stride(), grid.columns(), rowsCount, grid.stride() };
+    }
+
+    /// @brief Copies cells of the stored slice into the matrix, which is resized to dimensions of slices
+    void copySliceInto(int slice, CellGrid<Cell>& matrix) const
+    {
+        matrix.resize(grid.columns(), rowsCount);
+        const auto cellsOfSlice = grid.cells().subspan(rowIndex(slice, 0) * grid.stride(), matrix.cellsCount());
+        std::ranges::copy(cellsOfSlice, matrix.data());
+    }
+
+private:
+    CellGrid<Cell> grid; ///< Rows of stored slices one after another
+    int rowsCount = 0;   ///< Rows of one slice
+    int slicesCount = 0;
+    SliceRange stored;
+};
@@ -0,0 +1,34 @@
+/** @file DecodedStepCache.cpp
+ * @brief Memory budget shared by caches of decoded steps (DecodedStepCache.hpp). */
+
+#include <atomic>
+
+#include "DecodedStepCache.hpp"
+
+
+namespace
+{
+std::atomic<std::size_t> cacheBudgetInMegabytes = DecodedStepCacheSettings::defaultBudgetInMegabytes;
+std::atomic<bool> cacheStatisticsReported = false;
+} // namespace
+
+
+std::size_t DecodedStepCacheSettings::budgetInMegabytes()
+{
+    return cacheBudgetInMegabytes;
+}
+
+void DecodedStepCacheSettings::setBudgetInMegabytes(std::size_t megabytes)
+{
+    cacheBudgetInMegabytes = megabytes;
+}
+
+bool DecodedStepCacheSettings::statisticsReported()
+{
+    return cacheStatisticsReported;
+}
+
+void DecodedStepCacheSettings::setStatisticsReported(bool reported)
+{
+    cacheStatisticsReported = reported;
+}
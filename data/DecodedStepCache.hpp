@@ -0,0 +1,218 @@
+/** @file DecodedStepCache.hpp
+ * @brief Declaration of the DecodedStepCache class - memory budgeted LRU cache of already read steps. */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "core/types.h"
+#include "visualiser/Line.h"
+
+
+/// @brief Process wide memory budget of caches of decoded steps (all models together share it one at a time)
+namespace DecodedStepCacheSettings
+{
+inline constexpr std::size_t defaultBudgetInMegabytes = 512;
+
+std::size_t budgetInMegabytes();
+
+/// @brief Sets memory budget of caches of decoded steps, 0 disables caching
+void setBudgetInMegabytes(std::size_t megabytes);
+
+/// @brief If true hits and misses of a cache are printed when it is cleared (disabled by default)
+bool statisticsReported();
+
+void setStatisticsReported(bool reported);
+} // namespace DecodedStepCacheSettings
+
+
+/** @class DecodedStepCache
+ * @brief Least-recently-used cache of decoded steps (matrix of cells and load balancing lines) keyed by model and step.
+ *
+ * Going back and forth between steps (e.g. comparing flow fronts) does not read and parse data files again,
+ * the cached matrix is just copied into the displayed one (cells of contiguous grid are copied at once).
+ * Used memory is estimated from dimensions of matrices (sizeof of cells, memory allocated by cells itself is not counted),
+ * when it exceeds the budget (DecodedStepCacheSettings) the least recently used steps are evicted.
+ *
+ * @tparam Matrix Type of the matrix of cells (CellGrid)
+ * @note The class is not thread-safe, it is used from the GUI thread. */
+template<class Matrix>
+class DecodedStepCache
+{
+public:
+    struct Statistics
+    {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::size_t steps = 0;
+        std::size_t usedBytes = 0;
+        std::size_t budgetBytes = 0;
+    };
+
+    /// @param budgetBytes Memory budget, by default taken from DecodedStepCacheSettings when the step is stored
+    explicit DecodedStepCache(std::optional<std::size_t> budgetBytes = std::nullopt)
+        : fixedBudgetBytes{ budgetBytes }
+    {
+    }
+
+    /** @brief Copies the cached step into the matrix and lines.
+     * @return false if the step is not cached (or it was cached with different dimensions) */
+    bool get(const std::string& model, StepIndex step, Matrix& matrix, Line* lines, std::size_t linesCount);
+
+    /// @brief Checks if the step is cached (without counting hit or miss and changing order of eviction)
+    bool contains(const std::string& model, StepIndex step) const
+    {
+        return entries.contains(Key{ model, step });
+    }
+
+    /// @brief Stores copy of the step, the least recently used steps are evicted to keep the budget
+    void put(const std::string& model, StepIndex step, const Matrix& matrix, const Line* lines, std::size_t linesCount);
+
+    /// @brief Removes all steps (counters are kept)
+    void clear();
+
+    Statistics statistics() const;
+
+    std::size_t budgetBytes() const
+    {
+        return fixedBudgetBytes.value_or(DecodedStepCacheSettings::budgetInMegabytes() * 1024 * 1024);
+    }
+
+    /// @brief Estimated number of bytes needed to cache the matrix with the lines
+    static std::size_t estimatedBytes(const Matrix& matrix, std::size_t linesCount);
+
+private:
+    struct Key
+    {
+        std::string model;
+        StepIndex step;
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const
+        {
+            return std::hash<std::string>{}(key.model) ^ (std::hash<StepIndex>{}(key.step) * 0x9e3779b97f4a7c15ull);
+        }
+    };
+
+    struct Entry
+    {
+        Key key;
+        Matrix matrix;
+        std::vector<Line> lines;
+        std::size_t bytes;
+    };
+    using EntryList = std::list<Entry>;
+
+    void evictUntilFits(std::size_t additionalBytes);
+
+    const std::optional<std::size_t> fixedBudgetBytes;
+
+    EntryList recentlyUsed; ///< Most recently used at front
+    std::unordered_map<Key, typename EntryList::iterator, KeyHash> entries;
+    std::size_t usedBytes = 0;
+
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+};
+
+
+template<class Matrix>
+bool DecodedStepCache<Matrix>::get(const std::string& model, StepIndex step, Matrix& matrix, Line* lines, std::size_t linesCount)
+{
+    auto it = entries.find(Key{ model, step });
+    if (it == entries.end())
+    {
+        ++misses;
+        return false;
+    }
+
+    auto listIterator = it->second;
+    const bool sameDimensions = listIterator->matrix.hasSameDimensions(matrix) && listIterator->lines.size() == linesCount;
+    if (! sameDimensions)
+    {
+        usedBytes -= listIterator->bytes;
+        recentlyUsed.erase(listIterator);
+        entries.erase(it);
+        ++misses;
+        return false;
+    }
+
+    recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, listIterator);
+    matrix = listIterator->matrix;
+    std::ranges::copy(listIterator->lines, lines);
+
+    ++hits;
+    return true;
+}
+
+template<class Matrix>
+void DecodedStepCache<Matrix>::put(const std::string& model, StepIndex step, const Matrix& matrix, const Line* lines, std::size_t linesCount)
+{
+    const auto bytes = estimatedBytes(matrix, linesCount);
+    if (bytes > budgetBytes())
+        return;
+
+    Key key{ model, step };
+    if (auto it = entries.find(key); it != entries.end())
+    {
+        usedBytes -= it->second->bytes;
+        recentlyUsed.erase(it->second);
+        entries.erase(it);
+    }
+
+    evictUntilFits(bytes);
+
+    recentlyUsed.push_front(Entry{ key, matrix, std::vector<Line>(lines, lines + linesCount), bytes });
+    entries.emplace(std::move(key), recentlyUsed.begin());
+    usedBytes += bytes;
+}
+
+template<class Matrix>
+void DecodedStepCache<Matrix>::clear()
+{
+    entries.clear();
+    recentlyUsed.clear();
+    usedBytes = 0;
+}
+
+template<class Matrix>
+typename DecodedStepCache<Matrix>::Statistics DecodedStepCache<Matrix>::statistics() const
+{
+    return Statistics{
+        .hits = hits,
+        .misses = misses,
+        .steps = recentlyUsed.size(),
+        .usedBytes = usedBytes,
+        .budgetBytes = budgetBytes()
+    };
+}
+
+template<class Matrix>
+std::size_t DecodedStepCache<Matrix>::estimatedBytes(const Matrix& matrix, std::size_t linesCount)
+{
+    return sizeof(Entry) + linesCount * sizeof(Line) + matrix.cellsCount() * sizeof(typename Matrix::value_type);
+}
+
+template<class Matrix>
+void DecodedStepCache<Matrix>::evictUntilFits(std::size_t additionalBytes)
+{
+    const auto budget = budgetBytes();
+    while (! recentlyUsed.empty() && usedBytes + additionalBytes > budget)
+    {
+        usedBytes -= recentlyUsed.back().bytes;
+        entries.erase(recentlyUsed.back().key);
+        recentlyUsed.pop_back();
+    }
+}
@@ -0,0 +1,95 @@
+/** @file GridArena.cpp
+ * @brief Implementation of the GridArena class. */
+
+#include <algorithm>
+#include <new>
+
+#include "GridArena.h"
+
+
+GridArena& GridArena::instance()
+{
+    static GridArena instance;
+    return instance;
+}
+
+GridArena::~GridArena()
+{
+    trim();
+}
+
+GridArena::Block GridArena::acquire(std::size_t bytes)
+{
+    if (0 == bytes)
+        return {};
+
+    {
+        std::lock_guard lock(mutex);
+
+        // the smallest suitable block is taken, so bigger blocks stay for bigger grids
+        auto bestBlock = releasedBlocks.end();
+        for (auto it = releasedBlocks.begin(); it != releasedBlocks.end(); ++it)
+        {
+            const bool fits = it->capacity >= bytes && it->capacity / 2 <= bytes;
+            if (fits && (bestBlock == releasedBlocks.end() || it->capacity < bestBlock->capacity))
+                bestBlock = it;
+        }
+
+        if (bestBlock != releasedBlocks.end())
+        {
+            const auto block = *bestBlock;
+            releasedBlocks.erase(bestBlock);
+            releasedBytes -= block.capacity;
+            return block;
+        }
+    }
+
+    const auto capacity = (bytes + alignment - 1) / alignment * alignment;
+    return Block{ .data = static_cast<std::byte*>(::operator new(capacity, std::align_val_t{ alignment })), .capacity = capacity };
+}
+
+void GridArena::release(Block block)
+{
+    if (! block.data)
+        return;
+
+    std::vector<Block> blocksToFree;
+    {
+        std::lock_guard lock(mutex);
+        releasedBlocks.push_back(block);
+        releasedBytes += block.capacity;
+
+        auto oldestKeptBlock = releasedBlocks.begin();
+        while (releasedBytes > cachedBytesLimit && oldestKeptBlock != releasedBlocks.end())
+        {
+            releasedBytes -= oldestKeptBlock->capacity;
+            blocksToFree.push_back(*oldestKeptBlock++);
+        }
+        releasedBlocks.erase(releasedBlocks.begin(), oldestKeptBlock);
+    }
+
+    std::ranges::for_each(blocksToFree, &GridArena::free);
+}
+
+void GridArena::trim()
+{
+    std::vector<Block> blocksToFree;
+    {
+        std::lock_guard lock(mutex);
+        blocksToFree.swap(releasedBlocks);
+        releasedBytes = 0;
+    }
+
+    std::ranges::for_each(blocksToFree, &GridArena::free);
+}
+
+std::size_t GridArena::cachedBytes() const
+{
+    std::lock_guard lock(mutex);
+    return releasedBytes;
+}
+
+void GridArena::free(Block block)
+{
+    ::operator delete(block.data, std::align_val_t{ alignment });
+}
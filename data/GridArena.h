@@ -0,0 +1,68 @@
+/** @file GridArena.h
+ * @brief Declaration of the GridArena class - reusable memory blocks of cell grids (CellGrid). */
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/** @class GridArena
+ * @brief Process wide pool of memory blocks for cell grids.
+ *
+ * Every CellGrid keeps all its cells in one block. When the grid is destroyed or resized the block
+ * is returned into the arena and it is reused by the next grid of similar size, so reloading the model,
+ * switching between models or recycling matrices of the read-ahead does not allocate gigabytes again.
+ * Released blocks are kept only up to the limit of cached bytes, the oldest ones are freed first.
+ *
+ * @note The class is thread-safe (grids are created also by background reading of steps). */
+class GridArena
+{
+public:
+    static constexpr std::size_t alignment = 64;                     ///< Blocks start at a cache line
+    static constexpr std::size_t defaultCachedBytesLimit = 1ull << 30; ///< Released blocks kept for reuse
+
+    /// @brief Memory block of the arena
+    struct Block
+    {
+        std::byte* data = nullptr;
+        std::size_t capacity = 0;
+    };
+
+    /// @brief Get singleton instance
+    static GridArena& instance();
+
+    explicit GridArena(std::size_t cachedBytesLimit = defaultCachedBytesLimit)
+        : cachedBytesLimit{ cachedBytesLimit }
+    {
+    }
+
+    ~GridArena();
+
+    GridArena(const GridArena&) = delete;
+    GridArena& operator=(const GridArena&) = delete;
+
+    /** @brief Returns block of at least bytes (aligned to alignment).
+     *
+     * Released block is reused if it is big enough, but not more than twice bigger (small grid should not hold huge block).
+     * @throws std::bad_alloc If new block can not be allocated */
+    Block acquire(std::size_t bytes);
+
+    /// @brief Returns the block into the arena (empty block is ignored)
+    void release(Block block);
+
+    /// @brief Frees all released blocks
+    void trim();
+
+    /// @brief Total capacity of released blocks waiting for reuse
+    std::size_t cachedBytes() const;
+
+private:
+    static void free(Block block);
+
+    const std::size_t cachedBytesLimit;
+
+    mutable std::mutex mutex;
+    std::vector<Block> releasedBlocks; ///< The most recently released at back
+    std::size_t releasedBytes = 0;
+};
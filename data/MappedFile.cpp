@@ -0,0 +1,134 @@
+/** @file MappedFile.cpp
+ * @brief Implementation of the MappedFile class. */
+
+#include <algorithm>
+#include <format>
+#include <stdexcept>
+
+#ifdef _WIN32
+#   define WIN32_LEAN_AND_MEAN
+#   define NOMINMAX
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+#include "MappedFile.h"
+
+
+MappedFile::MappedFile(const std::string& filePath)
+    : filePath{filePath}
+{
+#ifdef _WIN32
+    HANDLE fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                    nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (INVALID_HANDLE_VALUE == fileHandle)
+    {
+        throw std::runtime_error(std::format("Cannot open file '{}' for mapping!", filePath));
+    }
+
+    LARGE_INTEGER fileSize{};
+    if (! GetFileSizeEx(fileHandle, &fileSize))
+    {
+        CloseHandle(fileHandle);
+        throw std::runtime_error(std::format("Cannot read size of file '{}'!", filePath));
+    }
+    mappedSize = static_cast<std::size_t>(fileSize.QuadPart);
+    if (0 == mappedSize)
+    {
+        CloseHandle(fileHandle);
+        return;
+    }
+
+    HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(fileHandle); // the mapping object keeps the file open
+    if (! mappingHandle)
+    {
+        mappedSize = 0;
+        throw std::runtime_error(std::format("Cannot create mapping of file '{}'!", filePath));
+    }
+
+    mappedData = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    CloseHandle(mappingHandle); // the view keeps the mapping object alive
+    if (! mappedData)
+    {
+        mappedSize = 0;
+        throw std::runtime_error(std::format("Cannot map file '{}'!", filePath));
+    }
+#else
+    const int fileDescriptor = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor < 0)
+    {
+        throw std::runtime_error(std::format("Cannot open file '{}' for mapping!", filePath));
+    }
+
+    struct stat fileStatus{};
+    if (::fstat(fileDescriptor, &fileStatus) != 0)
+    {
+        ::close(fileDescriptor);
+        throw std::runtime_error(std::format("Cannot read size of file '{}'!", filePath));
+    }
+    mappedSize = static_cast<std::size_t>(fileStatus.st_size);
+    if (0 == mappedSize)
+    {
+        ::close(fileDescriptor);
+        return;
+    }
+
+    void* address = ::mmap(nullptr, mappedSize, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+    ::close(fileDescriptor); // the mapping stays valid after closing the descriptor
+    if (MAP_FAILED == address)
+    {
+        mappedSize = 0;
+        throw std::runtime_error(std::format("Cannot map file '{}'!", filePath));
+    }
+    mappedData = static_cast<const char*>(address);
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+std::string_view MappedFile::viewFrom(std::size_t offset) const
+{
+    if (offset > mappedSize)
+    {
+        throw std::out_of_range(std::format("Offset {} is outside of mapped file '{}' (size {})", offset, filePath, mappedSize));
+    }
+    return { mappedData + offset, mappedSize - offset };
+}
+
+void MappedFile::adviseWillNeed(std::size_t offset, std::size_t length) const
+{
+#if defined(_WIN32)
+    (void)offset;
+    (void)length;
+#else
+    if (! mappedData || offset >= mappedSize)
+        return;
+
+    // madvise requires page aligned address
+    static const std::size_t pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t alignedOffset = offset - offset % pageSize;
+    length = std::min(length + (offset - alignedOffset), mappedSize - alignedOffset);
+    ::madvise(const_cast<char*>(mappedData) + alignedOffset, length, MADV_WILLNEED);
+#endif
+}
+
+void MappedFile::unmap()
+{
+#ifdef _WIN32
+    if (mappedData)
+        UnmapViewOfFile(mappedData);
+#else
+    if (mappedData)
+        ::munmap(const_cast<char*>(mappedData), mappedSize);
+#endif
+    mappedData = nullptr;
+    mappedSize = 0;
+}
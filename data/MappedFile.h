@@ -0,0 +1,68 @@
+/** @file MappedFile.h
+ * @brief Declaration of the MappedFile class - read-only memory mapping of a whole file.
+ *
+ * The class is used by ModelReader to access per-node data files without
+ * reopening and seeking them with std::ifstream on every simulation step. */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/** @class MappedFile
+ * @brief RAII wrapper of a read-only memory mapped file.
+ *
+ * The whole file is mapped at construction time and the mapping stays valid until the object is destroyed.
+ * The file descriptor (handle) is closed right after mapping, so mapped files do not count
+ * to the limit of open files of the process.
+ * The file can grow while it is mapped (e.g. simulation is still writing it), then a new object has to be created
+ * to see the new content (see MappedFilePool).
+ *
+ * @note Data returned by the class is read-only, the mapping is never modified. */
+class MappedFile
+{
+public:
+    /** @brief Maps the whole file into memory.
+     * @param filePath Path of the file to map
+     * @throws std::runtime_error If the file can not be opened or mapped */
+    explicit MappedFile(const std::string& filePath);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// @brief Path of the mapped file
+    const std::string& path() const
+    {
+        return filePath;
+    }
+
+    /// @brief Pointer to the first byte of the mapping (nullptr for empty file)
+    const char* data() const
+    {
+        return mappedData;
+    }
+
+    /// @brief Number of mapped bytes
+    std::size_t size() const
+    {
+        return mappedSize;
+    }
+
+    /** @brief Returns the part of the file starting at given offset up to the end of the mapping.
+     * @throws std::out_of_range If offset is outside of the mapping */
+    std::string_view viewFrom(std::size_t offset) const;
+
+    /** @brief Hints the operating system that given range will be read soon.
+     * It is only a hint, the function does nothing when it is not supported by the platform. */
+    void adviseWillNeed(std::size_t offset, std::size_t length) const;
+
+private:
+    void unmap();
+
+    std::string filePath;
+    const char* mappedData = nullptr;
+    std::size_t mappedSize = 0;
+};
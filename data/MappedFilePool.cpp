@@ -0,0 +1,83 @@
+/** @file MappedFilePool.cpp
+ * @brief Implementation of the MappedFilePool class. */
+
+#include <algorithm>
+
+#ifndef _WIN32
+#   include <sys/resource.h>
+#endif
+
+#include "MappedFilePool.h"
+
+
+MappedFilePool::MappedFilePool(std::size_t capacity)
+    : maxMappedFiles{std::max<std::size_t>(1, capacity)}
+{
+}
+
+std::size_t MappedFilePool::defaultCapacity()
+{
+    constexpr std::size_t minimalCapacity = 16;
+    constexpr std::size_t maximalCapacity = 8192;
+
+#ifdef _WIN32
+    constexpr std::size_t openFilesLimit = 512; // default limit of the C runtime
+#else
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0 || RLIM_INFINITY == limit.rlim_cur)
+        return maximalCapacity;
+
+    const auto openFilesLimit = static_cast<std::size_t>(limit.rlim_cur);
+#endif
+    return std::clamp(openFilesLimit / 2, minimalCapacity, maximalCapacity);
+}
+
+std::shared_ptr<const MappedFile> MappedFilePool::acquire(const std::string& filePath, std::size_t minimalSize)
+{
+    {
+        std::lock_guard lock(mutex);
+        if (auto it = mappedFiles.find(filePath); it != mappedFiles.end())
+        {
+            auto listIterator = it->second;
+            if ((*listIterator)->size() >= minimalSize)
+            {
+                recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, listIterator);
+                return *listIterator;
+            }
+        }
+    }
+
+    // Mapping outside of the lock, on network file systems opening can be slow
+    std::shared_ptr<const MappedFile> mappedFile = std::make_shared<MappedFile>(filePath);
+
+    std::lock_guard lock(mutex);
+    if (auto it = mappedFiles.find(filePath); it != mappedFiles.end())
+    {
+        recentlyUsed.erase(it->second);
+        mappedFiles.erase(it);
+    }
+
+    recentlyUsed.push_front(mappedFile);
+    mappedFiles.emplace(filePath, recentlyUsed.begin());
+
+    while (recentlyUsed.size() > maxMappedFiles)
+    {
+        mappedFiles.erase(recentlyUsed.back()->path());
+        recentlyUsed.pop_back();
+    }
+
+    return mappedFile;
+}
+
+void MappedFilePool::clear()
+{
+    std::lock_guard lock(mutex);
+    mappedFiles.clear();
+    recentlyUsed.clear();
+}
+
+std::size_t MappedFilePool::size() const
+{
+    std::lock_guard lock(mutex);
+    return recentlyUsed.size();
+}
@@ -0,0 +1,63 @@
+/** @file MappedFilePool.h
+ * @brief Declaration of the MappedFilePool class - bounded LRU cache of memory mapped data files. */
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "data/MappedFile.h"
+
+/** @class MappedFilePool
+ * @brief Bounded pool of memory mapped files with least-recently-used eviction.
+ *
+ * The pool is owned by ModelReader and reused across steps, so every node's data file
+ * is opened once instead of twice per step (header read and parsing share the same mapping).
+ * Number of kept mappings is bounded, by default it is derived from the limit of open files
+ * of the process (RLIMIT_NOFILE), so runs with thousands of nodes do not exhaust the system resources.
+ *
+ * Files are returned as shared pointers: an evicted (or replaced) mapping stays valid
+ * until the last user releases it. The class is thread-safe. */
+class MappedFilePool
+{
+public:
+    explicit MappedFilePool(std::size_t capacity = defaultCapacity());
+
+    MappedFilePool(const MappedFilePool&) = delete;
+    MappedFilePool& operator=(const MappedFilePool&) = delete;
+
+    /** @brief Returns mapping of the file, the file is mapped if it is not in the pool.
+     *
+     * If the mapping is smaller than @p minimalSize, the file is mapped again
+     * (simulation may still be writing it) and the old mapping is replaced in the pool.
+     * @throws std::runtime_error If the file can not be mapped */
+    std::shared_ptr<const MappedFile> acquire(const std::string& filePath, std::size_t minimalSize = 0);
+
+    /// @brief Releases all mappings of the pool (mappings still used outside are released by their users)
+    void clear();
+
+    /// @brief Number of mappings kept in the pool
+    std::size_t size() const;
+
+    std::size_t capacity() const
+    {
+        return maxMappedFiles;
+    }
+
+    /** @brief Default capacity: half of the soft limit of open files of the process (clamped to a sane range).
+     * The rest of the limit is left for other parts of the application (Qt, VTK, plugins, streams). */
+    static std::size_t defaultCapacity();
+
+private:
+    using MappedFileList = std::list<std::shared_ptr<const MappedFile>>;
+
+    mutable std::mutex mutex;
+    const std::size_t maxMappedFiles;
+
+    MappedFileList recentlyUsed; ///< Most recently used at front
+    std::unordered_map<std::string, MappedFileList::iterator> mappedFiles;
+};
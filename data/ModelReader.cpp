@@ -1,7 +1,103 @@
+#include <charconv> // std::from_chars
+#include <iterator> // std::back_inserter
+
 #include "ModelReader.hpp"
 
 
-ColumnAndRow ReaderHelpers::getColumnAndRowFromLine(const std::string& line)
+namespace
+{
+bool isBlank(char character)
+{
+    return ' ' == character || '\t' == character || '\r' == character;
+}
+
+std::string_view skipBlanks(std::string_view text)
+{
+    while (! text.empty() && isBlank(text.front()))
+        text.remove_prefix(1);
+    return text;
+}
+
+bool isDigit(char character)
+{
+    return character >= '0' && character <= '9';
+}
+
+/// @brief Parses number at the beginning of the text (after blanks), on success the number is removed from the text
+template<typename Number>
+bool consumeNumber(std::string_view& text, Number& number)
+{
+    text = skipBlanks(text);
+    if (text.empty() || ! isDigit(text.front()))
+        return false;
+
+    const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), number);
+    if (error != std::errc{})
+        return false;
+
+    text.remove_prefix(static_cast<std::size_t>(end - text.data()));
+    return true;
+}
+
+/// @brief Parses "(C-R)" token of extended index format
+std::optional<ColumnAndRow> parseSceneSize(std::string_view token)
+{
+    if (token.size() < 2 || token.front() != '(' || token.back() != ')')
+        return std::nullopt;
+    token = token.substr(1, token.size() - 2);
+
+    int columns{}, rows{};
+    if (! consumeNumber(token, columns) || token.empty() || token.front() != '-')
+        return std::nullopt;
+    token.remove_prefix(1);
+    if (! consumeNumber(token, rows) || ! token.empty())
+        return std::nullopt;
+
+    return ColumnAndRow{ .column = columns, .row = rows };
+}
+
+/// @brief Parses header line of a step in text data file: "C-R" (one slice) or "C-R-S" of 3D models
+std::optional<VolumeSize> parseStepHeader(std::string_view line)
+{
+    int columns{}, rows{}, slices{ 1 };
+    if (! consumeNumber(line, columns) || line.empty() || line.front() != '-')
+        return std::nullopt;
+    line.remove_prefix(1);
+    if (! consumeNumber(line, rows))
+        return std::nullopt;
+    if (! line.empty() && line.front() == '-')
+    {
+        line.remove_prefix(1);
+        if (! consumeNumber(line, slices))
+            return std::nullopt;
+    }
+    if (! skipBlanks(line).empty() || columns <= 0 || rows <= 0 || slices <= 0)
+        return std::nullopt;
+
+    return VolumeSize{ .column = columns, .row = rows, .slice = slices };
+}
+
+std::size_t countTokens(std::string_view line)
+{
+    std::size_t tokens = 0;
+    bool insideToken = false;
+    for (const char character : line)
+    {
+        const bool blank = isBlank(character);
+        if (! blank && ! insideToken)
+            ++tokens;
+        insideToken = ! blank;
+    }
+    return tokens;
+}
+
+/// @brief Bytes read before the already parsed part of index file to find beginning of its line (index lines are much shorter)
+constexpr FilePosition indexLineLookBehind = 256;
+} // namespace
+
+
+
+ColumnAndRow ReaderHelpers::getColumnAndRowFromLine(std::string_view line)
 {
     /// input format: "C-R" for 2D or "C-R-S" for 3D where C, R, and S are numbers
     /// For 3D models, we only extract C and R (columns and rows), ignoring slices
@@ -11,27 +107,27 @@ ColumnAndRow ReaderHelpers::getColumnAndRowFromLine(const std::string& line)
     }
 
     const auto firstDelimiterPos = line.find('-');
-    if (firstDelimiterPos == std::string::npos)
+    if (firstDelimiterPos == std::string_view::npos)
     {
-        throw std::runtime_error("No delimiter '-' found in the line: >" + line + "<");
+        throw std::runtime_error("No delimiter '-' found in the line: >" + std::string(line) + "<");
     }
 
-    const auto x = std::stoi(line.substr(0, firstDelimiterPos));
+    const auto x = std::stoi(std::string(line.substr(0, firstDelimiterPos)));
     
     // Find second delimiter to check if this is 3D format (C-R-S)
     const auto secondDelimiterPos = line.find('-', firstDelimiterPos + 1);
     
     int y;
-    if (secondDelimiterPos != std::string::npos)
+    if (secondDelimiterPos != std::string_view::npos)
     {
         // 3D format: C-R-S, extract R from between first and second delimiter
-        y = std::stoi(line.substr(firstDelimiterPos + 1, secondDelimiterPos - firstDelimiterPos - 1));
+        y = std::stoi(std::string(line.substr(firstDelimiterPos + 1, secondDelimiterPos - firstDelimiterPos - 1)));
         // Note: We ignore the slice count (S) here as it's handled separately
     }
     else
     {
         // 2D format: C-R
-        y = std::stoi(line.substr(firstDelimiterPos + 1));
+        y = std::stoi(std::string(line.substr(firstDelimiterPos + 1)));
     }
     
     return ColumnAndRow::xy(x, y);
@@ -60,3 +156,409 @@ ColumnAndRow ReaderHelpers::calculateXYOffsetForNode(NodeIndex node,
     }
     return ColumnAndRow::xy(offsetX, offsetY);
 }
+
+VolumeSize ReaderHelpers::getVolumeSizeFromLine(std::string_view line)
+{
+    if (const auto volumeSize = parseStepHeader(line))
+        return *volumeSize;
+    throw std::runtime_error(std::format("Invalid header of step (expected \"C-R-S\" or \"C-R\"): >{}<", line));
+}
+
+VolumeSize ReaderHelpers::calculateXYZOffsetForNode(NodeIndex node, NodeIndex nNodeX, NodeIndex nNodeY, const std::vector<VolumeSize>& volumeSizes)
+{
+    const NodeIndex nodesInLayer = nNodeX * nNodeY;
+    const NodeIndex nodeX = node % nNodeX;
+    const NodeIndex nodeY = (node % nodesInLayer) / nNodeX;
+    const NodeIndex nodeZ = node / nodesInLayer;
+
+    VolumeSize offset;
+    for (NodeIndex x = 0; x < nodeX; ++x)
+        offset.column += volumeSizes[node - nodeX + x].column;
+    for (NodeIndex y = 0; y < nodeY; ++y)
+        offset.row += volumeSizes[node - (nodeY - y) * nNodeX].row;
+    for (NodeIndex z = 0; z < nodeZ; ++z)
+        offset.slice += volumeSizes[node - (nodeZ - z) * nodesInLayer].slice;
+    return offset;
+}
+
+void ReaderHelpers::setVolumeNodesLines(Line* lines, std::span<const VolumeNodePlacement> nodes, NodeIndex nNodeX, NodeIndex nNodeY, int slice, int volumeColumns, int volumeRows)
+{
+    const NodeIndex nodesInLayer = nNodeX * nNodeY;
+    for (std::size_t node = 0; node < nodes.size(); ++node)
+    {
+        const auto& [offset, size] = nodes[node];
+        if (offset.slice <= slice && slice < offset.slice + size.slice)
+        {
+            setNodeLines(lines, static_cast<NodeIndex>(node % nodesInLayer), nNodeX, nNodeY, ColumnAndRow::xy(offset.column, offset.row),
+                         ColumnAndRow::xy(size.column, size.row), volumeColumns, volumeRows);
+        }
+    }
+}
+
+void ReaderHelpers::setNodeLines(Line* lines, NodeIndex node, NodeIndex nNodeX, NodeIndex nNodeY, ColumnAndRow offsetXY, ColumnAndRow columnAndRow, int matrixColumns, int matrixRows)
+{
+    const NodeIndex totalNodes = nNodeX * nNodeY;
+    const int x1 = std::min(offsetXY.x(), matrixColumns - 1);
+    const int y1 = std::min(offsetXY.y(), matrixRows - 1);
+    const int x2 = std::min(offsetXY.x() + columnAndRow.column, matrixColumns);
+    const int y2 = std::min(offsetXY.y() + columnAndRow.row, matrixRows);
+
+    // Define boundary lines for the node (bottom and left edges)
+    lines[node * 2] = Line(x1, y1, x2, y1);
+    lines[node * 2 + 1] = Line(x1, y1, x1, y2);
+
+    // Add top edge line for nodes in the last row (highest y)
+    const NodeIndex nodeRow = node / nNodeX;
+    if (nodeRow == nNodeY - 1) // Top row
+    {
+        const int topLineIndex = 2 * totalNodes + (node % nNodeX);
+        lines[topLineIndex] = Line(x1, y2, x2, y2);
+    }
+
+    // Add right edge line for nodes in the last column (highest x)
+    const NodeIndex nodeCol = node % nNodeX;
+    if (nodeCol == nNodeX - 1) // Rightmost column
+    {
+        const int rightLineIndex = 2 * totalNodes + nNodeX + nodeRow;
+        lines[rightLineIndex] = Line(x2, y1, x2, y2);
+    }
+}
+
+GridRegion ReaderHelpers::nodeRegionInMatrix(ColumnAndRow offsetXY, ColumnAndRow columnAndRow, int matrixColumns, int matrixRows)
+{
+    return GridRegion{ .firstColumn = offsetXY.x(),
+                       .firstRow = offsetXY.y(),
+                       .endColumn = std::min(offsetXY.x() + columnAndRow.column, matrixColumns),
+                       .endRow = std::min(offsetXY.y() + columnAndRow.row, matrixRows) };
+}
+
+std::optional<StepIndex> ReaderHelpers::loadBalancingPeriod(StepIndex step, int firstLB, int stepLB)
+{
+    if (firstLB <= 0 || stepLB <= 0)
+        return std::nullopt;
+
+    const auto firstLoadBalancingStep = static_cast<StepIndex>(firstLB);
+    if (step < firstLoadBalancingStep)
+        return 0;
+
+    const auto stepsAfterFirstLoadBalancing = step - firstLoadBalancingStep;
+    if (stepsAfterFirstLoadBalancing % stepLB == 0)
+        return std::nullopt; // load balancing step
+
+    return 1 + stepsAfterFirstLoadBalancing / stepLB;
+}
+
+std::vector<ReaderHelpers::IndexEntry> ReaderHelpers::parseIndexFileContent(std::string_view content, const std::string& fileName)
+{
+    std::vector<IndexEntry> entries;
+    entries.reserve(static_cast<std::size_t>(std::ranges::count(content, '\n')) + 1);
+
+    while (! content.empty())
+    {
+        const auto endOfLine = content.find('\n');
+        const auto line = content.substr(0, endOfLine);
+        content.remove_prefix(endOfLine == std::string_view::npos ? content.size() : endOfLine + 1);
+
+        auto rest = skipBlanks(line);
+        if (rest.empty())
+            continue;
+
+        IndexEntry entry{};
+        if (! consumeNumber(rest, entry.step) || ! consumeNumber(rest, entry.position))
+            throw std::runtime_error("Invalid line format in file: " + fileName);
+
+        // Optional "(columns-rows)" part, anything after it is ignored
+        rest = skipBlanks(rest);
+        if (! rest.empty())
+        {
+            const auto sceneSizeToken = rest.substr(0, std::ranges::find_if(rest, isBlank) - rest.begin());
+            entry.sceneSize = parseSceneSize(sceneSizeToken);
+            if (! entry.sceneSize)
+                throw std::runtime_error("Invalid range format in file: " + fileName + " line: " + std::string(line));
+        }
+
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+std::optional<ReaderHelpers::IndexFileTail> ReaderHelpers::readIndexFileTail(const std::string& fileName, FilePosition parsedSize)
+{
+    std::error_code errorCode;
+    const auto fileSize = static_cast<FilePosition>(std::filesystem::file_size(fileName, errorCode));
+    if (errorCode)
+        return IndexFileTail{ .entries = {}, .parsedSize = parsedSize }; // the file was not written yet
+    if (fileSize < parsedSize)
+        return std::nullopt;
+    if (fileSize == parsedSize)
+        return IndexFileTail{ .entries = {}, .parsedSize = parsedSize };
+
+    const FilePosition readStart = std::max(parsedSize - indexLineLookBehind, FilePosition{ 0 });
+    std::string content(static_cast<std::size_t>(fileSize - readStart), '\0');
+    std::ifstream file(fileName, std::ios::binary);
+    if (! file || ! file.seekg(readStart) || ! file.read(content.data(), static_cast<std::streamsize>(content.size())))
+        throw std::runtime_error(std::format("Cannot read file '{}'", fileName));
+
+    // the line at parsedSize is read again, it was not terminated by '\n' when it was parsed
+    std::string_view text = content;
+    const auto parsedPart = text.substr(0, static_cast<std::size_t>(parsedSize - readStart));
+    const auto lastParsedNewLine = parsedPart.rfind('\n');
+    if (lastParsedNewLine != std::string_view::npos)
+        text.remove_prefix(lastParsedNewLine + 1);
+    else if (readStart > 0)
+        text.remove_prefix(parsedPart.size());
+    const auto textStart = readStart + static_cast<FilePosition>(content.size() - text.size());
+
+    const auto lastNewLine = text.rfind('\n');
+    const auto completeLines = (lastNewLine == std::string_view::npos) ? std::string_view{} : text.substr(0, lastNewLine + 1);
+    IndexFileTail tail{ .entries = parseIndexFileContent(completeLines, fileName),
+                        .parsedSize = textStart + static_cast<FilePosition>(completeLines.size()) };
+
+    try
+    {
+        std::ranges::copy(parseIndexFileContent(text.substr(completeLines.size()), fileName), std::back_inserter(tail.entries));
+    }
+    catch (const std::runtime_error&)
+    {
+        // the simulation did not write the rest of the line yet
+    }
+    return tail;
+}
+
+std::optional<ReaderHelpers::IndexEntry> ReaderHelpers::readLastIndexEntry(const std::string& fileName)
+{
+    const auto fileSize = static_cast<FilePosition>(std::filesystem::file_size(fileName));
+    const FilePosition readStart = std::max(fileSize - indexLineLookBehind, FilePosition{ 0 });
+    std::string content(static_cast<std::size_t>(fileSize - readStart), '\0');
+    std::ifstream file(fileName, std::ios::binary);
+    if (! file || ! file.seekg(readStart) || ! file.read(content.data(), static_cast<std::streamsize>(content.size())))
+        throw std::runtime_error(std::format("Cannot read file '{}'", fileName));
+
+    std::string_view text = content;
+    if (readStart > 0)
+    {
+        const auto firstNewLine = text.find('\n');
+        text.remove_prefix(firstNewLine == std::string_view::npos ? text.size() : firstNewLine + 1); // the first line can be cut
+    }
+
+    // lines from the end, the last one may be still being written
+    while (! text.empty())
+    {
+        const auto previousNewLine = text.substr(0, text.size() - 1).rfind('\n');
+        const auto lineStart = (previousNewLine == std::string_view::npos) ? 0 : previousNewLine + 1;
+        const auto line = text.substr(lineStart);
+        text = text.substr(0, lineStart);
+        try
+        {
+            if (auto entries = parseIndexFileContent(line, fileName); ! entries.empty())
+                return entries.back();
+        }
+        catch (const std::runtime_error&)
+        {
+            if (line.ends_with('\n'))
+                throw;
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<ReaderHelpers::ScannedStep> ReaderHelpers::scanTextDataFile(std::string_view content, FilePosition startPosition)
+{
+    struct HeaderCandidate
+    {
+        std::size_t position;
+        std::size_t line; ///< Number of the line counted from startPosition
+        VolumeSize volumeSize;
+    };
+
+    struct Chunk
+    {
+        std::size_t begin;
+        std::size_t end;
+        std::size_t newlines = 0; ///< Number of '\n' in [begin, end)
+        std::vector<HeaderCandidate> candidates;
+    };
+
+    const auto start = static_cast<std::size_t>(std::max<FilePosition>(startPosition, 0));
+    if (start >= content.size())
+        return {};
+
+    constexpr std::size_t chunkSize = 4 << 20;
+    std::vector<Chunk> chunks((content.size() - start + chunkSize - 1) / chunkSize);
+    for (std::size_t index = 0; index < chunks.size(); ++index)
+    {
+        chunks[index].begin = start + index * chunkSize;
+        chunks[index].end = std::min(chunks[index].begin + chunkSize, content.size());
+    }
+
+    /// Phase 1: chunks are searched in parallel for lines looking like step headers (line numbers are local to chunks)
+    ThreadPool::instance().parallelFor(chunks.size(),
+                                       [&](std::size_t index)
+                                       {
+                                           auto& chunk = chunks[index];
+                                           auto position = chunk.begin;
+                                           if (position != start && content[position - 1] != '\n')
+                                           {
+                                               // the line started in the previous chunk
+                                               const auto newline = content.find('\n', position);
+                                               if (newline == std::string_view::npos || newline >= chunk.end)
+                                                   return;
+                                               chunk.newlines = 1;
+                                               position = newline + 1;
+                                           }
+
+                                           while (position < chunk.end)
+                                           {
+                                               const auto newline = content.find('\n', position);
+                                               const auto lineEnd = (newline == std::string_view::npos) ? content.size() : newline;
+                                               if (const auto volumeSize = parseStepHeader(content.substr(position, lineEnd - position)))
+                                                   chunk.candidates.push_back({ position, chunk.newlines, *volumeSize });
+
+                                               if (newline == std::string_view::npos || newline >= chunk.end)
+                                                   break;
+                                               ++chunk.newlines;
+                                               position = newline + 1;
+                                           }
+                                       });
+
+    std::vector<HeaderCandidate> candidates;
+    std::size_t newlinesBefore = 0;
+    for (const auto& chunk : chunks)
+    {
+        for (auto candidate : chunk.candidates)
+        {
+            candidate.line += newlinesBefore;
+            candidates.push_back(candidate);
+        }
+        newlinesBefore += chunk.newlines;
+    }
+    const auto newlinesCount = newlinesBefore;
+
+    /// Phase 2: headers are chained - the next step starts right after rows of the previous one
+    /// (it filters out rows which only look like headers, e.g. single column of cells "a-b")
+    const auto lastLineStart = content.rfind('\n');
+    const auto lastLine = content.substr((lastLineStart == std::string_view::npos || lastLineStart < start) ? start : lastLineStart + 1);
+
+    std::vector<ScannedStep> steps;
+    auto candidate = candidates.begin();
+    if (candidate == candidates.end() || candidate->line != 0)
+        return steps;
+
+    while (true)
+    {
+        // slices of 3D models follow one another, each of them has R rows
+        const auto& volumeSize = candidate->volumeSize;
+        const auto nextStepLine = candidate->line + 1 + static_cast<std::size_t>(volumeSize.row) * static_cast<std::size_t>(volumeSize.slice);
+
+        // every row is terminated by '\n', only the last row of the file may be without it
+        const bool completeStep = nextStepLine <= newlinesCount
+                                  || (nextStepLine == newlinesCount + 1 && countTokens(lastLine) >= static_cast<std::size_t>(volumeSize.column));
+        if (! completeStep)
+            break;
+
+        steps.push_back({ static_cast<FilePosition>(candidate->position), ColumnAndRow::xy(volumeSize.column, volumeSize.row) });
+
+        candidate = std::ranges::lower_bound(candidate + 1, candidates.end(), nextStepLine, {}, &HeaderCandidate::line);
+        if (candidate == candidates.end() || candidate->line != nextStepLine)
+            break;
+    }
+    return steps;
+}
+
+std::vector<ReaderHelpers::ScannedStep> ReaderHelpers::scanBinaryDataFile(std::size_t fileSize, FilePosition startPosition, ColumnAndRow sceneSize, std::size_t cellSize)
+{
+    const auto stepSize = static_cast<std::size_t>(sceneSize.column) * static_cast<std::size_t>(sceneSize.row) * cellSize;
+    if (0 == stepSize || startPosition < 0)
+        return {};
+
+    std::vector<ScannedStep> steps;
+    for (auto position = static_cast<std::size_t>(startPosition); position + stepSize <= fileSize; position += stepSize)
+    {
+        steps.push_back({ static_cast<FilePosition>(position), sceneSize });
+    }
+    return steps;
+}
+
+std::vector<StepIndex> ReaderHelpers::inferStepNumbers(std::span<const StepIndex> knownSteps, std::span<const StepIndex> referenceSteps, std::size_t count)
+{
+    const bool useReference = referenceSteps.size() > knownSteps.size() && std::ranges::equal(knownSteps, referenceSteps.first(knownSteps.size()));
+    const auto steps = useReference ? referenceSteps : knownSteps;
+
+    std::vector<StepIndex> numbers;
+    numbers.reserve(count);
+
+    const auto stepAt = [&](std::size_t index)
+    {
+        return index < steps.size() ? steps[index] : numbers[index - knownSteps.size()];
+    };
+
+    for (auto index = knownSteps.size(); index < knownSteps.size() + count; ++index)
+    {
+        if (index < steps.size())
+        {
+            numbers.push_back(steps[index]);
+        }
+        else if (0 == index)
+        {
+            numbers.push_back(0);
+        }
+        else
+        {
+            // the last difference of steps is repeated (steps are often saved every N steps)
+            const auto previous = stepAt(index - 1);
+            const auto difference = (index >= 2 && previous > stepAt(index - 2)) ? previous - stepAt(index - 2) : 1;
+            numbers.push_back(previous + difference);
+        }
+    }
+    return numbers;
+}
+
+void ReaderHelpers::writeIndexFile(const std::string& fileName, std::span<const IndexEntry> entries, bool append)
+{
+    std::string content;
+    if (append)
+    {
+        // the last line of existing file may be without '\n'
+        std::ifstream existingFile(fileName, std::ios::binary | std::ios::ate);
+        if (existingFile && existingFile.tellg() > 0)
+        {
+            char lastCharacter{};
+            existingFile.seekg(-1, std::ios::end);
+            if (existingFile.get(lastCharacter) && lastCharacter != '\n')
+                content += '\n';
+        }
+    }
+
+
+    for (const auto& entry : entries)
+    {
+        if (entry.sceneSize)
+            content += std::format("{} {} ({}-{})\n", entry.step, entry.position, entry.sceneSize->column, entry.sceneSize->row);
+        else
+            content += std::format("{} {}\n", entry.step, entry.position);
+    }
+
+    const auto writeContent = [&content](const std::string& filePath, std::ios::openmode mode)
+    {
+        std::ofstream file(filePath, std::ios::binary | mode);
+        if (! file || ! file.write(content.data(), static_cast<std::streamsize>(content.size())) || ! file.flush())
+            throw std::runtime_error(std::format("Cannot write file '{}'", filePath));
+    };
+
+    if (append)
+    {
+        writeContent(fileName, std::ios::app);
+        return;
+    }
+
+    const auto temporaryFileName = fileName + ".tmp";
+    writeContent(temporaryFileName, std::ios::trunc);
+
+    std::error_code errorCode;
+    std::filesystem::rename(temporaryFileName, fileName, errorCode);
+    if (errorCode)
+    {
+        std::filesystem::remove(temporaryFileName, errorCode);
+        throw std::runtime_error(std::format("Cannot rename '{}' to '{}'", temporaryFileName, fileName));
+    }
+}
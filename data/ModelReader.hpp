@@ -8,24 +8,45 @@
 #pragma once
 
 #include <algorithm> // std::ranges::sort
+#include <atomic>
 #include <climits>   // INT_MAX
 #include <cmath>     // log10
+#include <cstdint>   // std::uintptr_t
 #include <cstring>   // std::memcpy
 #include <filesystem>
 #include <format>
 #include <fstream>
-#include <future>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <ranges>
-#include <regex>
+#include <span>
+#include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
+#include "core/ThreadPool.h"
 #include "core/types.h"
+#include "data/CellGrid.hpp"
+#include "data/CellVolume.hpp"
+#include "data/MappedFilePool.h"
+#include "data/RowTokenizer.h"
+#include "data/StepOffsetsTable.h"
 #include "visualiser/Line.h"
 #include "visualiser/SettingParameter.h"
 #include "plugins/CellConcept.hpp"
 
+/// @brief Part of the grid of 3D model covered by a node in a step
+struct VolumeNodePlacement
+{
+    VolumeSize offset; ///< Columns, rows and slices of nodes before the node
+    VolumeSize size;   ///< Dimensions of the node
+};
+
 /** @class ModelReader
  * @brief Template class for reading and processing model data from files.
  * 
@@ -38,15 +59,28 @@
 template<CellLike Cell>
 class ModelReader
 {
-public:
-    struct StepOffsetInfo
-    {
-        FilePosition position;
-        std::optional<ColumnAndRow> sceneSize;
-    };
-
 private:
-    std::vector<std::unordered_map<StepIndex, StepOffsetInfo>> nodeStepOffsets; ///< Maps node indices to their file positions for each step
+    StepOffsetsTable stepOffsets; ///< Positions of steps in data files of all nodes
+    std::vector<FilePosition> indexFilesParsedSizes; ///< Parsed parts of index files of nodes, appended entries follow them (see readIndexFilesUpdate())
+
+    /// Data files of nodes mapped into memory, they are mapped once and reused for all steps
+    MappedFilePool mappedFiles;
+
+    bool useMemoryMappedFiles = true; ///< If false data files are read with std::ifstream (opened for every step)
+    bool useConsolidatedIndex = true; ///< If true consolidated index is used (and created) when index files are read
+    bool useIndexRecovery = true;     ///< If true missing index files are rebuilt from data files (see recoverIndexFiles())
+    bool checkStaleIndexFiles = false; ///< If true also existing index files are extended by steps found after their last entry
+
+    /// Substates decoded by cells supporting selective decoding (see setDecodedSubstates()), read by all decoding threads
+    std::atomic<SubstatesMask> decodedSubstatesMask = allSubstatesMask;
+
+    /// Dimensions of all nodes for steps, which were read from data files (see knownNodesLayout())
+    std::unordered_map<StepIndex, std::vector<ColumnAndRow>> nodesLayoutsOfSteps;
+    /// Dimensions of all nodes for periods between load balancing steps (key is number of the period)
+    std::unordered_map<StepIndex, std::vector<ColumnAndRow>> nodesLayoutsOfLoadBalancingPeriods;
+    mutable std::mutex nodesLayoutsMutex;
+
+    static constexpr std::size_t maxCachedNodesLayoutsOfSteps = 1024;
 
 public:
     /** @brief Prepares the reader for a new stage of data processing.
@@ -59,19 +93,100 @@ public:
      * @param nNodeZ Number of nodes along the Z axis (defaults to 1 for 2D models) */
     void prepareStage(NodeIndex nNodeX, NodeIndex nNodeY, NodeIndex nNodeZ = 1)
     {
-        nodeStepOffsets.resize(nNodeX * nNodeY * nNodeZ);
+        stepOffsets.resize(nNodeX * nNodeY * nNodeZ);
+        indexFilesParsedSizes.clear();
     }
 
     /// @brief Clears the current stage and releases associated resources.
     void clearStage()
     {
-        nodeStepOffsets.clear();
+        stepOffsets.clear();
+        indexFilesParsedSizes.clear();
+        mappedFiles.clear();
+        forgetNodesLayouts();
+    }
+
+    /** @brief Enables or disables reading data files through memory mapping.
+     *
+     * When enabled (default) every node's data file is mapped once (see MappedFilePool) and data of a step
+     * are located directly in the mapping, so changing the step does not require reopening and seeking files. */
+    void setMemoryMappedFilesEnabled(bool enabled)
+    {
+        useMemoryMappedFiles = enabled;
+        if (! enabled)
+            mappedFiles.clear();
+    }
+
+    bool memoryMappedFilesEnabled() const
+    {
+        return useMemoryMappedFiles;
+    }
+
+    /** @brief Enables or disables consolidated index (enabled by default).
+     *
+     * Consolidated index (ReaderHelpers::giveMeConsolidatedIndexFileName()) is a binary table of positions of steps of all nodes
+     * (see StepOffsetsTable). It is written when text index files are read and next time it is just mapped into memory,
+     * unless any index file was changed (its size or modification time is different). */
+    void setConsolidatedIndexEnabled(bool enabled)
+    {
+        useConsolidatedIndex = enabled;
+    }
+
+    bool consolidatedIndexEnabled() const
+    {
+        return useConsolidatedIndex;
+    }
+
+    /** @brief Enables or disables rebuilding of missing index files from data files (enabled by default).
+     *
+     * Index files are often missing when the simulation crashed, with recovery such partial runs
+     * can be viewed without running external tools first (see recoverIndexFiles()). */
+    void setIndexRecoveryEnabled(bool enabled)
+    {
+        useIndexRecovery = enabled;
+    }
+
+    bool indexRecoveryEnabled() const
+    {
+        return useIndexRecovery;
+    }
+
+    /** @brief Enables or disables checking of existing index files, which can miss the last steps of a crashed simulation (disabled by default).
+     *
+     * The check reads only the last entry of every index file and the data file after it, so opening stays cheap,
+     * but it is still done for all nodes on every open, so it has to be requested (it needs index recovery enabled too). */
+    void setStaleIndexCheckEnabled(bool enabled)
+    {
+        checkStaleIndexFiles = enabled;
+    }
+
+    bool staleIndexCheckEnabled() const
+    {
+        return checkStaleIndexFiles;
+    }
+
+    /** @brief Sets substates, which are decoded from text data files by cells supporting selective decoding (SelectiveDecodingCell).
+     *
+     * Other cells always decode all substates, so for them the call does nothing.
+     * @param fieldNames Names of displayed substates, all substates are decoded if it is empty or any name is unknown to the cell
+     * @return true if the set of decoded substates changed (already decoded steps do not contain all displayed substates) */
+    bool setDecodedSubstates(const std::vector<std::string>& fieldNames);
+
+    /// @brief Substates decoded by cells supporting selective decoding (allSubstatesMask by default)
+    SubstatesMask decodedSubstates() const
+    {
+        return decodedSubstatesMask.load(std::memory_order_relaxed);
     }
 
     /** @brief Reads the stage state from files for a specific step.
      * 
      * This method reads the model state for a specific simulation step and updates
      * the provided matrix and settings accordingly.
+     *
+     * Dimensions of nodes (needed to place nodes in the matrix) are taken from index files (extended format)
+     * or from the cache of already read steps, headers of data files are read in advance only when they are unknown.
+     * When load balancing settings are known (sp->firstLB, sp->stepLB) dimensions are reused
+     * for all steps between two load balancing steps.
      * 
      * @tparam Matrix The matrix type used to store the model state
      * @param m Reference to the matrix that will store the model state
@@ -80,6 +195,49 @@ public:
     template<class Matrix>
     void readStageStateFromFilesForStep(Matrix& m, SettingParameter* sp, Line* lines);
 
+    /** @brief Reads the step like readStageStateFromFilesForStep(), but only nodes whose part of the matrix intersects the region.
+     *
+     * When only a small part of a decomposition into many nodes is displayed, data files of other nodes are not read at all.
+     * Cells of nodes, which are not read, are reset to default cells (they would contain another step otherwise),
+     * lines of all nodes are set. Nodes already in the matrix (loadedNodes) are neither read again nor reset,
+     * so the same call completes the step when the region grows (e.g. the view was panned).
+     *
+     * @param region Part of the matrix, which is needed (e.g. its visible part)
+     * @param loadedNodes Nodes of the step already read into the matrix (empty if the matrix contains another step),
+     *        nodes read by the call are added */
+    template<class Matrix>
+    void readStageStateFromFilesForStepInRegion(Matrix& m, SettingParameter* sp, Line* lines, const GridRegion& region, std::vector<bool>& loadedNodes);
+
+    /** @brief Reads slices of the step of 3D model into the volume.
+     *
+     * Nodes of 3D models are split along all three axes (see ReaderHelpers::calculateXYZOffsetForNode()), a step of a node
+     * in text data file is header "C-R-S" followed by S slices of R rows. Only slices in the range are decoded:
+     * rows of slices of the node before them are only skipped (ends of lines are found, cells are not parsed)
+     * and nodes without any slice in the range are not read further than their headers.
+     * Decoding is split into slabs - ranges of rows of one slice of one node - which are decoded in parallel,
+     * so even a single displayed slice uses all threads.
+     * Data files are always memory mapped (rows of slices are located in the mapping).
+     *
+     * @param slices Slices which are decoded, the volume stores only them (see CellVolume::storedSlices())
+     * @return Placement of all nodes in the volume (e.g. for their boundary lines, see ReaderHelpers::setVolumeNodesLines())
+     * @throws std::runtime_error If data files can not be read or they are binary (there are no dimensions of slices of nodes in binary files) */
+    std::vector<VolumeNodePlacement> readVolumeOfStep(CellVolume<Cell>& volume, const SettingParameter& sp, SliceRange slices);
+
+    /** @brief Returns parts of the matrix covered by nodes in the step sp.step (empty parts for nodes outside of the matrix).
+     * @return std::nullopt if dimensions of nodes in the step are not known without reading data files */
+    std::optional<std::vector<GridRegion>> nodesRegions(const SettingParameter& sp) const;
+
+    /** @brief Returns read-only view of cells of the node for the step directly in memory mapped binary data file.
+     *
+     * Nothing is copied or decoded, records of the file are used as cells (only for cells, which can be copied
+     * byte by byte, see TriviallyCopyableCell). The view keeps the mapping alive.
+     *
+     * @param fileName Base file name (without node index or extension)
+     * @return std::nullopt if records of the step are not aligned for Cell in the mapping (then it has to be read)
+     * @throws std::runtime_error If the step is not in the index or the file is too short */
+    std::optional<CellGridView<Cell>> mappedBinaryCells(StepIndex step, const std::string& fileName, NodeIndex node)
+        requires TriviallyCopyableCell<Cell>;
+
     /** @brief Loads step offset data from text files into an internal hash map.
      *
      * Supports two file formats:
@@ -95,10 +253,39 @@ public:
      * @param nNodeX Number of nodes along the X axis
      * @param nNodeY Number of nodes along the Y axis
      * @param nNodeZ Number of nodes along the Z axis (defaults to 1 for 2D models)
+     * Missing index files are rebuilt from data files first (see setIndexRecoveryEnabled(), setStaleIndexCheckEnabled()).
+     *
      * @param filename Name of the file containing the step offsets
+     * @param isBinary If true data files are binary (readMode "binary" of settings), it matters only for rebuilding of index files
      *
      * @throws std::runtime_error If the file cannot be opened or has an invalid format */
-    void readStepsOffsetsForAllNodesFromFiles(NodeIndex nNodeX, NodeIndex nNodeY, NodeIndex nNodeZ, const std::string& filename);
+    void readStepsOffsetsForAllNodesFromFiles(NodeIndex nNodeX, NodeIndex nNodeY, NodeIndex nNodeZ, const std::string& filename, bool isBinary = false);
+
+    /// @brief New records of index files of nodes read by readIndexFilesUpdate()
+    struct IndexFilesUpdate
+    {
+        std::vector<std::vector<StepOffsetRecord>> nodesRecords; ///< Records appended to index file of every node
+        std::vector<FilePosition> parsedSizes;                    ///< Parsed parts of index files including the new records
+
+        bool hasNewRecords() const
+        {
+            return std::ranges::any_of(nodesRecords, [](const auto& records) { return ! records.empty(); });
+        }
+    };
+
+    /** @brief Reads entries appended to index files since they were read, while the simulation is still running.
+     *
+     * Only new parts of index files are read and parsed (nodes in parallel), so the cost is proportional to the number
+     * of new entries, not to the whole history. Positions of steps are not changed (see applyIndexFilesUpdate()),
+     * so steps can be read meanwhile. Nothing is read before readStepsOffsetsForAllNodesFromFiles().
+     * @param filename Base file name (without node index or extension)
+     * @return std::nullopt if any index file was written again (it is shorter than before), then index files have to be read whole
+     * @throws std::runtime_error If an index file can not be read or it has invalid format */
+    std::optional<IndexFilesUpdate> readIndexFilesUpdate(const std::string& filename) const;
+
+    /** @brief Appends records read by readIndexFilesUpdate() to positions of steps, steps must not be read meanwhile.
+     * @return Steps, which became available in all nodes (sorted) */
+    std::vector<StepIndex> applyIndexFilesUpdate(IndexFilesUpdate update);
 
     /** @brief Returns a sorted list of all available simulation steps.
      *
@@ -127,6 +314,29 @@ public:
 private:
     FilePosition getStepStartingPositionInFile(StepIndex step, NodeIndex node) const;
 
+    /** @brief Implementation of readStageStateFromFilesForStep() and readStageStateFromFilesForStepInRegion().
+     * @param region Nodes outside of the region are not read, nullptr to read all nodes */
+    template<class Matrix>
+    void readNodesOfStep(Matrix& m, SettingParameter* sp, Line* lines, const GridRegion* region, std::vector<bool>& loadedNodes);
+
+    /** @brief Reads nodes of the step with dimensions of nodes from the given source (see readNodesOfStep()).
+     * @param usePredictedLayout If true dimensions of nodes known in advance (knownNodesLayout()) are used
+     * @return false if headers of data files do not match predicted dimensions (nothing is decoded then) */
+    template<class Matrix>
+    bool readStageStateFromFilesForStepWithLayout(Matrix& m, SettingParameter* sp, Line* lines, bool usePredictedLayout,
+                                                  const GridRegion* region, std::vector<bool>& loadedNodes);
+
+    /** @brief Returns dimensions of all nodes for the step if they are known without reading data files.
+     *
+     * Sources (in order): cache of already read steps, index files (extended format),
+     * cache of load balancing periods (dimensions can change only on load balancing steps). */
+    std::optional<std::vector<ColumnAndRow>> knownNodesLayout(StepIndex step, NodeIndex nodesCount, int firstLB, int stepLB) const;
+
+    /// @brief Stores dimensions of nodes read from data files for the step (and its load balancing period)
+    void rememberNodesLayout(StepIndex step, const std::vector<ColumnAndRow>& nodesLayout, int firstLB, int stepLB);
+
+    void forgetNodesLayouts();
+
     /** @brief Opens the data file for a given simulation step and node.
      *
      * The function locates the correct file for the specified node (e.g. "ball3.txt", where 3 is node number),
@@ -149,11 +359,56 @@ private:
 
     [[nodiscard]] ColumnAndRow readColumnAndRowForStepFromFile(StepIndex step, const std::string& fileName, NodeIndex node, bool isBinary = false);
 
+    /// @brief Data of one step of a node inside of a memory mapped data file
+    struct MappedStepData
+    {
+        std::shared_ptr<const MappedFile> file; ///< Keeps the mapping alive while the data are used
+        std::string_view data;                  ///< Text after the header line or raw binary cells
+    };
+
+    /** @brief Memory mapped equivalent of readColumnAndRowForStepFromFileReturningStream().
+     *
+     * The file is taken from the pool of mapped files (it is mapped only when it is not there).
+     *
+     * @param step         Simulation step number.
+     * @param fileName     Base file name (without node index or extension).
+     * @param node         Node index for which data should be read.
+     * @param columnAndRow Output: number of local columns and rows (header line for text, index for binary).
+     *
+     * @return Data of the step, for text starting right after the header line.
+     * @throws std::runtime_error If the file cannot be mapped, position is outside of the file or header is invalid. */
+    [[nodiscard]] MappedStepData readColumnAndRowForStepFromMappedFile(StepIndex step,
+                                                                       const std::string& fileName,
+                                                                       NodeIndex node,
+                                                                       ColumnAndRow& columnAndRow,
+                                                                       bool isBinary = false);
+
+    /** @brief Returns dimensions of the node at given step stored in index file (extended format).
+     * @throws std::runtime_error If the index has no dimensions for the step (they are required for binary files) */
+    [[nodiscard]] ColumnAndRow sceneSizeFromIndex(StepIndex step, NodeIndex node) const;
+
+    /** @brief Parses one text row (space separated cells) and fills the corresponding part of the matrix row.
+     * @param substates Substates decoded by cells supporting selective decoding (see setDecodedSubstates())
+     * @note The line is tokenized in place (see RowTokenizer), because composeElement() expects a mutable C-string. */
+    template<class Matrix>
+    static void composeMatrixRowFromText(Matrix& m, int matrixRow, int columns, int offsetX, std::string& line, SubstatesMask substates);
+
     std::vector<ColumnAndRow> giveMeLocalColsAndRowsForAllSteps(StepIndex step,
                                                                 NodeIndex nNodeX,
                                                                 NodeIndex nNodeY,
                                                                 const std::string& fileName,
                                                                 bool isBinary = false);
+
+    /** @brief Rebuilds missing index files (and extends stale ones, see setStaleIndexCheckEnabled()) by scanning data files of nodes (in parallel).
+     *
+     * Existing index file is stale when its data file continues after the last indexed step: binary data file is longer than
+     * the position of the last step plus its size, text data file has step headers after the last step.
+     * Steps following the last indexed one are found by scanning the data file (step headers in text files, size of steps in binary files),
+     * their numbers are inferred (see ReaderHelpers::inferStepNumbers()) and they are written into the index file.
+     * Missing index of binary data file can not be rebuilt, because there are no dimensions of nodes in binary files.
+     * @return Records of nodes, whose index files could not be written (they have to be used instead of the files),
+     *         std::nullopt for other nodes */
+    std::vector<std::optional<std::vector<StepOffsetRecord>>> recoverIndexFiles(NodeIndex totalNodes, const std::string& filename, bool isBinary);
 };
 
 /////////////////////////////
@@ -170,20 +425,195 @@ namespace ReaderHelpers /// functions which are not templates
     return std::format("{}{}_index.txt", fileName, node);
 }
 
-ColumnAndRow getColumnAndRowFromLine(const std::string& line);
+/// @brief Name of the consolidated index of all nodes (see StepOffsetsTable)
+[[nodiscard]] inline std::string giveMeConsolidatedIndexFileName(const std::string& fileName)
+{
+    return std::format("{}_index.bin", fileName);
+}
+
+ColumnAndRow getColumnAndRowFromLine(std::string_view line);
+
+/// @brief One line of index file of a node: "step position" (legacy format) or "step position (C-R)" (extended format)
+struct IndexEntry
+{
+    StepIndex step;
+    FilePosition position;
+    std::optional<ColumnAndRow> sceneSize;
+
+    StepOffsetRecord record() const
+    {
+        return StepOffsetRecord{ .step = step,
+                                 .hasSceneSize = sceneSize.has_value(),
+                                 .position = position,
+                                 .columns = sceneSize.value_or(ColumnAndRow{}).column,
+                                 .rows = sceneSize.value_or(ColumnAndRow{}).row };
+    }
+};
+
+/** @brief Parses whole content of index file (empty lines are skipped, "\r\n" line endings are accepted).
+ * @param fileName Name of the index file, used in error messages
+ * @throws std::runtime_error If a line has invalid format */
+std::vector<IndexEntry> parseIndexFileContent(std::string_view content, const std::string& fileName);
+
+/// @brief Entries appended to index file since it was read (see readIndexFileTail())
+struct IndexFileTail
+{
+    std::vector<IndexEntry> entries;
+    FilePosition parsedSize; ///< Position, where reading continues next time (beginning of the last line, if it is not terminated by '\n')
+};
+
+/** @brief Reads only entries of index file following already parsed part of the file (the simulation is still appending them).
+ *
+ * The last line not terminated by '\n' may be still being written, it is parsed if it is valid, but it is read again next time
+ * (the entry of the same step replaces it then, see StepOffsetsTable::appendNodeRecords()).
+ * @param parsedSize Size of the file when it was read whole or parsedSize of the previous tail
+ * @return std::nullopt if the file is shorter than parsedSize (it was written again, so it has to be read whole),
+ *         no entries if the file does not exist (yet)
+ * @throws std::runtime_error If the file can not be read or a complete line has invalid format */
+std::optional<IndexFileTail> readIndexFileTail(const std::string& fileName, FilePosition parsedSize);
+
+/** @brief Reads only the last entry of index file (the end of the file), the entry with the highest position of steps written in order.
+ * @return std::nullopt if the file has no entries (the last line not terminated by '\n' is skipped if it is incomplete)
+ * @throws std::runtime_error If the file can not be read */
+std::optional<IndexEntry> readLastIndexEntry(const std::string& fileName);
 
 ColumnAndRow calculateXYOffsetForNode(NodeIndex node, NodeIndex nNodeX, NodeIndex nNodeY, const std::vector<ColumnAndRow>& columnsAndRows);
+
+/** @brief Parses header line of a step of 3D model: "C-R-S" (or "C-R" which has one slice).
+ * @throws std::runtime_error If the line is not a valid header */
+VolumeSize getVolumeSizeFromLine(std::string_view line);
+
+/** @brief Offsets (columns, rows and slices) of the node of 3D model, whose nodes are split along all three axes.
+ * Nodes are numbered along X first, then along Y and then along Z: node = x + nNodeX * (y + nNodeY * z).
+ * @param volumeSizes Dimensions of all nodes */
+VolumeSize calculateXYZOffsetForNode(NodeIndex node, NodeIndex nNodeX, NodeIndex nNodeY, const std::vector<VolumeSize>& volumeSizes);
+
+/** @brief Sets boundary lines of nodes of 3D model crossing the slice (nodes of one layer, like nodes of 2D models).
+ * @param nodes Placement of all nodes (see ModelReader::readVolumeOfStep())
+ * @param lines Lines of nodes of one layer: 2 * nNodeX * nNodeY + nNodeX + nNodeY */
+void setVolumeNodesLines(Line* lines, std::span<const VolumeNodePlacement> nodes, NodeIndex nNodeX, NodeIndex nNodeY, int slice, int volumeColumns, int volumeRows);
+
+/** @brief Sets boundary lines of the node placed at offsetXY (left and bottom edges, top and right edges of the last nodes),
+ * the lines are clamped to the matrix (matrixColumns x matrixRows).
+ * @param lines Lines of all nodes: 2 * nNodeX * nNodeY + nNodeX + nNodeY */
+void setNodeLines(Line* lines, NodeIndex node, NodeIndex nNodeX, NodeIndex nNodeY, ColumnAndRow offsetXY, ColumnAndRow columnAndRow, int matrixColumns, int matrixRows);
+
+/// @brief Part of the matrix (matrixColumns x matrixRows) covered by the node of the dimensions placed at offsetXY, empty if the node is outside of it
+GridRegion nodeRegionInMatrix(ColumnAndRow offsetXY, ColumnAndRow columnAndRow, int matrixColumns, int matrixRows);
+
+/** @brief Returns number of the period between load balancing steps, which contains the step.
+ *
+ * Load balancing (which can change dimensions of nodes) is done on steps firstLB, firstLB + stepLB, firstLB + 2*stepLB...
+ * Steps before firstLB are in period 0, steps between firstLB and firstLB + stepLB in period 1 and so on.
+ * @return Number of the period or std::nullopt if load balancing settings are unknown (non-positive)
+ *         or the step is load balancing step itself (its dimensions can belong to both neighbouring periods). */
+std::optional<StepIndex> loadBalancingPeriod(StepIndex step, int firstLB, int stepLB);
+
+/// @brief Step found by scanning data file of a node (see scanTextDataFile(), scanBinaryDataFile())
+struct ScannedStep
+{
+    FilePosition position;
+    ColumnAndRow sceneSize;
+};
+
+/** @brief Finds complete steps in text data file - header line "C-R" followed by R rows ("C-R-S" of 3D models by S * R rows).
+ *
+ * The content is split into chunks searched in parallel (ThreadPool) for lines looking like headers,
+ * then headers are chained: the next step has to start right after rows of the previous one.
+ * Incomplete last step (e.g. the simulation was interrupted while writing it) is not returned.
+ * @param startPosition Position of the first step (beginning of its header line)
+ * @return Steps sorted by position */
+std::vector<ScannedStep> scanTextDataFile(std::string_view content, FilePosition startPosition = 0);
+
+/// @brief Returns positions of complete steps of binary data file, which have all the same dimensions (there are no headers in binary files)
+std::vector<ScannedStep> scanBinaryDataFile(std::size_t fileSize, FilePosition startPosition, ColumnAndRow sceneSize, std::size_t cellSize);
+
+/** @brief Returns numbers of count steps found by scanning, which follow already known steps of the node.
+ *
+ * Data files do not contain step numbers, so they are taken from referenceSteps (steps of another node, all nodes
+ * save the same steps) when it continues knownSteps, otherwise the last difference of steps is repeated
+ * (without any known steps they are numbered 0, 1, 2...). */
+std::vector<StepIndex> inferStepNumbers(std::span<const StepIndex> knownSteps, std::span<const StepIndex> referenceSteps, std::size_t count);
+
+/** @brief Writes index file in extended format.
+ *
+ * New file is written through temporary file, which is renamed. Existing file is only appended,
+ * so lines appended concurrently by the simulation are not lost (duplicated steps are ignored when reading).
+ * @param append If true the entries are appended to existing file
+ * @throws std::runtime_error If the file can not be written */
+void writeIndexFile(const std::string& fileName, std::span<const IndexEntry> entries, bool append = false);
 } // namespace ReaderHelpers
 /////////////////////////////
 
 template<CellLike Cell>
 ColumnAndRow ModelReader<Cell>::readColumnAndRowForStepFromFile(StepIndex step, const std::string& fileName, NodeIndex node, bool isBinary)
 {
+    if (isBinary)
+    {
+        return sceneSizeFromIndex(step, node); // no need to open the file
+    }
+
     ColumnAndRow columnAndRow;
+    if (useMemoryMappedFiles)
+    {
+        [[maybe_unused]] const auto stepData = readColumnAndRowForStepFromMappedFile(step, fileName, node, columnAndRow);
+        return columnAndRow;
+    }
+
     std::ifstream file [[maybe_unused]] = readColumnAndRowForStepFromFileReturningStream(step, fileName, node, columnAndRow, isBinary);
     return columnAndRow;
 }
 
+template<CellLike Cell>
+ColumnAndRow ModelReader<Cell>::sceneSizeFromIndex(StepIndex step, NodeIndex node) const
+{
+    if (node >= stepOffsets.nodesCount())
+        throw std::runtime_error(std::format("Invalid node index {} in binary mode", node));
+
+    if (const auto* record = stepOffsets.find(node, step); record && record->hasSceneSize)
+    {
+        return *record->sceneSize();
+    }
+    throw std::runtime_error(std::format("Binary mode requires sceneSize in step offset info for step {} node {}", step, node));
+}
+
+template<CellLike Cell>
+typename ModelReader<Cell>::MappedStepData ModelReader<Cell>::readColumnAndRowForStepFromMappedFile(StepIndex step,
+                                                                                                     const std::string& fileName,
+                                                                                                     NodeIndex node,
+                                                                                                     ColumnAndRow& columnAndRow,
+                                                                                                     bool isBinary)
+{
+    const auto fPos = getStepStartingPositionInFile(step, node);
+    if (fPos < 0)
+    {
+        throw std::runtime_error(std::format("Invalid position {} of step {} in node {}", fPos, step, node));
+    }
+
+    std::size_t minimalSize = static_cast<std::size_t>(fPos) + 1;
+    if (isBinary)
+    {
+        columnAndRow = sceneSizeFromIndex(step, node);
+        minimalSize = static_cast<std::size_t>(fPos) + static_cast<std::size_t>(columnAndRow.column) * columnAndRow.row * sizeof(Cell);
+    }
+
+    MappedStepData stepData;
+    stepData.file = mappedFiles.acquire(ReaderHelpers::giveMeFileName(fileName, node, isBinary), minimalSize);
+    if (stepData.file->size() < minimalSize)
+    {
+        throw std::runtime_error(std::format("Seek failed in '{}' at position {}", stepData.file->path(), fPos));
+    }
+
+    stepData.data = stepData.file->viewFrom(static_cast<std::size_t>(fPos));
+    if (! isBinary)
+    {
+        const auto headerEnd = stepData.data.find('\n');
+        columnAndRow = ReaderHelpers::getColumnAndRowFromLine(stepData.data.substr(0, headerEnd));
+        stepData.data = (headerEnd == std::string_view::npos) ? std::string_view{} : stepData.data.substr(headerEnd + 1);
+    }
+    return stepData;
+}
+
 template<CellLike Cell>
 std::ifstream ModelReader<Cell>::readColumnAndRowForStepFromFileReturningStream(StepIndex step,
                                                                                 const std::string& fileName,
@@ -208,19 +638,8 @@ std::ifstream ModelReader<Cell>::readColumnAndRowForStepFromFileReturningStream(
 
     if (isBinary)
     {
-        // For binary mode, read dimensions from sceneSize in StepOffsetInfo
-        if (node >= nodeStepOffsets.size())
-            throw std::runtime_error(std::format("Invalid node index {} in binary mode", node));
-
-        const auto& stepMap = nodeStepOffsets[node];
-        if (auto it = stepMap.find(step); it != stepMap.end() && it->second.sceneSize.has_value())
-        {
-            columnAndRow = it->second.sceneSize.value();
-        }
-        else
-        {
-            throw std::runtime_error(std::format("Binary mode requires sceneSize in step offset info for step {} node {}", step, node));
-        }
+        // For binary mode, read dimensions from sceneSize of the index record
+        columnAndRow = sceneSizeFromIndex(step, node);
     }
     else
     {
@@ -237,97 +656,226 @@ std::ifstream ModelReader<Cell>::readColumnAndRowForStepFromFileReturningStream(
     return file;
 }
 
+template<CellLike Cell>
+bool ModelReader<Cell>::setDecodedSubstates(const std::vector<std::string>& fieldNames)
+{
+    if constexpr (! SelectiveDecodingCell<Cell>)
+    {
+        return false;
+    }
+    else
+    {
+        SubstatesMask substates = fieldNames.empty() ? allSubstatesMask : 0;
+        for (const auto& fieldName : fieldNames)
+        {
+            const int substateId = Cell::substateId(fieldName.c_str());
+            if (substateId < 0 || substateId >= std::numeric_limits<SubstatesMask>::digits)
+            {
+                substates = allSubstatesMask; // substate, which can not be in the mask, is maybe encoded in other fields
+                break;
+            }
+            substates |= SubstatesMask{ 1 } << substateId;
+        }
+
+        return decodedSubstatesMask.exchange(substates) != substates;
+    }
+}
+
 template<CellLike Cell>
 template<class Matrix>
 void ModelReader<Cell>::readStageStateFromFilesForStep(Matrix& m, SettingParameter* sp, Line* lines)
+{
+    std::vector<bool> loadedNodes;
+    readNodesOfStep(m, sp, lines, /*region=*/nullptr, loadedNodes);
+}
+
+template<CellLike Cell>
+template<class Matrix>
+void ModelReader<Cell>::readStageStateFromFilesForStepInRegion(Matrix& m, SettingParameter* sp, Line* lines, const GridRegion& region, std::vector<bool>& loadedNodes)
+{
+    readNodesOfStep(m, sp, lines, &region, loadedNodes);
+}
+
+template<CellLike Cell>
+std::optional<std::vector<GridRegion>> ModelReader<Cell>::nodesRegions(const SettingParameter& sp) const
+{
+    const auto totalNodes = sp.nNodeX * sp.nNodeY;
+    const auto nodesLayout = knownNodesLayout(sp.step, totalNodes, sp.firstLB, sp.stepLB);
+    if (! nodesLayout)
+        return std::nullopt;
+
+    std::vector<GridRegion> regions(totalNodes);
+    for (NodeIndex node = 0; node < totalNodes; ++node)
+    {
+        const auto offsetXY = ReaderHelpers::calculateXYOffsetForNode(node, sp.nNodeX, sp.nNodeY, *nodesLayout);
+        regions[node] = ReaderHelpers::nodeRegionInMatrix(offsetXY, (*nodesLayout)[node], sp.numberOfColumnX, sp.numberOfRowsY);
+    }
+    return regions;
+}
+
+template<CellLike Cell>
+template<class Matrix>
+void ModelReader<Cell>::readNodesOfStep(Matrix& m, SettingParameter* sp, Line* lines, const GridRegion* region, std::vector<bool>& loadedNodes)
+{
+    if (readStageStateFromFilesForStepWithLayout(m, sp, lines, /*usePredictedLayout=*/true, region, loadedNodes))
+        return;
+
+    std::cerr << std::format("Warning: dimensions of nodes in step {} differ from expected ones (index files or load balancing settings), "
+                             "reading them from data files",
+                             sp->step)
+              << std::endl;
+    forgetNodesLayouts();
+    loadedNodes.clear(); // nodes in the matrix could be placed with wrong dimensions
+    readStageStateFromFilesForStepWithLayout(m, sp, lines, /*usePredictedLayout=*/false, region, loadedNodes);
+}
+
+template<CellLike Cell>
+template<class Matrix>
+bool ModelReader<Cell>::readStageStateFromFilesForStepWithLayout(Matrix& m, SettingParameter* sp, Line* lines, bool usePredictedLayout,
+                                                                const GridRegion* region, std::vector<bool>& loadedNodes)
 {
     const auto totalNodes = sp->nNodeX * sp->nNodeY;
     const bool isBinary = (sp->readMode == "binary");
-    const auto columnsAndRows = giveMeLocalColsAndRowsForAllSteps(sp->step, sp->nNodeX, sp->nNodeY, sp->outputFileName, isBinary);
+    const auto substates = decodedSubstates(); // the same for the whole step
+    const bool readFromMappedFile = useMemoryMappedFiles;
+
+    std::optional<std::vector<ColumnAndRow>> predictedLayout;
+    if (usePredictedLayout)
+        predictedLayout = knownNodesLayout(sp->step, totalNodes, sp->firstLB, sp->stepLB);
+
+    std::vector<ColumnAndRow> columnsAndRows;
+    if (predictedLayout)
+    {
+        columnsAndRows = std::move(*predictedLayout);
+    }
+    else
+    {
+        columnsAndRows = giveMeLocalColsAndRowsForAllSteps(sp->step, sp->nNodeX, sp->nNodeY, sp->outputFileName, isBinary);
+        rememberNodesLayout(sp->step, columnsAndRows, sp->firstLB, sp->stepLB);
+    }
+    std::atomic<bool> layoutMismatch = false;
+    const bool completingStep = loadedNodes.size() == totalNodes; // the matrix contains some nodes of the step already
 
-    /// Lambda responsible for reading and processing a single node's file
-    auto processNode = [&, this](NodeIndex node)
+    // Clamp coordinates to matrix bounds
+    const int maxX = static_cast<int>(m[0].size()) - 1;
+    const int maxY = static_cast<int>(m.size()) - 1;
+
+    /// Data of a node prepared in the first phase, its rows are decoded in the second phase
+    struct NodeStepData
+    {
+        ColumnAndRow columnAndRow{};
+        ColumnAndRow offsetXY{};
+        bool read = false;                         ///< The node is read (it is not outside of the region or loaded already)
+        int rowsInMatrix = 0;                      ///< Number of rows of the node which fit into the matrix
+        std::shared_ptr<const MappedFile> mapping; ///< Keeps the memory mapped file alive while decoding
+        std::vector<std::string_view> textRows;    ///< Rows located in memory mapped text file
+        std::string_view binaryData;               ///< Raw cells of binary file (in mapping or in binaryBuffer)
+        std::vector<char> binaryBuffer;            ///< Raw cells read from binary file with stream
+    };
+    std::vector<NodeStepData> nodesData(totalNodes);
+
+    /// Lambda setting boundary lines of a node
+    auto setNodeLines = [&](NodeIndex node, ColumnAndRow offsetXY, ColumnAndRow columnAndRow)
+    {
+        ReaderHelpers::setNodeLines(lines, node, sp->nNodeX, sp->nNodeY, offsetXY, columnAndRow, maxX + 1, maxY + 1);
+    };
+
+    /// Phase 1: lambda reading header of a node, its boundary lines and locating its rows.
+    /// Text read with streams can not be split to row ranges, so in that mode the whole node is decoded here.
+    auto prepareNode = [&, this](NodeIndex node)
     {
-        const auto offsetXY = ReaderHelpers::calculateXYOffsetForNode(node, sp->nNodeX, sp->nNodeY, columnsAndRows);
+        auto& nodeData = nodesData[node];
+        const auto offsetXY = nodeData.offsetXY = ReaderHelpers::calculateXYOffsetForNode(node, sp->nNodeX, sp->nNodeY, columnsAndRows);
+
+        const bool alreadyLoaded = completingStep && loadedNodes[node];
+        const auto nodeRegion = ReaderHelpers::nodeRegionInMatrix(offsetXY, columnsAndRows[node], maxX + 1, maxY + 1);
+        if (alreadyLoaded || (region && ! region->intersects(nodeRegion)))
+        {
+            setNodeLines(node, offsetXY, columnsAndRows[node]);
+            if (alreadyLoaded || completingStep)
+                return; // cells of nodes, which were not read, were reset when the step was read
+
+            // default cells instead of cells of a previously read step
+            for (int row = nodeRegion.firstRow; row < nodeRegion.endRow; ++row)
+                std::fill(m[row].begin() + nodeRegion.firstColumn, m[row].begin() + nodeRegion.endColumn, Cell{});
+            return;
+        }
+        nodeData.read = true;
 
         ColumnAndRow columnAndRow;
-        std::ifstream fp = readColumnAndRowForStepFromFileReturningStream(sp->step, sp->outputFileName, node, columnAndRow, isBinary);
-        if (! fp)
-            throw std::runtime_error("Cannot open file for node " + std::to_string(node));
-
-        // Clamp coordinates to matrix bounds
-        const int maxX = static_cast<int>(m[0].size()) - 1;
-        const int maxY = static_cast<int>(m.size()) - 1;
-        
-        const int x1 = std::min(offsetXY.x(), maxX);
-        const int y1 = std::min(offsetXY.y(), maxY);
-        const int x2 = std::min(offsetXY.x() + columnAndRow.column, maxX + 1);
-        const int y2 = std::min(offsetXY.y() + columnAndRow.row, maxY + 1);
-        
-        // Define boundary lines for the node (bottom and left edges)
-        lines[node * 2] = Line(x1, y1, x2, y1);
-        lines[node * 2 + 1] = Line(x1, y1, x1, y2);
-
-        // Add top edge line for nodes in the last row (highest y)
-        const NodeIndex nodeRow = node / sp->nNodeX;
-        if (nodeRow == sp->nNodeY - 1) // Top row
+        std::ifstream fp;
+        std::string_view mappedStepData; ///< Data of the step (text after header line) when reading from memory mapped file
+        if (readFromMappedFile)
         {
-            const int topLineIndex = 2 * totalNodes + (node % sp->nNodeX);
-            lines[topLineIndex] = Line(x1, y2, x2, y2);
+            auto stepData = readColumnAndRowForStepFromMappedFile(sp->step, sp->outputFileName, node, columnAndRow, isBinary);
+            mappedStepData = stepData.data;
+            nodeData.mapping = std::move(stepData.file);
         }
+        else
+        {
+            fp = readColumnAndRowForStepFromFileReturningStream(sp->step, sp->outputFileName, node, columnAndRow, isBinary);
+            if (! fp)
+                throw std::runtime_error("Cannot open file for node " + std::to_string(node));
+        }
+        nodeData.columnAndRow = columnAndRow;
 
-        // Add right edge line for nodes in the last column (highest x)
-        const NodeIndex nodeCol = node % sp->nNodeX;
-        if (nodeCol == sp->nNodeX - 1) // Rightmost column
+        if (columnAndRow.column != columnsAndRows[node].column || columnAndRow.row != columnsAndRows[node].row)
         {
-            const int rightLineIndex = 2 * totalNodes + sp->nNodeX + nodeRow;
-            lines[rightLineIndex] = Line(x2, y1, x2, y2);
+            layoutMismatch = true; // offsets of nodes are wrong, the step has to be read again
+            return;
         }
 
-        bool localStartStepDone = false;
+        setNodeLines(node, offsetXY, columnAndRow);
+
+        const bool anyCellInMatrix = offsetXY.x() <= maxX && offsetXY.y() <= maxY && columnAndRow.column > 0 && columnAndRow.row > 0;
+        if (! anyCellInMatrix)
+            return;
+
+        nodeData.rowsInMatrix = std::min(columnAndRow.row, maxY + 1 - offsetXY.y());
+        m[offsetXY.y()][offsetXY.x()].startStep(sp->step);
 
         if (isBinary)
         {
-            // Binary mode: read raw cell data
+            // Binary mode: raw cell data, they are copied to the matrix in the second phase
             const size_t cellCount = columnAndRow.column * columnAndRow.row;
-            const size_t cellSize = sizeof(Cell);
-            const size_t totalBytes = cellCount * cellSize;
-
-            std::vector<char> buffer(totalBytes);
-            fp.read(buffer.data(), totalBytes);
+            const size_t totalBytes = cellCount * sizeof(Cell);
 
-            if (fp.gcount() != static_cast<std::streamsize>(totalBytes))
+            if (readFromMappedFile)
             {
-                throw std::runtime_error(std::format("Failed to read {} bytes from binary file for node {}", totalBytes, node));
+                nodeData.binaryData = mappedStepData.substr(0, totalBytes); // size was checked when mapping
             }
-
-            // Parse binary data and fill matrix
-            for (int row = 0; row < columnAndRow.row; ++row)
+            else
             {
-                const int matrixRow = row + offsetXY.y();
-                if (matrixRow >= static_cast<int>(m.size()))
-                    continue; // Skip rows that are out of bounds
-                    
-                for (int col = 0; col < columnAndRow.column; ++col)
+                nodeData.binaryBuffer.resize(totalBytes);
+                fp.read(nodeData.binaryBuffer.data(), totalBytes);
+
+                if (fp.gcount() != static_cast<std::streamsize>(totalBytes))
                 {
-                    const int matrixCol = col + offsetXY.x();
-                    if (matrixCol >= static_cast<int>(m[matrixRow].size()))
-                        continue; // Skip columns that are out of bounds
+                    throw std::runtime_error(std::format("Failed to read {} bytes from binary file for node {}", totalBytes, node));
+                }
+                nodeData.binaryData = { nodeData.binaryBuffer.data(), nodeData.binaryBuffer.size() };
+            }
+        }
+        else if (readFromMappedFile)
+        {
+            // Text mode from memory mapped file: only locating rows, they are parsed in the second phase
+            nodeData.textRows.reserve(nodeData.rowsInMatrix);
 
-                    if (! localStartStepDone) [[unlikely]]
-                    {
-                        m[matrixRow][matrixCol].startStep(sp->step);
-                        localStartStepDone = true;
-                    }
+            std::size_t rowBegin = 0;
+            for (int row = 0; row < nodeData.rowsInMatrix; ++row)
+            {
+                if (rowBegin >= mappedStepData.size())
+                {
+                    const auto fileNameTmp = ReaderHelpers::giveMeFileName(sp->outputFileName, node, isBinary);
+                    throw std::runtime_error("Error reading entire line from " + fileNameTmp);
+                }
 
-                    const size_t cellIndex = row * columnAndRow.column + col;
-                    const char* cellData = buffer.data() + (cellIndex * cellSize);
+                auto rowEnd = mappedStepData.find('\n', rowBegin);
+                if (rowEnd == std::string_view::npos)
+                    rowEnd = mappedStepData.size();
 
-                    // Create a temporary cell from binary data and copy to matrix
-                    Cell tempCell;
-                    std::memcpy(&tempCell, cellData, cellSize); /// @note This is erasing vtable, so don't use the object polimorphic way
-                    m[matrixRow][matrixCol] = tempCell;
-                }
+                nodeData.textRows.push_back(mappedStepData.substr(rowBegin, rowEnd - rowBegin));
+                rowBegin = rowEnd + 1;
             }
         }
         else
@@ -346,72 +894,296 @@ void ModelReader<Cell>::readStageStateFromFilesForStep(Matrix& m, SettingParamet
             // Process each line (row) from the node's file
             for (int row = 0; row < columnAndRow.row; ++row)
             {
-                const int matrixRow = row + offsetXY.y();
-                if (matrixRow >= static_cast<int>(m.size()))
-                {
-                    // Skip reading this line from file but don't process it
-                    if (! std::getline(fp, line))
-                    {
-                        const auto fileNameTmp = ReaderHelpers::giveMeFileName(sp->outputFileName, node, isBinary);
-                        throw std::runtime_error("Error reading entire line from " + fileNameTmp);
-                    }
-                    continue; // Skip this row - it's out of bounds
-                }
-                    
                 if (! std::getline(fp, line))
                 {
                     const auto fileNameTmp = ReaderHelpers::giveMeFileName(sp->outputFileName, node, isBinary);
                     throw std::runtime_error("Error reading entire line from " + fileNameTmp);
                 }
 
-                // Replace spaces with '\0' to tokenize more efficiently
-                std::replace(line.begin(), line.end(), ' ', '\0');
+                const int matrixRow = row + offsetXY.y();
+                if (matrixRow >= static_cast<int>(m.size()))
+                    continue; // Skip this row - it's out of bounds
+
+                composeMatrixRowFromText(m, matrixRow, columnAndRow.column, offsetXY.x(), line, substates);
+            }
+            nodeData.rowsInMatrix = 0; // nothing left for the second phase
+        }
+    };
 
-                // Tokenize and fill the corresponding part of the matrix
-                char* currentTokenPtr = line.data();
-                for (int col = 0; col < columnAndRow.column && *currentTokenPtr; ++col)
-                {
-                    const int matrixCol = col + offsetXY.x();
-                    if (matrixCol >= static_cast<int>(m[matrixRow].size()))
-                        continue; // Skip this column - it's out of bounds
+    /// Phase 2: lambda decoding range of rows of a node (text from memory mapped file or binary cells)
+    auto decodeRows = [&](NodeIndex node, int rowBegin, int rowEnd)
+    {
+        const auto& nodeData = nodesData[node];
+        const auto& columnAndRow = nodeData.columnAndRow;
+
+        for (int row = rowBegin; row < rowEnd; ++row)
+        {
+            const int matrixRow = row + nodeData.offsetXY.y();
 
-                    if (! localStartStepDone) [[unlikely]]
+            if (isBinary)
+            {
+                const int columnsInMatrix = std::min(columnAndRow.column, static_cast<int>(m[matrixRow].size()) - nodeData.offsetXY.x());
+                const char* rowData = nodeData.binaryData.data() + static_cast<std::size_t>(row) * columnAndRow.column * sizeof(Cell);
+                if constexpr (TriviallyCopyableCell<Cell>)
+                {
+                    // Records are cells, whole row is copied at once without temporary cells
+                    std::memcpy(m[matrixRow].data() + nodeData.offsetXY.x(), rowData, static_cast<std::size_t>(std::max(columnsInMatrix, 0)) * sizeof(Cell));
+                }
+                else
+                {
+                    for (int col = 0; col < columnsInMatrix; ++col)
                     {
-                        m[matrixRow][matrixCol].startStep(sp->step);
-                        localStartStepDone = true;
+                        // Create a temporary cell from binary data and copy to matrix
+                        Cell tempCell;
+                        std::memcpy(&tempCell, rowData + col * sizeof(Cell), sizeof(Cell)); /// @note This is erasing vtable, so don't use the object polimorphic way
+                        m[matrixRow][col + nodeData.offsetXY.x()] = tempCell;
                     }
+                }
+            }
+            else
+            {
+                // each row is copied to a reusable buffer because composeElement() modifies the text
+                static thread_local std::string line;
+                line.assign(nodeData.textRows[row]);
+                composeMatrixRowFromText(m, matrixRow, columnAndRow.column, nodeData.offsetXY.x(), line, substates);
+            }
+        }
+    };
 
-                    /// composeElement() may add extra '\0', so we need extra variable to jump to next position
-                    char* nextTokenPtr = std::find(currentTokenPtr, line.data() + line.size(), '\0');
-                    ++nextTokenPtr; // skip '\0'
+    auto& threadPool = ThreadPool::instance();
+    threadPool.parallelFor(totalNodes,
+                           [&](std::size_t node)
+                           {
+                               prepareNode(static_cast<NodeIndex>(node));
+                           });
+    if (layoutMismatch)
+        return false;
+
+    /// Splitting rows of nodes into tasks, so even few big nodes use all threads
+    struct RowRange
+    {
+        NodeIndex node;
+        int rowBegin;
+        int rowEnd;
+    };
 
-                    m[matrixRow][matrixCol].composeElement(currentTokenPtr);
+    int rowsToDecode = 0;
+    for (const auto& nodeData : nodesData)
+        rowsToDecode += nodeData.rowsInMatrix;
 
-                    currentTokenPtr = nextTokenPtr;
-                }
-            }
+    constexpr int minimumRowsPerTask = 8;
+    constexpr int tasksPerThread = 4; // more tasks than threads for better balancing (rows differ in length)
+    const int rowsPerTask = std::max(minimumRowsPerTask, rowsToDecode / static_cast<int>(tasksPerThread * threadPool.threadCount()));
+
+    std::vector<RowRange> rowRanges;
+    for (NodeIndex node = 0; node < totalNodes; ++node)
+    {
+        for (int rowBegin = 0; rowBegin < nodesData[node].rowsInMatrix; rowBegin += rowsPerTask)
+        {
+            rowRanges.push_back({ node, rowBegin, std::min(rowBegin + rowsPerTask, nodesData[node].rowsInMatrix) });
         }
+    }
+
+    threadPool.parallelFor(rowRanges.size(),
+                           [&](std::size_t task)
+                           {
+                               const auto& range = rowRanges[task];
+                               decodeRows(range.node, range.rowBegin, range.rowEnd);
+                           });
+
+    if (! completingStep)
+        loadedNodes.assign(totalNodes, false);
+    for (NodeIndex node = 0; node < totalNodes; ++node)
+    {
+        if (nodesData[node].read)
+            loadedNodes[node] = true;
+    }
+    return true;
+}
+
+template<CellLike Cell>
+std::vector<VolumeNodePlacement> ModelReader<Cell>::readVolumeOfStep(CellVolume<Cell>& volume, const SettingParameter& sp, SliceRange slices)
+{
+    if (sp.readMode == "binary")
+        throw std::runtime_error("3D models can not be read from binary files (there are no dimensions of slices of nodes in them)");
+
+    const NodeIndex nodesInLayer = sp.nNodeX * sp.nNodeY;
+    const NodeIndex totalNodes = nodesInLayer * std::max(sp.nNodeZ, NodeIndex{ 1 });
+    const auto substates = decodedSubstates(); // the same for the whole step
+
+    volume.resize(sp.numberOfColumnX, sp.numberOfRowsY, sp.numberOfSlicesZ, slices);
+    slices = volume.storedSlices();
+
+    /// Data of a node prepared in the first phases, its slabs are decoded in the last phase
+    struct NodeVolumeData
+    {
+        VolumeSize volumeSize{};
+        VolumeSize offset{};
+        std::shared_ptr<const MappedFile> mapping; ///< Keeps the memory mapped file alive while decoding
+        std::string_view data;                     ///< Text of the step after the header line
+        SliceRange decodedSlices;                  ///< Slices of the node in the volume, which are decoded
+        int rowsInVolume = 0;                      ///< Number of rows of slices of the node which fit into the volume
+        std::vector<std::string_view> textRows;    ///< Rows of decoded slices, slice after slice
     };
+    std::vector<NodeVolumeData> nodesData(totalNodes);
+
+    auto& threadPool = ThreadPool::instance();
+
+    /// Phase 1: headers of all nodes (dimensions of preceding nodes are needed to place a node)
+    threadPool.parallelFor(totalNodes,
+                           [&, this](std::size_t node)
+                           {
+                               auto& nodeData = nodesData[node];
+                               const auto fPos = getStepStartingPositionInFile(sp.step, static_cast<NodeIndex>(node));
+                               if (fPos < 0)
+                                   throw std::runtime_error(std::format("Invalid position {} of step {} in node {}", fPos, sp.step, node));
+
+                               nodeData.mapping = mappedFiles.acquire(ReaderHelpers::giveMeFileName(sp.outputFileName, static_cast<NodeIndex>(node)),
+                                                                      static_cast<std::size_t>(fPos) + 1);
+                               if (nodeData.mapping->size() <= static_cast<std::size_t>(fPos))
+                                   throw std::runtime_error(std::format("Seek failed in '{}' at position {}", nodeData.mapping->path(), fPos));
+
+                               const auto stepData = nodeData.mapping->viewFrom(static_cast<std::size_t>(fPos));
+                               const auto headerEnd = stepData.find('\n');
+                               nodeData.volumeSize = ReaderHelpers::getVolumeSizeFromLine(stepData.substr(0, headerEnd));
+                               nodeData.data = (headerEnd == std::string_view::npos) ? std::string_view{} : stepData.substr(headerEnd + 1);
+                           });
+
+    std::vector<VolumeSize> volumeSizes(totalNodes);
+    std::ranges::transform(nodesData, volumeSizes.begin(), &NodeVolumeData::volumeSize);
+
+    /// Phase 2: locating rows of decoded slices of nodes (rows of preceding slices are skipped without parsing)
+    threadPool.parallelFor(totalNodes,
+                           [&](std::size_t node)
+                           {
+                               auto& nodeData = nodesData[node];
+                               const auto& volumeSize = nodeData.volumeSize;
+                               const auto offset = nodeData.offset = ReaderHelpers::calculateXYZOffsetForNode(static_cast<NodeIndex>(node), sp.nNodeX, sp.nNodeY, volumeSizes);
+
+
+                               nodeData.decodedSlices = slices.intersection({ .first = offset.slice, .end = offset.slice + volumeSize.slice });
+                               const bool anyCellInVolume = offset.column < volume.columns() && offset.row < volume.rows() && volumeSize.column > 0;
+                               if (nodeData.decodedSlices.empty() || ! anyCellInVolume)
+                                   return;
+
+                               nodeData.rowsInVolume = std::min(volumeSize.row, volume.rows() - offset.row);
+                               nodeData.textRows.reserve(static_cast<std::size_t>(nodeData.rowsInVolume) * nodeData.decodedSlices.size());
+
+                               const auto firstRow = static_cast<std::size_t>(nodeData.decodedSlices.first - offset.slice) * static_cast<std::size_t>(volumeSize.row);
+                               const auto endRow = firstRow + static_cast<std::size_t>(nodeData.decodedSlices.size()) * static_cast<std::size_t>(volumeSize.row);
+                               std::size_t rowBegin = 0;
+                               for (std::size_t row = 0; row < endRow; ++row)
+                               {
+                                   if (rowBegin >= nodeData.data.size())
+                                   {
+                                       const auto fileNameTmp = ReaderHelpers::giveMeFileName(sp.outputFileName, static_cast<NodeIndex>(node));
+                                       throw std::runtime_error("Error reading entire line from " + fileNameTmp);
+                                   }
+
+                                   auto rowEnd = nodeData.data.find('\n', rowBegin);
+                                   if (rowEnd == std::string_view::npos)
+                                       rowEnd = nodeData.data.size();
+
+                                   const auto rowOfSlice = static_cast<int>(row % static_cast<std::size_t>(volumeSize.row));
+                                   if (row >= firstRow && rowOfSlice < nodeData.rowsInVolume)
+                                       nodeData.textRows.push_back(nodeData.data.substr(rowBegin, rowEnd - rowBegin));
+                                   rowBegin = rowEnd + 1;
+                               }
+
+                               volume(offset.column, offset.row, nodeData.decodedSlices.first).startStep(sp.step);
+                           });
+
+    /// Splitting slices of nodes into slabs of rows, so even a single slice of few big nodes uses all threads
+    struct Slab
+    {
+        NodeIndex node;
+        int slice; ///< Slice in the volume
+        int rowBegin;
+        int rowEnd;
+    };
+
+    std::size_t rowsToDecode = 0;
+    for (const auto& nodeData : nodesData)
+        rowsToDecode += nodeData.textRows.size();
 
-    /// Launch async tasks — one per node
-    std::vector<std::future<void>> futures;
-    futures.reserve(totalNodes);
+    constexpr int minimumRowsPerTask = 8;
+    constexpr std::size_t tasksPerThread = 4; // more tasks than threads for better balancing (rows differ in length)
+    const int rowsPerTask = std::max(minimumRowsPerTask, static_cast<int>(rowsToDecode / (tasksPerThread * threadPool.threadCount())));
 
+    std::vector<Slab> slabs;
     for (NodeIndex node = 0; node < totalNodes; ++node)
     {
-        futures.push_back(std::async(std::launch::async,
-                                     [&, node]()
-                                     {
-                                         processNode(node);
-                                     }));
+        const auto& nodeData = nodesData[node];
+        if (0 == nodeData.rowsInVolume)
+            continue;
+
+        for (int slice = nodeData.decodedSlices.first; slice < nodeData.decodedSlices.end; ++slice)
+        {
+            for (int rowBegin = 0; rowBegin < nodeData.rowsInVolume; rowBegin += rowsPerTask)
+                slabs.push_back({ node, slice, rowBegin, std::min(rowBegin + rowsPerTask, nodeData.rowsInVolume) });
+        }
     }
 
-    // Wait for all async tasks to complete
-    std::ranges::for_each(futures,
-                          [](std::future<void>& f)
-                          {
-                              f.get();
-                          });
+    /// Phase 3: decoding slabs
+    threadPool.parallelFor(slabs.size(),
+                           [&](std::size_t task)
+                           {
+                               const auto& slab = slabs[task];
+                               const auto& nodeData = nodesData[slab.node];
+                               const auto sliceOfNode = static_cast<std::size_t>(slab.slice - nodeData.decodedSlices.first);
+
+                               // each row is copied to a reusable buffer because composeElement() modifies the text
+                               static thread_local std::string line;
+                               for (int row = slab.rowBegin; row < slab.rowEnd; ++row)
+                               {
+                                   line.assign(nodeData.textRows[sliceOfNode * static_cast<std::size_t>(nodeData.rowsInVolume) + static_cast<std::size_t>(row)]);
+                                   const auto volumeRow = static_cast<int>(volume.rowIndex(slab.slice, row + nodeData.offset.row));
+                                   composeMatrixRowFromText(volume, volumeRow, nodeData.volumeSize.column, nodeData.offset.column, line, substates);
+                               }
+                           });
+
+    std::vector<VolumeNodePlacement> placements(totalNodes);
+    std::ranges::transform(nodesData, placements.begin(),
+                           [](const NodeVolumeData& nodeData)
+                           {
+                               return VolumeNodePlacement{ .offset = nodeData.offset, .size = nodeData.volumeSize };
+                           });
+    return placements;
+}
+
+template<CellLike Cell>
+template<class Matrix>
+void ModelReader<Cell>::composeMatrixRowFromText(Matrix& m,
+                                                 int matrixRow,
+                                                 int columns,
+                                                 int offsetX,
+                                                 std::string& line,
+                                                 [[maybe_unused]] SubstatesMask substates)
+{
+    // Split whole row in one (vectorized) pass, tokens are terminated by '\0'
+    static thread_local std::vector<char*> tokens;
+    if (tokens.size() < static_cast<std::size_t>(columns))
+        tokens.resize(columns);
+
+    const auto tokensCount = static_cast<int>(RowTokenizer::splitInPlace(line.data(), line.size(), tokens.data(), columns));
+
+    const int lastColumn = std::min(tokensCount, static_cast<int>(m[matrixRow].size()) - offsetX);
+
+    /// @note composeElement() may add extra '\0', it does not matter because tokens are already split
+    if constexpr (SelectiveDecodingCell<Cell>)
+    {
+        for (int col = 0; col < lastColumn; ++col)
+        {
+            m[matrixRow][col + offsetX].composeElement(tokens[col], substates);
+        }
+    }
+    else
+    {
+        for (int col = 0; col < lastColumn; ++col)
+        {
+            m[matrixRow][col + offsetX].composeElement(tokens[col]);
+        }
+    }
 }
 
 template<CellLike Cell>
@@ -423,76 +1195,351 @@ std::vector<ColumnAndRow> ModelReader<Cell>::giveMeLocalColsAndRowsForAllSteps(S
 {
     const auto nodesCount = nNodeX * nNodeY;
     std::vector<ColumnAndRow> allColumnsAndRows(nodesCount);
-    allColumnsAndRows.resize(nodesCount);
 
-    for (NodeIndex node = 0; node < nodesCount; node++)
+    ThreadPool::instance().parallelFor(nodesCount,
+                                       [&](std::size_t node)
+                                       {
+                                           allColumnsAndRows[node] = readColumnAndRowForStepFromFile(step, fileName, node, isBinary);
+                                       });
+    return allColumnsAndRows;
+}
+
+template<CellLike Cell>
+std::optional<std::vector<ColumnAndRow>> ModelReader<Cell>::knownNodesLayout(StepIndex step, NodeIndex nodesCount, int firstLB, int stepLB) const
+{
     {
-        allColumnsAndRows[node] = readColumnAndRowForStepFromFile(step, fileName, node, isBinary);
+        std::lock_guard lock(nodesLayoutsMutex);
+        if (auto it = nodesLayoutsOfSteps.find(step); it != nodesLayoutsOfSteps.end() && it->second.size() == nodesCount)
+            return it->second;
     }
-    return allColumnsAndRows;
+
+    // Extended index format contains dimensions of nodes for every step
+    if (stepOffsets.nodesCount() >= nodesCount)
+    {
+        std::vector<ColumnAndRow> nodesLayout(nodesCount);
+        bool allNodesHaveSceneSize = true;
+        for (NodeIndex node = 0; node < nodesCount && allNodesHaveSceneSize; ++node)
+        {
+            const auto* record = stepOffsets.find(node, step);
+            allNodesHaveSceneSize = (record && record->hasSceneSize);
+            if (allNodesHaveSceneSize)
+                nodesLayout[node] = *record->sceneSize();
+        }
+        if (allNodesHaveSceneSize)
+            return nodesLayout;
+    }
+
+    if (const auto period = ReaderHelpers::loadBalancingPeriod(step, firstLB, stepLB))
+    {
+        std::lock_guard lock(nodesLayoutsMutex);
+        if (auto it = nodesLayoutsOfLoadBalancingPeriods.find(*period); it != nodesLayoutsOfLoadBalancingPeriods.end() && it->second.size() == nodesCount)
+            return it->second;
+    }
+    return std::nullopt;
 }
 
 template<CellLike Cell>
-void ModelReader<Cell>::readStepsOffsetsForAllNodesFromFiles(NodeIndex nNodeX, NodeIndex nNodeY, NodeIndex nNodeZ, const std::string& filename)
+void ModelReader<Cell>::rememberNodesLayout(StepIndex step, const std::vector<ColumnAndRow>& nodesLayout, int firstLB, int stepLB)
 {
-    const auto totalNodes = nNodeX * nNodeY * nNodeZ;
-    prepareStage(nNodeX, nNodeY, nNodeZ);
+    std::lock_guard lock(nodesLayoutsMutex);
+    if (nodesLayoutsOfSteps.size() >= maxCachedNodesLayoutsOfSteps)
+        nodesLayoutsOfSteps.clear();
+    nodesLayoutsOfSteps[step] = nodesLayout;
+
+    if (const auto period = ReaderHelpers::loadBalancingPeriod(step, firstLB, stepLB))
+        nodesLayoutsOfLoadBalancingPeriods[*period] = nodesLayout;
+}
+
+template<CellLike Cell>
+void ModelReader<Cell>::forgetNodesLayouts()
+{
+    std::lock_guard lock(nodesLayoutsMutex);
+    nodesLayoutsOfSteps.clear();
+    nodesLayoutsOfLoadBalancingPeriods.clear();
+}
+
+template<CellLike Cell>
+std::optional<CellGridView<Cell>> ModelReader<Cell>::mappedBinaryCells(StepIndex step, const std::string& fileName, NodeIndex node)
+    requires TriviallyCopyableCell<Cell>
+{
+    ColumnAndRow columnAndRow;
+    auto stepData = readColumnAndRowForStepFromMappedFile(step, fileName, node, columnAndRow, /*isBinary=*/true);
+
+    const auto* cells = stepData.data.data();
+    if (reinterpret_cast<std::uintptr_t>(cells) % alignof(Cell) != 0)
+        return std::nullopt;
+
+    return CellGridView<Cell>(reinterpret_cast<const Cell*>(cells),
+                              columnAndRow.column,
+                              columnAndRow.row,
+                              static_cast<std::size_t>(columnAndRow.column),
+                              std::move(stepData.file));
+}
+
+template<CellLike Cell>
+std::vector<std::optional<std::vector<StepOffsetRecord>>> ModelReader<Cell>::recoverIndexFiles(NodeIndex totalNodes, const std::string& filename, bool isBinary)
+{
+    struct NodeRecovery
+    {
+        bool indexExists = false;
+        std::vector<ReaderHelpers::IndexEntry> knownEntries; ///< Entries of index file sorted by position (only for stale index files)
+        std::vector<ReaderHelpers::ScannedStep> newSteps;    ///< Steps after the last known one
+    };
+    std::vector<NodeRecovery> nodes(totalNodes);
+
+    const auto readIndexEntries = [](const std::string& indexFileName)
+    {
+        const MappedFile indexFile(indexFileName);
+        auto entries = ReaderHelpers::parseIndexFileContent({ indexFile.data(), indexFile.size() }, indexFileName);
+        std::ranges::stable_sort(entries, {}, &ReaderHelpers::IndexEntry::position);
+        return entries;
+    };
+
+    /// Phase 1: data files of nodes with missing (or stale) index files are scanned in parallel (chunks of text files in parallel too)
+    ThreadPool::instance().parallelFor(totalNodes,
+                                       [&](std::size_t nodeIndex)
+                                       {
+                                           const auto node = static_cast<NodeIndex>(nodeIndex);
+                                           auto& recovery = nodes[node];
+                                           const auto indexFileName = ReaderHelpers::giveMeFileNameIndex(filename, node);
+                                           const auto dataFileName = ReaderHelpers::giveMeFileName(filename, node, isBinary);
+                                           if (! std::filesystem::exists(dataFileName))
+                                               return; // nothing to recover without data file
+
+                                           recovery.indexExists = std::filesystem::exists(indexFileName);
+                                           if (recovery.indexExists && ! checkStaleIndexFiles)
+                                               return;
+
+                                           std::optional<ReaderHelpers::IndexEntry> lastKnownEntry;
+                                           if (recovery.indexExists)
+                                               lastKnownEntry = ReaderHelpers::readLastIndexEntry(indexFileName);
+                                           if (isBinary)
+                                           {
+                                               if (! lastKnownEntry || ! lastKnownEntry->sceneSize)
+                                               {
+                                                   std::cerr << std::format("Warning: index of binary data file '{}' can not be rebuilt, "
+                                                                            "dimensions of the node are unknown (binary files have no headers of steps)",
+                                                                            dataFileName)
+                                                             << std::endl;
+                                                   return;
+                                               }
+                                               const auto sceneSize = *lastKnownEntry->sceneSize;
+                                               const FilePosition stepSize = FilePosition{ sceneSize.column } * sceneSize.row * static_cast<FilePosition>(sizeof(Cell));
+                                               const FilePosition nextStepPosition = lastKnownEntry->position + stepSize;
+                                               const auto dataFileSize = static_cast<FilePosition>(std::filesystem::file_size(dataFileName));
+                                               if (dataFileSize <= nextStepPosition)
+                                                   return; // the last indexed step is the last one of the data file
+                                               recovery.newSteps = ReaderHelpers::scanBinaryDataFile(static_cast<std::size_t>(dataFileSize), nextStepPosition, sceneSize, sizeof(Cell));
+                                           }
+                                           else
+                                           {
+                                               // only the part of the data file from the last indexed step is read
+                                               const MappedFile dataFile(dataFileName);
+                                               recovery.newSteps = ReaderHelpers::scanTextDataFile({ dataFile.data(), dataFile.size() },
+                                                                                                   lastKnownEntry ? lastKnownEntry->position : 0);
+                                               if (lastKnownEntry && ! recovery.newSteps.empty())
+                                                   recovery.newSteps.erase(recovery.newSteps.begin()); // the last known step itself
+                                           }
+
+                                           // the whole index is read only when it is stale, numbers of new steps follow its steps
+                                           if (recovery.indexExists && ! recovery.newSteps.empty())
+                                               recovery.knownEntries = readIndexEntries(indexFileName);
+                                       });
+
+    std::vector<std::optional<std::vector<StepOffsetRecord>>> unwrittenRecords(totalNodes);
+    if (std::ranges::all_of(nodes, [](const NodeRecovery& recovery) { return recovery.newSteps.empty(); }))
+        return unwrittenRecords;
+
+    /// Phase 2: numbers of new steps are inferred from the longest list of steps of nodes (all nodes save the same steps)
+    std::vector<StepIndex> referenceSteps;
+    for (NodeIndex node = 0; node < totalNodes; ++node)
+    {
+        const auto& recovery = nodes[node];
+        const bool checked = ! recovery.knownEntries.empty() || ! recovery.newSteps.empty();
+        const auto entries = (checked || ! recovery.indexExists) ? recovery.knownEntries : readIndexEntries(ReaderHelpers::giveMeFileNameIndex(filename, node));
+        if (entries.size() > referenceSteps.size())
+        {
+            auto steps = entries | std::views::transform(&ReaderHelpers::IndexEntry::step);
+            referenceSteps.assign(steps.begin(), steps.end());
+        }
+    }
 
     for (NodeIndex node = 0; node < totalNodes; ++node)
     {
-        const auto fileNameIndex = ReaderHelpers::giveMeFileNameIndex(filename, node);
-        if (! std::filesystem::exists(fileNameIndex))
-            throw std::runtime_error("File not found: " + fileNameIndex);
+        auto& recovery = nodes[node];
+        if (recovery.newSteps.empty())
+            continue;
 
-        std::ifstream file(fileNameIndex);
-        if (! file)
-            throw std::runtime_error("Cannot open file: " + fileNameIndex);
+        auto knownSteps = recovery.knownEntries | std::views::transform(&ReaderHelpers::IndexEntry::step);
+        const auto numbers = ReaderHelpers::inferStepNumbers(std::vector<StepIndex>(knownSteps.begin(), knownSteps.end()), referenceSteps, recovery.newSteps.size());
 
-        std::string line;
-        while (std::getline(file, line))
+        std::vector<ReaderHelpers::IndexEntry> newEntries;
+        newEntries.reserve(recovery.newSteps.size());
+        for (std::size_t index = 0; index < recovery.newSteps.size(); ++index)
         {
-            if (line.empty())
-                continue;
+            newEntries.push_back({ .step = numbers[index], .position = recovery.newSteps[index].position, .sceneSize = recovery.newSteps[index].sceneSize });
+        }
+
+        const auto indexFileName = ReaderHelpers::giveMeFileNameIndex(filename, node);
+        try
+        {
+            ReaderHelpers::writeIndexFile(indexFileName, newEntries, /*append=*/recovery.indexExists);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Warning: rebuilt index is used only in memory: " << e.what() << std::endl;
+
+            auto& records = unwrittenRecords[node].emplace();
+            for (const auto& entry : recovery.knownEntries)
+                records.push_back(entry.record());
+            for (const auto& entry : newEntries)
+                records.push_back(entry.record());
+        }
+    }
+    return unwrittenRecords;
+}
 
-            std::istringstream iss(line);
-            StepIndex stepNumber{};
-            FilePosition position{};
-            if (! (iss >> stepNumber >> position))
-                throw std::runtime_error("Invalid line format in file: " + fileNameIndex);
+template<CellLike Cell>
+void ModelReader<Cell>::readStepsOffsetsForAllNodesFromFiles(NodeIndex nNodeX, NodeIndex nNodeY, NodeIndex nNodeZ, const std::string& filename, bool isBinary)
+{
+    const auto totalNodes = nNodeX * nNodeY * nNodeZ;
+    prepareStage(nNodeX, nNodeY, nNodeZ);
 
-            StepOffsetInfo info{position, std::nullopt};
+    auto recoveredRecords = useIndexRecovery ? recoverIndexFiles(totalNodes, filename, isBinary)
+                                             : std::vector<std::optional<std::vector<StepOffsetRecord>>>(totalNodes);
+    const bool allIndexFilesExist = std::ranges::none_of(recoveredRecords,
+                                                         [](const auto& records)
+                                                         {
+                                                             return records.has_value();
+                                                         });
 
-            // Check if we have the optional "(columns-rows)" part
-            std::string rangePart;
-            if (iss >> rangePart)
-            {
-                std::regex rangeRegex(R"(\((\d+)-(\d+)\))");
-                std::smatch match;
-                if (std::regex_match(rangePart, match, rangeRegex))
-                {
-                    const int columnCount = std::stoi(match[1].str());
-                    const int rowsCount = std::stoi(match[2].str());
-                    info.sceneSize = ColumnAndRow{.column = columnCount, .row = rowsCount};
-                }
-                else
-                {
-                    throw std::runtime_error("Invalid range format in file: " + fileNameIndex + " line: " + line);
-                }
-            }
+    std::vector<std::string> indexFileNames(totalNodes);
+    std::vector<IndexFileStamp> indexFileStamps(totalNodes);
+    for (NodeIndex node = 0; node < totalNodes; ++node)
+    {
+        indexFileNames[node] = ReaderHelpers::giveMeFileNameIndex(filename, node);
+        if (recoveredRecords[node])
+            continue;
+        if (! std::filesystem::exists(indexFileNames[node]))
+            throw std::runtime_error("File not found: " + indexFileNames[node]);
+        indexFileStamps[node] = IndexFileStamp::of(indexFileNames[node]);
+    }
 
-            const auto [it, inserted] = nodeStepOffsets[node].emplace(stepNumber, info);
-            if (! inserted)
-            {
-                std::cerr << std::format("Duplicate stepNumber {} in file '{}' (node {})", stepNumber, fileNameIndex, node) << std::endl;
-            }
+    const auto consolidatedIndexFileName = ReaderHelpers::giveMeConsolidatedIndexFileName(filename);
+    const bool canUseConsolidatedIndex = useConsolidatedIndex && allIndexFilesExist;
+    if (canUseConsolidatedIndex && stepOffsets.mapConsolidatedIndex(consolidatedIndexFileName, indexFileStamps))
+    {
+        indexFilesParsedSizes.resize(totalNodes);
+        std::ranges::transform(indexFileStamps, indexFilesParsedSizes.begin(), [](const IndexFileStamp& stamp) { return static_cast<FilePosition>(stamp.size); });
+        return;
+    }
+
+    // Every node has its own index file and its own records, so nodes are read in parallel
+    std::vector<FilePosition> parsedSizes(totalNodes, 0);
+    ThreadPool::instance().parallelFor(totalNodes,
+                                       [&](std::size_t nodeIndex)
+                                       {
+                                           const auto node = static_cast<NodeIndex>(nodeIndex);
+                                           const auto& fileNameIndex = indexFileNames[node];
+
+                                           std::vector<StepOffsetRecord> records;
+                                           if (recoveredRecords[node])
+                                           {
+                                               records = std::move(*recoveredRecords[node]);
+
+                                               std::error_code errorCode;
+                                               const auto indexFileSize = std::filesystem::file_size(fileNameIndex, errorCode);
+                                               parsedSizes[node] = errorCode ? 0 : static_cast<FilePosition>(indexFileSize);
+                                           }
+                                           else
+                                           {
+                                               const MappedFile indexFile(fileNameIndex);
+                                               const auto entries = ReaderHelpers::parseIndexFileContent({ indexFile.data(), indexFile.size() }, fileNameIndex);
+                                               parsedSizes[node] = static_cast<FilePosition>(indexFile.size());
+
+                                               records.reserve(entries.size());
+                                               for (const auto& entry : entries)
+                                               {
+                                                   records.push_back(entry.record());
+                                               }
+                                           }
+
+                                           for (const auto duplicatedStep : stepOffsets.setNodeRecords(node, std::move(records)))
+                                           {
+                                               std::cerr << std::format("Duplicate stepNumber {} in file '{}' (node {})", duplicatedStep, fileNameIndex, node) << std::endl;
+                                           }
+                                       });
+    stepOffsets.finishLoading();
+    indexFilesParsedSizes = std::move(parsedSizes);
+
+    if (canUseConsolidatedIndex)
+    {
+        try
+        {
+            stepOffsets.writeConsolidatedIndex(consolidatedIndexFileName, indexFileStamps);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Warning: consolidated index was not written: " << e.what() << std::endl;
         }
     }
 }
 
+template<CellLike Cell>
+std::optional<typename ModelReader<Cell>::IndexFilesUpdate> ModelReader<Cell>::readIndexFilesUpdate(const std::string& filename) const
+{
+    const auto totalNodes = stepOffsets.nodesCount();
+    if (indexFilesParsedSizes.size() != totalNodes)
+        return IndexFilesUpdate{}; // index files were not read yet
+
+    IndexFilesUpdate update{ .nodesRecords = std::vector<std::vector<StepOffsetRecord>>(totalNodes), .parsedSizes = indexFilesParsedSizes };
+
+    std::atomic<bool> rewritten = false;
+    ThreadPool::instance().parallelFor(totalNodes,
+                                       [&](std::size_t node)
+                                       {
+                                           const auto tail = ReaderHelpers::readIndexFileTail(ReaderHelpers::giveMeFileNameIndex(filename, static_cast<NodeIndex>(node)),
+                                                                                              indexFilesParsedSizes[node]);
+                                           if (! tail)
+                                           {
+                                               rewritten = true;
+                                               return;
+                                           }
+
+                                           update.parsedSizes[node] = tail->parsedSize;
+                                           update.nodesRecords[node].reserve(tail->entries.size());
+                                           for (const auto& entry : tail->entries)
+                                               update.nodesRecords[node].push_back(entry.record());
+                                       });
+    if (rewritten)
+        return std::nullopt;
+    return update;
+}
+
+template<CellLike Cell>
+std::vector<StepIndex> ModelReader<Cell>::applyIndexFilesUpdate(IndexFilesUpdate update)
+{
+    if (update.nodesRecords.size() != stepOffsets.nodesCount() || update.parsedSizes.size() != stepOffsets.nodesCount())
+        return {};
+
+    std::vector<std::vector<StepIndex>> newStepsOfNodes(update.nodesRecords.size());
+    ThreadPool::instance().parallelFor(update.nodesRecords.size(),
+                                       [&](std::size_t node)
+                                       {
+                                           newStepsOfNodes[node] = stepOffsets.appendNodeRecords(static_cast<NodeIndex>(node), update.nodesRecords[node]);
+                                       });
+    indexFilesParsedSizes = std::move(update.parsedSizes);
+
+    std::vector<StepIndex> newSteps;
+    for (const auto& nodeSteps : newStepsOfNodes)
+        newSteps.insert(newSteps.end(), nodeSteps.begin(), nodeSteps.end());
+    return stepOffsets.finishAppending(std::move(newSteps));
+}
+
 template<CellLike Cell>
 std::vector<StepIndex> ModelReader<Cell>::availableSteps(bool throwOnMismatch) const
 {
-    if (nodeStepOffsets.empty())
+    if (0 == stepOffsets.nodesCount())
     {
         const auto errorMessage = "Warning: availableSteps() called on an empty stage.";
         if (throwOnMismatch)
@@ -506,25 +1553,29 @@ std::vector<StepIndex> ModelReader<Cell>::availableSteps(bool throwOnMismatch) c
         return {};
     }
 
-    // Helper lambda: extracts all step indices (keys) from a map and returns them sorted.
-    auto extractAndSortStepIndices = [](const auto& map) -> std::vector<StepIndex>
+    // Steps available in all nodes are known since loading (they are also part of consolidated index)
+    if (const auto commonSteps = stepOffsets.commonSteps())
+    {
+        return std::vector<StepIndex>(commonSteps->begin(), commonSteps->end());
+    }
+
+    // Helper lambda: extracts all step indices from records (records are sorted by step).
+    auto extractAndSortStepIndices = [](std::span<const StepOffsetRecord> records) -> std::vector<StepIndex>
     {
-        auto steps = std::views::keys(map);
-        std::vector<StepIndex> steps2Return(steps.begin(), steps.end());
-        std::ranges::sort(steps2Return);
-        return steps2Return;
+        auto steps = records | std::views::transform(&StepOffsetRecord::step);
+        return std::vector<StepIndex>(steps.begin(), steps.end());
     };
 
     // Use the first node as the reference
-    const auto& fistNodeData = nodeStepOffsets.front();
+    const auto fistNodeData = stepOffsets.nodeRecords(0);
 
     // Collect and sort all step indices from the first node
     auto firstNodeSteps = extractAndSortStepIndices(fistNodeData);
 
     // Compare each node's step list against the reference
-    for (NodeIndex node = 1; node < nodeStepOffsets.size(); ++node)
+    for (NodeIndex node = 1; node < stepOffsets.nodesCount(); ++node)
     {
-        const auto& nodeMap = nodeStepOffsets[node];
+        const auto nodeMap = stepOffsets.nodeRecords(node);
         if (nodeMap.size() != fistNodeData.size())
         {
             const std::string msg = std::format("Step count mismatch for node {} (expected {}, found {})",
@@ -558,43 +1609,35 @@ std::vector<StepIndex> ModelReader<Cell>::availableSteps(bool throwOnMismatch) c
 template<CellLike Cell>
 FilePosition ModelReader<Cell>::getStepStartingPositionInFile(StepIndex step, NodeIndex node) const
 {
-    if (node >= nodeStepOffsets.size())
+    if (node >= stepOffsets.nodesCount())
     {
-        throw std::out_of_range(std::format("Invalid node index {} (available nodes: {})", node, nodeStepOffsets.size()));
+        throw std::out_of_range(std::format("Invalid node index {} (available nodes: {})", node, stepOffsets.nodesCount()));
     }
 
-    const auto& stepMap = nodeStepOffsets[node];
-    if (auto it = stepMap.find(step); it != stepMap.end())
+    if (const auto* record = stepOffsets.find(node, step))
     {
-        return it->second.position;
+        return record->position;
     }
 
     // Step not found - find closest available steps
-    if (stepMap.empty())
+    const auto records = stepOffsets.nodeRecords(node);
+    if (records.empty())
     {
         throw std::out_of_range(std::format("Step {} not found in node {} (no steps available)", step, node));
     }
 
-    // Find closest previous and next steps
+    // Find closest previous and next steps (records are sorted by step)
     std::optional<StepIndex> prevStep;
     std::optional<StepIndex> nextStep;
 
-    for (const auto& [availableStep, _] : stepMap) // unordered_map does not have lower/upper_bound
+    const auto nextRecord = std::ranges::upper_bound(records, step, {}, &StepOffsetRecord::step);
+    if (nextRecord != records.end())
     {
-        if (availableStep < step)
-        {
-            if (!prevStep || availableStep > *prevStep)
-            {
-                prevStep = availableStep;
-            }
-        }
-        else if (availableStep > step)
-        {
-            if (!nextStep || availableStep < *nextStep)
-            {
-                nextStep = availableStep;
-            }
-        }
+        nextStep = nextRecord->step;
+    }
+    if (nextRecord != records.begin())
+    {
+        prevStep = std::prev(nextRecord)->step;
     }
 
     // Build error message with nearest steps
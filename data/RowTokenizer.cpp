@@ -0,0 +1,227 @@
+/** @file RowTokenizer.cpp
+ * @brief Implementation of the vectorized row tokenizer. */
+
+#include <bit> // std::countr_zero
+#include <format>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#   define ROW_TOKENIZER_X86 1
+#   include <immintrin.h>
+#   ifdef _MSC_VER
+#       include <intrin.h>
+#       define ROW_TOKENIZER_TARGET_AVX2
+#   else
+#       define ROW_TOKENIZER_TARGET_AVX2 __attribute__((target("avx2")))
+#   endif
+#endif
+
+#include "RowTokenizer.h"
+
+
+namespace
+{
+constexpr char delimiter = ' ';
+
+/** @brief State of splitting shared by all implementations.
+ *
+ * Implementations only find positions of delimiters, the token is stored when its terminating delimiter is found.
+ * Empty token means end of the data (the same rule as in the original std::find based loop). */
+struct SplitState
+{
+    char* row;
+    std::size_t length;
+    char** tokens;
+    std::size_t maxTokens;
+    std::size_t tokensCount = 0;
+    std::size_t tokenStart = 0;
+
+    /// @brief Called for delimiter (already replaced by '\0') on given position. Returns false if splitting is finished.
+    bool onDelimiter(std::size_t position)
+    {
+        if (position == tokenStart) // empty token
+            return false;
+
+        tokens[tokensCount++] = row + tokenStart;
+        tokenStart = position + 1;
+        return tokensCount < maxTokens;
+    }
+
+    /// @brief Scalar processing of the rest of the row, returns number of tokens
+    std::size_t finishFrom(std::size_t position)
+    {
+        for (; position < length; ++position)
+        {
+            if (row[position] == delimiter)
+            {
+                row[position] = '\0';
+                if (! onDelimiter(position))
+                    return tokensCount;
+            }
+        }
+
+        // last token is terminated by the end of the row
+        if (tokenStart < length && row[tokenStart] != '\0')
+            tokens[tokensCount++] = row + tokenStart;
+        return tokensCount;
+    }
+};
+
+std::size_t splitScalar(SplitState& state)
+{
+    return state.finishFrom(0);
+}
+
+#ifdef ROW_TOKENIZER_X86
+std::size_t splitSSE2(SplitState& state)
+{
+    const __m128i delimiters = _mm_set1_epi8(delimiter);
+
+    std::size_t position = 0;
+    for (; position + sizeof(__m128i) <= state.length; position += sizeof(__m128i))
+    {
+        auto* chunkAddress = reinterpret_cast<__m128i*>(state.row + position);
+        const __m128i chunk = _mm_loadu_si128(chunkAddress);
+        const __m128i isDelimiter = _mm_cmpeq_epi8(chunk, delimiters);
+
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(isDelimiter));
+        if (0 == mask)
+            continue;
+
+        _mm_storeu_si128(chunkAddress, _mm_andnot_si128(isDelimiter, chunk)); // delimiters -> '\0'
+        for (; mask; mask &= mask - 1)
+        {
+            if (! state.onDelimiter(position + std::countr_zero(mask)))
+                return state.tokensCount;
+        }
+    }
+    return state.finishFrom(position);
+}
+
+ROW_TOKENIZER_TARGET_AVX2 std::size_t splitAVX2(SplitState& state)
+{
+    const __m256i delimiters = _mm256_set1_epi8(delimiter);
+
+    std::size_t position = 0;
+    for (; position + sizeof(__m256i) <= state.length; position += sizeof(__m256i))
+    {
+        auto* chunkAddress = reinterpret_cast<__m256i*>(state.row + position);
+        const __m256i chunk = _mm256_loadu_si256(chunkAddress);
+        const __m256i isDelimiter = _mm256_cmpeq_epi8(chunk, delimiters);
+
+        auto mask = static_cast<unsigned>(_mm256_movemask_epi8(isDelimiter));
+        if (0 == mask)
+            continue;
+
+        _mm256_storeu_si256(chunkAddress, _mm256_andnot_si256(isDelimiter, chunk)); // delimiters -> '\0'
+        for (; mask; mask &= mask - 1)
+        {
+            if (! state.onDelimiter(position + std::countr_zero(mask)))
+                return state.tokensCount;
+        }
+    }
+    return state.finishFrom(position);
+}
+
+bool detectAVX2()
+{
+#   ifdef _MSC_VER
+    int info[4]{};
+    __cpuid(info, 1);
+    const bool osUsesXSave = info[2] & (1 << 27);
+    const bool cpuHasAVX = info[2] & (1 << 28);
+    if (! osUsesXSave || ! cpuHasAVX || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return info[1] & (1 << 5);
+#   else
+    return __builtin_cpu_supports("avx2");
+#   endif
+}
+
+bool cpuSupportsAVX2()
+{
+    static const bool supported = detectAVX2();
+    return supported;
+}
+#endif // ROW_TOKENIZER_X86
+} // namespace
+
+
+namespace RowTokenizer
+{
+bool isSupported(Implementation implementation)
+{
+    switch (implementation)
+    {
+    case Implementation::Scalar:
+        return true;
+#ifdef ROW_TOKENIZER_X86
+    case Implementation::SSE2:
+        return true;
+    case Implementation::AVX2:
+        return cpuSupportsAVX2();
+#endif
+    default:
+        return false;
+    }
+}
+
+Implementation bestImplementation()
+{
+    static const Implementation best = []
+    {
+        if (isSupported(Implementation::AVX2))
+            return Implementation::AVX2;
+        if (isSupported(Implementation::SSE2))
+            return Implementation::SSE2;
+        return Implementation::Scalar;
+    }();
+    return best;
+}
+
+std::size_t splitInPlace(char* row, std::size_t length, char** tokens, std::size_t maxTokens)
+{
+    return splitInPlace(row, length, tokens, maxTokens, bestImplementation());
+}
+
+std::size_t splitInPlace(char* row, std::size_t length, char** tokens, std::size_t maxTokens, Implementation implementation)
+{
+    if (0 == maxTokens)
+        return 0;
+
+    SplitState state{ .row = row, .length = length, .tokens = tokens, .maxTokens = maxTokens };
+
+    switch (implementation)
+    {
+    case Implementation::Scalar:
+        return splitScalar(state);
+#ifdef ROW_TOKENIZER_X86
+    case Implementation::SSE2:
+        return splitSSE2(state);
+    case Implementation::AVX2:
+        if (cpuSupportsAVX2())
+            return splitAVX2(state);
+        break;
+#endif
+    default:
+        break;
+    }
+    throw std::invalid_argument(std::format("Tokenizer implementation {} is not supported on this CPU", toString(implementation)));
+}
+
+std::string_view toString(Implementation implementation)
+{
+    switch (implementation)
+    {
+    case Implementation::Scalar:
+        return "scalar";
+    case Implementation::SSE2:
+        return "SSE2";
+    case Implementation::AVX2:
+        return "AVX2";
+    }
+    return "unknown";
+}
+} // namespace RowTokenizer
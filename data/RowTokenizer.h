@@ -0,0 +1,48 @@
+/** @file RowTokenizer.h
+ * @brief Vectorized splitting of text rows (space separated cell values) into tokens.
+ *
+ * Text data files contain one row of the node per line, cells are separated by single spaces.
+ * The functions find all delimiters of a row in one pass (SSE2/AVX2 when available, scalar otherwise),
+ * terminate each token with '\0' and return pointers to the beginnings of tokens,
+ * so they can be passed directly to Cell::composeElement(). */
+
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+
+namespace RowTokenizer
+{
+/// @brief Available implementations of the tokenizer
+enum class Implementation
+{
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+/** @brief Splits a row in place.
+ *
+ * Every space in the row is replaced by '\0' and pointer to the beginning of each token is stored in @p tokens.
+ * Splitting stops on first empty token (two consecutive spaces, trailing space or end of the row)
+ * or when @p maxTokens tokens were found.
+ * The behaviour is the same as tokenizing with std::replace(' ', '\0') followed by std::find('\0') for each token.
+ *
+ * @param row       Mutable row text, row[length] must be accessible and equal '\0' (like std::string::data())
+ * @param length    Length of the row (without the terminating '\0')
+ * @param tokens    Output array with space for at least @p maxTokens pointers
+ * @param maxTokens Maximum number of tokens to find (number of columns of the node)
+ * @return Number of tokens stored in @p tokens */
+std::size_t splitInPlace(char* row, std::size_t length, char** tokens, std::size_t maxTokens);
+
+/// @brief The same as splitInPlace(), but with explicitly selected implementation (used by tests and benchmark)
+std::size_t splitInPlace(char* row, std::size_t length, char** tokens, std::size_t maxTokens, Implementation implementation);
+
+/// @brief The fastest implementation supported by the CPU (selected once, at first call)
+Implementation bestImplementation();
+
+/// @brief Returns true if the implementation can be executed on current CPU
+bool isSupported(Implementation implementation);
+
+std::string_view toString(Implementation implementation);
+} // namespace RowTokenizer
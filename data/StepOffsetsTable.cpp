@@ -0,0 +1,325 @@
+/** @file StepOffsetsTable.cpp
+ * @brief Implementation of the StepOffsetsTable class. */
+
+#include <algorithm>
+#include <array>
+#include <cstring> // std::memcmp
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <ranges>
+#include <stdexcept>
+
+#include "StepOffsetsTable.h"
+
+
+namespace
+{
+constexpr std::array<char, 8> consolidatedIndexMagic = { 'O', 'O', 'C', 'V', 'I', 'D', 'X', '\0' };
+constexpr std::uint32_t byteOrderMark = 0x01020304;
+
+struct ConsolidatedIndexHeader
+{
+    std::array<char, 8> magic;
+    std::uint32_t version;
+    std::uint32_t byteOrderMark;
+    std::uint32_t nodesCount;
+    std::uint32_t recordSize;
+    std::uint32_t hasCommonSteps;
+    std::uint32_t reserved;
+    std::uint64_t recordsCount;
+    std::uint64_t stepsCount;
+};
+static_assert(sizeof(ConsolidatedIndexHeader) == 48);
+
+constexpr std::size_t stampsOffset = sizeof(ConsolidatedIndexHeader);
+
+constexpr std::size_t firstRecordsOffset(std::size_t nodesCount)
+{
+    return stampsOffset + nodesCount * sizeof(IndexFileStamp);
+}
+
+constexpr std::size_t recordsOffset(std::size_t nodesCount)
+{
+    return firstRecordsOffset(nodesCount) + (nodesCount + 1) * sizeof(std::uint64_t);
+}
+
+template<typename T>
+void writeArray(std::ofstream& file, const T* values, std::size_t count)
+{
+    file.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(count * sizeof(T)));
+}
+} // namespace
+
+
+IndexFileStamp IndexFileStamp::of(const std::string& filePath)
+{
+    return IndexFileStamp{
+        .size = static_cast<std::uint64_t>(std::filesystem::file_size(filePath)),
+        .modificationTime = static_cast<std::int64_t>(std::filesystem::last_write_time(filePath).time_since_epoch().count())
+    };
+}
+
+
+void StepOffsetsTable::resize(NodeIndex nodesCount)
+{
+    consolidatedIndex.reset();
+    ownedRecords.assign(nodesCount, {});
+    nodes.assign(nodesCount, {});
+    ownedCommonSteps.clear();
+    commonStepsView = {};
+    nodesHaveCommonSteps = false;
+}
+
+std::size_t StepOffsetsTable::recordsCount() const
+{
+    std::size_t count = 0;
+    for (const auto& nodeRecords : nodes)
+        count += nodeRecords.size();
+    return count;
+}
+
+std::vector<StepIndex> StepOffsetsTable::setNodeRecords(NodeIndex node, std::vector<StepOffsetRecord> records)
+{
+    std::ranges::stable_sort(records, {}, &StepOffsetRecord::step);
+
+    std::vector<StepIndex> duplicatedSteps;
+    const auto duplicates = std::ranges::unique(records,
+                                                [&duplicatedSteps](const StepOffsetRecord& first, const StepOffsetRecord& second)
+                                                {
+                                                    if (first.step != second.step)
+                                                        return false;
+                                                    duplicatedSteps.push_back(second.step);
+                                                    return true;
+                                                });
+    records.erase(duplicates.begin(), duplicates.end());
+
+    ownedRecords.at(node) = std::move(records);
+    nodes[node] = ownedRecords[node];
+    return duplicatedSteps;
+}
+
+void StepOffsetsTable::finishLoading()
+{
+    ownedCommonSteps.clear();
+    nodesHaveCommonSteps = ! nodes.empty();
+    if (nodes.empty())
+        return;
+
+    const auto sameSteps = [](std::span<const StepOffsetRecord> first, std::span<const StepOffsetRecord> second)
+    {
+        return std::ranges::equal(first, second, {}, &StepOffsetRecord::step, &StepOffsetRecord::step);
+    };
+    nodesHaveCommonSteps = std::ranges::all_of(nodes,
+                                               [&](const auto& nodeRecords)
+                                               {
+                                                   return sameSteps(nodes.front(), nodeRecords);
+                                               });
+    ownedCommonSteps.reserve(nodes.front().size());
+    for (const auto& record : nodes.front())
+    {
+        // nodes usually have the same steps, then nothing is searched
+        if (nodesHaveCommonSteps || isInAllNodes(record.step))
+            ownedCommonSteps.push_back(record.step);
+    }
+    commonStepsView = ownedCommonSteps;
+}
+
+std::vector<StepIndex> StepOffsetsTable::appendNodeRecords(NodeIndex node, std::span<const StepOffsetRecord> records)
+{
+    std::vector<StepIndex> newSteps;
+    if (records.empty())
+        return newSteps;
+
+    auto& nodeRecords = ownedRecords.at(node);
+    if (nodeRecords.data() != nodes[node].data())
+        nodeRecords.assign(nodes[node].begin(), nodes[node].end()); // records are in mapped consolidated index
+
+    for (const auto& record : records)
+    {
+        if (nodeRecords.empty() || record.step > nodeRecords.back().step)
+        {
+            nodeRecords.push_back(record);
+            newSteps.push_back(record.step);
+            continue;
+        }
+        if (record.step == nodeRecords.back().step)
+        {
+            nodeRecords.back() = record;
+            continue;
+        }
+
+        const auto it = std::ranges::lower_bound(nodeRecords, record.step, {}, &StepOffsetRecord::step);
+        if (it->step != record.step)
+        {
+            nodeRecords.insert(it, record);
+            newSteps.push_back(record.step);
+        }
+    }
+
+    nodes[node] = nodeRecords;
+    return newSteps;
+}
+
+std::vector<StepIndex> StepOffsetsTable::finishAppending(std::vector<StepIndex> newSteps)
+{
+    std::ranges::sort(newSteps);
+    const auto duplicates = std::ranges::unique(newSteps);
+    newSteps.erase(duplicates.begin(), duplicates.end());
+    std::erase_if(newSteps,
+                  [this](StepIndex step)
+                  {
+                      return ! isInAllNodes(step);
+                  });
+
+    if (! newSteps.empty())
+    {
+        if (ownedCommonSteps.data() != commonStepsView.data())
+            ownedCommonSteps.assign(commonStepsView.begin(), commonStepsView.end()); // steps are in mapped consolidated index
+
+        for (const auto step : newSteps)
+            ownedCommonSteps.insert(std::ranges::upper_bound(ownedCommonSteps, step), step);
+        commonStepsView = ownedCommonSteps;
+    }
+
+    nodesHaveCommonSteps = ! nodes.empty()
+                           && std::ranges::all_of(nodes,
+                                                  [this](const auto& nodeRecords)
+                                                  {
+                                                      return nodeRecords.size() == commonStepsView.size();
+                                                  });
+    return newSteps;
+}
+
+const StepOffsetRecord* StepOffsetsTable::find(NodeIndex node, StepIndex step) const
+{
+    if (node >= nodes.size())
+        return nullptr;
+
+    const auto& nodeRecords = nodes[node];
+    const auto it = std::ranges::lower_bound(nodeRecords, step, {}, &StepOffsetRecord::step);
+    if (it == nodeRecords.end() || it->step != step)
+        return nullptr;
+    return &*it;
+}
+
+bool StepOffsetsTable::isInAllNodes(StepIndex step) const
+{
+    return std::ranges::all_of(std::views::iota(NodeIndex{ 0 }, nodesCount()),
+                               [this, step](NodeIndex node)
+                               {
+                                   return find(node, step) != nullptr;
+                               });
+}
+
+std::optional<std::span<const StepIndex>> StepOffsetsTable::commonSteps() const
+{
+    if (! nodesHaveCommonSteps)
+        return std::nullopt;
+    return commonStepsView;
+}
+
+void StepOffsetsTable::writeConsolidatedIndex(const std::string& filePath, const std::vector<IndexFileStamp>& sourceStamps) const
+{
+    if (sourceStamps.size() != nodes.size())
+        throw std::invalid_argument(std::format("Stamps of {} index files provided for {} nodes", sourceStamps.size(), nodes.size()));
+
+    std::vector<std::uint64_t> firstRecords;
+    firstRecords.reserve(nodes.size() + 1);
+    firstRecords.push_back(0);
+    for (const auto& nodeRecords : nodes)
+        firstRecords.push_back(firstRecords.back() + nodeRecords.size());
+
+    const ConsolidatedIndexHeader header{
+        .magic = consolidatedIndexMagic,
+        .version = consolidatedIndexVersion,
+        .byteOrderMark = byteOrderMark,
+        .nodesCount = static_cast<std::uint32_t>(nodes.size()),
+        .recordSize = sizeof(StepOffsetRecord),
+        .hasCommonSteps = nodesHaveCommonSteps ? 1u : 0u,
+        .reserved = 0,
+        .recordsCount = firstRecords.back(),
+        .stepsCount = commonStepsView.size()
+    };
+
+    const auto temporaryFilePath = filePath + ".tmp";
+    {
+        std::ofstream file(temporaryFilePath, std::ios::binary | std::ios::trunc);
+        if (! file)
+            throw std::runtime_error(std::format("Cannot create file '{}'", temporaryFilePath));
+
+        writeArray(file, &header, 1);
+        writeArray(file, sourceStamps.data(), sourceStamps.size());
+        writeArray(file, firstRecords.data(), firstRecords.size());
+        for (const auto& nodeRecords : nodes)
+            writeArray(file, nodeRecords.data(), nodeRecords.size());
+        writeArray(file, commonStepsView.data(), commonStepsView.size());
+
+        if (! file.flush())
+            throw std::runtime_error(std::format("Cannot write file '{}'", temporaryFilePath));
+    }
+
+    std::error_code errorCode;
+    std::filesystem::rename(temporaryFilePath, filePath, errorCode);
+    if (errorCode)
+    {
+        std::filesystem::remove(temporaryFilePath, errorCode);
+        throw std::runtime_error(std::format("Cannot rename '{}' to '{}'", temporaryFilePath, filePath));
+    }
+}
+
+bool StepOffsetsTable::mapConsolidatedIndex(const std::string& filePath, const std::vector<IndexFileStamp>& sourceStamps)
+{
+    std::error_code errorCode;
+    if (! std::filesystem::is_regular_file(filePath, errorCode))
+        return false;
+
+    auto mappedFile = std::make_shared<const MappedFile>(filePath);
+    const char* data = mappedFile->data();
+    const std::size_t fileSize = mappedFile->size();
+
+    if (fileSize < sizeof(ConsolidatedIndexHeader))
+        return false;
+
+    ConsolidatedIndexHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != consolidatedIndexMagic || header.version != consolidatedIndexVersion || header.byteOrderMark != byteOrderMark
+        || header.recordSize != sizeof(StepOffsetRecord) || header.nodesCount != sourceStamps.size())
+    {
+        return false;
+    }
+
+    const std::size_t nodesCount = header.nodesCount;
+    const auto maxRecords = fileSize / sizeof(StepOffsetRecord);
+    const auto maxSteps = fileSize / sizeof(StepIndex);
+    if (header.recordsCount > maxRecords || header.stepsCount > maxSteps)
+        return false;
+
+    const auto stepsOffset = recordsOffset(nodesCount) + header.recordsCount * sizeof(StepOffsetRecord);
+    if (fileSize != stepsOffset + header.stepsCount * sizeof(StepIndex))
+        return false;
+
+    if (std::memcmp(data + stampsOffset, sourceStamps.data(), nodesCount * sizeof(IndexFileStamp)) != 0)
+        return false; // index files changed
+
+    const auto* firstRecords = reinterpret_cast<const std::uint64_t*>(data + firstRecordsOffset(nodesCount));
+    const auto* records = reinterpret_cast<const StepOffsetRecord*>(data + recordsOffset(nodesCount));
+    if (firstRecords[0] != 0 || firstRecords[nodesCount] != header.recordsCount)
+        return false;
+
+    std::vector<std::span<const StepOffsetRecord>> mappedNodes(nodesCount);
+    for (std::size_t node = 0; node < nodesCount; ++node)
+    {
+        if (firstRecords[node + 1] < firstRecords[node])
+            return false;
+        mappedNodes[node] = { records + firstRecords[node], static_cast<std::size_t>(firstRecords[node + 1] - firstRecords[node]) };
+    }
+
+    ownedRecords.assign(nodesCount, {}); // records of nodes are copied when records are appended to them
+    ownedCommonSteps.clear();
+    nodes = std::move(mappedNodes);
+    commonStepsView = { reinterpret_cast<const StepIndex*>(data + stepsOffset), static_cast<std::size_t>(header.stepsCount) };
+    nodesHaveCommonSteps = (header.hasCommonSteps != 0);
+    consolidatedIndex = std::move(mappedFile);
+    return true;
+}
@@ -0,0 +1,164 @@
+/** @file StepOffsetsTable.h
+ * @brief Declaration of the StepOffsetsTable class - positions of steps in data files of all nodes. */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "core/types.h"
+#include "data/MappedFile.h"
+
+
+/** @struct StepOffsetRecord
+ * @brief Position of a step in the data file of a node (one line of index file of the node).
+ *
+ * The structure is stored as is in consolidated index file, so it has fixed size and layout. */
+struct StepOffsetRecord
+{
+    StepIndex step;
+    std::uint32_t hasSceneSize; ///< 1 if dimensions of the node are known (extended index format "step position (C-R)")
+    FilePosition position;
+    std::int32_t columns;
+    std::int32_t rows;
+
+    std::optional<ColumnAndRow> sceneSize() const
+    {
+        if (! hasSceneSize)
+            return std::nullopt;
+        return ColumnAndRow{ .column = columns, .row = rows };
+    }
+};
+static_assert(sizeof(StepOffsetRecord) == 24 && std::is_trivially_copyable_v<StepOffsetRecord>, "StepOffsetRecord is stored in files");
+
+/** @struct IndexFileStamp
+ * @brief Size and modification time of an index file.
+ *
+ * Consolidated index is used only if stamps of all index files are the same as when it was written. */
+struct IndexFileStamp
+{
+    std::uint64_t size;
+    std::int64_t modificationTime; ///< Ticks of std::filesystem::file_time_type
+
+    bool operator==(const IndexFileStamp&) const = default;
+
+    /// @throws std::filesystem::filesystem_error If the file does not exist
+    static IndexFileStamp of(const std::string& filePath);
+};
+
+
+/** @class StepOffsetsTable
+ * @brief Positions of all steps in data files of all nodes, records of every node are sorted by step.
+ *
+ * The table is filled from text index files (see ModelReader::readStepsOffsetsForAllNodesFromFiles)
+ * and can be written into consolidated index file - binary, versioned table of records of all nodes
+ * together with list of steps available in all nodes. When the dataset is opened again the consolidated
+ * index is just mapped into memory and records are used directly from the mapping (nothing is parsed).
+ *
+ * Layout of consolidated index file (native byte order, checked by byteOrderMark):
+ * - header (ConsolidatedIndexHeader),
+ * - IndexFileStamp of every node (to detect changed index files),
+ * - index of first record of every node (nodesCount + 1 values),
+ * - records (StepOffsetRecord) of all nodes,
+ * - steps available in all nodes (StepIndex, sorted).
+ *
+ * While the simulation is still running, records read from the end of index files are appended
+ * (appendNodeRecords(), finishAppending()), so the table is not built again for every new step. */
+class StepOffsetsTable
+{
+public:
+    static constexpr std::uint32_t consolidatedIndexVersion = 2; ///< Version 2 stores steps available in all nodes also when nodes have different steps
+
+    /// @brief Removes all records and prepares empty records for the nodes
+    void resize(NodeIndex nodesCount);
+
+    void clear()
+    {
+        resize(0);
+    }
+
+    NodeIndex nodesCount() const
+    {
+        return static_cast<NodeIndex>(nodes.size());
+    }
+
+    /// @brief Number of records of all nodes
+    std::size_t recordsCount() const;
+
+    /** @brief Sets records of the node, they are sorted by step (for duplicated steps the first record is kept).
+     *
+     * Records of different nodes can be set concurrently.
+     * @return Steps, which were duplicated */
+    std::vector<StepIndex> setNodeRecords(NodeIndex node, std::vector<StepOffsetRecord> records);
+
+    /** @brief Computes list of steps available in all nodes, must be called after records of all nodes are set
+     *  (it is part of the consolidated index, so it is not computed again when the index is mapped). */
+    void finishLoading();
+
+    /** @brief Appends records of the node read from the end of its index file (the simulation is still running).
+     *
+     * Records normally follow the last step of the node, so they are just appended. A record of the last step replaces it
+     * (the last line of the index file could be read before it was written completely), records of other known steps are ignored.
+     * Records of the node used from mapped consolidated index are copied first.
+     * Records of different nodes can be appended concurrently, finishAppending() has to be called then.
+     * @return Steps, which are new for the node */
+    std::vector<StepIndex> appendNodeRecords(NodeIndex node, std::span<const StepOffsetRecord> records);
+
+    /** @brief Updates steps available in all nodes after records were appended, only new steps are checked.
+     * @param newSteps Steps new for any node (returned by appendNodeRecords())
+     * @return Steps, which became available in all nodes (sorted) */
+    std::vector<StepIndex> finishAppending(std::vector<StepIndex> newSteps);
+
+    /// @brief Records of the node sorted by step
+    std::span<const StepOffsetRecord> nodeRecords(NodeIndex node) const
+    {
+        return nodes.at(node);
+    }
+
+    /// @return Record of the step of the node or nullptr if the node does not have the step
+    const StepOffsetRecord* find(NodeIndex node, StepIndex step) const;
+
+    /// @brief Sorted steps available in all nodes, std::nullopt if nodes have different steps
+    std::optional<std::span<const StepIndex>> commonSteps() const;
+
+    /// @brief Sorted steps available in all nodes, also when some nodes have other steps too (e.g. the simulation is writing a step)
+    std::span<const StepIndex> completeSteps() const
+    {
+        return commonStepsView;
+    }
+
+    /** @brief Writes the table into consolidated index file.
+     *
+     * The content is written into temporary file, which is renamed, so readers never see partially written file.
+     * @param sourceStamps Stamps of index files of all nodes
+     * @throws std::runtime_error If the file can not be written */
+    void writeConsolidatedIndex(const std::string& filePath, const std::vector<IndexFileStamp>& sourceStamps) const;
+
+    /** @brief Maps consolidated index file and uses records from the mapping.
+     * @param sourceStamps Current stamps of index files of all nodes
+     * @return false (and the table is not changed) if the file does not exist, has different version or layout
+     *         or any index file changed since the consolidated index was written */
+    bool mapConsolidatedIndex(const std::string& filePath, const std::vector<IndexFileStamp>& sourceStamps);
+
+    /// @brief Checks if records are used from mapped consolidated index
+    bool isMappedConsolidatedIndex() const
+    {
+        return consolidatedIndex != nullptr;
+    }
+
+private:
+    bool isInAllNodes(StepIndex step) const;
+
+    std::vector<std::vector<StepOffsetRecord>> ownedRecords; ///< Records read from text index files
+    std::shared_ptr<const MappedFile> consolidatedIndex;     ///< Mapping of consolidated index if records are used from it
+    std::vector<std::span<const StepOffsetRecord>> nodes;    ///< Records of nodes (in ownedRecords or in the mapping)
+
+    std::vector<StepIndex> ownedCommonSteps;
+    std::span<const StepIndex> commonStepsView; ///< Steps available in all nodes (in ownedCommonSteps or in the mapping)
+    bool nodesHaveCommonSteps = false;          ///< All nodes have the same steps
+};
@@ -0,0 +1,294 @@
+/** @file StepPrefetcher.hpp
+ * @brief Declaration of the StepPrefetcher class - background read-ahead of steps during playback. */
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility> // std::swap
+#include <vector>
+
+#include "core/types.h"
+#include "visualiser/Line.h"
+#include "visualiser/SettingParameter.h"
+
+
+/** @class StepPrefetcher
+ * @brief Reads steps, which will be displayed soon, in background into standby matrices.
+ *
+ * During playback the next steps (in the playback direction, with the playback speed) are requested by prefetch().
+ * They are read by a background thread (reading itself is parallelised on the shared ThreadPool, so idle cores are used)
+ * into standby matrices. When the step is displayed take() just swaps the standby matrix with the displayed one
+ * (the displayed matrix is reused for next standby step).
+ *
+ * Number of steps worth reading ahead is provided by recommendedDepth() - it is based on measured time of reading of a step
+ * compared with interval between displayed frames.
+ *
+ * @tparam Matrix Type of the matrix of cells (CellGrid)
+ * @note Methods are expected to be called from one (GUI) thread, reading is done in the background thread. */
+template<class Matrix>
+class StepPrefetcher
+{
+public:
+    /// @brief Function reading the step (sp->step) into the matrix and lines (ModelReader::readStageStateFromFilesForStep())
+    using ReadStepFunction = std::function<void(Matrix&, SettingParameter*, Line*)>;
+
+    static constexpr std::size_t minimalDepth = 2;
+    static constexpr std::size_t maximalDepth = 8; ///< Every standby step keeps whole matrix in memory
+
+    explicit StepPrefetcher(ReadStepFunction readStep)
+        : readStep{ std::move(readStep) }
+    {
+    }
+
+    StepPrefetcher(const StepPrefetcher&) = delete;
+    StepPrefetcher& operator=(const StepPrefetcher&) = delete;
+
+    ~StepPrefetcher();
+
+    /** @brief Requests reading of the steps (in order of displaying) in background.
+     *
+     * Previous request is replaced: standby steps which are not requested any more are dropped.
+     * At most maximalDepth steps are kept.
+     * @param sp Current settings (steps are read with a copy of them, only the step number is changed) */
+    void prefetch(const SettingParameter& sp, const std::vector<StepIndex>& steps);
+
+    /** @brief Moves the step read in background into the matrix and lines (the matrix is swapped with the standby one).
+     *
+     * If the step is just being read it waits for the end of reading.
+     * @return false if the step was not prefetched (it has to be read directly) */
+    bool take(StepIndex step, Matrix& matrix, Line* lines, std::size_t linesCount);
+
+    /** @brief Drops all standby steps and pending requests, waits until reading in background is finished.
+     *
+     * Must be called before the reader (or the matrix dimensions) is changed. */
+    void clear();
+
+    /** @brief Number of steps, which should be read ahead to keep the interval between frames.
+     *
+     * If reading of a step takes k frame intervals, the step needed k frames later has to be requested now
+     * (plus one standby step ready to be swapped). */
+    std::size_t recommendedDepth(std::chrono::milliseconds frameInterval) const;
+
+    /// @brief Average (exponential moving average) time of reading of one step in background
+    std::chrono::microseconds averageReadTime() const;
+
+    /// @brief Number of steps already read and waiting to be taken
+    std::size_t standbyStepsCount() const
+    {
+        std::lock_guard lock(mutex);
+        return standbySteps.size();
+    }
+
+private:
+    struct StandbyStep
+    {
+        Matrix matrix;
+        std::vector<Line> lines;
+    };
+
+    void workerLoop();
+
+    /// @brief Returns matrix of the dimensions, recycled one if available (caller must lock the mutex)
+    Matrix matrixForReading(int columns, int rows);
+
+    /// @brief Keeps the matrix for reading of next steps (caller must lock the mutex)
+    void recycle(Matrix&& matrix);
+
+    ReadStepFunction readStep;
+
+    mutable std::mutex mutex;
+    std::condition_variable changed; ///< Notified when requests change or reading of a step is finished
+
+    std::optional<SettingParameter> settings; ///< Settings of the last request
+    std::deque<StepIndex> pendingSteps;
+    std::unordered_map<StepIndex, StandbyStep> standbySteps;
+    std::optional<StepIndex> stepBeingRead;
+    std::vector<Matrix> recycledMatrices;
+    std::uint64_t generation = 0; ///< Increased by clear(), steps read for older generation are dropped
+
+    std::chrono::microseconds readTime{};
+    bool stopping = false;
+    std::thread worker; ///< Started with the first request
+};
+
+
+template<class Matrix>
+StepPrefetcher<Matrix>::~StepPrefetcher()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+
+    if (worker.joinable())
+        worker.join();
+}
+
+template<class Matrix>
+void StepPrefetcher<Matrix>::prefetch(const SettingParameter& sp, const std::vector<StepIndex>& steps)
+{
+    const auto requestedSteps = std::min(steps.size(), maximalDepth);
+    {
+        std::lock_guard lock(mutex);
+        settings = sp;
+
+        const auto requestedEnd = steps.begin() + static_cast<std::ptrdiff_t>(requestedSteps);
+        for (auto it = standbySteps.begin(); it != standbySteps.end();)
+        {
+            if (std::find(steps.begin(), requestedEnd, it->first) != requestedEnd)
+            {
+                ++it;
+                continue;
+            }
+            recycle(std::move(it->second.matrix));
+            it = standbySteps.erase(it);
+        }
+
+        pendingSteps.clear();
+        for (std::size_t i = 0; i < requestedSteps; ++i)
+        {
+            if (! standbySteps.contains(steps[i]) && stepBeingRead != steps[i])
+                pendingSteps.push_back(steps[i]);
+        }
+
+        if (! worker.joinable())
+            worker = std::thread(&StepPrefetcher::workerLoop, this);
+    }
+    changed.notify_all();
+}
+
+template<class Matrix>
+bool StepPrefetcher<Matrix>::take(StepIndex step, Matrix& matrix, Line* lines, std::size_t linesCount)
+{
+    std::unique_lock lock(mutex);
+    std::erase(pendingSteps, step); // it is going to be read directly
+    changed.wait(lock, [&] { return stepBeingRead != step; });
+
+    auto it = standbySteps.find(step);
+    if (it == standbySteps.end())
+        return false;
+
+    auto& standbyStep = it->second;
+    const bool usable = matrix.hasSameDimensions(standbyStep.matrix) && standbyStep.lines.size() == linesCount;
+    if (usable)
+    {
+        std::swap(matrix, standbyStep.matrix);
+        std::ranges::copy(standbyStep.lines, lines);
+    }
+    recycle(std::move(standbyStep.matrix));
+    standbySteps.erase(it);
+    return usable;
+}
+
+template<class Matrix>
+void StepPrefetcher<Matrix>::clear()
+{
+    std::unique_lock lock(mutex);
+    ++generation;
+    settings.reset();
+    pendingSteps.clear();
+    standbySteps.clear();
+    recycledMatrices.clear();
+    changed.wait(lock, [this] { return ! stepBeingRead.has_value(); });
+}
+
+template<class Matrix>
+std::size_t StepPrefetcher<Matrix>::recommendedDepth(std::chrono::milliseconds frameInterval) const
+{
+    const auto averageTime = averageReadTime();
+    if (averageTime.count() <= 0)
+        return minimalDepth;
+
+    const auto interval = std::chrono::duration_cast<std::chrono::microseconds>(std::max(frameInterval, std::chrono::milliseconds{ 1 }));
+    const auto framesPerRead = static_cast<std::size_t>(std::ceil(static_cast<double>(averageTime.count()) / static_cast<double>(interval.count())));
+    return std::clamp(framesPerRead + 1, minimalDepth, maximalDepth);
+}
+
+template<class Matrix>
+std::chrono::microseconds StepPrefetcher<Matrix>::averageReadTime() const
+{
+    std::lock_guard lock(mutex);
+    return readTime;
+}
+
+template<class Matrix>
+void StepPrefetcher<Matrix>::workerLoop()
+{
+    std::unique_lock lock(mutex);
+    while (true)
+    {
+        changed.wait(lock, [this] { return stopping || ! pendingSteps.empty(); });
+        if (stopping)
+            return;
+
+        const StepIndex step = pendingSteps.front();
+        pendingSteps.pop_front();
+        if (standbySteps.contains(step) || ! settings)
+            continue;
+
+        SettingParameter sp = *settings;
+        sp.step = step;
+        const auto readGeneration = generation;
+        StandbyStep standbyStep{ matrixForReading(sp.numberOfColumnX, sp.numberOfRowsY),
+                                 std::vector<Line>(static_cast<std::size_t>(std::max(sp.numberOfLines, 0))) };
+        stepBeingRead = step;
+        lock.unlock();
+
+        bool success = true;
+        const auto startTime = std::chrono::steady_clock::now();
+        try
+        {
+            readStep(standbyStep.matrix, &sp, standbyStep.lines.data());
+        }
+        catch (const std::exception& e)
+        {
+            // the step will be read (and the error reported) when it is displayed
+            std::cerr << "Warning: reading step " << step << " in background failed: " << e.what() << std::endl;
+            success = false;
+        }
+        const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+
+        lock.lock();
+        stepBeingRead.reset();
+        if (success && readGeneration == generation)
+        {
+            readTime = (readTime.count() > 0) ? (3 * readTime + duration) / 4 : duration;
+            standbySteps.insert_or_assign(step, std::move(standbyStep));
+        }
+        changed.notify_all();
+    }
+}
+
+template<class Matrix>
+Matrix StepPrefetcher<Matrix>::matrixForReading(int columns, int rows)
+{
+    Matrix matrix;
+    if (! recycledMatrices.empty())
+    {
+        matrix = std::move(recycledMatrices.back());
+        recycledMatrices.pop_back();
+    }
+
+    matrix.resize(columns, rows); // memory of recycled matrix is reused also when dimensions changed
+    return matrix;
+}
+
+template<class Matrix>
+void StepPrefetcher<Matrix>::recycle(Matrix&& matrix)
+{
+    if (recycledMatrices.size() < maximalDepth)
+        recycledMatrices.push_back(std::move(matrix));
+}
+
@@ -0,0 +1,89 @@
+/** @file SubstateColumns.cpp
+ * @brief Implementation of the SubstateColumns class. */
+
+#include <charconv>
+
+#include "SubstateColumns.h"
+
+
+std::optional<SubstateColumn::ValueRange> SubstateColumn::valueRange(double skippedValue, bool onlyPositive) const
+{
+    const bool hasSkippedValue = ! std::isnan(skippedValue);
+
+    ValueRange range{ .min = std::numeric_limits<double>::max(), .max = std::numeric_limits<double>::lowest() };
+    bool found = false;
+    for (const double value : columnValues)
+    {
+        if (std::isnan(value) || (hasSkippedValue && value == skippedValue) || (onlyPositive && value <= 0.0))
+            continue;
+
+        range.min = std::min(range.min, value);
+        range.max = std::max(range.max, value);
+        found = true;
+    }
+
+    if (! found)
+        return std::nullopt;
+    return range;
+}
+
+void SubstateColumn::computeTileValueRanges()
+{
+    const int tilesInRow = tileColumns();
+    tileValueRanges.assign(static_cast<std::size_t>(tilesInRow) * static_cast<std::size_t>(tileRows()), ValueRange{ notANumber, notANumber });
+
+    ThreadPool::instance().parallelFor(static_cast<std::size_t>(tileRows()),
+                                       [&](std::size_t tileRow)
+                                       {
+                                           ValueRange* ranges = tileValueRanges.data() + tileRow * static_cast<std::size_t>(tilesInRow);
+                                           const int lastRow = std::min(rowsCount, static_cast<int>(tileRow + 1) * tileSize);
+                                           for (int row = static_cast<int>(tileRow) * tileSize; row < lastRow; ++row)
+                                           {
+                                               for (int column = 0; column < columnsCount; ++column)
+                                               {
+                                                   const double cellValue = value(row, column);
+                                                   if (std::isnan(cellValue))
+                                                       continue;
+
+                                                   auto& range = ranges[column / tileSize];
+                                                   if (std::isnan(range.min))
+                                                   {
+                                                       range = { cellValue, cellValue };
+                                                       continue;
+                                                   }
+                                                   range.min = std::min(range.min, cellValue);
+                                                   range.max = std::max(range.max, cellValue);
+                                               }
+                                           }
+                                       });
+}
+
+double SubstateColumn::parseValue(std::string_view text)
+{
+    const char* first = text.data();
+    const char* last = text.data() + text.size();
+    while (first != last && (*first == ' ' || (*first >= '\t' && *first <= '\r')))
+        ++first;
+    if (first != last && *first == '+') // accepted by std::stod, but not by std::from_chars
+        ++first;
+
+    double value = notANumber;
+    if (std::from_chars(first, last, value).ec != std::errc{})
+        return notANumber; // also out of range values (std::stod throws for them)
+    return value;
+}
+
+
+const SubstateColumn* SubstateColumns::find(std::string_view fieldName) const
+{
+    const auto it = std::ranges::find(fields, fieldName, &std::pair<std::string, SubstateColumn>::first);
+    return it != fields.end() ? &it->second : nullptr;
+}
+
+std::size_t SubstateColumns::usedBytes() const
+{
+    std::size_t bytes = 0;
+    for (const auto& [fieldName, column] : fields)
+        bytes += column.values().size() * sizeof(double);
+    return bytes;
+}
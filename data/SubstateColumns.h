@@ -0,0 +1,258 @@
+/** @file SubstateColumns.h
+ * @brief Declaration of the SubstateColumns class - numeric values of substates of the displayed step. */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "core/ThreadPool.h"
+#include "plugins/CellConcept.hpp"
+
+
+/** @class SubstateColumn
+ * @brief Numeric values of one substate of all cells stored row after row in one array.
+ *
+ * Values are NaN for cells whose encoding is not a number, so NaN works as a mask of cells without value.
+ * Value representing "no data" (SubstateInfo::noValue) is not masked here, because the user can change it
+ * without reading the step again - it is compared by consumers (see isNoValue()).
+ * Ranges of values of tiles are computed together with values, so parts of the grid without anything
+ * to display can be skipped (see ActiveTiles). */
+class SubstateColumn
+{
+public:
+    static constexpr double notANumber = std::numeric_limits<double>::quiet_NaN();
+    static constexpr int tileSize = 32; ///< Cells are grouped into square tiles, range of values of each tile is known (see tileValueRange())
+
+    /// @brief Smallest and largest value of the column
+    struct ValueRange
+    {
+        double min;
+        double max;
+    };
+
+    int columns() const
+    {
+        return columnsCount;
+    }
+
+    int rows() const
+    {
+        return rowsCount;
+    }
+
+    bool contains(int row, int column) const
+    {
+        return row >= 0 && column >= 0 && row < rowsCount && column < columnsCount;
+    }
+
+    /// @return Value of the cell, NaN if its encoding is not a number
+    double value(int row, int column) const
+    {
+        return columnValues[static_cast<std::size_t>(row) * static_cast<std::size_t>(columnsCount) + static_cast<std::size_t>(column)];
+    }
+
+    /// @brief Values of all cells row after row
+    std::span<const double> values() const
+    {
+        return columnValues;
+    }
+
+    int tileColumns() const
+    {
+        return (columnsCount + tileSize - 1) / tileSize;
+    }
+
+    int tileRows() const
+    {
+        return (rowsCount + tileSize - 1) / tileSize;
+    }
+
+    /// @return Range of values of cells of the tile, std::nullopt if no cell of the tile is a number
+    std::optional<ValueRange> tileValueRange(int tileRow, int tileColumn) const
+    {
+        const auto& range = tileValueRanges[static_cast<std::size_t>(tileRow) * static_cast<std::size_t>(tileColumns()) + static_cast<std::size_t>(tileColumn)];
+        if (std::isnan(range.min))
+            return std::nullopt;
+        return range;
+    }
+
+    static bool isNoValue(double value, bool noValueEnabled, double noValue)
+    {
+        return noValueEnabled && ! std::isnan(noValue) && value == noValue;
+    }
+
+    /** @brief Finds range of values, NaN are skipped.
+     * @param skippedValue Value which is skipped too (e.g. enabled noValue), NaN if none
+     * @param onlyPositive Only values greater than zero are considered
+     * @return std::nullopt if there is no such value */
+    std::optional<ValueRange> valueRange(double skippedValue = notANumber, bool onlyPositive = false) const;
+
+    /** @brief Converts text into number the same way as std::stod (leading whitespaces are skipped, so are characters after the number),
+     *  but without throwing and allocating.
+     * @return NaN if the text does not start with a number */
+    static double parseValue(std::string_view text);
+
+    /** @brief Value of the field of single cell (for cells which were not extracted).
+     * @return NaN if the value is not a number */
+    template<class Cell>
+    static double cellValue(const Cell& cell, const char* fieldName)
+    {
+        if constexpr (NumericSubstatesCell<Cell>)
+        {
+            if (const int id = Cell::substateId(fieldName); id >= 0)
+                return static_cast<double>(cell.substateValue(id));
+        }
+        return parseValue(cell.stringEncoding(fieldName));
+    }
+
+    /** @brief Fills the column with values of the field of all cells (rows are processed in parallel).
+     *
+     * Cells providing numeric substates (NumericSubstatesCell) are read directly, the field name is resolved
+     * into id at the first extraction only (the column is kept for the field), other cells are converted
+     * with stringEncoding().
+     * @param p Matrix of cells (p.size() rows)
+     * @param fieldName Name of the substate field */
+    template<class Matrix>
+    void extract(const Matrix& p, const char* fieldName);
+
+private:
+    static constexpr std::size_t rowsPerTask = 64;
+    static constexpr int unresolvedSubstateId = std::numeric_limits<int>::min();
+
+    /// @brief Calls function(row, rowValues) for all rows in parallel
+    template<typename Function>
+    void forEachRow(Function function);
+
+    /// @brief Finds ranges of values of all tiles (values have to be extracted already)
+    void computeTileValueRanges();
+
+    std::vector<double> columnValues;
+    std::vector<ValueRange> tileValueRanges; ///< Row after row, NaN for tiles without numbers
+    int columnsCount = 0;
+    int rowsCount = 0;
+    int substateId = unresolvedSubstateId; ///< Id of the field for NumericSubstatesCell (negative if the cell does not know it)
+};
+
+
+/** @class SubstateColumns
+ * @brief Per-step cache of numeric values of substates (one SubstateColumn for each field).
+ *
+ * Previously every consumer converted cell into number with stringEncoding() and std::stod whenever it needed
+ * the value (coloring of each cell, every corner of 3D mesh, four times for every sample of grid lines on 3D surface,
+ * tooltip and calculating of minimum and maximum), which meant millions of string allocations for every frame.
+ * Now each substate of the displayed step is extracted once, right after the step was read, and consumers read
+ * contiguous arrays of numbers. Memory of columns is reused by next steps. */
+class SubstateColumns
+{
+public:
+    /** @brief Extracts values of the fields from the matrix, columns of other fields are removed.
+     * Must be called whenever content of the matrix changes. */
+    template<class Matrix>
+    void extract(const Matrix& p, const std::vector<std::string>& fieldNames);
+
+    /// @return Column of the field, nullptr if it was not extracted
+    const SubstateColumn* find(std::string_view fieldName) const;
+
+    /** @return Column of the field only if it matches dimensions of the matrix, otherwise nullptr (values
+     *  were not extracted from the matrix, e.g. it was resized). */
+    template<class Matrix>
+    const SubstateColumn* find(std::string_view fieldName, const Matrix& p) const
+    {
+        const auto* column = find(fieldName);
+        if (! column || column->rows() != static_cast<int>(p.size()))
+            return nullptr;
+        if (column->rows() > 0 && column->columns() != static_cast<int>(p[0].size()))
+            return nullptr;
+        return column;
+    }
+
+    void clear()
+    {
+        fields.clear();
+    }
+
+    /// @brief Memory used by values of all columns
+    std::size_t usedBytes() const;
+
+private:
+    std::vector<std::pair<std::string, SubstateColumn>> fields; ///< There are only a few substates, so vector is searched linearly
+};
+
+
+template<class Matrix>
+void SubstateColumn::extract(const Matrix& p, const char* fieldName)
+{
+    using Cell = std::remove_cvref_t<decltype(p[0][0])>;
+
+    rowsCount = static_cast<int>(p.size());
+    columnsCount = rowsCount > 0 ? static_cast<int>(p[0].size()) : 0;
+    columnValues.resize(static_cast<std::size_t>(rowsCount) * static_cast<std::size_t>(columnsCount));
+
+    if constexpr (NumericSubstatesCell<Cell>)
+    {
+        if (unresolvedSubstateId == substateId)
+            substateId = Cell::substateId(fieldName);
+
+        if (substateId >= 0)
+        {
+            forEachRow(
+                [&](std::size_t row, double* rowValues)
+                {
+                    for (int column = 0; column < columnsCount; ++column)
+                        rowValues[column] = static_cast<double>(p[row][column].substateValue(substateId));
+                });
+            computeTileValueRanges();
+            return;
+        }
+    }
+
+    forEachRow(
+        [&](std::size_t row, double* rowValues)
+        {
+            for (int column = 0; column < columnsCount; ++column)
+                rowValues[column] = parseValue(p[row][column].stringEncoding(fieldName));
+        });
+    computeTileValueRanges();
+}
+
+template<typename Function>
+void SubstateColumn::forEachRow(Function function)
+{
+    const auto rows = static_cast<std::size_t>(rowsCount);
+    const auto tasksCount = (rows + rowsPerTask - 1) / rowsPerTask;
+    ThreadPool::instance().parallelFor(tasksCount,
+                                       [&](std::size_t task)
+                                       {
+                                           const auto lastRow = std::min(rows, (task + 1) * rowsPerTask);
+                                           for (std::size_t row = task * rowsPerTask; row < lastRow; ++row)
+                                               function(row, columnValues.data() + row * static_cast<std::size_t>(columnsCount));
+                                       });
+}
+
+template<class Matrix>
+void SubstateColumns::extract(const Matrix& p, const std::vector<std::string>& fieldNames)
+{
+    std::erase_if(fields,
+                  [&fieldNames](const auto& field)
+                  {
+                      return std::ranges::find(fieldNames, field.first) == fieldNames.end();
+                  });
+
+    for (const auto& fieldName : fieldNames)
+    {
+        auto it = std::ranges::find(fields, fieldName, &std::pair<std::string, SubstateColumn>::first);
+        if (it == fields.end())
+            it = fields.insert(fields.end(), { fieldName, SubstateColumn{} });
+        it->second.extract(p, fieldName.c_str());
+    }
+}
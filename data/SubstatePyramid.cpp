@@ -0,0 +1,241 @@
+/** @file SubstatePyramid.cpp
+ * @brief Implementation of the SubstatePyramid and SubstatePyramids classes. */
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "SubstatePyramid.h"
+
+
+namespace
+{
+constexpr std::array<char, 8> fileMagic{ 'O', 'O', 'C', 'L', 'O', 'D', '0', '1' };
+
+/// @brief Accumulates values of a block
+struct ReductionAccumulator
+{
+    double min = std::numeric_limits<double>::max();
+    double max = std::numeric_limits<double>::lowest();
+    double sum = 0.0;
+    std::uint64_t count = 0;
+
+    void add(double value)
+    {
+        min = std::min(min, value);
+        max = std::max(max, value);
+        sum += value;
+        ++count;
+    }
+
+    void add(const SubstatePyramid::Reduction& reduction)
+    {
+        if (0 == reduction.count)
+            return;
+        min = std::min(min, static_cast<double>(reduction.min));
+        max = std::max(max, static_cast<double>(reduction.max));
+        sum += static_cast<double>(reduction.mean) * reduction.count;
+        count += reduction.count;
+    }
+
+    SubstatePyramid::Reduction result() const
+    {
+        if (0 == count)
+        {
+            constexpr auto notANumber = std::numeric_limits<float>::quiet_NaN();
+            return { notANumber, notANumber, notANumber, 0 };
+        }
+        return { static_cast<float>(min), static_cast<float>(max), static_cast<float>(sum / static_cast<double>(count)), static_cast<std::uint32_t>(count) };
+    }
+};
+
+bool sameSkippedValue(double lhs, double rhs)
+{
+    return (std::isnan(lhs) && std::isnan(rhs)) || lhs == rhs;
+}
+
+template<typename T>
+void writeValue(std::ofstream& file, const T& value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+bool readValue(std::ifstream& file, T& value)
+{
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+} // namespace
+
+
+int SubstatePyramid::levelsCountFor(int columns, int rows)
+{
+    int levelsCount = 0;
+    while (std::max(columns, rows) > largestTopLevelSize)
+    {
+        columns = (columns + 1) / 2;
+        rows = (rows + 1) / 2;
+        ++levelsCount;
+    }
+    return levelsCount;
+}
+
+std::string SubstatePyramid::fileName(const std::string& outputFileName, StepIndex step, std::string_view fieldName)
+{
+    return std::format("{}_lod_{}_{}.lod", outputFileName, fieldName, step);
+}
+
+void SubstatePyramid::build(const SubstateColumn& column, int levelsCount, double skippedValue)
+{
+    resizeLevels(column.columns(), column.rows(), levelsCount);
+    skipped = skippedValue;
+
+    const bool hasSkippedValue = ! std::isnan(skippedValue);
+    for (int level = 1; level <= levels(); ++level)
+    {
+        auto& data = levelsData[level - 1];
+        const auto tasksCount = (static_cast<std::size_t>(data.rows) + rowsPerTask - 1) / rowsPerTask;
+        ThreadPool::instance().parallelFor(tasksCount,
+                                           [&](std::size_t task)
+                                           {
+                                               const int lastRow = std::min(data.rows, static_cast<int>((task + 1) * rowsPerTask));
+                                               for (int row = static_cast<int>(task * rowsPerTask); row < lastRow; ++row)
+                                               {
+                                                   for (int blockColumn = 0; blockColumn < data.columns; ++blockColumn)
+                                                   {
+                                                       ReductionAccumulator accumulator;
+                                                       for (int subRow = 2 * row; subRow < 2 * row + 2; ++subRow)
+                                                       {
+                                                           for (int subColumn = 2 * blockColumn; subColumn < 2 * blockColumn + 2; ++subColumn)
+                                                           {
+                                                               if (1 == level)
+                                                               {
+                                                                   if (! column.contains(subRow, subColumn))
+                                                                       continue;
+                                                                   const double value = column.value(subRow, subColumn);
+                                                                   if (std::isnan(value) || (hasSkippedValue && value == skippedValue))
+                                                                       continue;
+                                                                   accumulator.add(value);
+                                                               }
+                                                               else if (subRow < rows(level - 1) && subColumn < columns(level - 1))
+                                                               {
+                                                                   accumulator.add(reduction(level - 1, subRow, subColumn));
+                                                               }
+                                                           }
+                                                       }
+                                                       data.reductions[static_cast<std::size_t>(row) * static_cast<std::size_t>(data.columns) + static_cast<std::size_t>(blockColumn)] = accumulator.result();
+                                                   }
+                                               }
+                                           });
+    }
+}
+
+bool SubstatePyramid::matches(int columnsOfColumn, int rowsOfColumn, double skippedValue) const
+{
+    return baseColumns == columnsOfColumn && baseRows == rowsOfColumn && sameSkippedValue(skipped, skippedValue);
+}
+
+void SubstatePyramid::save(const std::string& fileName, std::uint64_t sourceStamp) const
+{
+    std::ofstream file(fileName, std::ios::binary | std::ios::trunc);
+    if (! file)
+        throw std::runtime_error(std::format("Can't write levels of detail into '{}'", fileName));
+
+    file.write(fileMagic.data(), fileMagic.size());
+    writeValue(file, sourceStamp);
+    writeValue(file, static_cast<std::int32_t>(baseColumns));
+    writeValue(file, static_cast<std::int32_t>(baseRows));
+    writeValue(file, static_cast<std::int32_t>(levels()));
+    writeValue(file, skipped);
+    for (const auto& level : levelsData)
+        file.write(reinterpret_cast<const char*>(level.reductions.data()), static_cast<std::streamsize>(level.reductions.size() * sizeof(Reduction)));
+
+    if (! file)
+        throw std::runtime_error(std::format("Writing levels of detail into '{}' failed", fileName));
+}
+
+bool SubstatePyramid::load(const std::string& fileName, std::uint64_t sourceStamp, int columnsOfColumn, int rowsOfColumn, int levelsCount, double skippedValue)
+{
+    clear();
+
+    std::ifstream file(fileName, std::ios::binary);
+    if (! file)
+        return false;
+
+    std::array<char, fileMagic.size()> magic{};
+    std::uint64_t stamp = 0;
+    std::int32_t columnsInFile = 0, rowsInFile = 0, levelsInFile = 0;
+    double skippedInFile = 0.0;
+    if (! file.read(magic.data(), magic.size()) || magic != fileMagic || ! readValue(file, stamp) || ! readValue(file, columnsInFile) || ! readValue(file, rowsInFile)
+        || ! readValue(file, levelsInFile) || ! readValue(file, skippedInFile))
+        return false;
+
+    if (stamp != sourceStamp || columnsInFile != columnsOfColumn || rowsInFile != rowsOfColumn || levelsInFile != levelsCount || ! sameSkippedValue(skippedInFile, skippedValue))
+        return false;
+
+    resizeLevels(columnsOfColumn, rowsOfColumn, levelsCount);
+    skipped = skippedValue;
+    for (auto& level : levelsData)
+    {
+        if (! file.read(reinterpret_cast<char*>(level.reductions.data()), static_cast<std::streamsize>(level.reductions.size() * sizeof(Reduction))))
+        {
+            clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+void SubstatePyramid::clear()
+{
+    levelsData.clear();
+    baseColumns = 0;
+    baseRows = 0;
+    skipped = SubstateColumn::notANumber;
+}
+
+void SubstatePyramid::resizeLevels(int columnsOfColumn, int rowsOfColumn, int levelsCount)
+{
+    baseColumns = columnsOfColumn;
+    baseRows = rowsOfColumn;
+    levelsData.resize(static_cast<std::size_t>(std::max(levelsCount, 0)));
+
+    int levelColumns = columnsOfColumn;
+    int levelRows = rowsOfColumn;
+    for (auto& level : levelsData)
+    {
+        levelColumns = (levelColumns + 1) / 2;
+        levelRows = (levelRows + 1) / 2;
+        level.columns = levelColumns;
+        level.rows = levelRows;
+        level.reductions.resize(static_cast<std::size_t>(levelColumns) * static_cast<std::size_t>(levelRows));
+    }
+}
+
+
+SubstatePyramid& SubstatePyramids::pyramid(std::string_view fieldName)
+{
+    auto it = std::ranges::find(fields, fieldName, &std::pair<std::string, SubstatePyramid>::first);
+    if (it == fields.end())
+        it = fields.insert(fields.end(), { std::string(fieldName), SubstatePyramid{} });
+    return it->second;
+}
+
+const SubstatePyramid* SubstatePyramids::find(std::string_view fieldName) const
+{
+    const auto it = std::ranges::find(fields, fieldName, &std::pair<std::string, SubstatePyramid>::first);
+    return it != fields.end() && it->second.levels() > 0 ? &it->second : nullptr;
+}
+
+void SubstatePyramids::keepOnly(const std::vector<std::string>& fieldNames)
+{
+    std::erase_if(fields,
+                  [&fieldNames](const auto& field)
+                  {
+                      return std::ranges::find(fieldNames, field.first) == fieldNames.end();
+                  });
+}
@@ -0,0 +1,131 @@
+/** @file SubstatePyramid.h
+ * @brief Declaration of the SubstatePyramid class - reduced resolutions of values of one substate
+ * and the SubstatePyramids class - pyramids of displayed substates. */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "core/types.h" // StepIndex
+#include "data/SubstateColumns.h"
+
+
+/** @class SubstatePyramid
+ * @brief Levels of detail of one SubstateColumn, each level reduces 2x2 blocks of the previous level into one value.
+ *
+ * Grids much larger than the screen (e.g. 20000x20000 cells) have many cells in one pixel, so colouring every cell
+ * is wasted work. Reduced levels keep minimum, maximum and mean of values of the block, so the view can draw the level
+ * matching on-screen density of cells. Level 0 is the column itself, it is not stored here.
+ * Values which are NaN or equal to the skipped value (enabled noValue of the substate) are not reduced,
+ * so "no data" does not distort means; a block without other values has NaN reduction. */
+class SubstatePyramid
+{
+public:
+    /// @brief Reduced values of one block (float halves memory of levels, the precision is enough for colouring)
+    struct Reduction
+    {
+        float min;
+        float max;
+        float mean;
+        std::uint32_t count; ///< Number of reduced values, 0 if the block has none (other members are NaN then)
+    };
+
+    static constexpr int largestTopLevelSize = 256; ///< Levels are added until both dimensions of the top level fit into it
+
+    /// @return Number of reduced levels needed for the grid (0 for grids fitting into largestTopLevelSize)
+    static int levelsCountFor(int columns, int rows);
+
+    /// @brief Name of the file with levels of the substate of the step (next to data files)
+    static std::string fileName(const std::string& outputFileName, StepIndex step, std::string_view fieldName);
+
+    /** @brief Builds reduced levels of the column, rows of each level are reduced in parallel (memory of previous levels is reused).
+     * @param skippedValue Value which is not reduced (e.g. enabled noValue), NaN if none */
+    void build(const SubstateColumn& column, int levelsCount, double skippedValue);
+
+    /// @return Number of reduced levels (level 0 is the column itself)
+    int levels() const
+    {
+        return static_cast<int>(levelsData.size());
+    }
+
+    /// @param level Reduced level (from 1 to levels())
+    int columns(int level) const
+    {
+        return levelsData[level - 1].columns;
+    }
+
+    /// @param level Reduced level (from 1 to levels())
+    int rows(int level) const
+    {
+        return levelsData[level - 1].rows;
+    }
+
+    /// @return Reduction of cells of the block, block (row, column) of level L covers 2^L x 2^L cells of the column
+    const Reduction& reduction(int level, int row, int column) const
+    {
+        const auto& data = levelsData[level - 1];
+        return data.reductions[static_cast<std::size_t>(row) * static_cast<std::size_t>(data.columns) + static_cast<std::size_t>(column)];
+    }
+
+    /// @return true if the levels were built from a column of these dimensions with the skipped value
+    bool matches(int columnsOfColumn, int rowsOfColumn, double skippedValue) const;
+
+    /** @brief Writes levels into a binary file, so next display of the step does not reduce values again.
+     * @param sourceStamp Identification of data the column was read from (e.g. modification time of data files)
+     * @throws std::runtime_error when the file can't be written */
+    void save(const std::string& fileName, std::uint64_t sourceStamp) const;
+
+    /** @brief Reads levels written by save().
+     * @return false if the file does not exist, it is incomplete or it was written for other data
+     *  (other stamp, dimensions, number of levels or skipped value), the pyramid is cleared then */
+    bool load(const std::string& fileName, std::uint64_t sourceStamp, int columnsOfColumn, int rowsOfColumn, int levelsCount, double skippedValue);
+
+    void clear();
+
+private:
+    static constexpr std::size_t rowsPerTask = 32;
+
+    struct Level
+    {
+        int columns = 0;
+        int rows = 0;
+        std::vector<Reduction> reductions; ///< Row after row
+    };
+
+    /// @brief Sets dimensions of levels (reductions are not initialized)
+    void resizeLevels(int columnsOfColumn, int rowsOfColumn, int levelsCount);
+
+    std::vector<Level> levelsData;
+    int baseColumns = 0; ///< Dimensions of the reduced column
+    int baseRows = 0;
+    double skipped = SubstateColumn::notANumber;
+};
+
+
+/** @class SubstatePyramids
+ * @brief Pyramids of substates of the displayed step (one SubstatePyramid for each field, see SubstateColumns). */
+class SubstatePyramids
+{
+public:
+    /// @brief Pyramid of the field, it is created empty if it does not exist yet
+    SubstatePyramid& pyramid(std::string_view fieldName);
+
+    /// @return Pyramid of the field, nullptr if it does not exist or it has no level
+    const SubstatePyramid* find(std::string_view fieldName) const;
+
+    /// @brief Removes pyramids of fields which are not in the list
+    void keepOnly(const std::vector<std::string>& fieldNames);
+
+    void clear()
+    {
+        fields.clear();
+    }
+
+private:
+    std::vector<std::pair<std::string, SubstatePyramid>> fields; ///< There are only a few substates, so vector is searched linearly
+};
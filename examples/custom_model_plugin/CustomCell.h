@@ -78,6 +78,19 @@ public:
         return std::to_string(value);
     }
 
+    /** Optional: id of substate field used by substateValue() (negative for unknown field).
+     * Providing it together with substateValue() lets the viewer read values without converting strings. */
+    static int substateId(const char* /*fieldName*/)
+    {
+        return 0; // there is only one value, the same as in stringEncoding()
+    }
+
+    /// Optional: numeric value of substate field with the id returned by substateId()
+    double substateValue(int /*substateId*/) const
+    {
+        return value;
+    }
+
     /** Determine the output color based on the cell value
      * Blue (0) -> Cyan -> Green -> Yellow -> Red (255) */
     Color outputValue(const char* /*str*/, GlobalValueManager* /*gvm*/) const override
@@ -32,6 +32,8 @@
 
 #include "mainwindow.h"
 #include "core/CommandLineParser.h"
+#include "core/ThreadPool.h"
+#include "data/DecodedStepCache.hpp"
 #include "plugins/PluginLoader.h"
 
 
@@ -64,6 +66,17 @@ int main(int argc, char* argv[])
         return 1; // Parsing failed
     }
 
+    if (cmdParser.getReaderThreads())
+    {
+        ThreadPool::instance().setThreadCount(cmdParser.getReaderThreads().value());
+    }
+
+    if (cmdParser.getStepCacheMB())
+    {
+        DecodedStepCacheSettings::setBudgetInMegabytes(cmdParser.getStepCacheMB().value());
+    }
+    DecodedStepCacheSettings::setStatisticsReported(cmdParser.shouldReportStepCacheStatistics());
+
     // Load custom model plugins if specified
     for (const auto& modelPath : cmdParser.getLoadModelPaths())
     {
@@ -74,6 +87,7 @@ int main(int argc, char* argv[])
     }
 
     MainWindow mainWindow;
+    mainWindow.setIndexFilesOptions(cmdParser.shouldUseConsolidatedIndex(), cmdParser.shouldRecoverIndexFiles(), cmdParser.shouldCheckStaleIndexFiles());
 
     // Load configuration file or model directory if provided
     if (cmdParser.getConfigFile())
@@ -3,6 +3,7 @@
 #include <filesystem>
 #include <source_location>
 #include <algorithm>
+#include <chrono>
 #include <QCommonStyle>
 #include <QSettings>
 #include <QDebug>
@@ -175,6 +176,8 @@ void MainWindow::setupConnections()
     connect(ui->sceneWidget, &SceneWidget::changedStepNumberWithKeyboardKeys, ui->updatePositionSlider, &QSlider::setValue);
     connect(ui->sceneWidget, &SceneWidget::totalNumberOfStepsReadFromConfigFile, this, &MainWindow::totalStepsNumberChanged);
     connect(ui->sceneWidget, &SceneWidget::availableStepsReadFromConfigFile, this, &MainWindow::availableStepsLoadedFromConfigFile);
+    connect(ui->sceneWidget, &SceneWidget::newStepsAvailable, this, &MainWindow::onNewStepsAvailable);
+    connect(ui->sceneWidget, &SceneWidget::displayedSliceChanged, this, &MainWindow::onDisplayedSliceChanged);
 
     connect(&playbackTimer, &QTimer::timeout, this, &MainWindow::onPlaybackTimerTick);
 }
@@ -192,6 +195,17 @@ void MainWindow::connectMenuActions()
     connect(ui->actionColor_settings, &QAction::triggered, this, &MainWindow::onColorSettingsRequested);
     connect(ui->actionCompilation_settings, &QAction::triggered, this, &MainWindow::onCompilationSettingsRequested);
     connect(ui->actionCellRendering, &QAction::triggered, this, &MainWindow::onCellRenderingToggled);
+    connect(ui->actionTextureRendering, &QAction::triggered, this, &MainWindow::onTextureRenderingToggled);
+    connect(ui->actionLoadVisibleNodesOnly, &QAction::triggered, this, &MainWindow::onLoadVisibleNodesOnlyToggled);
+    connect(ui->actionDetailLevels, &QAction::triggered, this, &MainWindow::onDetailLevelsToggled);
+    connect(ui->actionPersistDetailLevels, &QAction::triggered, this, &MainWindow::onDetailLevelsToggled);
+    connect(ui->actionFollowLiveData, &QAction::triggered, this, &MainWindow::onFollowLiveDataToggled);
+    connect(ui->actionDecodeDisplayedSliceOnly, &QAction::triggered, this, &MainWindow::onDecodeDisplayedSliceOnlyToggled);
+    connect(ui->actionConsolidatedIndex, &QAction::triggered, this, &MainWindow::onIndexFilesOptionsToggled);
+    connect(ui->actionIndexRecovery, &QAction::triggered, this, &MainWindow::onIndexFilesOptionsToggled);
+    connect(ui->actionCheckStaleIndexFiles, &QAction::triggered, this, &MainWindow::onIndexFilesOptionsToggled);
+    connect(ui->actionNextSlice, &QAction::triggered, this, &MainWindow::onNextSliceRequested);
+    connect(ui->actionPreviousSlice, &QAction::triggered, this, &MainWindow::onPreviousSliceRequested);
     connect(ui->actionShow_reduction, &QAction::triggered, this, &MainWindow::onShowReductionRequested);
 
     // View mode actions
@@ -262,6 +276,35 @@ void MainWindow::availableStepsLoadedFromConfigFile(std::vector<StepIndex> avail
     }
 }
 
+void MainWindow::onNewStepsAvailable(std::vector<StepIndex> newSteps)
+{
+    if (newSteps.empty())
+    {
+        return;
+    }
+
+    for (const auto step : newSteps)
+    {
+        const auto it = std::ranges::lower_bound(availableSteps, step);
+        if (it == availableSteps.end() || *it != step)
+            availableSteps.insert(it, step);
+    }
+
+    // The simulation can run longer than the config file says
+    if (newSteps.back() > totalSteps())
+    {
+        totalStepsNumberChanged(newSteps.back());
+    }
+    changeWhichButtonsAreEnabled();
+
+    // Playback is not interrupted, it reaches new steps by itself
+    if (ui->actionJumpToNewestStep->isChecked() && ! playbackTimer.isActive())
+    {
+        currentStep = newSteps.back();
+        setPositionOnWidgets(currentStep);
+    }
+}
+
 void MainWindow::totalStepsNumberChanged(StepIndex totalStepsValue)
 {
     ui->totalStep->setText(QString("/") + QString::number(totalStepsValue));
@@ -450,45 +493,24 @@ void MainWindow::playingRequested(PlayingDirection direction)
 
     // Start timer with interval from sleepSpinBox
     playbackTimer.start(ui->sleepSpinBox->value());
+    prefetchStepsInDirection(playbackDirection);
 }
 
 void MainWindow::onPlaybackTimerTick()
 {
-    // Calculate target step
-    // Note: We need to use signed arithmetic to handle backward direction correctly
-    // to avoid unsigned integer underflow
-    const auto stepsToMove = static_cast<int>(ui->speedSpinBox->value());
-    const auto directionValue = std::to_underlying(playbackDirection);
-    const auto targetStepSigned = static_cast<int>(currentStep) + (stepsToMove * directionValue);
-    
-    // Clamp to valid range and convert back to unsigned
-    const auto clampedStep = static_cast<StepIndex>(
-        std::clamp(targetStepSigned, static_cast<int>(FIRST_STEP_NUMBER), static_cast<int>(totalSteps()))
-    );
-    
-    // Check if we reached the end
-    if ((playbackDirection == PlayingDirection::Forward && clampedStep >= totalSteps())
-        || (playbackDirection == PlayingDirection::Backward && clampedStep <= FIRST_STEP_NUMBER))
+    // Target step is resolved like steps which are prefetched (speed, end of the range, missing steps)
+    const auto nextStep = nextPlaybackStep(currentStep, playbackDirection);
+    if (! nextStep)
     {
         playbackTimer.stop();
         return;
     }
-    
-    // Check if target step exists in available steps
-    if (! std::ranges::contains(availableSteps, clampedStep))
-    {
-        // Handle missing step
-        if (! handleMissingStepDuringPlayback(clampedStep, playbackDirection))
-        {
-            playbackTimer.stop();
-            return;
-        }
-        // If handleMissingStepDuringPlayback returns true, currentStep was updated
-    }
-    else
+
+    if (const auto targetStep = playbackTargetStep(currentStep, playbackDirection); targetStep && *targetStep != *nextStep)
     {
-        currentStep = clampedStep;
+        reportMissingStepDuringPlayback(*targetStep, *nextStep, playbackDirection);
     }
+    currentStep = *nextStep;
 
     // Update UI
     {
@@ -502,6 +524,71 @@ void MainWindow::onPlaybackTimerTick()
 
     // Update timer interval in case sleepSpinBox changed
     playbackTimer.setInterval(ui->sleepSpinBox->value());
+
+    // Next steps are read in background, so the next tick only swaps matrices
+    prefetchStepsInDirection(playbackDirection);
+}
+
+std::optional<StepIndex> MainWindow::playbackTargetStep(StepIndex fromStep, PlayingDirection direction) const
+{
+    // Note: We need to use signed arithmetic to handle backward direction correctly
+    // to avoid unsigned integer underflow
+    const auto stepsToMove = static_cast<int>(ui->speedSpinBox->value());
+    const auto targetStepSigned = static_cast<int>(fromStep) + (stepsToMove * std::to_underlying(direction));
+
+    // Clamp to valid range and convert back to unsigned
+    const auto clampedStep = static_cast<StepIndex>(
+        std::clamp(targetStepSigned, static_cast<int>(FIRST_STEP_NUMBER), static_cast<int>(totalSteps()))
+    );
+
+    // Check if we reached the end
+    if ((direction == PlayingDirection::Forward && clampedStep >= totalSteps())
+        || (direction == PlayingDirection::Backward && clampedStep <= FIRST_STEP_NUMBER))
+    {
+        return std::nullopt;
+    }
+    return clampedStep;
+}
+
+std::optional<StepIndex> MainWindow::nextPlaybackStep(StepIndex fromStep, PlayingDirection direction) const
+{
+    const auto targetStep = playbackTargetStep(fromStep, direction);
+    if (! targetStep)
+    {
+        return std::nullopt;
+    }
+
+    if (std::ranges::contains(availableSteps, *targetStep))
+    {
+        return targetStep;
+    }
+
+    StepIndex nearestStep;
+    if (findNearestAvailableStep(*targetStep, direction, nearestStep))
+    {
+        return nearestStep;
+    }
+    return std::nullopt;
+}
+
+void MainWindow::prefetchStepsInDirection(PlayingDirection direction)
+{
+    const auto frameInterval = std::chrono::milliseconds(ui->sleepSpinBox->value());
+    const auto depth = ui->sceneWidget->recommendedPrefetchDepth(frameInterval);
+
+    std::vector<StepIndex> stepsToPrefetch;
+    auto step = currentStep;
+    while (stepsToPrefetch.size() < depth)
+    {
+        const auto nextStep = nextPlaybackStep(step, direction);
+        if (! nextStep)
+            break;
+
+        stepsToPrefetch.push_back(*nextStep);
+        step = *nextStep;
+    }
+
+    ui->sceneWidget->prefetchSteps(stepsToPrefetch);
 }
 
 bool MainWindow::findNearestAvailableStep(StepIndex targetStep, PlayingDirection direction, StepIndex& outNextStep) const
@@ -540,18 +627,8 @@ bool MainWindow::findNearestAvailableStep(StepIndex targetStep, PlayingDirection
     }
 }
 
-bool MainWindow::handleMissingStepDuringPlayback(StepIndex targetStep, PlayingDirection direction)
+void MainWindow::reportMissingStepDuringPlayback(StepIndex targetStep, StepIndex nextStep, PlayingDirection direction)
 {
-    StepIndex nextStep;
-    
-    // Try to find the nearest available step in the given direction
-    if (! findNearestAvailableStep(targetStep, direction, nextStep))
-    {
-        // No available step in this direction
-        return false;
-    }
-    
-    // In normal mode, ask user what to do
     const QString nextStepText = (direction == PlayingDirection::Forward)
                                      ? tr("next available step is %1").arg(nextStep)
                                      : tr("previous available step is %1").arg(nextStep);
@@ -560,8 +637,6 @@ bool MainWindow::handleMissingStepDuringPlayback(StepIndex targetStep, PlayingDi
               << tr("Step %1 is not available.\nThe %2")
                      .arg(targetStep)
                      .arg(nextStepText).toStdString() << endl;
-    currentStep = nextStep;
-    return true;
 }
 
 void MainWindow::onPlayButtonClicked()
@@ -676,12 +751,14 @@ void MainWindow::onLeftButtonClicked()
 {
     const auto stepsPerClick = static_cast<StepIndex>(ui->speedSpinBox->value());
     navigateToNearestAvailableStep(PlayingDirection::Backward, stepsPerClick);
+    prefetchStepsInDirection(PlayingDirection::Backward);
 }
 
 void MainWindow::onRightButtonClicked()
 {
     const auto stepsPerClick = static_cast<StepIndex>(ui->speedSpinBox->value());
     navigateToNearestAvailableStep(PlayingDirection::Forward, stepsPerClick);
+    prefetchStepsInDirection(PlayingDirection::Forward);
 }
 
 bool MainWindow::setPositionOnWidgets(StepIndex stepPosition, bool updateSlider)
@@ -930,8 +1007,8 @@ void MainWindow::openConfigurationFile(const QString& configFileName, std::share
         // Synchronize flat scene background checkbox with current visibility state
         syncFlatSceneBackgroundCheckbox();
 
-        // Synchronize cell rendering checkbox with current setting
-        syncCellRenderingCheckbox();
+        // Synchronize cell and texture rendering checkboxes with current setting
+        syncGridRenderingCheckboxes();
 
         // Update UI with new configuration
         showInputFilePathOnBarLabel(configFileName);
@@ -981,20 +1058,103 @@ void MainWindow::onCellRenderingToggled(bool checked)
 {
     if (ui->sceneWidget)
     {
-        ui->sceneWidget->setUseCellRendering(checked);
+        ui->sceneWidget->setGridRenderingMode(checked ? GridRenderingMode::Cells : GridRenderingMode::Points);
+        syncGridRenderingCheckboxes(); // cell and texture rendering exclude each other
+        ui->sceneWidget->setViewMode2D(); // this is to refresh visualization
+    }
+}
+
+void MainWindow::onTextureRenderingToggled(bool checked)
+{
+    if (ui->sceneWidget)
+    {
+        ui->sceneWidget->setGridRenderingMode(checked ? GridRenderingMode::Texture : GridRenderingMode::Points);
+        syncGridRenderingCheckboxes();
         ui->sceneWidget->setViewMode2D(); // this is to refresh visualization
     }
 }
 
-void MainWindow::syncCellRenderingCheckbox()
+void MainWindow::syncGridRenderingCheckboxes()
 {
     if (ui->sceneWidget)
     {
-        bool useCellRendering = ui->sceneWidget->getUseCellRendering();
-        ui->actionCellRendering->setChecked(useCellRendering);
+        const GridRenderingMode renderingMode = ui->sceneWidget->getGridRenderingMode();
+        ui->actionCellRendering->setChecked(renderingMode == GridRenderingMode::Cells);
+        ui->actionTextureRendering->setChecked(renderingMode == GridRenderingMode::Texture);
     }
 }
 
+void MainWindow::onLoadVisibleNodesOnlyToggled(bool checked)
+{
+    if (ui->sceneWidget)
+    {
+        ui->sceneWidget->setLoadVisibleNodesOnly(checked);
+    }
+}
+
+void MainWindow::onDetailLevelsToggled()
+{
+    if (ui->sceneWidget)
+    {
+        ui->sceneWidget->setUseDetailLevels(ui->actionDetailLevels->isChecked(), ui->actionPersistDetailLevels->isChecked());
+    }
+}
+
+void MainWindow::onFollowLiveDataToggled(bool checked)
+{
+    if (ui->sceneWidget)
+    {
+        ui->sceneWidget->setFollowLiveData(checked);
+    }
+}
+
+void MainWindow::onDecodeDisplayedSliceOnlyToggled(bool checked)
+{
+    if (ui->sceneWidget)
+    {
+        ui->sceneWidget->setDecodeDisplayedSliceOnly(checked);
+    }
+}
+
+void MainWindow::onIndexFilesOptionsToggled()
+{
+    if (ui->sceneWidget)
+    {
+        ui->sceneWidget->setIndexFilesOptions(ui->actionConsolidatedIndex->isChecked(),
+                                              ui->actionIndexRecovery->isChecked(),
+                                              ui->actionCheckStaleIndexFiles->isChecked());
+    }
+}
+
+void MainWindow::setIndexFilesOptions(bool consolidatedIndex, bool recovery, bool staleCheck)
+{
+    ui->actionConsolidatedIndex->setChecked(consolidatedIndex);
+    ui->actionIndexRecovery->setChecked(recovery);
+    ui->actionCheckStaleIndexFiles->setChecked(staleCheck);
+    onIndexFilesOptionsToggled();
+}
+
+void MainWindow::onNextSliceRequested()
+{
+    if (ui->sceneWidget)
+    {
+        ui->sceneWidget->setDisplayedSlice(ui->sceneWidget->getDisplayedSlice() + 1);
+    }
+}
+
+void MainWindow::onPreviousSliceRequested()
+{
+    if (ui->sceneWidget)
+    {
+        ui->sceneWidget->setDisplayedSlice(ui->sceneWidget->getDisplayedSlice() - 1);
+    }
+}
+
+void MainWindow::onDisplayedSliceChanged(int slice, int slicesCount)
+{
+    ui->statusbar->showMessage(tr("Slice %1 of %2").arg(slice + 1).arg(slicesCount));
+}
+
 void MainWindow::enterNoConfigurationFileMode()
 {
     ui->sceneWidget->setHidden(true);
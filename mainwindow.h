@@ -7,6 +7,7 @@
 #include <QStyle>
 #include <QTimer>
 #include <memory>
+#include <optional>
 #include "core/types.h"
 
 namespace Ui
@@ -37,6 +38,9 @@ public:
     void openConfigurationFile(const QString& configFileName, std::shared_ptr<Config> optionalConfig={});
     void applyCommandLineOptions(const CommandLineParser& cmdParser);
     void loadModelFromDirectory(const QString& modelDirectory, bool forceCompilation=false);
+
+    /// @brief Set reading of index files of nodes (Settings menu), it is used when data are read next time
+    void setIndexFilesOptions(bool consolidatedIndex, bool recovery, bool staleCheck);
     
     /// @brief Load model data using an existing model from the system
     /// @param modelDirectory Directory containing Header.txt and data files
@@ -75,7 +79,16 @@ private slots: // menu actions
     void onColorSettingsRequested();
     void onCompilationSettingsRequested();
     void onCellRenderingToggled(bool checked);
-    void syncCellRenderingCheckbox();
+    void onTextureRenderingToggled(bool checked);
+    void syncGridRenderingCheckboxes();
+    void onLoadVisibleNodesOnlyToggled(bool checked);
+    void onDetailLevelsToggled();
+    void onFollowLiveDataToggled(bool checked);
+    void onDecodeDisplayedSliceOnlyToggled(bool checked);
+    void onIndexFilesOptionsToggled();
+    void onNextSliceRequested();
+    void onPreviousSliceRequested();
+    void onDisplayedSliceChanged(int slice, int slicesCount);
 
     // Help submenu:
     void showAboutThisApplicationDialog();
@@ -106,6 +119,7 @@ private slots: // menu actions
 
     void totalStepsNumberChanged(StepIndex totalStepsValue);
     void availableStepsLoadedFromConfigFile(std::vector<StepIndex> availableSteps);
+    void onNewStepsAvailable(std::vector<StepIndex> newSteps);
 
     void onRecentFileTriggered();
     void onPlaybackTimerTick();
@@ -180,11 +194,11 @@ private:
     void initializeReductionManager(const QString& configFileName, std::shared_ptr<Config> optionalConfig = {});
     void updateReductionDisplay();
 
-    /// @brief Handle missing step during playback
+    /// @brief Report missing step during playback
     /// @param targetStep The step that was attempted but not found
+    /// @param nextStep The nearest available step which is displayed instead
     /// @param direction The playback direction
-    /// @return true if playback should continue, false if it should stop
-    bool handleMissingStepDuringPlayback(StepIndex targetStep, PlayingDirection direction);
+    void reportMissingStepDuringPlayback(StepIndex targetStep, StepIndex nextStep, PlayingDirection direction);
     
     /// @brief Find the nearest available step in the given direction
     /// @param targetStep The target step to search from
@@ -193,6 +207,17 @@ private:
     /// @return true if a step was found in the given direction, false otherwise
     bool findNearestAvailableStep(StepIndex targetStep, PlayingDirection direction, StepIndex& outNextStep) const;
 
+    /// @brief Step which playback targets after the given one (respecting speed), it can be missing
+    /// @return std::nullopt if playback reached the end of steps
+    std::optional<StepIndex> playbackTargetStep(StepIndex fromStep, PlayingDirection direction) const;
+
+    /// @brief Step which playback would display after the given one (respecting speed and missing steps)
+    /// @return std::nullopt if playback would stop
+    std::optional<StepIndex> nextPlaybackStep(StepIndex fromStep, PlayingDirection direction) const;
+
+    /// @brief Requests reading of next steps in the direction in background (number of steps adapts to reading time vs sleepSpinBox interval)
+    void prefetchStepsInDirection(PlayingDirection direction);
+
 private:
     static constexpr int MAX_RECENT_FILES = 10;
     Ui::MainWindow *ui;
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <concepts> // it requires C++20
+#include <cstdint>
 #include <string>
+#include <type_traits>
 #include <OOpenCAL/base/Cell.h>
 
 /// @brief Concept verifying that a type satisfies the Cell interface
@@ -14,3 +16,63 @@ concept CellLike = requires(Cell cell, char* str, const char* cstr, int step, Gl
     { cell.outputValue(cstr, gvm) } -> std::convertible_to<Color>;
     { cell.startStep(step) } -> std::same_as<void>;
 };
+
+/** @brief Concept of a cell, which can be copied byte by byte from binary data files.
+ *
+ * Such cells (plain structures without virtual functions and owned memory, e.g. not derived from Element)
+ * are copied from memory mapped binary files by whole rows and they can be viewed directly in the mapping
+ * (see ModelReader::mappedBinaryCells()). */
+template <typename Cell>
+concept TriviallyCopyableCell = CellLike<Cell> && std::is_trivially_copyable_v<Cell>;
+
+/** @brief Concept of a cell providing numeric values of its substates (optional part of the plugin contract).
+ *
+ * Plugins which do not provide it are read through stringEncoding() converted into number.
+ * Names of substate fields are resolved into ids only once (static substateId(), negative id for unknown field),
+ * then values are read without formatting and parsing of strings:
+ * @code
+ * static int substateId(const char* fieldName);    // e.g. "h" -> 0, "z" -> 1, unknown -> -1
+ * double substateValue(int substateId) const;       // NaN if the cell does not have a value
+ * @endcode */
+template <typename Cell>
+concept NumericSubstatesCell = CellLike<Cell> && requires(const Cell cell, const char* cstr, int substateId)
+{
+    { Cell::substateId(cstr) } -> std::convertible_to<int>;
+    { cell.substateValue(substateId) } -> std::convertible_to<double>;
+};
+
+/// @brief Set of substates (bit substateId is set for every substate, which has to be decoded)
+using SubstatesMask = std::uint64_t;
+inline constexpr SubstatesMask allSubstatesMask = ~SubstatesMask{ 0 };
+
+/** @brief Concept of a cell, which can decode only some of its substates (optional part of the plugin contract).
+ *
+ * Instead of composeElement(str) the viewer calls composeElement(str, mask) with bits of substates
+ * (ids from substateId()), which are displayed (colouring, 3D height, tooltips and substates panel),
+ * other substates can be skipped while parsing and their values are not used until the mask changes.
+ * Substates needed by outputValue(nullptr, gvm) (default colouring) have to be decoded always.
+ * allSubstatesMask is passed when all substates are needed (e.g. id of a displayed substate is unknown or bigger than 63):
+ * @code
+ * static int substateId(const char* fieldName);             // e.g. "h" -> 0, "z" -> 1, unknown -> -1
+ * void composeElement(char* str, SubstatesMask substates); // parse fields with (substates >> id) & 1
+ * @endcode */
+template <typename Cell>
+concept SelectiveDecodingCell = CellLike<Cell> && requires(Cell cell, char* str, const char* cstr, SubstatesMask substates)
+{
+    { Cell::substateId(cstr) } -> std::convertible_to<int>;
+    { cell.composeElement(str, substates) } -> std::same_as<void>;
+};
+
+/** @brief Concept of a cell, whose colouring functions must not be called concurrently (optional part of the plugin contract).
+ *
+ * The viewer colours rows of the grid in parallel, it calls outputValue() (and stringEncoding() of cells without
+ * numeric substates) from several threads at once. A cell, which e.g. caches into a shared buffer, declares it
+ * and its grids are coloured serially:
+ * @code
+ * static constexpr bool threadSafeOutputValue = false;
+ * @endcode */
+template <typename Cell>
+concept SerialColoringCell = CellLike<Cell> && requires
+{
+    { Cell::threadSafeOutputValue } -> std::convertible_to<bool>;
+} && (! Cell::threadSafeOutputValue);
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include "data/CellGrid.hpp"
+#include "data/CellVolume.hpp"
+
+/**
+ * Test Suite: CellGrid
+ *
+ * This test suite verifies contiguous grid of cells, which replaced vector of rows:
+ * - rows are views into one row-major memory block (m[row][column] like with vector of rows),
+ * - cells which are not trivial (they have own memory) are constructed, copied and destroyed properly,
+ * - memory blocks are reused through GridArena when grids are resized or destroyed,
+ * - volumes of 3D models store only a range of slices in one grid.
+ */
+
+// ============================================================================
+// Test 1: Rows are views into one row-major block
+// ============================================================================
+TEST(CellGrid, RowMajorLayout)
+{
+    CellGrid<int> grid(4, 3);
+    ASSERT_EQ(grid.size(), 3u);
+    ASSERT_EQ(grid.columns(), 4);
+    ASSERT_EQ(grid[0].size(), 4u);
+    EXPECT_EQ(grid.stride(), 4u);
+    EXPECT_TRUE(std::ranges::all_of(grid.cells(), [](int cell) { return cell == 0; })); // value-initialized
+
+    for (int row = 0; row < grid.rows(); ++row)
+        for (int column = 0; column < grid.columns(); ++column)
+            grid[row][column] = row * 10 + column;
+
+    EXPECT_EQ(grid.data()[2 * 4 + 1], 21);
+    EXPECT_EQ(&grid[1][0], &grid[0][0] + grid.stride());
+
+    const auto& constGrid = grid;
+    EXPECT_EQ(constGrid[2][3], 23);
+
+    grid.resize(4, 3); // the same dimensions - cells are kept like with vector of rows
+    EXPECT_EQ(grid[2][3], 23);
+
+    grid.resize(2, 2);
+    EXPECT_EQ(grid.cellsCount(), 4u);
+    EXPECT_EQ(grid[1][1], 0);
+
+    grid.resize(0, 5);
+    EXPECT_EQ(grid.cellsCount(), 0u);
+}
+
+// ============================================================================
+// Test 2: Copying and moving grid of non-trivial cells
+// ============================================================================
+TEST(CellGrid, CopyAndMove)
+{
+    CellGrid<std::string> grid(3, 2);
+    grid[1][2] = std::string(100, 'x'); // longer than small string buffer
+
+    CellGrid<std::string> copy = grid;
+    EXPECT_EQ(copy, grid);
+    EXPECT_NE(copy.data(), grid.data());
+
+    copy[1][2] = "changed";
+    EXPECT_EQ(grid[1][2], std::string(100, 'x'));
+
+    CellGrid<std::string> smaller(1, 1);
+    smaller = grid;
+    EXPECT_EQ(smaller, grid);
+
+    const auto* cells = grid.data();
+    CellGrid<std::string> moved = std::move(grid);
+    EXPECT_EQ(moved.data(), cells);
+    EXPECT_TRUE(grid.empty());
+
+    std::swap(moved, copy);
+    EXPECT_EQ(copy[1][2], std::string(100, 'x'));
+    EXPECT_EQ(moved[1][2], "changed");
+}
+
+// ============================================================================
+// Test 3: Memory blocks are reused
+// ============================================================================
+TEST(CellGrid, ArenaReusesBlocks)
+{
+    const std::byte* block = nullptr;
+    {
+        CellGrid<double> grid(300, 200);
+        block = reinterpret_cast<const std::byte*>(grid.data());
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(block) % GridArena::alignment, 0u);
+    }
+
+    CellGrid<double> sameSizeGrid(200, 300); // e.g. model was reloaded
+    EXPECT_EQ(reinterpret_cast<const std::byte*>(sameSizeGrid.data()), block);
+
+    sameSizeGrid.resize(250, 200); // smaller, but the block is still worth keeping
+    EXPECT_EQ(reinterpret_cast<const std::byte*>(sameSizeGrid.data()), block);
+
+    GridArena arena(/*cachedBytesLimit=*/1000);
+    const auto first = arena.acquire(600);
+    arena.release(first);
+    const auto reused = arena.acquire(500);
+    EXPECT_EQ(reused.data, first.data);
+    arena.release(reused);
+
+    const auto small = arena.acquire(100);
+    EXPECT_NE(small.data, first.data); // the released block is too big for small request
+
+    const auto second = arena.acquire(600);
+    arena.release(second);
+    EXPECT_EQ(arena.cachedBytes(), second.capacity); // the oldest released block was freed to keep the limit
+    arena.release(small);
+}
+
+// ============================================================================
+// Test 4: Volume stores only the range of slices, slice after slice
+// ============================================================================
+TEST(CellVolume, StoredSlices)
+{
+    CellVolume<int> volume;
+    volume.resize(/*columns=*/3, /*rows=*/2, /*slices=*/5, SliceRange{ .first = 3, .end = 9 });
+    EXPECT_EQ(volume.slices(), 5);
+    EXPECT_EQ(volume.storedSlices(), (SliceRange{ .first = 3, .end = 5 })); // clamped to slices of the volume
+    ASSERT_EQ(volume.size(), 4u);                                          // rows of stored slices
+    EXPECT_EQ(volume.rowIndex(4, 1), 3u);
+
+    for (int slice = 3; slice < 5; ++slice)
+        for (int row = 0; row < volume.rows(); ++row)
+            for (int column = 0; column < volume.columns(); ++column)
+                volume(column, row, slice) = 100 * slice + 10 * row + column;
+    EXPECT_EQ(volume[3][2], 412);
+
+    const auto slice = volume.slice(4);
+    ASSERT_EQ(slice.size(), 2u);
+    EXPECT_EQ(slice[1][2], 412);
+
+    CellGrid<int> matrix;
+    volume.copySliceInto(3, matrix);
+    ASSERT_EQ(matrix.columns(), 3);
+    ASSERT_EQ(matrix.rows(), 2);
+    EXPECT_EQ(matrix[0][0], 300);
+    EXPECT_EQ(matrix[1][1], 311);
+
+    volume.resize(3, 2, 5, SliceRange{ .first = 0, .end = 5 });
+    EXPECT_EQ(volume.size(), 10u);
+    EXPECT_EQ(volume(2, 1, 4), 0); // value-initialized when the number of cells changes
+}
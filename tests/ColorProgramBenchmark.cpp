@@ -0,0 +1,204 @@
+/** @file ColorProgramBenchmark.cpp
+ * @brief Microbenchmark of ColorProgram against the original colouring of cells (Visualizer::calculateCellColor).
+ *
+ * Usage: ColorProgramBenchmark [columns=2000] [rows=2000]
+ *
+ * Cells have values of two substates, half of them is noValue (like flow simulations far from the flow).
+ * Every variant colors all cells on one thread (values are read from SubstateColumn in both cases)
+ * and the benchmark reports cells per second. The original way sorted substates and parsed hex colors
+ * for every cell, the compiled program does it once for the grid. */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <exception>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "data/CellGrid.hpp"
+#include "data/SubstateColumns.h"
+#include "visualiser/ColorProgram.h"
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+constexpr double noValue = -9999.0;
+
+struct BenchmarkCell
+{
+    double h = 0.0;
+    double z = 0.0;
+
+    void composeElement(char*) {}
+    std::string stringEncoding(const char* fieldName) const { return std::to_string(std::string(fieldName) == "h" ? h : z); }
+    Color outputValue(const char*, GlobalValueManager*) const { return Color(128, 128, 128); }
+    void startStep(int) {}
+
+    static int substateId(const char* fieldName)
+    {
+        return std::string(fieldName) == "h" ? 0 : 1;
+    }
+
+    double substateValue(int substateId) const
+    {
+        return 0 == substateId ? h : z;
+    }
+};
+
+CellGrid<BenchmarkCell> generateMatrix(int columns, int rows)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> distribution(-10., 110.);
+    std::bernoulli_distribution isNoValue(0.5);
+
+    CellGrid<BenchmarkCell> matrix(columns, rows);
+    for (int row = 0; row < rows; ++row)
+    {
+        for (auto& cell : matrix[row])
+        {
+            cell.h = isNoValue(generator) ? noValue : distribution(generator);
+            cell.z = distribution(generator);
+        }
+    }
+    return matrix;
+}
+
+/// Original Visualizer::calculateGradientColor()
+std::optional<Color> originalGradientColor(double value, const SubstateInfo& substateInfo)
+{
+    if (std::isnan(value))
+        return std::nullopt;
+
+    try
+    {
+        double minVal = substateInfo.minValue;
+        double maxVal = substateInfo.maxValue;
+        if (std::isnan(minVal) || std::isnan(maxVal))
+            return std::nullopt;
+        else if (SubstateColumn::isNoValue(value, substateInfo.noValueEnabled, substateInfo.noValue))
+            return std::nullopt;
+        else if (value <= minVal || value >= maxVal)
+            return std::nullopt;
+
+        double normalized = (value - minVal) / (maxVal - minVal);
+
+        auto parseHexColor = [](const std::string& hex) -> std::tuple<int, int, int> {
+            if (hex.length() != 7 || hex[0] != '#')
+                return {0, 0, 0};
+            int r = std::stoi(hex.substr(1, 2), nullptr, 16);
+            int g = std::stoi(hex.substr(3, 2), nullptr, 16);
+            int b = std::stoi(hex.substr(5, 2), nullptr, 16);
+            return {r, g, b};
+        };
+
+        auto [minR, minG, minB] = parseHexColor(substateInfo.minColor);
+        auto [maxR, maxG, maxB] = parseHexColor(substateInfo.maxColor);
+
+        int r = static_cast<int>(minR + (maxR - minR) * normalized);
+        int g = static_cast<int>(minG + (maxG - minG) * normalized);
+        int b = static_cast<int>(minB + (maxB - minB) * normalized);
+        return Color(static_cast<std::uint8_t>(r), static_cast<std::uint8_t>(g), static_cast<std::uint8_t>(b), 255);
+    }
+    catch (const std::exception&)
+    {
+        return std::nullopt;
+    }
+}
+
+/// Original Visualizer::calculateCellColor() for substates with custom colors
+Color originalCellColor(int row, int column, const std::vector<const SubstateInfo*>& colorSubstateInfos, const std::function<const SubstateColumn*(const SubstateInfo&)>& findColumn, const Color& background)
+{
+    auto colorSubstateInfosSorted = colorSubstateInfos;
+    std::ranges::sort(colorSubstateInfosSorted);
+
+    for (const auto colorSubstateInfo : colorSubstateInfosSorted)
+    {
+        const double value = findColumn(*colorSubstateInfo)->value(row, column);
+        if (auto optionalColor = originalGradientColor(value, *colorSubstateInfo))
+            return *optionalColor;
+    }
+    return background;
+}
+
+/// Colors all cells several times, returns best cells/s
+double measure(int columns, int rows, const std::function<Color(int, int)>& cellColor, unsigned& checksum)
+{
+    constexpr int repetitions = 3;
+
+    double bestSeconds = 1e100;
+    for (int repetition = 0; repetition < repetitions; ++repetition)
+    {
+        const auto start = Clock::now();
+        for (int row = 0; row < rows; ++row)
+        {
+            for (int column = 0; column < columns; ++column)
+                {
+                const Color color = cellColor(row, column);
+                checksum += color.getRed() + color.getGreen() + color.getBlue();
+            }
+        }
+        const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+        bestSeconds = std::min(bestSeconds, elapsed.count());
+    }
+    return static_cast<double>(columns) * rows / bestSeconds;
+}
+
+void runTable(const std::string& title, const CellGrid<BenchmarkCell>& matrix, const SubstateColumns& substateColumns, const std::vector<const SubstateInfo*>& colorSubstateInfos)
+{
+    const int columns = matrix.columns();
+    const int rows = matrix.rows();
+    const Color background(0, 0, 0);
+    const auto findColumn = [&](const SubstateInfo& substateInfo) { return substateColumns.find(substateInfo.name, matrix); };
+    unsigned checksum = 0;
+
+    std::cout << title << '\n';
+
+    const double baseline = measure(columns, rows, [&](int row, int column) { return originalCellColor(row, column, colorSubstateInfos, findColumn, background); }, checksum);
+    std::cout << std::format("  {:<36} {:>10.1f} Mcells/s\n", "original (sort + parse per cell)", baseline / 1e6);
+
+    const ColorProgram colorProgram(colorSubstateInfos, background, findColumn);
+    const double cellsPerSecond = measure(columns, rows, [&](int row, int column) { return colorProgram.cellColor(row, column, matrix, nullptr); }, checksum);
+    std::cout << std::format("  {:<36} {:>10.1f} Mcells/s  (x{:.2f})\n", "ColorProgram (compiled once)", cellsPerSecond / 1e6, cellsPerSecond / baseline);
+    std::cout << "  (checksum " << checksum << ")\n" << std::endl;
+}
+
+SubstateInfo gradientInfo(const std::string& name, const std::string& minColor, const std::string& maxColor)
+{
+    SubstateInfo info;
+    info.name = name;
+    info.minValue = 0.0;
+    info.maxValue = 100.0;
+    info.noValue = noValue;
+    info.noValueEnabled = true;
+    info.minColor = minColor;
+    info.maxColor = maxColor;
+    return info;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const int columns = argc > 1 ? std::stoi(argv[1]) : 2'000;
+    const int rows = argc > 2 ? std::stoi(argv[2]) : 2'000;
+
+    std::cout << std::format("Grid: {} x {} cells, colored on one thread\n\n", columns, rows);
+
+    const auto matrix = generateMatrix(columns, rows);
+    SubstateColumns substateColumns;
+    substateColumns.extract(matrix, { "h", "z" });
+
+    const auto h = gradientInfo("h", "#000011", "#0011ff");
+    const auto z = gradientInfo("z", "#110000", "#ff1100");
+
+    runTable("One substate with custom colors:", matrix, substateColumns, { &h });
+    runTable("Two substates with custom colors:", matrix, substateColumns, { &h, &z });
+}
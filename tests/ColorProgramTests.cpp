@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+#include "data/CellGrid.hpp"
+#include "data/SubstateColumns.h"
+#include "data/SubstatePyramid.h"
+#include "visualiser/ColorProgram.h"
+
+/**
+ * Test Suite: ColorProgram
+ *
+ * This test suite verifies colouring of cells compiled once for the whole grid:
+ * - gradients of substates with custom colors color only values in the open interval (minValue, maxValue)
+ *   which are not enabled noValue, their ends have minColor and maxColor,
+ * - substates which can not color any value (no minValue, colors with not hex digits) are left out,
+ * - substates are tried by their display order (substates without order after them), the first color wins,
+ *   coloring by outputValue() colors every cell,
+ *   cells without color get the background color,
+ * - values are read from substate columns when they are available, blocks of levels of detail use means of blocks.
+ */
+
+namespace
+{
+/// Cell with value of field "h" (also in text), outputValue() encodes the field name into the red channel
+struct ValueCell
+{
+    double value = 0.0;
+
+    void composeElement(char*) {}
+    std::string stringEncoding(const char*) const { return std::to_string(value); }
+    Color outputValue(const char* fieldName, GlobalValueManager*) const
+    {
+        return Color(fieldName ? 200 : 100, 0, 0);
+    }
+    void startStep(int) {}
+};
+
+CellGrid<ValueCell> makeMatrix(int columns, int rows)
+{
+    CellGrid<ValueCell> matrix(columns, rows);
+    for (int row = 0; row < rows; ++row)
+        for (int column = 0; column < columns; ++column)
+            matrix[row][column].value = row * columns + column;
+    return matrix;
+}
+
+SubstateInfo gradientInfo(std::string name, double minValue, double maxValue, std::string minColor = "#000000", std::string maxColor = "#ff8000")
+{
+    SubstateInfo info;
+    info.name = std::move(name);
+    info.minValue = minValue;
+    info.maxValue = maxValue;
+    info.minColor = std::move(minColor);
+    info.maxColor = std::move(maxColor);
+    return info;
+}
+
+void expectColor(const Color& color, int red, int green, int blue)
+{
+    EXPECT_EQ(color.getRed(), red);
+    EXPECT_EQ(color.getGreen(), green);
+    EXPECT_EQ(color.getBlue(), blue);
+}
+
+const Color background(7, 7, 7);
+} // namespace
+
+// ============================================================================
+// Test 1: Gradient of a substate
+// ============================================================================
+TEST(ColorProgram, Gradient)
+{
+    auto info = gradientInfo("h", 0.0, 10.0);
+    info.noValue = 5.0;
+
+    auto gradient = ColorProgram::Gradient::compile(info);
+    ASSERT_TRUE(gradient.has_value());
+    ASSERT_NE(gradient->colorOf(1e-9), nullptr);
+    expectColor(*gradient->colorOf(1e-9), 0, 0, 0);
+    expectColor(*gradient->colorOf(10.0 - 1e-9), 255, 128, 0);
+    expectColor(*gradient->colorOf(5.0), 128, 64, 0); // noValue is disabled
+
+    EXPECT_EQ(gradient->colorOf(0.0), nullptr); // the interval is open
+    EXPECT_EQ(gradient->colorOf(10.0), nullptr);
+    EXPECT_EQ(gradient->colorOf(-1.0), nullptr);
+    EXPECT_EQ(gradient->colorOf(std::numeric_limits<double>::quiet_NaN()), nullptr);
+
+    info.noValueEnabled = true;
+    gradient = ColorProgram::Gradient::compile(info);
+    EXPECT_EQ(gradient->colorOf(5.0), nullptr);
+    EXPECT_NE(gradient->colorOf(5.5), nullptr);
+
+    EXPECT_EQ(ColorProgram::Gradient::compile(gradientInfo("h", 10.0, 10.0))->colorOf(10.0), nullptr);
+}
+
+// ============================================================================
+// Test 2: Substates which can not color any value
+// ============================================================================
+TEST(ColorProgram, InvalidGradients)
+{
+    EXPECT_FALSE(ColorProgram::Gradient::compile(gradientInfo("h", std::numeric_limits<double>::quiet_NaN(), 10.0)).has_value());
+    EXPECT_FALSE(ColorProgram::Gradient::compile(gradientInfo("h", 0.0, 10.0, "#zz0000")).has_value());
+
+    const auto blackGradient = ColorProgram::Gradient::compile(gradientInfo("h", 0.0, 10.0, "red", "#00"));
+    ASSERT_TRUE(blackGradient.has_value()); // colors of other formats are black
+    expectColor(*blackGradient->colorOf(9.0), 0, 0, 0);
+
+    // the layer is left out, so the default coloring of the next layer is used
+    const auto matrix = makeMatrix(2, 2);
+    const auto invalid = gradientInfo("h", std::numeric_limits<double>::quiet_NaN(), 10.0);
+    SubstateInfo plain;
+    plain.name = "z";
+    std::vector<const SubstateInfo*> infos{ &invalid, &plain };
+    const ColorProgram program(infos, background);
+    expectColor(program.cellColor(0, 1, matrix, nullptr), 200, 0, 0);
+}
+
+// ============================================================================
+// Test 3: Layers, default coloring and background
+// ============================================================================
+TEST(ColorProgram, Layers)
+{
+    const auto matrix = makeMatrix(4, 4); // values 0..15
+
+    const ColorProgram defaultColoring({}, background);
+    expectColor(defaultColoring.cellColor(2, 2, matrix, nullptr), 100, 0, 0);
+
+    const std::vector<const SubstateInfo*> nullInfo{ nullptr };
+    expectColor(ColorProgram(nullInfo, background).cellColor(2, 2, matrix, nullptr), 100, 0, 0);
+
+    // layers are sorted by display order, so the order of the vector does not matter
+    std::vector<SubstateInfo> infos{ gradientInfo("low", 0.0, 8.0, "#000000", "#0000ff"), gradientInfo("high", 4.0, 16.0, "#000000", "#00ff00") };
+    infos[0].order = 0;
+    infos[1].order = 1;
+    const std::vector<const SubstateInfo*> forward{ &infos[0], &infos[1] };
+    const std::vector<const SubstateInfo*> backward{ &infos[1], &infos[0] };
+    const ColorProgram program(forward, background);
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            const auto color = program.cellColor(row, column, matrix, nullptr);
+            EXPECT_EQ(color.getBlue(), ColorProgram(backward, background).cellColor(row, column, matrix, nullptr).getBlue());
+        }
+    }
+    expectColor(program.cellColor(1, 2, matrix, nullptr), 0, 0, 191); // 6 is colored by the first layer
+    expectColor(program.cellColor(3, 0, matrix, nullptr), 0, 170, 0);  // 12 by the second one
+    expectColor(program.cellColor(0, 0, matrix, nullptr), 7, 7, 7);    // 0 by none
+}
+
+// ============================================================================
+// Test 4: Values from columns and blocks from levels of detail
+// ============================================================================
+TEST(ColorProgram, ColumnsAndBlocks)
+{
+    const auto matrix = makeMatrix(4, 4);
+    SubstateColumns columns;
+    columns.extract(matrix, { "h" });
+    const SubstateColumn* column = columns.find("h");
+    ASSERT_NE(column, nullptr);
+
+    SubstatePyramid pyramid;
+    pyramid.build(*column, /*levelsCount=*/1, SubstateColumn::notANumber);
+
+    const auto info = gradientInfo("h", 0.0, 15.0, "#000000", "#ff0000");
+    const std::vector<const SubstateInfo*> infos{ &info };
+    const ColorProgram program(
+        infos,
+        background,
+        [&](const SubstateInfo&) { return column; },
+        [&](const SubstateInfo&) { return &pyramid; });
+
+    // cell values: 5 from the column
+    expectColor(program.cellColor(1, 1, matrix, nullptr), 85, 0, 0);
+
+    // the block (1, 1) has cells 10, 11, 14, 15 with mean 12.5, the first cell 10 would be red 170
+    expectColor(program.blockColor(1, 1, 1, matrix, nullptr), 213, 0, 0);
+    // the block (0, 0) has mean 2.5 (the first cell is 0, out of the range)
+    expectColor(program.blockColor(1, 0, 0, matrix, nullptr), 43, 0, 0);
+}
+
+// ============================================================================
+// Test 5: Precedence of layers by display order
+// ============================================================================
+TEST(ColorProgram, LayerPrecedence)
+{
+    const auto matrix = makeMatrix(4, 4); // values 0..15
+
+    SubstateInfo low = gradientInfo("low", 0.0, 8.0, "#000000", "#0000ff");
+    SubstateInfo high = gradientInfo("high", 4.0, 16.0, "#000000", "#00ff00");
+    high.order = 1;
+
+    // high has order, low has not, nullptr (outputValue()) is the last one regardless of positions in the vector
+    const std::vector<const SubstateInfo*> infos{ nullptr, &low, &high };
+    const ColorProgram program(infos, background);
+    expectColor(program.cellColor(1, 2, matrix, nullptr), 0, 43, 0);  // 6 is colored by high
+    expectColor(program.cellColor(0, 2, matrix, nullptr), 0, 0, 64);  // 2 by low
+    expectColor(program.cellColor(0, 0, matrix, nullptr), 100, 0, 0); // 0 by outputValue()
+
+    // lower order wins
+    low.order = 0;
+    const ColorProgram reordered(infos, background);
+    expectColor(reordered.cellColor(1, 2, matrix, nullptr), 0, 0, 191); // 6 is colored by low
+    expectColor(reordered.cellColor(3, 0, matrix, nullptr), 0, 170, 0); // 12 by high
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include "data/CellGrid.hpp"
+#include "data/DecodedStepCache.hpp"
+
+/**
+ * Test Suite: DecodedStepCache
+ *
+ * This test suite verifies the cache of recently displayed steps:
+ * - cached step is copied back (matrix and lines) and counted as hit,
+ * - steps are distinguished by model and step number,
+ * - the least recently used steps are evicted when memory budget is exceeded,
+ * - steps cached with different dimensions are not returned.
+ */
+
+namespace
+{
+using Matrix = CellGrid<int>;
+
+constexpr std::size_t rows = 10;
+constexpr std::size_t columns = 10;
+
+Matrix matrixOfStep(StepIndex step)
+{
+    Matrix matrix(columns, rows);
+    std::ranges::fill(matrix.cells(), static_cast<int>(step));
+    return matrix;
+}
+
+std::size_t bytesOfOneStep()
+{
+    return DecodedStepCache<Matrix>::estimatedBytes(matrixOfStep(0), /*linesCount=*/1);
+}
+} // namespace
+
+// ============================================================================
+// Test 1: Cached step is returned, counters are updated
+// ============================================================================
+TEST(DecodedStepCache, HitAndMiss)
+{
+    DecodedStepCache<Matrix> cache(10 * bytesOfOneStep());
+
+    const Line line(1, 2, 3, 4);
+    cache.put("Ball", 5, matrixOfStep(5), &line, 1);
+
+    Matrix matrix = matrixOfStep(0);
+    Line readLine;
+    EXPECT_TRUE(cache.get("Ball", 5, matrix, &readLine, 1));
+    EXPECT_EQ(matrix, matrixOfStep(5));
+    EXPECT_EQ(readLine.x2, 3);
+
+    EXPECT_FALSE(cache.get("Ball", 6, matrix, &readLine, 1));
+    EXPECT_FALSE(cache.get("Sciddica", 5, matrix, &readLine, 1));
+
+    const auto statistics = cache.statistics();
+    EXPECT_EQ(statistics.hits, 1u);
+    EXPECT_EQ(statistics.misses, 2u);
+    EXPECT_EQ(statistics.steps, 1u);
+    EXPECT_EQ(statistics.usedBytes, bytesOfOneStep());
+}
+
+// ============================================================================
+// Test 2: Least recently used steps are evicted to keep the budget
+// ============================================================================
+TEST(DecodedStepCache, EvictsLeastRecentlyUsed)
+{
+    DecodedStepCache<Matrix> cache(3 * bytesOfOneStep());
+    const Line line;
+    Matrix matrix = matrixOfStep(0);
+    Line readLine;
+
+    for (const StepIndex step : { 1u, 2u, 3u })
+        cache.put("Ball", step, matrixOfStep(step), &line, 1);
+
+    EXPECT_TRUE(cache.get("Ball", 1, matrix, &readLine, 1)); // step 2 becomes least recently used
+    cache.put("Ball", 4, matrixOfStep(4), &line, 1);
+
+    EXPECT_TRUE(cache.contains("Ball", 1));
+    EXPECT_FALSE(cache.contains("Ball", 2));
+    EXPECT_TRUE(cache.contains("Ball", 3));
+    EXPECT_TRUE(cache.contains("Ball", 4));
+    EXPECT_LE(cache.statistics().usedBytes, cache.budgetBytes());
+}
+
+// ============================================================================
+// Test 3: Steps bigger than the budget and steps of different dimensions
+// ============================================================================
+TEST(DecodedStepCache, BudgetAndDimensions)
+{
+    const Line line;
+    Line readLine;
+
+    DecodedStepCache<Matrix> disabledCache(0);
+    disabledCache.put("Ball", 1, matrixOfStep(1), &line, 1);
+    EXPECT_FALSE(disabledCache.contains("Ball", 1));
+
+    DecodedStepCache<Matrix> cache(10 * bytesOfOneStep());
+    cache.put("Ball", 1, matrixOfStep(1), &line, 1);
+
+    Matrix smallerMatrix(columns, rows - 1);
+    EXPECT_FALSE(cache.get("Ball", 1, smallerMatrix, &readLine, 1));
+    EXPECT_FALSE(cache.contains("Ball", 1));
+    EXPECT_EQ(cache.statistics().usedBytes, 0u);
+}
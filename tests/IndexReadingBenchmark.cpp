@@ -0,0 +1,107 @@
+/** @file IndexReadingBenchmark.cpp
+ * @brief Microbenchmark of opening a dataset - reading index files of all nodes (ModelReader::readStepsOffsetsForAllNodesFromFiles).
+ *
+ * Usage: IndexReadingBenchmark [nodes=16] [steps=100000]
+ *
+ * Index files in extended format are generated into a temporary directory, then the benchmark reports index entries per second
+ * of parsing text index files (in parallel) and of mapping the consolidated index written by the first opening. */
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+
+#include "data/ModelReader.hpp"
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+struct BenchmarkCell
+{
+    void composeElement(char*) {}
+    std::string stringEncoding(const char*) const { return {}; }
+    Color outputValue(const char*, GlobalValueManager*) const { return Color(); }
+    void startStep(int) {}
+};
+
+void generateIndexFiles(const std::string& fileName, NodeIndex nodes, std::size_t steps)
+{
+    for (NodeIndex node = 0; node < nodes; ++node)
+    {
+        std::ofstream index(ReaderHelpers::giveMeFileNameIndex(fileName, node));
+        for (std::size_t step = 0; step < steps; ++step)
+            index << step << ' ' << step * 2'000'000 << " (250-500)\n";
+    }
+}
+
+/// Opens the dataset several times, returns the best time in seconds
+double measure(const std::function<void()>& open)
+{
+    constexpr int repetitions = 5;
+
+    double bestSeconds = 1e100;
+    for (int repetition = 0; repetition < repetitions; ++repetition)
+    {
+        const auto start = Clock::now();
+        open();
+        const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+        bestSeconds = std::min(bestSeconds, elapsed.count());
+    }
+    return bestSeconds;
+}
+
+void report(const std::string& title, std::size_t entries, double seconds)
+{
+    std::cout << std::format("  {:<36} {:>10.3f} ms {:>10.1f} Mentries/s\n", title, seconds * 1e3, static_cast<double>(entries) / seconds / 1e6);
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const auto nodes = static_cast<NodeIndex>(argc > 1 ? std::stoul(argv[1]) : 16);
+    const std::size_t steps = argc > 2 ? std::stoul(argv[2]) : 100'000;
+    const std::size_t entries = static_cast<std::size_t>(nodes) * steps;
+
+    const auto directory = std::filesystem::temp_directory_path() / "IndexReadingBenchmark";
+    std::filesystem::create_directories(directory);
+    const auto fileName = (directory / "benchmark").string();
+    generateIndexFiles(fileName, nodes, steps);
+
+    std::cout << std::format("Index files: {} nodes x {} steps, {} reader threads\n", nodes, steps, ThreadPool::instance().threadCount());
+
+    ModelReader<BenchmarkCell> reader;
+    reader.setIndexRecoveryEnabled(false); // there are no data files
+
+    reader.setConsolidatedIndexEnabled(false);
+    report("Parsing text index files",
+           entries,
+           measure([&]
+                   {
+                       reader.readStepsOffsetsForAllNodesFromFiles(nodes, 1, 1, fileName);
+                       reader.clearStage();
+                   }));
+
+    reader.setConsolidatedIndexEnabled(true);
+    std::filesystem::remove(ReaderHelpers::giveMeConsolidatedIndexFileName(fileName));
+    const auto start = Clock::now();
+    reader.readStepsOffsetsForAllNodesFromFiles(nodes, 1, 1, fileName);
+    const std::chrono::duration<double> firstOpening = Clock::now() - start;
+    reader.clearStage();
+    report("Parsing and writing consolidated index", entries, firstOpening.count());
+
+    report("Mapping consolidated index",
+           entries,
+           measure([&]
+                   {
+                       reader.readStepsOffsetsForAllNodesFromFiles(nodes, 1, 1, fileName);
+                       reader.clearStage();
+                   }));
+
+    std::filesystem::remove_all(directory);
+}
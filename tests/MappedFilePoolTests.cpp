@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include "data/MappedFilePool.h"
+
+/**
+ * Test Suite: MappedFilePool
+ *
+ * This test suite verifies the pool of memory mapped data files used by ModelReader:
+ * - the same file is mapped only once and reused,
+ * - least recently used mappings are evicted when capacity is exceeded,
+ * - mapping which is still used stays valid after eviction,
+ * - file which grew is mapped again when bigger size is required.
+ */
+
+namespace
+{
+class MappedFilePoolTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        directory = std::filesystem::temp_directory_path() / ("MappedFilePoolTest_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+        std::filesystem::create_directories(directory);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(directory);
+    }
+
+    std::string writeFile(const std::string& name, const std::string& content, bool append = false)
+    {
+        const auto path = (directory / name).string();
+        std::ofstream file(path, append ? std::ios::app : std::ios::trunc);
+        file << content;
+        return path;
+    }
+
+    std::filesystem::path directory;
+};
+} // namespace
+
+// ============================================================================
+// Test 1: The same file is mapped once
+// ============================================================================
+TEST_F(MappedFilePoolTest, ReusesMapping)
+{
+    MappedFilePool pool(4);
+    const auto path = writeFile("node0.txt", "3-1\n1 2 3\n");
+
+    const auto first = pool.acquire(path);
+    const auto second = pool.acquire(path);
+
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(pool.size(), 1u);
+    EXPECT_EQ(std::string(first->data(), first->size()), "3-1\n1 2 3\n");
+}
+
+// ============================================================================
+// Test 2: Least recently used mapping is evicted, but stays valid for its user
+// ============================================================================
+TEST_F(MappedFilePoolTest, EvictsLeastRecentlyUsed)
+{
+    MappedFilePool pool(2);
+    const auto path0 = writeFile("node0.txt", "node0");
+    const auto path1 = writeFile("node1.txt", "node1");
+    const auto path2 = writeFile("node2.txt", "node2");
+
+    const auto mapping0 = pool.acquire(path0);
+    const auto mapping1 = pool.acquire(path1);
+    pool.acquire(path0); // node1 is now least recently used
+    pool.acquire(path2);
+
+    EXPECT_EQ(pool.size(), 2u);
+    EXPECT_EQ(pool.acquire(path0), mapping0);     // still in the pool
+    EXPECT_NE(pool.acquire(path1), mapping1);     // was evicted, mapped again
+    EXPECT_EQ(std::string(mapping1->data(), mapping1->size()), "node1"); // evicted mapping is still valid
+}
+
+// ============================================================================
+// Test 3: Growing file is mapped again when bigger size is required
+// ============================================================================
+TEST_F(MappedFilePoolTest, RemapsGrowingFile)
+{
+    MappedFilePool pool(4);
+    const auto path = writeFile("node0.txt", "1-1\n0\n");
+
+    const auto before = pool.acquire(path);
+    writeFile("node0.txt", "1-1\n1\n", /*append=*/true);
+
+    EXPECT_EQ(pool.acquire(path, before->size()), before); // already big enough
+    const auto after = pool.acquire(path, before->size() + 1);
+
+    EXPECT_EQ(after->size(), 2 * before->size());
+    EXPECT_EQ(std::string(before->data(), before->size()), "1-1\n0\n");
+}
+
+// ============================================================================
+// Test 4: Default capacity is bounded
+// ============================================================================
+TEST(MappedFilePool, DefaultCapacityIsBounded)
+{
+    const auto capacity = MappedFilePool::defaultCapacity();
+    EXPECT_GE(capacity, 16u);
+    EXPECT_LE(capacity, 8192u);
+}
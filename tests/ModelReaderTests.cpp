@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
 #include <vector>
 #include "core/types.h"
 #include "data/ModelReader.hpp"
@@ -496,3 +499,702 @@ TEST(CalculateXYOffsetForNode, ThreeByTwo_600x400)
     EXPECT_EQ(offset5.x(), 400);
     EXPECT_EQ(offset5.y(), 200);
 }
+
+// ============================================================================
+// Test 13: Periods between load balancing steps (dimensions of nodes are reused inside of a period)
+// ============================================================================
+TEST(LoadBalancingPeriod, FirstLB100_StepLB50)
+{
+    EXPECT_EQ(ReaderHelpers::loadBalancingPeriod(/*step=*/0, /*firstLB=*/100, /*stepLB=*/50), 0);
+    EXPECT_EQ(ReaderHelpers::loadBalancingPeriod(/*step=*/99, /*firstLB=*/100, /*stepLB=*/50), 0);
+    EXPECT_EQ(ReaderHelpers::loadBalancingPeriod(/*step=*/101, /*firstLB=*/100, /*stepLB=*/50), 1);
+    EXPECT_EQ(ReaderHelpers::loadBalancingPeriod(/*step=*/149, /*firstLB=*/100, /*stepLB=*/50), 1);
+    EXPECT_EQ(ReaderHelpers::loadBalancingPeriod(/*step=*/151, /*firstLB=*/100, /*stepLB=*/50), 2);
+
+    // load balancing steps themselves belong to no period
+    EXPECT_FALSE(ReaderHelpers::loadBalancingPeriod(/*step=*/100, /*firstLB=*/100, /*stepLB=*/50).has_value());
+    EXPECT_FALSE(ReaderHelpers::loadBalancingPeriod(/*step=*/150, /*firstLB=*/100, /*stepLB=*/50).has_value());
+}
+
+// ============================================================================
+// Test 14: Unknown load balancing settings - no period, dimensions have to be read
+// ============================================================================
+TEST(LoadBalancingPeriod, UnknownSettings)
+{
+    EXPECT_FALSE(ReaderHelpers::loadBalancingPeriod(/*step=*/10, /*firstLB=*/-1, /*stepLB=*/-1).has_value());
+    EXPECT_FALSE(ReaderHelpers::loadBalancingPeriod(/*step=*/10, /*firstLB=*/100, /*stepLB=*/0).has_value());
+    EXPECT_FALSE(ReaderHelpers::loadBalancingPeriod(/*step=*/10, /*firstLB=*/0, /*stepLB=*/100).has_value());
+}
+
+// ============================================================================
+// Test 15: Index file - legacy format "step position"
+// ============================================================================
+TEST(ParseIndexFileContent, LegacyFormat)
+{
+    const auto entries = ReaderHelpers::parseIndexFileContent("0 0\n10 1234\n20\t987654321012\n", "ball0_index.txt");
+
+    ASSERT_EQ(entries.size(), 3u);
+    EXPECT_EQ(entries[0].step, 0u);
+    EXPECT_EQ(entries[0].position, 0);
+    EXPECT_EQ(entries[1].step, 10u);
+    EXPECT_EQ(entries[1].position, 1234);
+    EXPECT_EQ(entries[2].step, 20u);
+    EXPECT_EQ(entries[2].position, 987654321012LL);
+    for (const auto& entry : entries)
+        EXPECT_FALSE(entry.sceneSize.has_value());
+}
+
+// ============================================================================
+// Test 16: Index file - extended format "step position (C-R)", empty lines and "\r\n"
+// ============================================================================
+TEST(ParseIndexFileContent, ExtendedFormat)
+{
+    const auto entries = ReaderHelpers::parseIndexFileContent("1 0 (250-500)\r\n\r\n  2 5000 (125-40)  \n3 9000", "ball1_index.txt");
+
+    ASSERT_EQ(entries.size(), 3u);
+    ASSERT_TRUE(entries[0].sceneSize.has_value());
+    EXPECT_EQ(entries[0].sceneSize->column, 250);
+    EXPECT_EQ(entries[0].sceneSize->row, 500);
+
+    EXPECT_EQ(entries[1].step, 2u);
+    EXPECT_EQ(entries[1].position, 5000);
+    ASSERT_TRUE(entries[1].sceneSize.has_value());
+    EXPECT_EQ(entries[1].sceneSize->column, 125);
+    EXPECT_EQ(entries[1].sceneSize->row, 40);
+
+    // legacy lines can be mixed with extended ones, last line does not need to end with new line
+    EXPECT_EQ(entries[2].step, 3u);
+    EXPECT_EQ(entries[2].position, 9000);
+    EXPECT_FALSE(entries[2].sceneSize.has_value());
+}
+
+// ============================================================================
+// Test 17: Index file - invalid lines
+// ============================================================================
+TEST(ParseIndexFileContent, InvalidLines)
+{
+    EXPECT_THROW(ReaderHelpers::parseIndexFileContent("1\n", "index.txt"), std::runtime_error);
+    EXPECT_THROW(ReaderHelpers::parseIndexFileContent("a 10\n", "index.txt"), std::runtime_error);
+    EXPECT_THROW(ReaderHelpers::parseIndexFileContent("1 -10\n", "index.txt"), std::runtime_error);
+    EXPECT_THROW(ReaderHelpers::parseIndexFileContent("1 10 (250x500)\n", "index.txt"), std::runtime_error);
+    EXPECT_THROW(ReaderHelpers::parseIndexFileContent("1 10 (250-)\n", "index.txt"), std::runtime_error);
+    EXPECT_THROW(ReaderHelpers::parseIndexFileContent("1 10 250-500\n", "index.txt"), std::runtime_error);
+
+    EXPECT_TRUE(ReaderHelpers::parseIndexFileContent("", "index.txt").empty());
+    EXPECT_TRUE(ReaderHelpers::parseIndexFileContent("\n  \n", "index.txt").empty());
+}
+
+// ============================================================================
+// Test 18: Index reconstruction - steps of text data file are found by their headers
+// ============================================================================
+TEST(ScanTextDataFile, CompleteAndInterruptedSteps)
+{
+    // node with single column: rows "3-1" look like headers, but they are inside of steps
+    const std::string step0 = "1-2\n3-1\n4-2\n";
+    const std::string step1 = "1-2\n5-1\n6-2\n";
+    const std::string interruptedStep = "1-2\n7-1\n";
+
+    const auto steps = ReaderHelpers::scanTextDataFile(step0 + step1 + interruptedStep);
+    ASSERT_EQ(steps.size(), 2u);
+    EXPECT_EQ(steps[0].position, 0);
+    EXPECT_EQ(steps[1].position, static_cast<FilePosition>(step0.size()));
+    EXPECT_EQ(steps[1].sceneSize.column, 1);
+    EXPECT_EQ(steps[1].sceneSize.row, 2);
+
+    // the last row does not need to end with new line when all cells are there
+    const std::string stepWithoutNewLine = "3-1\r\n1 2 3";
+    EXPECT_EQ(ReaderHelpers::scanTextDataFile(step0 + stepWithoutNewLine).size(), 2u);
+    EXPECT_EQ(ReaderHelpers::scanTextDataFile(step0 + "3-1\n1 2").size(), 1u);
+
+    // scanning from position of known step (stale index)
+    const auto tail = ReaderHelpers::scanTextDataFile(step0 + step1, static_cast<FilePosition>(step0.size()));
+    ASSERT_EQ(tail.size(), 1u);
+    EXPECT_EQ(tail[0].position, static_cast<FilePosition>(step0.size()));
+
+    EXPECT_TRUE(ReaderHelpers::scanTextDataFile("").empty());
+    EXPECT_TRUE(ReaderHelpers::scanTextDataFile("1 2 3\n").empty());
+}
+
+TEST(ScanTextDataFile, StepsCrossingChunks)
+{
+    // the file is scanned in parallel chunks of few megabytes, steps and rows cross their boundaries
+    std::string row;
+    for (int column = 0; column < 100; ++column)
+        row += std::to_string(1000 + column) + ' ';
+    row.back() = '\n';
+
+    std::string content;
+    std::vector<FilePosition> positions;
+    for (int step = 0; step < 30; ++step)
+    {
+        const int rows = 3000 + step * 7;
+        positions.push_back(static_cast<FilePosition>(content.size()));
+        content += "100-" + std::to_string(rows) + '\n';
+        for (int r = 0; r < rows; ++r)
+            content += row;
+    }
+
+    const auto steps = ReaderHelpers::scanTextDataFile(content);
+    ASSERT_EQ(steps.size(), positions.size());
+    for (std::size_t step = 0; step < steps.size(); ++step)
+    {
+        EXPECT_EQ(steps[step].position, positions[step]);
+        EXPECT_EQ(steps[step].sceneSize.row, 3000 + static_cast<int>(step) * 7);
+    }
+}
+
+// ============================================================================
+// Test 19: Index reconstruction - binary steps and numbers of found steps
+// ============================================================================
+TEST(ScanBinaryDataFile, StepsOfKnownSize)
+{
+    constexpr std::size_t cellSize = 8;
+    const ColumnAndRow sceneSize = ColumnAndRow::xy(10, 5); // 400 bytes per step
+
+    const auto steps = ReaderHelpers::scanBinaryDataFile(/*fileSize=*/1300, /*startPosition=*/400, sceneSize, cellSize);
+    ASSERT_EQ(steps.size(), 2u); // the last 100 bytes are incomplete step
+    EXPECT_EQ(steps[0].position, 400);
+    EXPECT_EQ(steps[1].position, 800);
+
+    using Steps = std::vector<StepIndex>;
+    EXPECT_EQ(ReaderHelpers::inferStepNumbers(Steps{}, Steps{}, 3), (Steps{ 0, 1, 2 }));
+    EXPECT_EQ(ReaderHelpers::inferStepNumbers(Steps{ 0, 10 }, Steps{}, 2), (Steps{ 20, 30 }));
+    EXPECT_EQ(ReaderHelpers::inferStepNumbers(Steps{ 0, 10 }, Steps{ 0, 10, 15 }, 2), (Steps{ 15, 20 }));
+    EXPECT_EQ(ReaderHelpers::inferStepNumbers(Steps{ 5 }, Steps{ 0, 10, 20 }, 1), (Steps{ 6 })); // reference does not match
+}
+
+// ============================================================================
+// Test 20: Index reconstruction - rebuilt index is written in extended format
+// ============================================================================
+TEST(WriteIndexFile, WrittenAndAppendedEntries)
+{
+    const auto fileName = (std::filesystem::temp_directory_path() / "ModelReaderTests_index.txt").string();
+    std::filesystem::remove(fileName);
+
+    const std::vector<ReaderHelpers::IndexEntry> entries = { { 0, 0, ColumnAndRow::xy(250, 500) }, { 10, 1234, std::nullopt } };
+    ReaderHelpers::writeIndexFile(fileName, entries);
+    ReaderHelpers::writeIndexFile(fileName, std::vector<ReaderHelpers::IndexEntry>{ { 20, 5678, ColumnAndRow::xy(125, 40) } }, /*append=*/true);
+
+    const MappedFile indexFile(fileName);
+    const auto readEntries = ReaderHelpers::parseIndexFileContent({ indexFile.data(), indexFile.size() }, fileName);
+    ASSERT_EQ(readEntries.size(), 3u);
+    EXPECT_EQ(readEntries[0].sceneSize->column, 250);
+    EXPECT_EQ(readEntries[1].position, 1234);
+    EXPECT_FALSE(readEntries[1].sceneSize.has_value());
+    EXPECT_EQ(readEntries[2].step, 20u);
+    EXPECT_EQ(readEntries[2].sceneSize->row, 40);
+
+    std::filesystem::remove(fileName);
+}
+
+// ============================================================================
+// Test 22: Binary files of cells without virtual functions - rows are copied at once or viewed in the mapping
+// ============================================================================
+namespace
+{
+struct PlainCell
+{
+    int value = -1;
+    float weight = 0;
+
+    void composeElement(char*) {}
+    std::string stringEncoding(const char*) const { return std::to_string(value); }
+    Color outputValue(const char*, GlobalValueManager*) const { return Color(); }
+    void startStep(int) {}
+};
+} // namespace
+
+TEST(ModelReaderBinary, TriviallyCopyableCells)
+{
+    static_assert(TriviallyCopyableCell<PlainCell>);
+
+    const auto directory = std::filesystem::temp_directory_path() / "ModelReaderTests_binary";
+    std::filesystem::create_directories(directory);
+    const auto fileName = (directory / "plain").string();
+
+    constexpr int nodes = 2, columns = 3, rows = 2, steps = 2;
+    for (int node = 0; node < nodes; ++node)
+    {
+        std::ofstream data(fileName + std::to_string(node) + ".bin", std::ios::binary);
+        std::ofstream index(fileName + std::to_string(node) + "_index.txt");
+        for (int step = 0; step < steps; ++step)
+        {
+            index << step << ' ' << data.tellp() << " (" << columns << '-' << rows << ")\n";
+            for (int cell = 0; cell < columns * rows; ++cell)
+            {
+                const PlainCell plainCell{ .value = step * 100 + node * 10 + cell, .weight = 0.5f };
+                data.write(reinterpret_cast<const char*>(&plainCell), sizeof(plainCell));
+            }
+        }
+    }
+
+    ModelReader<PlainCell> reader;
+    reader.readStepsOffsetsForAllNodesFromFiles(nodes, 1, 1, fileName, /*isBinary=*/true);
+
+    SettingParameter sp{};
+    sp.nNodeX = nodes;
+    sp.nNodeY = 1;
+    sp.outputFileName = fileName;
+    sp.readMode = "binary";
+    sp.step = 1;
+    std::vector<Line> lines(2 * nodes + nodes + 1);
+
+    CellGrid<PlainCell> grid(nodes * columns, rows);
+    reader.readStageStateFromFilesForStep(grid, &sp, lines.data());
+    for (int node = 0; node < nodes; ++node)
+        for (int row = 0; row < rows; ++row)
+            for (int column = 0; column < columns; ++column)
+                EXPECT_EQ(grid[row][node * columns + column].value, 100 + node * 10 + row * columns + column);
+
+    const auto view = reader.mappedBinaryCells(/*step=*/1, fileName, /*node=*/1);
+    ASSERT_TRUE(view.has_value());
+    EXPECT_EQ(view->columns(), columns);
+    EXPECT_EQ(view->size(), static_cast<std::size_t>(rows));
+    EXPECT_EQ((*view)[1][2].value, 115);
+    EXPECT_EQ((*view)[1][2].weight, 0.5f);
+
+    reader.clearStage();
+    std::filesystem::remove_all(directory);
+}
+
+// ============================================================================
+// Test 23: Cells supporting selective decoding parse only displayed substates
+// ============================================================================
+namespace
+{
+/// Cell with substates "h" and "z" encoded as "h,z", value of substate which is not decoded stays -1
+struct SelectiveCell
+{
+    double h = -1;
+    double z = -1;
+
+    void composeElement(char* str) { composeElement(str, allSubstatesMask); }
+    void composeElement(char* str, SubstatesMask substates)
+    {
+        const std::string text = str;
+        const auto comma = text.find(',');
+        if (substates & 1)
+            h = std::stod(text.substr(0, comma));
+        if (substates & 2)
+            z = std::stod(text.substr(comma + 1));
+    }
+    std::string stringEncoding(const char* fieldName) const { return std::to_string(std::string(fieldName) == "z" ? z : h); }
+    Color outputValue(const char*, GlobalValueManager*) const { return Color(); }
+    void startStep(int) {}
+
+    static int substateId(const char* fieldName)
+    {
+        const std::string name = fieldName;
+        return name == "h" ? 0 : (name == "z" ? 1 : -1);
+    }
+};
+} // namespace
+
+TEST(ModelReaderText, SelectiveDecodingCells)
+{
+    static_assert(SelectiveDecodingCell<SelectiveCell>);
+    static_assert(! SelectiveDecodingCell<PlainCell>);
+
+    const auto directory = std::filesystem::temp_directory_path() / "ModelReaderTests_selective";
+    std::filesystem::create_directories(directory);
+    const auto fileName = (directory / "selective").string();
+    {
+        std::ofstream data(fileName + "0.txt");
+        std::ofstream index(fileName + "0_index.txt");
+        index << 0 << ' ' << data.tellp() << " (2-1)\n";
+        data << "2-1\n1.5,10 2.5,20\n";
+    }
+
+    ModelReader<SelectiveCell> reader;
+    reader.readStepsOffsetsForAllNodesFromFiles(1, 1, 1, fileName);
+    EXPECT_EQ(reader.decodedSubstates(), allSubstatesMask);
+
+    SettingParameter sp{};
+    sp.nNodeX = 1;
+    sp.nNodeY = 1;
+    sp.outputFileName = fileName;
+    sp.readMode = "text";
+    sp.step = 0;
+    std::vector<Line> lines(4);
+
+    EXPECT_TRUE(reader.setDecodedSubstates({ "z" }));
+    EXPECT_FALSE(reader.setDecodedSubstates({ "z" })); // not changed
+    CellGrid<SelectiveCell> grid(2, 1);
+    reader.readStageStateFromFilesForStep(grid, &sp, lines.data());
+    EXPECT_EQ(grid[0][1].h, -1);
+    EXPECT_EQ(grid[0][1].z, 20);
+
+    EXPECT_TRUE(reader.setDecodedSubstates({ "z", "unknown" })); // all substates are decoded for unknown substate
+    EXPECT_EQ(reader.decodedSubstates(), allSubstatesMask);
+    reader.readStageStateFromFilesForStep(grid, &sp, lines.data());
+    EXPECT_EQ(grid[0][1].h, 2.5);
+
+    EXPECT_FALSE(ModelReader<PlainCell>{}.setDecodedSubstates({ "z" })); // cells without selective decoding
+
+    reader.clearStage();
+    std::filesystem::remove_all(directory);
+}
+
+// ============================================================================
+// Test 24: Only nodes intersecting the region are read, the step is completed when the region grows
+// ============================================================================
+TEST(ModelReaderText, NodesInRegion)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "ModelReaderTests_region";
+    std::filesystem::create_directories(directory);
+    const auto fileName = (directory / "region").string();
+    for (NodeIndex node = 0; node < 4; ++node) // 2x2 nodes of 2x2 cells, value of cells is 10 * step + node
+    {
+        std::ofstream data(fileName + std::to_string(node) + ".txt");
+        std::ofstream index(fileName + std::to_string(node) + "_index.txt");
+        for (int step = 0; step < 2; ++step)
+        {
+            const auto value = std::to_string(10 * step + node) + ",0";
+            index << step << ' ' << data.tellp() << " (2-2)\n";
+            data << "2-2\n" << value << ' ' << value << '\n' << value << ' ' << value << '\n';
+        }
+    }
+
+    ModelReader<SelectiveCell> reader;
+    reader.readStepsOffsetsForAllNodesFromFiles(2, 2, 1, fileName);
+
+    SettingParameter sp{};
+    sp.nNodeX = 2;
+    sp.nNodeY = 2;
+    sp.numberOfColumnX = 4;
+    sp.numberOfRowsY = 4;
+    sp.outputFileName = fileName;
+    sp.readMode = "text";
+    sp.step = 0;
+    std::vector<Line> lines(12);
+
+    CellGrid<SelectiveCell> grid(4, 4);
+    reader.readStageStateFromFilesForStep(grid, &sp, lines.data());
+    EXPECT_EQ(grid[3][3].h, 3);
+
+    const auto regions = reader.nodesRegions(sp);
+    ASSERT_TRUE(regions.has_value());
+    ASSERT_EQ(regions->size(), 4u);
+    EXPECT_EQ((*regions)[3], (GridRegion{ .firstColumn = 2, .firstRow = 2, .endColumn = 4, .endRow = 4 }));
+
+    sp.step = 1;
+    std::vector<bool> loadedNodes;
+    reader.readStageStateFromFilesForStepInRegion(grid, &sp, lines.data(), GridRegion{ 0, 0, 1, 1 }, loadedNodes);
+    EXPECT_EQ(loadedNodes, (std::vector<bool>{ true, false, false, false }));
+    EXPECT_EQ(grid[1][1].h, 10);
+    EXPECT_EQ(grid[3][3].h, -1); // not read, cell of step 0 was reset
+    EXPECT_EQ(lines[6].x1, 2);   // lines of all nodes are set
+    EXPECT_EQ(lines[6].y1, 2);
+
+    grid[0][0].h = 42; // already loaded nodes are not read again
+    reader.readStageStateFromFilesForStepInRegion(grid, &sp, lines.data(), GridRegion{ 1, 1, 4, 3 }, loadedNodes);
+    EXPECT_EQ(loadedNodes, (std::vector<bool>{ true, true, true, true }));
+    EXPECT_EQ(grid[0][0].h, 42);
+    EXPECT_EQ(grid[0][3].h, 11);
+    EXPECT_EQ(grid[3][0].h, 12);
+    EXPECT_EQ(grid[3][3].h, 13);
+
+    reader.clearStage();
+    std::filesystem::remove_all(directory);
+}
+
+// ============================================================================
+// Test 25: Following running simulation - only entries appended to index files are read
+// ============================================================================
+TEST(ReadIndexFileTail, AppendedAndUnterminatedLines)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "ModelReaderTests_tail";
+    std::filesystem::create_directories(directory);
+    const auto indexFileName = (directory / "tail0_index.txt").string();
+
+    std::ofstream(indexFileName) << "0 0 (2-2)\n1 100 (2-2)\n";
+    const auto parsedSize = static_cast<FilePosition>(std::filesystem::file_size(indexFileName));
+    auto tail = ReaderHelpers::readIndexFileTail(indexFileName, parsedSize);
+    ASSERT_TRUE(tail.has_value());
+    EXPECT_TRUE(tail->entries.empty());
+    EXPECT_EQ(tail->parsedSize, parsedSize);
+
+    std::ofstream(indexFileName, std::ios::app) << "2 200 (2-2)\n3 30";
+    tail = ReaderHelpers::readIndexFileTail(indexFileName, parsedSize);
+    ASSERT_TRUE(tail.has_value());
+    ASSERT_EQ(tail->entries.size(), 2u); // the unterminated line is parsed, but it is read again next time
+    EXPECT_EQ(tail->entries[0].step, 2u);
+    EXPECT_EQ(tail->entries[0].position, 200);
+    EXPECT_EQ(tail->entries[1].step, 3u);
+    EXPECT_EQ(tail->entries[1].position, 30);
+    EXPECT_EQ(tail->parsedSize, parsedSize + static_cast<FilePosition>(std::string_view("2 200 (2-2)\n").size()));
+
+    std::ofstream(indexFileName, std::ios::app) << "0 (2-";
+    const auto incompleteTail = ReaderHelpers::readIndexFileTail(indexFileName, tail->parsedSize);
+    ASSERT_TRUE(incompleteTail.has_value());
+    EXPECT_TRUE(incompleteTail->entries.empty()); // "3 300 (2-" is not valid yet
+    EXPECT_EQ(incompleteTail->parsedSize, tail->parsedSize);
+
+    std::ofstream(indexFileName, std::ios::app) << "2)\n";
+    tail = ReaderHelpers::readIndexFileTail(indexFileName, tail->parsedSize);
+    ASSERT_TRUE(tail.has_value());
+    ASSERT_EQ(tail->entries.size(), 1u);
+    EXPECT_EQ(tail->entries[0].step, 3u);
+    EXPECT_EQ(tail->entries[0].position, 300);
+    EXPECT_EQ(tail->parsedSize, static_cast<FilePosition>(std::filesystem::file_size(indexFileName)));
+
+    EXPECT_FALSE(ReaderHelpers::readIndexFileTail(indexFileName, tail->parsedSize + 1).has_value()); // the file was written again
+    ASSERT_TRUE(ReaderHelpers::readIndexFileTail((directory / "missing_index.txt").string(), 0).has_value());
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(ModelReaderText, AppendedSteps)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "ModelReaderTests_appended";
+    std::filesystem::create_directories(directory);
+    const auto fileName = (directory / "appended").string();
+    const auto appendStep = [&fileName](NodeIndex node, int step)
+    {
+        std::ofstream data(fileName + std::to_string(node) + ".txt", std::ios::app);
+        std::ofstream index(fileName + std::to_string(node) + "_index.txt", std::ios::app);
+        const auto value = std::to_string(10 * step + node) + ",0";
+        index << step << ' ' << std::filesystem::file_size(fileName + std::to_string(node) + ".txt") << " (2-2)\n";
+        data << "2-2\n" << value << ' ' << value << '\n' << value << ' ' << value << '\n';
+    };
+    for (NodeIndex node = 0; node < 2; ++node)
+    {
+        std::ofstream(fileName + std::to_string(node) + ".txt");
+        appendStep(node, 0);
+    }
+
+    ModelReader<SelectiveCell> reader;
+    reader.setConsolidatedIndexEnabled(false);
+    reader.setIndexRecoveryEnabled(false);
+    reader.readStepsOffsetsForAllNodesFromFiles(2, 1, 1, fileName);
+    EXPECT_EQ(reader.availableSteps(), std::vector<StepIndex>{ 0 });
+
+    auto update = reader.readIndexFilesUpdate(fileName);
+    ASSERT_TRUE(update.has_value());
+    EXPECT_FALSE(update->hasNewRecords());
+    EXPECT_TRUE(reader.applyIndexFilesUpdate(std::move(*update)).empty());
+
+    appendStep(0, 1); // the simulation is writing step 1, node 1 did not write it yet
+    update = reader.readIndexFilesUpdate(fileName);
+    ASSERT_TRUE(update.has_value());
+    EXPECT_TRUE(update->hasNewRecords());
+    EXPECT_TRUE(reader.applyIndexFilesUpdate(std::move(*update)).empty());
+
+    appendStep(1, 1);
+    appendStep(0, 2);
+    update = reader.readIndexFilesUpdate(fileName);
+    ASSERT_TRUE(update.has_value());
+    EXPECT_EQ(reader.applyIndexFilesUpdate(std::move(*update)), std::vector<StepIndex>{ 1 }); // step 2 is not complete yet
+
+    SettingParameter sp{};
+    sp.nNodeX = 2;
+    sp.nNodeY = 1;
+    sp.numberOfColumnX = 4;
+    sp.numberOfRowsY = 2;
+    sp.outputFileName = fileName;
+    sp.readMode = "text";
+    sp.step = 1;
+    std::vector<Line> lines(7); // 2 * nodes + nNodeX + nNodeY
+
+    CellGrid<SelectiveCell> grid(4, 2);
+    reader.readStageStateFromFilesForStep(grid, &sp, lines.data()); // data files grew since they were mapped
+    EXPECT_EQ(grid[0][0].h, 10);
+    EXPECT_EQ(grid[1][3].h, 11);
+
+    std::ofstream(fileName + "1_index.txt", std::ios::trunc) << "0 0 (2-2)\n";
+    EXPECT_FALSE(reader.readIndexFilesUpdate(fileName).has_value()); // the simulation was started again
+
+    reader.clearStage();
+    std::filesystem::remove_all(directory);
+}
+
+// ============================================================================
+// Test 26: 3D models - nodes split along all axes, only requested slices are decoded
+// ============================================================================
+TEST(ReaderHelpers, VolumeHeadersAndOffsets)
+{
+    EXPECT_EQ(ReaderHelpers::getVolumeSizeFromLine("3-4-5"), (VolumeSize{ .column = 3, .row = 4, .slice = 5 }));
+    EXPECT_EQ(ReaderHelpers::getVolumeSizeFromLine("3-4\r"), (VolumeSize{ .column = 3, .row = 4, .slice = 1 }));
+    EXPECT_THROW(ReaderHelpers::getVolumeSizeFromLine("3-4-x"), std::runtime_error);
+
+    /* Nodes 2x2x2 (node = x + 2 * (y + 2 * z)), nodes of the first column have 3 columns,
+     * nodes of the first row 2 rows and nodes of the first layer 4 slices */
+    std::vector<VolumeSize> volumeSizes(8);
+    for (NodeIndex node = 0; node < volumeSizes.size(); ++node)
+    {
+        volumeSizes[node] = VolumeSize{ .column = node % 2 == 0 ? 3 : 5, .row = (node / 2) % 2 == 0 ? 2 : 6, .slice = node / 4 == 0 ? 4 : 7 };
+    }
+    EXPECT_EQ(ReaderHelpers::calculateXYZOffsetForNode(0, 2, 2, volumeSizes), (VolumeSize{ .column = 0, .row = 0, .slice = 0 }));
+    EXPECT_EQ(ReaderHelpers::calculateXYZOffsetForNode(3, 2, 2, volumeSizes), (VolumeSize{ .column = 3, .row = 2, .slice = 0 }));
+    EXPECT_EQ(ReaderHelpers::calculateXYZOffsetForNode(6, 2, 2, volumeSizes), (VolumeSize{ .column = 0, .row = 2, .slice = 4 }));
+    EXPECT_EQ(ReaderHelpers::calculateXYZOffsetForNode(7, 2, 2, volumeSizes), (VolumeSize{ .column = 3, .row = 2, .slice = 4 }));
+
+    // steps of 3D models have S * R rows
+    const std::string content = "2-1-2\na b\nc d\n2-1-2\ne f\ng h\n2-1-2\ni j\n";
+    const auto steps = ReaderHelpers::scanTextDataFile(content);
+    ASSERT_EQ(steps.size(), 2u);
+    EXPECT_EQ(steps[1].position, 14);
+    EXPECT_EQ(steps[1].sceneSize.column, 2);
+    EXPECT_EQ(steps[1].sceneSize.row, 1);
+}
+
+TEST(ModelReaderText, VolumeSlices)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "ModelReaderTests_volume";
+    std::filesystem::create_directories(directory);
+    const auto fileName = (directory / "volume").string();
+    for (NodeIndex node = 0; node < 4; ++node) // 2x1x2 nodes of 2x2x2 cells, "h,z" of cells is "100 * node + 10 * slice + row,column"
+    {
+        std::ofstream data(fileName + std::to_string(node) + ".txt");
+        std::ofstream index(fileName + std::to_string(node) + "_index.txt");
+        index << 0 << ' ' << data.tellp() << " (2-2)\n";
+        data << "2-2-2\n";
+        for (int slice = 0; slice < 2; ++slice)
+        {
+            for (int row = 0; row < 2; ++row)
+            {
+                const auto value = std::to_string(100 * node + 10 * slice + row);
+                data << value << ",0 " << value << ",1\n";
+            }
+        }
+    }
+
+    ModelReader<SelectiveCell> reader;
+    reader.readStepsOffsetsForAllNodesFromFiles(2, 1, 2, fileName);
+
+    SettingParameter sp{};
+    sp.nNodeX = 2;
+    sp.nNodeY = 1;
+    sp.nNodeZ = 2;
+    sp.numberOfColumnX = 4;
+    sp.numberOfRowsY = 2;
+    sp.numberOfSlicesZ = 4;
+    sp.outputFileName = fileName;
+    sp.readMode = "text";
+    sp.step = 0;
+
+    CellVolume<SelectiveCell> volume;
+    const auto nodes = reader.readVolumeOfStep(volume, sp, SliceRange{ .first = 0, .end = 4 });
+    ASSERT_EQ(volume.storedSlices(), (SliceRange{ .first = 0, .end = 4 }));
+    EXPECT_EQ(volume(0, 0, 0).h, 0);
+    EXPECT_EQ(volume(3, 1, 3).h, 311);
+    EXPECT_EQ(volume(3, 1, 3).z, 1);
+    EXPECT_EQ(volume(2, 0, 2).h, 300);
+    ASSERT_EQ(nodes.size(), 4u);
+    EXPECT_EQ(nodes[3].offset, (VolumeSize{ .column = 2, .row = 0, .slice = 2 }));
+    EXPECT_EQ(nodes[3].size, (VolumeSize{ .column = 2, .row = 2, .slice = 2 }));
+
+    std::vector<Line> lines(7); // lines of nodes of one layer
+    ReaderHelpers::setVolumeNodesLines(lines.data(), nodes, 2, 1, /*slice=*/3, volume.columns(), volume.rows());
+    EXPECT_EQ(lines[2].x1, 2); // bottom line of node 3 (the second node of its layer)
+    EXPECT_EQ(lines[2].x2, 4);
+
+    EXPECT_TRUE(reader.setDecodedSubstates({ "h" }));
+    reader.readVolumeOfStep(volume, sp, SliceRange{ .first = 1, .end = 2 }); // slice 0 of nodes 0 and 1 is skipped, nodes 2 and 3 are not decoded
+    ASSERT_EQ(volume.storedSlices(), (SliceRange{ .first = 1, .end = 2 }));
+    EXPECT_EQ(volume(0, 1, 1).h, 11);
+    EXPECT_EQ(volume(2, 0, 1).h, 110);
+    EXPECT_EQ(volume(2, 0, 1).z, -1); // not decoded substate
+
+    sp.readMode = "binary";
+    EXPECT_THROW(reader.readVolumeOfStep(volume, sp, SliceRange{ .first = 0, .end = 1 }), std::runtime_error);
+
+    reader.clearStage();
+    std::filesystem::remove_all(directory);
+}
+
+// ============================================================================
+// Test 27: Index recovery - missing index files are rebuilt, stale ones are extended only on request
+// ============================================================================
+TEST(ReadLastIndexEntry, LastCompleteEntry)
+{
+    const auto fileName = (std::filesystem::temp_directory_path() / "ModelReaderTests_last_index.txt").string();
+
+    std::ofstream(fileName) << "";
+    EXPECT_FALSE(ReaderHelpers::readLastIndexEntry(fileName).has_value());
+
+    std::ofstream(fileName) << "0 0 (2-2)\n1 16 (2-2)\n\n";
+    auto entry = ReaderHelpers::readLastIndexEntry(fileName);
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->step, 1u);
+    EXPECT_EQ(entry->position, 16);
+
+    std::ofstream(fileName, std::ios::app) << "2 32 (2-"; // the simulation is writing the line
+    entry = ReaderHelpers::readLastIndexEntry(fileName);
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->step, 1u);
+
+    std::ofstream(fileName) << std::string(300, '\n') << "7 70\r\n"; // longer than the part read from the end
+    entry = ReaderHelpers::readLastIndexEntry(fileName);
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->step, 7u);
+    EXPECT_FALSE(entry->sceneSize.has_value());
+
+    std::filesystem::remove(fileName);
+}
+
+TEST(ModelReaderText, RecoveredIndexFiles)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "ModelReaderTests_recovery";
+    std::filesystem::create_directories(directory);
+    const auto fileName = (directory / "recovery").string();
+    for (NodeIndex node = 0; node < 2; ++node) // 3 steps of 2x1 cells, the index of node 0 is missing, node 1 indexed only step 0
+    {
+        std::ofstream data(fileName + std::to_string(node) + ".txt");
+        for (int step = 0; step < 3; ++step)
+            data << "2-1\n" << step << ",0 " << step << ",1\n";
+    }
+    std::ofstream(fileName + "1_index.txt") << "0 0 (2-1)\n";
+
+    ModelReader<SelectiveCell> reader;
+    reader.setConsolidatedIndexEnabled(false);
+    reader.readStepsOffsetsForAllNodesFromFiles(2, 1, 1, fileName);
+    auto lastEntry = ReaderHelpers::readLastIndexEntry(fileName + "0_index.txt");
+    ASSERT_TRUE(lastEntry.has_value());
+    EXPECT_EQ(lastEntry->step, 2u);
+    EXPECT_EQ(lastEntry->position, 24); // the header and the row of a step take 12 bytes
+    lastEntry = ReaderHelpers::readLastIndexEntry(fileName + "1_index.txt");
+    ASSERT_TRUE(lastEntry.has_value());
+    EXPECT_EQ(lastEntry->step, 0u); // the existing index is not checked by default
+    reader.clearStage();
+
+    reader.setStaleIndexCheckEnabled(true);
+    reader.readStepsOffsetsForAllNodesFromFiles(2, 1, 1, fileName);
+    EXPECT_EQ(reader.availableSteps(), (std::vector<StepIndex>{ 0, 1, 2 }));
+    lastEntry = ReaderHelpers::readLastIndexEntry(fileName + "1_index.txt");
+    ASSERT_TRUE(lastEntry.has_value());
+    EXPECT_EQ(lastEntry->step, 2u);
+    EXPECT_EQ(lastEntry->position, 24);
+    reader.clearStage();
+
+    std::filesystem::remove_all(directory);
+}
+
+TEST(ModelReaderBinary, StaleIndexFileIsExtended)
+{
+    const auto directory = std::filesystem::temp_directory_path() / "ModelReaderTests_binary_recovery";
+    std::filesystem::create_directories(directory);
+    const auto fileName = (directory / "plain").string();
+    {
+        std::ofstream data(fileName + "0.bin", std::ios::binary);
+        for (int cell = 0; cell < 3 * 2; ++cell) // two steps of 3x1 cells, only step 0 is indexed
+        {
+            const PlainCell plainCell{ .value = cell };
+            data.write(reinterpret_cast<const char*>(&plainCell), sizeof(plainCell));
+        }
+        std::ofstream(fileName + "0_index.txt") << "0 0 (3-1)\n";
+    }
+
+    ModelReader<PlainCell> reader;
+    reader.setConsolidatedIndexEnabled(false);
+    reader.setStaleIndexCheckEnabled(true);
+    reader.readStepsOffsetsForAllNodesFromFiles(1, 1, 1, fileName, /*isBinary=*/true);
+    EXPECT_EQ(reader.availableSteps(), (std::vector<StepIndex>{ 0, 1 }));
+    reader.clearStage();
+
+    reader.readStepsOffsetsForAllNodesFromFiles(1, 1, 1, fileName, /*isBinary=*/true); // the data file ends with the last indexed step
+    EXPECT_EQ(reader.availableSteps(), (std::vector<StepIndex>{ 0, 1 }));
+    reader.clearStage();
+
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,143 @@
+/** @file RowTokenizerBenchmark.cpp
+ * @brief Microbenchmark of RowTokenizer against the original std::replace + std::find loop.
+ *
+ * Usage: RowTokenizerBenchmark [numbersPerRow=10000] [rows=1000]
+ *
+ * For each variant the benchmark splits the same rows (always from fresh copy, because splitting is in place)
+ * and reports cells per second. Second table additionally parses every token with std::from_chars
+ * (cheap composeElement()), to show what share of row processing the tokenizing is. */
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "data/RowTokenizer.h"
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+std::vector<std::string> generateRows(std::size_t numbersPerRow, std::size_t rows)
+{
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> distribution(-1000., 100000.);
+
+    std::vector<std::string> result(rows);
+    for (auto& row : result)
+    {
+        for (std::size_t i = 0; i < numbersPerRow; ++i)
+        {
+            row += std::format("{:.3f}", distribution(generator));
+            row += ' ';
+        }
+    }
+    return result;
+}
+
+/// Original loop from ModelReader::readStageStateFromFilesForStep, onToken is called instead of composeElement()
+template<typename OnToken>
+void splitTheOriginalWay(std::string& line, std::size_t columns, OnToken onToken)
+{
+    std::replace(line.begin(), line.end(), ' ', '\0');
+
+    char* currentTokenPtr = line.data();
+    for (std::size_t col = 0; col < columns && *currentTokenPtr; ++col)
+    {
+        char* nextTokenPtr = std::find(currentTokenPtr, line.data() + line.size(), '\0');
+        ++nextTokenPtr;
+
+        onToken(currentTokenPtr);
+
+        currentTokenPtr = nextTokenPtr;
+    }
+}
+
+template<typename OnToken>
+void splitWithTokenizer(std::string& line, std::size_t columns, RowTokenizer::Implementation implementation, OnToken onToken)
+{
+    static std::vector<char*> tokens;
+    tokens.resize(columns);
+
+    const auto count = RowTokenizer::splitInPlace(line.data(), line.size(), tokens.data(), columns, implementation);
+    for (std::size_t i = 0; i < count; ++i)
+        onToken(tokens[i]);
+}
+
+/// Runs the function for all rows several times, returns best cells/s
+double measure(const std::vector<std::string>& rows, std::size_t columns, const std::function<void(std::string&)>& splitRow)
+{
+    constexpr int repetitions = 5;
+
+    std::vector<std::string> workRows;
+    double bestSeconds = 1e100;
+    for (int repetition = 0; repetition < repetitions; ++repetition)
+    {
+        workRows = rows; // splitting modifies rows
+
+        const auto start = Clock::now();
+        for (auto& row : workRows)
+            splitRow(row);
+        const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+        bestSeconds = std::min(bestSeconds, elapsed.count());
+    }
+    return static_cast<double>(rows.size() * columns) / bestSeconds;
+}
+
+void runTable(const std::string& title, const std::vector<std::string>& rows, std::size_t columns, bool parseNumbers)
+{
+    double checksum = 0;
+    auto onToken = [&checksum, parseNumbers](const char* token)
+    {
+        if (parseNumbers)
+        {
+            double value{};
+            std::from_chars(token, token + std::strlen(token), value);
+            checksum += value;
+        }
+        else
+        {
+            checksum += static_cast<unsigned char>(*token);
+        }
+    };
+
+    std::cout << title << '\n';
+
+    const double baseline = measure(rows, columns, [&](std::string& row) { splitTheOriginalWay(row, columns, onToken); });
+    std::cout << std::format("  {:<28} {:>10.1f} Mcells/s\n", "std::replace + std::find", baseline / 1e6);
+
+    for (const auto implementation : { RowTokenizer::Implementation::Scalar, RowTokenizer::Implementation::SSE2, RowTokenizer::Implementation::AVX2 })
+    {
+        if (! RowTokenizer::isSupported(implementation))
+        {
+            std::cout << std::format("  {:<28} {:>10}\n", RowTokenizer::toString(implementation), "not supported");
+            continue;
+        }
+
+        const double cellsPerSecond = measure(rows, columns, [&](std::string& row) { splitWithTokenizer(row, columns, implementation, onToken); });
+        std::cout << std::format("  {:<28} {:>10.1f} Mcells/s  (x{:.2f})\n", RowTokenizer::toString(implementation), cellsPerSecond / 1e6, cellsPerSecond / baseline);
+    }
+    std::cout << "  (checksum " << checksum << ")\n" << std::endl;
+}
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const std::size_t numbersPerRow = argc > 1 ? std::stoul(argv[1]) : 10'000;
+    const std::size_t rowsCount = argc > 2 ? std::stoul(argv[2]) : 1'000;
+
+    std::cout << std::format("Rows: {} x {} numbers, best tokenizer on this CPU: {}\n\n",
+                             rowsCount, numbersPerRow, RowTokenizer::toString(RowTokenizer::bestImplementation()));
+
+    const auto rows = generateRows(numbersPerRow, rowsCount);
+
+    runTable("Tokenizing only:", rows, numbersPerRow, /*parseNumbers=*/false);
+    runTable("Tokenizing + std::from_chars for each token:", rows, numbersPerRow, /*parseNumbers=*/true);
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "data/RowTokenizer.h"
+
+/**
+ * Test Suite: RowTokenizer::splitInPlace()
+ *
+ * Every implementation (scalar, SSE2, AVX2 - when supported by the CPU) must split rows
+ * exactly the same way as the original loop in ModelReader:
+ *   std::replace(' ', '\0') and then std::find('\0') for each token, stopping on empty token.
+ */
+
+namespace
+{
+using RowTokenizer::Implementation;
+
+const std::vector<Implementation> allImplementations = { Implementation::Scalar, Implementation::SSE2, Implementation::AVX2 };
+
+/** Reference implementation - the loop which was used in ModelReader before RowTokenizer.
+ * @note The original loop was reading one byte after the terminating '\0' for rows without trailing space,
+ *       here it is bounded by the end of the row. */
+std::vector<std::string> splitTheOriginalWay(std::string line, std::size_t maxTokens)
+{
+    std::replace(line.begin(), line.end(), ' ', '\0');
+
+    std::vector<std::string> tokens;
+    char* currentTokenPtr = line.data();
+    for (std::size_t col = 0; col < maxTokens && currentTokenPtr < line.data() + line.size() && *currentTokenPtr; ++col)
+    {
+        char* nextTokenPtr = std::find(currentTokenPtr, line.data() + line.size(), '\0');
+        tokens.emplace_back(currentTokenPtr);
+        currentTokenPtr = nextTokenPtr + 1;
+    }
+    return tokens;
+}
+
+std::vector<std::string> split(std::string line, std::size_t maxTokens, Implementation implementation)
+{
+    std::vector<char*> tokenPointers(maxTokens);
+    const auto count = RowTokenizer::splitInPlace(line.data(), line.size(), tokenPointers.data(), maxTokens, implementation);
+    return { tokenPointers.begin(), tokenPointers.begin() + count };
+}
+
+void expectSameAsOriginal(const std::string& line, std::size_t maxTokens)
+{
+    const auto expected = splitTheOriginalWay(line, maxTokens);
+    for (const auto implementation : allImplementations)
+    {
+        if (! RowTokenizer::isSupported(implementation))
+            continue;
+
+        EXPECT_EQ(split(line, maxTokens, implementation), expected)
+            << "implementation: " << RowTokenizer::toString(implementation) << ", line: >" << line << "<, maxTokens: " << maxTokens;
+    }
+}
+} // namespace
+
+// ============================================================================
+// Test 1: Simple rows
+// ============================================================================
+TEST(RowTokenizer, SimpleRows)
+{
+    expectSameAsOriginal("", 5);
+    expectSameAsOriginal("1", 5);
+    expectSameAsOriginal("1 2 3", 5);
+    expectSameAsOriginal("12.5 -3 4e10 0", 10);
+}
+
+// ============================================================================
+// Test 2: Trailing and doubled delimiters end the row
+// ============================================================================
+TEST(RowTokenizer, EmptyTokenStopsSplitting)
+{
+    expectSameAsOriginal("1 2 3 ", 10);
+    expectSameAsOriginal("1 2  3", 10);
+    expectSameAsOriginal(" 1 2", 10);
+    expectSameAsOriginal("   ", 10);
+}
+
+// ============================================================================
+// Test 3: Number of tokens is limited by number of columns
+// ============================================================================
+TEST(RowTokenizer, MaxTokensLimit)
+{
+    expectSameAsOriginal("1 2 3 4 5", 3);
+    expectSameAsOriginal("1 2 3 4 5", 1);
+    expectSameAsOriginal("1 2 3 4 5", 5);
+    EXPECT_TRUE(split("1 2 3", 0, Implementation::Scalar).empty());
+}
+
+// ============================================================================
+// Test 4: Long rows (crossing many SIMD blocks, delimiters on block boundaries)
+// ============================================================================
+TEST(RowTokenizer, LongRowsAllLengths)
+{
+    for (std::size_t tokenLength = 1; tokenLength <= 40; ++tokenLength)
+    {
+        std::string line;
+        for (int token = 0; token < 100; ++token)
+        {
+            line += std::string(tokenLength, static_cast<char>('a' + token % 26));
+            line += ' ';
+        }
+
+        for (std::size_t cut = line.size() - 70; cut <= line.size(); ++cut)
+        {
+            expectSameAsOriginal(line.substr(0, cut), 1000);
+            expectSameAsOriginal(line.substr(0, cut), 37);
+        }
+    }
+}
+
+// ============================================================================
+// Test 5: Cell encodings with internal separators (e.g. "h:z") are kept in one token
+// ============================================================================
+TEST(RowTokenizer, CompositeCellEncodings)
+{
+    expectSameAsOriginal("1.0:2.0:3 4.5:0:1\r", 10);
+    expectSameAsOriginal("0,0,0 1,1,1 2,2,2 3,3,3 4,4,4 5,5,5 6,6,6 7,7,7 8,8,8 9,9,9 10,10,10", 11);
+}
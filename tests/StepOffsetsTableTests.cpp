@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "data/StepOffsetsTable.h"
+
+/**
+ * Test Suite: StepOffsetsTable
+ *
+ * This test suite verifies the table of positions of steps of all nodes:
+ * - records are sorted by step and duplicated steps are reported,
+ * - steps available in all nodes are computed once,
+ * - consolidated index written to file is mapped back with the same content,
+ * - consolidated index is not used when index files changed or it is damaged,
+ * - records appended while the simulation is running extend steps of all nodes.
+ */
+
+namespace
+{
+StepOffsetRecord record(StepIndex step, FilePosition position, std::optional<ColumnAndRow> sceneSize = std::nullopt)
+{
+    return StepOffsetRecord{ .step = step,
+                             .hasSceneSize = sceneSize.has_value(),
+                             .position = position,
+                             .columns = sceneSize.value_or(ColumnAndRow{}).column,
+                             .rows = sceneSize.value_or(ColumnAndRow{}).row };
+}
+
+class StepOffsetsTableTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        directory = std::filesystem::temp_directory_path() / ("StepOffsetsTableTest_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+        std::filesystem::create_directories(directory);
+
+        table.resize(2);
+        table.setNodeRecords(0, { record(20, 2000, ColumnAndRow{ .column = 10, .row = 5 }), record(10, 1000, ColumnAndRow{ .column = 12, .row = 5 }) });
+        table.setNodeRecords(1, { record(10, 100), record(20, 200) });
+        table.finishLoading();
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(directory);
+    }
+
+    std::string path(const std::string& name) const
+    {
+        return (directory / name).string();
+    }
+
+    std::filesystem::path directory;
+    StepOffsetsTable table;
+    const std::vector<IndexFileStamp> stamps{ IndexFileStamp{ .size = 100, .modificationTime = 1 }, IndexFileStamp{ .size = 200, .modificationTime = 2 } };
+};
+} // namespace
+
+// ============================================================================
+// Test 1: Records are sorted, duplicates are removed, common steps are computed
+// ============================================================================
+TEST_F(StepOffsetsTableTest, RecordsAndCommonSteps)
+{
+    ASSERT_NE(table.find(0, 10), nullptr);
+    EXPECT_EQ(table.find(0, 10)->position, 1000);
+    EXPECT_EQ(table.find(0, 10)->sceneSize()->column, 12);
+    EXPECT_FALSE(table.find(1, 20)->sceneSize().has_value());
+    EXPECT_EQ(table.find(1, 15), nullptr);
+    EXPECT_EQ(table.find(2, 10), nullptr);
+    EXPECT_EQ(table.recordsCount(), 4u);
+
+    ASSERT_TRUE(table.commonSteps().has_value());
+    EXPECT_EQ(std::vector<StepIndex>(table.commonSteps()->begin(), table.commonSteps()->end()), (std::vector<StepIndex>{ 10, 20 }));
+
+    const auto duplicates = table.setNodeRecords(1, { record(30, 300), record(10, 100), record(30, 333) });
+    table.finishLoading();
+    EXPECT_EQ(duplicates, std::vector<StepIndex>{ 30 });
+    EXPECT_EQ(table.find(1, 30)->position, 300); // the first record is kept
+    EXPECT_FALSE(table.commonSteps().has_value());
+}
+
+// ============================================================================
+// Test 2: Consolidated index is mapped with the same content
+// ============================================================================
+TEST_F(StepOffsetsTableTest, ConsolidatedIndexRoundTrip)
+{
+    const auto indexPath = path("model_index.bin");
+    table.writeConsolidatedIndex(indexPath, stamps);
+
+    StepOffsetsTable mappedTable;
+    ASSERT_TRUE(mappedTable.mapConsolidatedIndex(indexPath, stamps));
+    EXPECT_TRUE(mappedTable.isMappedConsolidatedIndex());
+    ASSERT_EQ(mappedTable.nodesCount(), 2u);
+    EXPECT_EQ(mappedTable.recordsCount(), 4u);
+    EXPECT_EQ(mappedTable.find(0, 20)->position, 2000);
+    EXPECT_EQ(mappedTable.find(0, 20)->sceneSize()->column, 10);
+    EXPECT_EQ(mappedTable.find(1, 10)->position, 100);
+    ASSERT_TRUE(mappedTable.commonSteps().has_value());
+    EXPECT_EQ(mappedTable.commonSteps()->size(), 2u);
+    EXPECT_FALSE(std::filesystem::exists(indexPath + ".tmp"));
+}
+
+// ============================================================================
+// Test 3: Outdated or damaged consolidated index is not used
+// ============================================================================
+TEST_F(StepOffsetsTableTest, OutdatedConsolidatedIndex)
+{
+    const auto indexPath = path("model_index.bin");
+    StepOffsetsTable mappedTable;
+    EXPECT_FALSE(mappedTable.mapConsolidatedIndex(indexPath, stamps)); // does not exist
+
+    table.writeConsolidatedIndex(indexPath, stamps);
+
+    auto changedStamps = stamps;
+    changedStamps[1].size += 1;
+    EXPECT_FALSE(mappedTable.mapConsolidatedIndex(indexPath, changedStamps));
+    changedStamps = stamps;
+    changedStamps[0].modificationTime += 1;
+    EXPECT_FALSE(mappedTable.mapConsolidatedIndex(indexPath, changedStamps));
+    EXPECT_FALSE(mappedTable.mapConsolidatedIndex(indexPath, { stamps[0] })); // different number of nodes
+
+    std::filesystem::resize_file(indexPath, std::filesystem::file_size(indexPath) - 1);
+    EXPECT_FALSE(mappedTable.mapConsolidatedIndex(indexPath, stamps));
+
+    std::ofstream(indexPath, std::ios::trunc) << "not an index";
+    EXPECT_FALSE(mappedTable.mapConsolidatedIndex(indexPath, stamps));
+    EXPECT_FALSE(mappedTable.isMappedConsolidatedIndex());
+}
+
+// ============================================================================
+// Test 4: Records appended while the simulation is running, steps of all nodes are updated
+// ============================================================================
+TEST_F(StepOffsetsTableTest, AppendedRecords)
+{
+    EXPECT_EQ(table.appendNodeRecords(0, std::vector{ record(30, 3000), record(40, 40) }), (std::vector<StepIndex>{ 30, 40 }));
+    EXPECT_TRUE(table.finishAppending({ 30, 40 }).empty()); // node 1 does not have them yet
+    EXPECT_FALSE(table.commonSteps().has_value());
+    EXPECT_EQ(table.completeSteps().size(), 2u);
+
+    // the last record is replaced (its line was not complete), other known steps are ignored
+    EXPECT_TRUE(table.appendNodeRecords(0, std::vector{ record(40, 4000), record(10, 1) }).empty());
+    EXPECT_EQ(table.find(0, 40)->position, 4000);
+    EXPECT_EQ(table.find(0, 10)->position, 1000);
+
+    EXPECT_EQ(table.appendNodeRecords(1, std::vector{ record(30, 300), record(40, 400), record(25, 250) }), (std::vector<StepIndex>{ 30, 40, 25 }));
+    EXPECT_EQ(table.finishAppending({ 30, 40, 25 }), (std::vector<StepIndex>{ 30, 40 }));
+    EXPECT_EQ(table.find(1, 25)->position, 250);
+    EXPECT_EQ(std::vector<StepIndex>(table.completeSteps().begin(), table.completeSteps().end()), (std::vector<StepIndex>{ 10, 20, 30, 40 }));
+    EXPECT_FALSE(table.commonSteps().has_value()); // step 25 is only in node 1
+
+    // records of mapped consolidated index are copied before they are appended
+    const auto indexPath = path("model_index.bin");
+    table.writeConsolidatedIndex(indexPath, stamps);
+    StepOffsetsTable mappedTable;
+    ASSERT_TRUE(mappedTable.mapConsolidatedIndex(indexPath, stamps));
+    EXPECT_EQ(mappedTable.completeSteps().size(), 4u);
+    EXPECT_EQ(mappedTable.appendNodeRecords(0, std::vector{ record(25, 2500) }), std::vector<StepIndex>{ 25 });
+    EXPECT_EQ(mappedTable.finishAppending({ 25 }), std::vector<StepIndex>{ 25 });
+    ASSERT_TRUE(mappedTable.commonSteps().has_value());
+    EXPECT_EQ(std::vector<StepIndex>(mappedTable.commonSteps()->begin(), mappedTable.commonSteps()->end()), (std::vector<StepIndex>{ 10, 20, 25, 30, 40 }));
+    EXPECT_EQ(mappedTable.find(0, 20)->position, 2000);
+    EXPECT_EQ(mappedTable.find(1, 40)->position, 400);
+}
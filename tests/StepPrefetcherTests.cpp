@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "data/CellGrid.hpp"
+#include "data/StepPrefetcher.hpp"
+
+/**
+ * Test Suite: StepPrefetcher
+ *
+ * This test suite verifies background read-ahead of steps used during playback:
+ * - prefetched step is swapped into the displayed matrix (together with lines),
+ * - steps which were not requested (or failed to read) have to be read directly,
+ * - depth of read-ahead grows when reading of a step takes longer than frame interval.
+ *
+ * Instead of ModelReader a fake reading function fills every cell with the step number.
+ */
+
+namespace
+{
+using Matrix = CellGrid<int>;
+
+constexpr int columns = 4;
+constexpr int rows = 3;
+constexpr int linesCount = 2;
+
+SettingParameter makeSettings()
+{
+    SettingParameter sp{};
+    sp.numberOfColumnX = columns;
+    sp.numberOfRowsY = rows;
+    sp.numberOfLines = linesCount;
+    return sp;
+}
+
+void fakeReadStep(Matrix& matrix, SettingParameter* sp, Line* lines)
+{
+    if (sp->step == 13)
+        throw std::runtime_error("step 13 is broken");
+
+    std::ranges::fill(matrix.cells(), static_cast<int>(sp->step));
+    for (int line = 0; line < sp->numberOfLines; ++line)
+        lines[line] = Line(static_cast<float>(sp->step), 0, 0, 0);
+}
+
+/// Step which was not started yet is read directly by take(), so tests wait until the background reading is finished
+void waitForStandbySteps(const StepPrefetcher<Matrix>& prefetcher, std::size_t count)
+{
+    using namespace std::chrono_literals;
+
+    const auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (prefetcher.standbyStepsCount() < count && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(1ms);
+}
+} // namespace
+
+// ============================================================================
+// Test 1: Prefetched step is swapped into the matrix
+// ============================================================================
+TEST(StepPrefetcher, TakesPrefetchedStep)
+{
+    std::atomic<int> readings = 0;
+    StepPrefetcher<Matrix> prefetcher(
+        [&](Matrix& matrix, SettingParameter* sp, Line* lines)
+        {
+            ++readings;
+            fakeReadStep(matrix, sp, lines);
+        });
+
+    prefetcher.prefetch(makeSettings(), { 1, 2, 3 });
+    waitForStandbySteps(prefetcher, 3);
+
+    Matrix matrix(columns, rows);
+    std::ranges::fill(matrix.cells(), -1);
+    std::vector<Line> lines(linesCount);
+    for (const StepIndex step : { 1u, 2u, 3u })
+    {
+        ASSERT_TRUE(prefetcher.take(step, matrix, lines.data(), lines.size())) << "step " << step;
+        EXPECT_TRUE(std::ranges::all_of(matrix.cells(), [step](int cell) { return cell == static_cast<int>(step); }));
+        EXPECT_EQ(lines[1].x1, static_cast<float>(step));
+    }
+    EXPECT_EQ(readings, 3);
+}
+
+// ============================================================================
+// Test 2: Not requested, failed or cleared steps are not taken
+// ============================================================================
+TEST(StepPrefetcher, StepsWhichAreNotAvailable)
+{
+    StepPrefetcher<Matrix> prefetcher(fakeReadStep);
+
+    Matrix matrix(columns, rows);
+    std::ranges::fill(matrix.cells(), -1);
+    std::vector<Line> lines(linesCount);
+
+    prefetcher.prefetch(makeSettings(), { 13, 14 });
+    waitForStandbySteps(prefetcher, 1);
+    EXPECT_FALSE(prefetcher.take(13, matrix, lines.data(), lines.size())); // reading failed
+    EXPECT_FALSE(prefetcher.take(20, matrix, lines.data(), lines.size())); // not requested
+    EXPECT_EQ(matrix[0][0], -1);
+
+    ASSERT_TRUE(prefetcher.take(14, matrix, lines.data(), lines.size()));
+    EXPECT_FALSE(prefetcher.take(14, matrix, lines.data(), lines.size())); // already taken
+
+    prefetcher.prefetch(makeSettings(), { 15 });
+    prefetcher.clear();
+    EXPECT_FALSE(prefetcher.take(15, matrix, lines.data(), lines.size()));
+
+    Matrix smallerMatrix(columns, rows - 1);
+    prefetcher.prefetch(makeSettings(), { 16 });
+    waitForStandbySteps(prefetcher, 1);
+    EXPECT_FALSE(prefetcher.take(16, smallerMatrix, lines.data(), lines.size())); // dimensions changed
+}
+
+// ============================================================================
+// Test 3: Depth of read-ahead adapts to reading time
+// ============================================================================
+TEST(StepPrefetcher, RecommendedDepth)
+{
+    using namespace std::chrono_literals;
+
+    StepPrefetcher<Matrix> prefetcher(
+        [](Matrix& matrix, SettingParameter* sp, Line* lines)
+        {
+            std::this_thread::sleep_for(20ms);
+            fakeReadStep(matrix, sp, lines);
+        });
+    EXPECT_EQ(prefetcher.recommendedDepth(100ms), StepPrefetcher<Matrix>::minimalDepth); // nothing measured yet
+
+    Matrix matrix(columns, rows);
+    std::ranges::fill(matrix.cells(), -1);
+    std::vector<Line> lines(linesCount);
+    prefetcher.prefetch(makeSettings(), { 1 });
+    waitForStandbySteps(prefetcher, 1);
+    ASSERT_TRUE(prefetcher.take(1, matrix, lines.data(), lines.size()));
+
+    EXPECT_GE(prefetcher.averageReadTime(), 20ms);
+    EXPECT_EQ(prefetcher.recommendedDepth(1000ms), StepPrefetcher<Matrix>::minimalDepth);
+    EXPECT_GE(prefetcher.recommendedDepth(5ms), 5u);
+    EXPECT_EQ(prefetcher.recommendedDepth(0ms), StepPrefetcher<Matrix>::maximalDepth);
+}
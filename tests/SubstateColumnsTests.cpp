@@ -0,0 +1,328 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "data/ActiveTiles.h"
+#include "data/CellGrid.hpp"
+#include "data/SubstateColumns.h"
+#include "data/SubstatePyramid.h"
+
+/**
+ * Test Suite: SubstateColumns
+ *
+ * This test suite verifies numeric values of substates extracted once for the displayed step:
+ * - cell encodings are converted like with std::stod, but cells which are not a number are NaN,
+ * - each field is extracted into own row-major column, columns of removed fields are dropped,
+ * - range of values skips NaN, noValue and (optionally) values which are not positive,
+ * - cells providing numeric substates (NumericSubstatesCell) are read without strings, field ids are resolved once,
+ * - ranges of values of tiles find tiles with values to display (ActiveTiles), tiles of noValue only are skipped,
+ * - levels of detail (SubstatePyramid) reduce 2x2 blocks into minimum, maximum and mean without skipped values,
+ *   they are persisted and read back only for the same data.
+ */
+
+namespace
+{
+/// Cell encoding its position: field "h" is row.column, field "z" is column (or text for the first column)
+struct FakeCell
+{
+    int row = 0;
+    int column = 0;
+
+    std::string stringEncoding(const char* fieldName) const
+    {
+        if (std::string(fieldName) == "h")
+            return std::to_string(row) + "." + std::to_string(column);
+        if (0 == column)
+            return "none";
+        return " " + std::to_string(column) + " ";
+    }
+};
+
+/// Cell with numeric substates: "h" is row, "z" is column, the string encoding is not a number
+struct NumericCell
+{
+    inline static int resolvedIds = 0;
+
+    int row = 0;
+    int column = 0;
+
+    void composeElement(char*) {}
+    std::string stringEncoding(const char*) const { return "not used"; }
+    Color outputValue(const char*, GlobalValueManager*) const { return Color(0, 0, 0); }
+    void startStep(int) {}
+
+    static int substateId(const char* fieldName)
+    {
+        ++resolvedIds;
+        const std::string name = fieldName;
+        return name == "h" ? 0 : (name == "z" ? 1 : -1);
+    }
+
+    double substateValue(int substateId) const
+    {
+        return 0 == substateId ? row : column;
+    }
+};
+static_assert(NumericSubstatesCell<NumericCell>);
+static_assert(! NumericSubstatesCell<FakeCell>);
+
+template<class Cell>
+CellGrid<Cell> makeMatrix(int columns, int rows)
+{
+    CellGrid<Cell> matrix(columns, rows);
+    for (int row = 0; row < rows; ++row)
+        for (int column = 0; column < columns; ++column)
+        {
+            matrix[row][column].row = row;
+            matrix[row][column].column = column;
+        }
+    return matrix;
+}
+} // namespace
+
+// ============================================================================
+// Test 1: Text is converted like std::stod, without exceptions
+// ============================================================================
+TEST(SubstateColumns, ParseValue)
+{
+    EXPECT_DOUBLE_EQ(SubstateColumn::parseValue("12.5"), 12.5);
+    EXPECT_DOUBLE_EQ(SubstateColumn::parseValue("  -3e2"), -300.0);
+    EXPECT_DOUBLE_EQ(SubstateColumn::parseValue("+7"), 7.0);
+    EXPECT_DOUBLE_EQ(SubstateColumn::parseValue("4.25 m"), 4.25); // the rest of text is ignored
+
+    EXPECT_TRUE(std::isnan(SubstateColumn::parseValue("")));
+    EXPECT_TRUE(std::isnan(SubstateColumn::parseValue("none")));
+    EXPECT_TRUE(std::isnan(SubstateColumn::parseValue("1e999")));
+}
+
+// ============================================================================
+// Test 2: Fields are extracted into row-major columns
+// ============================================================================
+TEST(SubstateColumns, ExtractFields)
+{
+    const auto matrix = makeMatrix<FakeCell>(3, 150); // more rows than processed by one task
+
+    SubstateColumns columns;
+    columns.extract(matrix, { "h", "z" });
+
+    const auto* h = columns.find("h", matrix);
+    ASSERT_NE(h, nullptr);
+    EXPECT_EQ(h->rows(), 150);
+    EXPECT_EQ(h->columns(), 3);
+    EXPECT_DOUBLE_EQ(h->value(149, 2), 149.2);
+    EXPECT_DOUBLE_EQ(h->values()[1 * 3 + 2], 1.2);
+
+    const auto* z = columns.find("z");
+    ASSERT_NE(z, nullptr);
+    EXPECT_TRUE(std::isnan(z->value(5, 0)));
+    EXPECT_DOUBLE_EQ(z->value(5, 1), 1.0);
+    EXPECT_EQ(columns.usedBytes(), 2 * 3 * 150 * sizeof(double));
+
+    EXPECT_EQ(columns.find("h", makeMatrix<FakeCell>(3, 10)), nullptr); // values are not from this matrix
+    EXPECT_TRUE(h->contains(149, 2));
+    EXPECT_FALSE(h->contains(150, 0));
+
+    columns.extract(matrix, { "z" });
+    EXPECT_EQ(columns.find("h"), nullptr);
+    EXPECT_NE(columns.find("z"), nullptr);
+
+    columns.clear();
+    EXPECT_EQ(columns.find("z"), nullptr);
+}
+
+// ============================================================================
+// Test 3: Range of values
+// ============================================================================
+TEST(SubstateColumns, ValueRange)
+{
+    const auto matrix = makeMatrix<FakeCell>(4, 2);
+
+    SubstateColumns columns;
+    columns.extract(matrix, { "z" });
+    const auto* z = columns.find("z");
+    ASSERT_NE(z, nullptr);
+
+    const auto range = z->valueRange();
+    ASSERT_TRUE(range.has_value());
+    EXPECT_DOUBLE_EQ(range->min, 1.0); // "none" of the first column is skipped
+    EXPECT_DOUBLE_EQ(range->max, 3.0);
+
+    const auto withoutNoValue = z->valueRange(/*skippedValue=*/3.0);
+    ASSERT_TRUE(withoutNoValue.has_value());
+    EXPECT_DOUBLE_EQ(withoutNoValue->max, 2.0);
+
+    columns.extract(matrix, { "h" });
+    const auto positive = columns.find("h")->valueRange(SubstateColumn::notANumber, /*onlyPositive=*/true);
+    ASSERT_TRUE(positive.has_value());
+    EXPECT_DOUBLE_EQ(positive->min, 0.1); // 0.0 is skipped
+
+    EXPECT_FALSE(SubstateColumn{}.valueRange().has_value());
+
+    EXPECT_TRUE(SubstateColumn::isNoValue(-9999.0, true, -9999.0));
+    EXPECT_FALSE(SubstateColumn::isNoValue(-9999.0, false, -9999.0));
+    EXPECT_FALSE(SubstateColumn::isNoValue(1.0, true, SubstateColumn::notANumber));
+}
+
+// ============================================================================
+// Test 4: Numeric substates of cells are read directly
+// ============================================================================
+TEST(SubstateColumns, NumericSubstatesCell)
+{
+    const auto matrix = makeMatrix<NumericCell>(5, 70);
+    NumericCell::resolvedIds = 0;
+
+    SubstateColumns columns;
+    columns.extract(matrix, { "h", "z", "unknown" });
+    columns.extract(matrix, { "h", "z", "unknown" }); // next step
+    EXPECT_EQ(NumericCell::resolvedIds, 3);            // names are resolved only once
+
+    EXPECT_DOUBLE_EQ(columns.find("h")->value(69, 4), 69.0);
+    EXPECT_DOUBLE_EQ(columns.find("z")->value(69, 4), 4.0);
+    EXPECT_TRUE(std::isnan(columns.find("unknown")->value(0, 0))); // string encoding is used for unknown field
+
+    EXPECT_DOUBLE_EQ(SubstateColumn::cellValue(matrix[3][2], "z"), 2.0);
+    EXPECT_DOUBLE_EQ(SubstateColumn::cellValue(makeMatrix<FakeCell>(3, 4)[3][2], "h"), 3.2);
+}
+
+// ============================================================================
+// Test 5: Tiles with values to display
+// ============================================================================
+TEST(SubstateColumns, ActiveTiles)
+{
+    const auto matrix = makeMatrix<NumericCell>(70, 40); // 3 x 2 tiles, the last ones are partial
+
+    SubstateColumns columns;
+    columns.extract(matrix, { "h", "z" });
+    const auto& h = *columns.find("h");
+    const auto& z = *columns.find("z");
+    ASSERT_EQ(z.tileColumns(), 3);
+    ASSERT_EQ(z.tileRows(), 2);
+
+    const auto lastTileRange = z.tileValueRange(1, 2);
+    ASSERT_TRUE(lastTileRange.has_value());
+    EXPECT_DOUBLE_EQ(lastTileRange->min, 64.0);
+    EXPECT_DOUBLE_EQ(lastTileRange->max, 69.0);
+    EXPECT_DOUBLE_EQ(h.tileValueRange(1, 0)->min, 32.0);
+    EXPECT_DOUBLE_EQ(h.tileValueRange(1, 0)->max, 39.0);
+
+    ActiveTiles tiles(z);
+    EXPECT_EQ(tiles.activeTilesCount(), 0u);
+
+    tiles.addValuesInRange(z, 31.0, 100.0, SubstateColumn::notANumber); // bounds are excluded
+    EXPECT_EQ(tiles.activeTilesCount(), 4u);
+    EXPECT_FALSE(tiles.isActiveCell(0, 31));
+    EXPECT_TRUE(tiles.isActiveCell(39, 32));
+    EXPECT_FALSE(tiles.isActiveTile(0, 3)); // outside of the grid
+    EXPECT_FALSE(tiles.isActiveTile(-1, 1));
+
+    tiles.addValuesInRange(h, 35.0, std::numeric_limits<double>::infinity(), SubstateColumn::notANumber);
+    EXPECT_EQ(tiles.activeTilesCount(), 5u);
+    EXPECT_TRUE(tiles.isActiveCell(39, 0));
+
+    tiles.addValuesInRange(h, SubstateColumn::notANumber, 100.0, SubstateColumn::notANumber); // minimum was not set
+    EXPECT_EQ(tiles.activeTilesCount(), 5u);
+
+    // tiles with noValue only are not active
+    const auto flat = makeMatrix<NumericCell>(1, 70);
+    columns.extract(flat, { "z" }); // all values are 0
+    const auto& flatZ = *columns.find("z");
+    ActiveTiles flatTiles(flatZ);
+    flatTiles.addValuesInRange(flatZ, -1.0, 1.0, /*skippedValue=*/0.0);
+    EXPECT_EQ(flatTiles.activeTilesCount(), 0u);
+    flatTiles.addValuesInRange(flatZ, -1.0, 1.0, SubstateColumn::notANumber);
+    EXPECT_EQ(flatTiles.activeTilesCount(), 3u);
+
+    EXPECT_THROW(tiles.addValuesInRange(flatZ, -1.0, 1.0, SubstateColumn::notANumber), std::invalid_argument);
+}
+
+// ============================================================================
+// Test 6: Levels of detail reduce 2x2 blocks
+// ============================================================================
+TEST(SubstateColumns, PyramidLevels)
+{
+    EXPECT_EQ(SubstatePyramid::levelsCountFor(256, 256), 0);
+    EXPECT_EQ(SubstatePyramid::levelsCountFor(257, 1), 1);
+    EXPECT_EQ(SubstatePyramid::levelsCountFor(20000, 20000), 7);
+
+    SubstateColumns columns;
+    columns.extract(makeMatrix<NumericCell>(5, 3), { "z" }); // value is column
+    const auto& z = *columns.find("z");
+
+    SubstatePyramid pyramid;
+    pyramid.build(z, 2, SubstateColumn::notANumber);
+    ASSERT_EQ(pyramid.levels(), 2);
+    ASSERT_EQ(pyramid.columns(1), 3);
+    ASSERT_EQ(pyramid.rows(1), 2);
+    ASSERT_EQ(pyramid.columns(2), 2);
+    ASSERT_EQ(pyramid.rows(2), 1);
+    EXPECT_TRUE(pyramid.matches(5, 3, SubstateColumn::notANumber));
+    EXPECT_FALSE(pyramid.matches(5, 3, 0.0));
+
+    const auto& first = pyramid.reduction(1, 0, 0);
+    EXPECT_FLOAT_EQ(first.min, 0.0f);
+    EXPECT_FLOAT_EQ(first.max, 1.0f);
+    EXPECT_FLOAT_EQ(first.mean, 0.5f);
+    EXPECT_EQ(first.count, 4u);
+    EXPECT_EQ(pyramid.reduction(1, 0, 2).count, 2u); // partial blocks at the edges
+    EXPECT_EQ(pyramid.reduction(1, 1, 2).count, 1u);
+    EXPECT_FLOAT_EQ(pyramid.reduction(1, 1, 2).mean, 4.0f);
+
+    EXPECT_EQ(pyramid.reduction(2, 0, 0).count, 12u); // reduced from blocks of the previous level
+    EXPECT_FLOAT_EQ(pyramid.reduction(2, 0, 0).mean, 1.5f);
+    EXPECT_FLOAT_EQ(pyramid.reduction(2, 0, 1).mean, 4.0f);
+
+    // skipped value (noValue) is not reduced, block of skipped values only is NaN
+    pyramid.build(z, 2, /*skippedValue=*/0.0);
+    EXPECT_EQ(pyramid.reduction(1, 0, 0).count, 2u);
+    EXPECT_FLOAT_EQ(pyramid.reduction(1, 0, 0).min, 1.0f);
+    EXPECT_FLOAT_EQ(pyramid.reduction(2, 0, 0).mean, 2.0f);
+    EXPECT_TRUE(pyramid.matches(5, 3, 0.0));
+
+    columns.extract(makeMatrix<NumericCell>(1, 3), { "z" });
+    pyramid.build(*columns.find("z"), 1, /*skippedValue=*/0.0);
+    EXPECT_EQ(pyramid.reduction(1, 0, 0).count, 0u);
+    EXPECT_TRUE(std::isnan(pyramid.reduction(1, 0, 0).mean));
+}
+
+// ============================================================================
+// Test 7: Levels of detail are persisted for the same data only
+// ============================================================================
+TEST(SubstateColumns, PyramidPersistence)
+{
+    const auto fileName = (std::filesystem::temp_directory_path() / SubstatePyramid::fileName("SubstateColumnsTests", 3, "z")).string();
+    EXPECT_TRUE(fileName.ends_with("SubstateColumnsTests_lod_z_3.lod"));
+
+    SubstateColumns columns;
+    columns.extract(makeMatrix<NumericCell>(5, 3), { "z" });
+    SubstatePyramid pyramid;
+    pyramid.build(*columns.find("z"), 2, /*skippedValue=*/0.0);
+    pyramid.save(fileName, /*sourceStamp=*/42);
+
+    SubstatePyramid loaded;
+    ASSERT_TRUE(loaded.load(fileName, 42, 5, 3, 2, 0.0));
+    ASSERT_EQ(loaded.levels(), 2);
+    EXPECT_TRUE(loaded.matches(5, 3, 0.0));
+    EXPECT_FLOAT_EQ(loaded.reduction(2, 0, 0).mean, pyramid.reduction(2, 0, 0).mean);
+    EXPECT_EQ(loaded.reduction(1, 1, 2).count, pyramid.reduction(1, 1, 2).count);
+
+    EXPECT_FALSE(loaded.load(fileName, 43, 5, 3, 2, 0.0)); // other data
+    EXPECT_EQ(loaded.levels(), 0);
+    EXPECT_FALSE(loaded.load(fileName, 42, 5, 4, 2, 0.0));
+    EXPECT_FALSE(loaded.load(fileName, 42, 5, 3, 1, 0.0));
+    EXPECT_FALSE(loaded.load(fileName, 42, 5, 3, 2, SubstateColumn::notANumber));
+    std::filesystem::remove(fileName);
+    EXPECT_FALSE(loaded.load(fileName, 42, 5, 3, 2, 0.0));
+
+    // pyramids of displayed fields
+    SubstatePyramids pyramids;
+    EXPECT_EQ(pyramids.find("z"), nullptr);
+    pyramids.pyramid("z").build(*columns.find("z"), 1, SubstateColumn::notANumber);
+    pyramids.pyramid("h");
+    ASSERT_NE(pyramids.find("z"), nullptr);
+    EXPECT_EQ(pyramids.find("h"), nullptr); // without levels
+    pyramids.keepOnly({ "h" });
+    EXPECT_EQ(pyramids.find("z"), nullptr);
+}
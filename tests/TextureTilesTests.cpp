@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+#include "visualiser/TextureTiles.h"
+
+/**
+ * Test Suite: TextureTiles
+ *
+ * This test suite verifies tiles of texture rendering of 2D grids:
+ * - the image of colors is split into tiles of at most maxTileSize x maxTileSize texels, a small grid is one tile,
+ * - tiles cover corners of cells (the same coordinates as cell rendering), rows of the image go from the bottom,
+ * - smaller blocks of levels of detail at the right and the bottom edge are cut by texture coordinates,
+ * - only texels of changed tiles are copied (and only such tiles are reported for upload).
+ */
+
+namespace
+{
+void expectRegion(const GridRegion& region, int firstColumn, int firstRow, int endColumn, int endRow)
+{
+    EXPECT_EQ(region.firstColumn, firstColumn);
+    EXPECT_EQ(region.firstRow, firstRow);
+    EXPECT_EQ(region.endColumn, endColumn);
+    EXPECT_EQ(region.endRow, endRow);
+}
+
+void expectGeometry(const TextureTiles::Tile& tile, double minX, double maxX, double minY, double maxY)
+{
+    EXPECT_DOUBLE_EQ(tile.minX, minX);
+    EXPECT_DOUBLE_EQ(tile.maxX, maxX);
+    EXPECT_DOUBLE_EQ(tile.minY, minY);
+    EXPECT_DOUBLE_EQ(tile.maxY, maxY);
+}
+
+void expectTextureCoordinates(const TextureTiles::Tile& tile, double minU, double maxU, double minV, double maxV)
+{
+    EXPECT_DOUBLE_EQ(tile.minU, minU);
+    EXPECT_DOUBLE_EQ(tile.maxU, maxU);
+    EXPECT_DOUBLE_EQ(tile.minV, minV);
+    EXPECT_DOUBLE_EQ(tile.maxV, maxV);
+}
+} // namespace
+
+// ============================================================================
+// Test 1: Tiles of cells
+// ============================================================================
+TEST(TextureTiles, TilesOfCells)
+{
+    const TextureTiles small(300, 200);
+    EXPECT_EQ(small.texelColumns(), 300);
+    EXPECT_EQ(small.texelRows(), 200);
+    ASSERT_EQ(small.tiles().size(), 1u);
+    expectRegion(small.tiles()[0].texels, 0, 0, 300, 200);
+    expectGeometry(small.tiles()[0], 0.0, 300.0, 0.0, 200.0);
+    expectTextureCoordinates(small.tiles()[0], 0.0, 1.0, 0.0, 1.0);
+
+    const TextureTiles large(2500, 1100, 1, 1024);
+    ASSERT_EQ(large.tiles().size(), 6u); // 3 tiles in a row, 2 rows of tiles
+    expectRegion(large.tiles()[0].texels, 0, 0, 1024, 1024);
+    expectRegion(large.tiles()[2].texels, 2048, 0, 2500, 1024);
+    expectRegion(large.tiles()[5].texels, 2048, 1024, 2500, 1100);
+    expectGeometry(large.tiles()[5], 2048.0, 2500.0, 1024.0, 1100.0);
+    expectTextureCoordinates(large.tiles()[5], 0.0, 1.0, 0.0, 1.0);
+
+    EXPECT_THROW(TextureTiles(0, 10), std::runtime_error);
+    EXPECT_THROW(TextureTiles(10, 10, 0), std::runtime_error);
+    EXPECT_THROW(TextureTiles(10, 10, 1, 0), std::runtime_error);
+}
+
+// ============================================================================
+// Test 2: Tiles of blocks of levels of detail
+// ============================================================================
+TEST(TextureTiles, TilesOfBlocks)
+{
+    // 10 x 10 cells in blocks of 4: 3 x 3 texels, the last column and the bottom row of blocks have 2 cells
+    const TextureTiles oneTile(10, 10, 4);
+    EXPECT_EQ(oneTile.texelColumns(), 3);
+    EXPECT_EQ(oneTile.texelRows(), 3);
+    ASSERT_EQ(oneTile.tiles().size(), 1u);
+    expectGeometry(oneTile.tiles()[0], 0.0, 10.0, 0.0, 10.0);
+    expectTextureCoordinates(oneTile.tiles()[0], 0.0, 10.0 / 12.0, 2.0 / 12.0, 1.0);
+
+    const TextureTiles fourTiles(10, 10, 4, 2);
+    ASSERT_EQ(fourTiles.tiles().size(), 4u);
+
+    const auto& bottomLeft = fourTiles.tiles()[0]; // the bottom row of blocks is cut
+    expectRegion(bottomLeft.texels, 0, 0, 2, 2);
+    expectGeometry(bottomLeft, 0.0, 8.0, 0.0, 6.0);
+    expectTextureCoordinates(bottomLeft, 0.0, 1.0, 0.25, 1.0);
+
+    const auto& topRight = fourTiles.tiles()[3]; // the right column of blocks is cut
+    expectRegion(topRight.texels, 2, 2, 3, 3);
+    expectGeometry(topRight, 8.0, 10.0, 6.0, 10.0);
+    expectTextureCoordinates(topRight, 0.0, 0.5, 0.0, 1.0);
+}
+
+// ============================================================================
+// Test 3: Copying of changed texels
+// ============================================================================
+TEST(TextureTiles, CopyChangedTexels)
+{
+    const TextureTiles tiles(3, 2, 1, 2); // tiles of columns [0, 2) and [2, 3)
+    ASSERT_EQ(tiles.tiles().size(), 2u);
+
+    std::vector<unsigned char> image(3 * 3 * 2);
+    for (std::size_t byte = 0; byte < image.size(); ++byte)
+        image[byte] = static_cast<unsigned char>(byte + 1);
+
+    std::vector<unsigned char> left(3 * 2 * 2, 0);
+    std::vector<unsigned char> right(3 * 1 * 2, 0);
+    EXPECT_TRUE(tiles.copyChangedTexels(image.data(), 0, left.data()));
+    EXPECT_TRUE(tiles.copyChangedTexels(image.data(), 1, right.data()));
+    EXPECT_EQ(left, (std::vector<unsigned char>{ 1, 2, 3, 4, 5, 6, 10, 11, 12, 13, 14, 15 }));
+    EXPECT_EQ(right, (std::vector<unsigned char>{ 7, 8, 9, 16, 17, 18 }));
+
+    // Nothing changed, nothing is uploaded
+    EXPECT_FALSE(tiles.copyChangedTexels(image.data(), 0, left.data()));
+    EXPECT_FALSE(tiles.copyChangedTexels(image.data(), 1, right.data()));
+
+    // The texel of the column 2 in the upper row changed, only the right tile is uploaded
+    image[3 * (3 + 2) + 1] = 200;
+    EXPECT_FALSE(tiles.copyChangedTexels(image.data(), 0, left.data()));
+    EXPECT_TRUE(tiles.copyChangedTexels(image.data(), 1, right.data()));
+    EXPECT_EQ(right[3 + 1], 200);
+}
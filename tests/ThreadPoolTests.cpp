@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "core/ThreadPool.h"
+
+/**
+ * Test Suite: ThreadPool
+ *
+ * This test suite verifies that parallelFor() of the shared pool:
+ * - executes every task exactly once,
+ * - rethrows exception thrown by a task (after all tasks are finished),
+ * - works when called from inside of a task (nested batches must not deadlock),
+ * - works after changing number of threads,
+ * - works while number of threads is changed by another thread.
+ */
+
+// ============================================================================
+// Test 1: Every task is executed exactly once
+// ============================================================================
+TEST(ThreadPool, ExecutesEveryTaskOnce)
+{
+    constexpr std::size_t tasksCount = 10'000;
+    std::vector<std::atomic<int>> executions(tasksCount);
+
+    ThreadPool::instance().parallelFor(tasksCount,
+                                       [&](std::size_t task)
+                                       {
+                                           ++executions[task];
+                                       });
+
+    for (std::size_t task = 0; task < tasksCount; ++task)
+        EXPECT_EQ(executions[task], 1) << "task " << task;
+}
+
+// ============================================================================
+// Test 2: Exception of a task is rethrown, other tasks are still executed
+// ============================================================================
+TEST(ThreadPool, RethrowsTaskException)
+{
+    std::atomic<int> executed = 0;
+
+    EXPECT_THROW(ThreadPool::instance().parallelFor(100,
+                                                    [&](std::size_t task)
+                                                    {
+                                                        ++executed;
+                                                        if (task == 42)
+                                                            throw std::runtime_error("task failed");
+                                                    }),
+                 std::runtime_error);
+
+    EXPECT_EQ(executed, 100);
+}
+
+// ============================================================================
+// Test 3: Nested parallelFor (e.g. node task splitting its rows)
+// ============================================================================
+TEST(ThreadPool, NestedParallelFor)
+{
+    constexpr std::size_t outerTasks = 64;
+    constexpr std::size_t innerTasks = 64;
+    std::atomic<std::size_t> sum = 0;
+
+    ThreadPool::instance().parallelFor(outerTasks,
+                                       [&](std::size_t)
+                                       {
+                                           ThreadPool::instance().parallelFor(innerTasks,
+                                                                              [&](std::size_t inner)
+                                                                              {
+                                                                                  sum += inner;
+                                                                              });
+                                       });
+
+    EXPECT_EQ(sum, outerTasks * (innerTasks * (innerTasks - 1) / 2));
+}
+
+// ============================================================================
+// Test 4: Changing number of threads
+// ============================================================================
+TEST(ThreadPool, SetThreadCount)
+{
+    auto& threadPool = ThreadPool::instance();
+
+    for (const unsigned threads : { 1u, 3u, 0u })
+    {
+        threadPool.setThreadCount(threads);
+        EXPECT_EQ(threadPool.threadCount(), threads ? threads : ThreadPool::defaultThreadCount());
+
+        std::vector<int> values(1000, 0);
+        threadPool.parallelFor(values.size(),
+                               [&](std::size_t task)
+                               {
+                                   values[task] = static_cast<int>(task);
+                               });
+
+        std::vector<int> expected(values.size());
+        std::iota(expected.begin(), expected.end(), 0);
+        EXPECT_EQ(values, expected);
+    }
+}
+
+// ============================================================================
+// Test 5: Changing number of threads while another thread runs batches
+// ============================================================================
+TEST(ThreadPool, SetThreadCountDuringParallelFor)
+{
+    auto& threadPool = ThreadPool::instance();
+
+    std::atomic<bool> done = false;
+    std::atomic<std::size_t> executedTasks = 0;
+    std::thread caller([&]
+                       {
+                           for (int batch = 0; batch < 200; ++batch)
+                           {
+                               threadPool.parallelFor(64,
+                                                      [&](std::size_t)
+                                                      {
+                                                          ++executedTasks;
+                                                      });
+                           }
+                           done = true;
+                       });
+
+    for (unsigned threads = 1; ! done; threads = threads % 4 + 1)
+        threadPool.setThreadCount(threads);
+    caller.join();
+
+    EXPECT_EQ(executedTasks, 200u * 64u);
+    threadPool.setThreadCount(0);
+}
@@ -0,0 +1,106 @@
+/** @file ColorProgram.cpp
+ * @brief Implementation of the ColorProgram class. */
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+
+#include "ColorProgram.h"
+
+
+namespace
+{
+/// @brief Channels of the hex color (#RRGGBB), colors of other formats are black, std::nullopt if a channel does not start with a hex digit
+std::optional<std::array<int, 3>> parseHexColor(const std::string& hex)
+{
+    std::array<int, 3> channels{};
+    if (hex.length() != 7 || hex[0] != '#')
+        return channels;
+
+    for (std::size_t channel = 0; channel < channels.size(); ++channel)
+    {
+        const char* first = hex.data() + 1 + 2 * channel;
+        if (std::from_chars(first, first + 2, channels[channel], 16).ec != std::errc{})
+            return std::nullopt;
+    }
+    return channels;
+}
+} // namespace
+
+
+std::optional<ColorProgram::Gradient> ColorProgram::Gradient::compile(const SubstateInfo& substateInfo)
+{
+    if (std::isnan(substateInfo.minValue) || std::isnan(substateInfo.maxValue))
+        return std::nullopt;
+
+    const auto minColor = parseHexColor(substateInfo.minColor);
+    const auto maxColor = parseHexColor(substateInfo.maxColor);
+    if (! minColor || ! maxColor)
+        return std::nullopt;
+
+    Gradient gradient;
+    gradient.minValue = substateInfo.minValue;
+    gradient.maxValue = substateInfo.maxValue;
+    if (substateInfo.noValueEnabled)
+        gradient.noValue = substateInfo.noValue;
+    if (gradient.maxValue > gradient.minValue)
+        gradient.indexScale = (gradientSize - 1) / (gradient.maxValue - gradient.minValue);
+
+    const auto [minRed, minGreen, minBlue] = *minColor;
+    const auto [maxRed, maxGreen, maxBlue] = *maxColor;
+    // the same interpolation as of values (truncated channels), only sampled at indexes of the table
+    for (int index = 0; index < gradientSize; ++index)
+    {
+        const auto channel = [index](int minChannel, int maxChannel)
+        {
+            return static_cast<std::uint8_t>(static_cast<int>(minChannel + (maxChannel - minChannel) * index / (gradientSize - 1.0)));
+        };
+        gradient.colors[index] = Color(channel(minRed, maxRed), channel(minGreen, maxGreen), channel(minBlue, maxBlue), 255);
+    }
+    return gradient;
+}
+
+ColorProgram::ColorProgram(const std::vector<const SubstateInfo*>& colorSubstateInfos, const Color& backgroundColor, const ColumnFinder& findColumn, const PyramidFinder& findPyramid)
+    : background{ backgroundColor }
+{
+    if (colorSubstateInfos.empty())
+    {
+        layers.emplace_back(); // default coloring of cells
+        return;
+    }
+
+    // Substates are tried by their display order, substates without order (and nullptr) after them in the given order
+    const auto precedence = [](const SubstateInfo* substateInfo)
+    {
+        if (! substateInfo)
+            return std::pair{ 2, 0 };
+        if (substateInfo->order < 0)
+            return std::pair{ 1, 0 };
+        return std::pair{ 0, substateInfo->order };
+    };
+    auto colorSubstateInfosSorted = colorSubstateInfos;
+    std::ranges::stable_sort(colorSubstateInfosSorted, std::ranges::less{}, precedence);
+
+    for (const auto substateInfo : colorSubstateInfosSorted)
+    {
+        Layer layer;
+        if (substateInfo)
+            layer.fieldName = substateInfo->name;
+
+        const bool hasCustomColors = substateInfo && ! substateInfo->minColor.empty() && ! substateInfo->maxColor.empty();
+        if (hasCustomColors)
+        {
+            layer.gradient = Gradient::compile(*substateInfo);
+            if (! layer.gradient)
+                continue; // it would not color any cell
+            layer.column = findColumn ? findColumn(*substateInfo) : nullptr;
+            layer.pyramid = findPyramid ? findPyramid(*substateInfo) : nullptr;
+        }
+        layers.push_back(std::move(layer));
+
+        if (! hasCustomColors)
+            break; // outputValue() colors every cell, next layers are never used
+    }
+}
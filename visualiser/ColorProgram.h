@@ -0,0 +1,143 @@
+/** @file ColorProgram.h
+ * @brief Declaration of the ColorProgram class - colouring of cells compiled once per refresh. */
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "OOpenCAL/base/Cell.h" // Color
+#include "data/SubstateColumns.h"
+#include "data/SubstatePyramid.h"
+#include "visualiser/SubstateInfo.h"
+
+
+/** @class ColorProgram
+ * @brief Colors of cells by substates chosen for coloring, prepared once for the whole grid.
+ *
+ * Layers are the substates in the order they are tried, the first layer giving a color colors the cell,
+ * a cell without color of any layer gets the background color. Layer of a substate with custom colors
+ * (minColor and maxColor) has its gradient with parsed colors, other layers color cells by outputValue().
+ * Before, every cell sorted the substates again and parsed hex colors with std::stoi (parse errors were
+ * exceptions caught per cell), so colouring of large grids was dominated by allocations and parsing.
+ * Values are taken from SubstateColumn when it is available, otherwise from the cell itself.
+ *
+ * Example usage:
+ * @code
+ * const ColorProgram program(colorSubstateInfos, backgroundColor, findColumn);
+ * for (int row = 0; row < rows; ++row)
+ *     for (int column = 0; column < columns; ++column)
+ *         draw(row, column, program.cellColor(row, column, p, gvm));
+ * @endcode */
+class ColorProgram
+{
+public:
+    static constexpr int gradientSize = 256; ///< Colors of a gradient, the same as the number of levels of a color channel
+
+    /** @class Gradient
+     * @brief Colors between minColor (at minValue) and maxColor (at maxValue) of a substate, sampled into a table. */
+    class Gradient
+    {
+    public:
+        /** @return Gradient of the substate with custom colors, std::nullopt if it can not color any value
+         *  (minValue or maxValue is not set, a color has not hex digits) */
+        static std::optional<Gradient> compile(const SubstateInfo& substateInfo);
+
+        /// @return Color of the value, nullptr for NaN, values out of the open interval (minValue, maxValue) and enabled noValue
+        const Color* colorOf(double value) const
+        {
+            // NaN fails both comparisons
+            if (! (value > minValue && value < maxValue) || value == noValue)
+                return nullptr;
+            return &colors[static_cast<std::size_t>((value - minValue) * indexScale + 0.5)];
+        }
+
+    private:
+        std::array<Color, gradientSize> colors;
+        double minValue = 0.0;
+        double maxValue = 0.0;
+        double noValue = SubstateColumn::notANumber; ///< NaN if noValue is disabled, so it does not equal any value
+        double indexScale = 0.0;                      ///< Converts distance from minValue into index of colors
+    };
+
+    using ColumnFinder = std::function<const SubstateColumn*(const SubstateInfo&)>;
+    using PyramidFinder = std::function<const SubstatePyramid*(const SubstateInfo&)>;
+
+    /** @brief Compiles layers of the substates sorted by SubstateInfo::order, layers which can not color any cell are left out.
+     *
+     * Substates without order follow in the given order.
+     *
+     * No substate means coloring by outputValue(nullptr, gvm), nullptr substate too.
+     * @param findColumn  Values of the substate (nullptr if they are not extracted), empty function if none are available
+     * @param findPyramid Reduced values of the substate used by blockColor() (nullptr if not available), empty function if none are available */
+    ColorProgram(const std::vector<const SubstateInfo*>& colorSubstateInfos, const Color& backgroundColor, const ColumnFinder& findColumn = {}, const PyramidFinder& findPyramid = {});
+
+    /// @return Color of the cell, background color if no layer colors it
+    template<class Matrix>
+    Color cellColor(int row, int column, const Matrix& p, GlobalValueManager* gvm) const
+    {
+        for (const auto& layer : layers)
+        {
+            if (const auto color = layerColor(layer, row, column, p, gvm))
+                return *color;
+        }
+        return background;
+    }
+
+    /** @return Color of the block (blockRow, blockColumn) of the level (see SubstatePyramid), gradient layers with reduced values
+     *  use mean of the block, other layers use the first cell of the block */
+    template<class Matrix>
+    Color blockColor(int level, int blockRow, int blockColumn, const Matrix& p, GlobalValueManager* gvm) const
+    {
+        const int row = blockRow << level;
+        const int column = blockColumn << level;
+        for (const auto& layer : layers)
+        {
+            if (layer.gradient && layer.pyramid && layer.pyramid->levels() >= level)
+            {
+                if (const Color* color = layer.gradient->colorOf(layer.pyramid->reduction(level, blockRow, blockColumn).mean))
+                    return *color;
+            }
+            else if (const auto color = layerColor(layer, row, column, p, gvm))
+                return *color;
+        }
+        return background;
+    }
+
+    const Color& backgroundColor() const
+    {
+        return background;
+    }
+
+private:
+    struct Layer
+    {
+        std::string fieldName;                   ///< Empty for default coloring
+        std::optional<Gradient> gradient;        ///< std::nullopt for coloring by outputValue()
+        const SubstateColumn* column = nullptr;
+        const SubstatePyramid* pyramid = nullptr;
+
+        const char* fieldNameOrNull() const
+        {
+            return fieldName.empty() ? nullptr : fieldName.c_str();
+        }
+    };
+
+    template<class Matrix>
+    static std::optional<Color> layerColor(const Layer& layer, int row, int column, const Matrix& p, GlobalValueManager* gvm)
+    {
+        if (! layer.gradient)
+            return p[row][column].outputValue(layer.fieldNameOrNull(), gvm);
+
+        const double value = layer.column ? layer.column->value(row, column) : SubstateColumn::cellValue(p[row][column], layer.fieldNameOrNull());
+        if (const Color* color = layer.gradient->colorOf(value))
+            return *color;
+        return std::nullopt;
+    }
+
+    std::vector<Layer> layers;
+    Color background;
+};
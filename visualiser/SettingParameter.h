@@ -30,6 +30,8 @@ struct SettingParameter
     std::string readMode;       ///< File read mode: "text" or "binary"
     std::string substates;      ///< Substates to read (e.g., "h,z")
     std::string reduction;      ///< Reduction operations (e.g., "sum,min,max")
+    int firstLB = -1;           ///< First step of load balancing (non-positive if unknown)
+    int stepLB = -1;            ///< Number of steps between load balancings (non-positive if unknown)
     
     /// @brief Map of substate information (name -> SubstateInfo) for display parameters
     std::map<std::string, SubstateInfo> substateInfo;
@@ -0,0 +1,68 @@
+/** @file TextureTiles.cpp
+ * @brief Implementation of the TextureTiles class. */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "TextureTiles.h"
+
+
+TextureTiles::TextureTiles(int nCols, int nRows, int blockSize, int maxTileSize)
+{
+    if (nCols <= 0 || nRows <= 0)
+        throw std::runtime_error("Texture of an empty grid can not be created!");
+    if (blockSize <= 0 || maxTileSize <= 0)
+        throw std::runtime_error("Size of blocks and tiles of a texture has to be positive!");
+
+    texelColumnsCount = (nCols + blockSize - 1) / blockSize;
+    texelRowsCount = (nRows + blockSize - 1) / blockSize;
+
+    // Blocks of the bottom row can be smaller, so texels are placed as if the image started below the grid
+    const double offsetY = static_cast<double>(texelRowsCount) * blockSize - nRows;
+
+    for (int firstRow = 0; firstRow < texelRowsCount; firstRow += maxTileSize)
+    {
+        const int endRow = std::min(firstRow + maxTileSize, texelRowsCount);
+        for (int firstColumn = 0; firstColumn < texelColumnsCount; firstColumn += maxTileSize)
+        {
+            const int endColumn = std::min(firstColumn + maxTileSize, texelColumnsCount);
+
+            Tile tile;
+            tile.texels = GridRegion{ .firstColumn = firstColumn, .firstRow = firstRow, .endColumn = endColumn, .endRow = endRow };
+
+            // Whole texels of the tile, then cut to the grid (the texture coordinates are cut in the same ratio)
+            const double texelsMinX = static_cast<double>(firstColumn) * blockSize;
+            const double texelsMaxX = static_cast<double>(endColumn) * blockSize;
+            const double texelsMinY = static_cast<double>(firstRow) * blockSize - offsetY;
+            const double texelsMaxY = static_cast<double>(endRow) * blockSize - offsetY;
+
+            tile.minX = texelsMinX;
+            tile.maxX = std::min(texelsMaxX, static_cast<double>(nCols));
+            tile.minY = std::max(texelsMinY, 0.0);
+            tile.maxY = texelsMaxY;
+            tile.maxU = (tile.maxX - texelsMinX) / (texelsMaxX - texelsMinX);
+            tile.minV = (tile.minY - texelsMinY) / (texelsMaxY - texelsMinY);
+
+            tilesOfImage.push_back(tile);
+        }
+    }
+}
+
+bool TextureTiles::copyChangedTexels(const unsigned char* image, std::size_t tileIndex, unsigned char* tileTexels) const
+{
+    const GridRegion& texels = tilesOfImage.at(tileIndex).texels;
+    const std::size_t rowBytes = 3 * static_cast<std::size_t>(texels.endColumn - texels.firstColumn);
+
+    bool changed = false;
+    for (int row = texels.firstRow; row < texels.endRow; ++row, tileTexels += rowBytes)
+    {
+        const unsigned char* imageRow = image + 3 * (static_cast<std::size_t>(row) * static_cast<std::size_t>(texelColumnsCount) + static_cast<std::size_t>(texels.firstColumn));
+        if (std::memcmp(tileTexels, imageRow, rowBytes) != 0)
+        {
+            std::memcpy(tileTexels, imageRow, rowBytes);
+            changed = true;
+        }
+    }
+    return changed;
+}
@@ -0,0 +1,78 @@
+/** @file TextureTiles.h
+ * @brief Declaration of the TextureTiles class - colors of the grid split into textures, which fit any OpenGL implementation. */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "core/types.h" // GridRegion
+
+
+/** @class TextureTiles
+ * @brief Layout of tiles of texture rendering (GridRenderingMode::Texture) and update of their texels.
+ *
+ * Colors of the grid are an RGB image, one texel per cell (or per block of 2^level x 2^level cells of levels of detail),
+ * rows of the image go from the bottom like rows of vtkImageData. The image is split into tiles of at most
+ * maxTileSize x maxTileSize texels, each tile is a texture on its own quad. Between steps only tiles whose texels changed
+ * are uploaded again (copyChangedTexels()), so e.g. flow simulations upload just the part of the grid where something flows.
+ *
+ * Geometry of tiles uses corners of cells (cell (row, column) covers x in [column, column + 1], y in [nRows - 1 - row, nRows - row]),
+ * blocks at the right and the bottom edge of the grid can be smaller, so their tiles are cut by texture coordinates. */
+class TextureTiles
+{
+public:
+    /** @brief Maximal edge of a tile in texels.
+     *
+     * OpenGL 3 requires every implementation to support textures of 1024 x 1024 texels (VTK needs OpenGL 3.2),
+     * so tiles fit also software OpenGL (llvmpipe) without asking the context, and smaller tiles make updates of changed tiles cheaper. */
+    static constexpr int defaultMaxTileSize = 1024;
+
+    struct Tile
+    {
+        GridRegion texels; ///< Texels of the image in the tile (rows counted from the bottom)
+
+        double minX = 0.0; ///< Part of the grid covered by the tile (corners of cells)
+        double maxX = 0.0;
+        double minY = 0.0;
+        double maxY = 0.0;
+
+        double minU = 0.0; ///< Texture coordinates of the covered part (less than the whole texture for cut blocks)
+        double maxU = 1.0;
+        double minV = 0.0;
+        double maxV = 1.0;
+    };
+
+    /** @brief Splits the image of colors of the grid into tiles.
+     * @param blockSize Cells of a texel in each direction (2^level for levels of detail, 1 for cells)
+     * @throws std::runtime_error for empty grid, non-positive block size or tile size */
+    TextureTiles(int nCols, int nRows, int blockSize = 1, int maxTileSize = defaultMaxTileSize);
+
+    /// @brief Columns of the image (one texel per block)
+    int texelColumns() const
+    {
+        return texelColumnsCount;
+    }
+
+    /// @brief Rows of the image (one texel per block)
+    int texelRows() const
+    {
+        return texelRowsCount;
+    }
+
+    const std::vector<Tile>& tiles() const
+    {
+        return tilesOfImage;
+    }
+
+    /** @brief Copies texels of the tile from the image into texels of the tile, rows which are the same are not written.
+     * @param image RGB texels of the whole image (texelColumns() x texelRows(), rows from the bottom)
+     * @param tileTexels RGB texels of the tile (its columns x its rows, rows from the bottom)
+     * @return true if any texel of the tile changed (the texture of the tile has to be uploaded again) */
+    bool copyChangedTexels(const unsigned char* image, std::size_t tileIndex, unsigned char* tileTexels) const;
+
+private:
+    int texelColumnsCount = 0;
+    int texelRowsCount = 0;
+    std::vector<Tile> tilesOfImage; ///< Row after row of tiles from the bottom
+};
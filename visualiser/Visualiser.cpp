@@ -1,4 +1,8 @@
+#include <algorithm>
 #include <limits>
+#include <vtkFloatArray.h>
+#include <vtkPlaneSource.h>
+#include <vtkTexture.h>
 #include "Line.h"
 #include "visualiser/Visualizer.hpp"
 #include "widgets/ColorSettings.h" // ColorSettings
@@ -10,6 +14,41 @@ vtkColor3d toVtkColor(QColor color)
 {
     return vtkColor3d{ color.redF(), color.greenF(), color.blueF() };
 }
+
+/// @return Quad of the tile at z = 1 (like grids of other rendering modes) with texture coordinates of the tile
+vtkSmartPointer<vtkPolyData> createTileQuad(const TextureTiles::Tile& tile)
+{
+    vtkNew<vtkPoints> points;
+    points->InsertNextPoint(tile.minX, tile.minY, 1);
+    points->InsertNextPoint(tile.maxX, tile.minY, 1);
+    points->InsertNextPoint(tile.maxX, tile.maxY, 1);
+    points->InsertNextPoint(tile.minX, tile.maxY, 1);
+
+    vtkNew<vtkFloatArray> textureCoordinates;
+    textureCoordinates->SetName("TextureCoordinates");
+    textureCoordinates->SetNumberOfComponents(2);
+    textureCoordinates->InsertNextTuple2(tile.minU, tile.minV);
+    textureCoordinates->InsertNextTuple2(tile.maxU, tile.minV);
+    textureCoordinates->InsertNextTuple2(tile.maxU, tile.maxV);
+    textureCoordinates->InsertNextTuple2(tile.minU, tile.maxV);
+
+    vtkNew<vtkCellArray> quads;
+    const vtkIdType corners[] = { 0, 1, 2, 3 };
+    quads->InsertNextCell(4, corners);
+
+    auto quad = vtkSmartPointer<vtkPolyData>::New();
+    quad->SetPoints(points);
+    quad->SetPolys(quads);
+    quad->GetPointData()->SetTCoords(textureCoordinates);
+    return quad;
+}
+
+/// @return RGB texels of the texture of the tile actor
+vtkUnsignedCharArray* tileTexels(vtkActor* tileActor)
+{
+    vtkImageData* image = tileActor->GetTexture()->GetInput();
+    return vtkUnsignedCharArray::SafeDownCast(image->GetPointData()->GetScalars());
+}
 } // namespace
 
 
@@ -178,69 +217,225 @@ void Visualizer::drawFlatSceneBackground(int nRows, int nCols, vtkSmartPointer<v
         return;
     }
 
-    const auto numberOfPoints = nRows * nCols;
-    vtkNew<vtkDoubleArray> pointValues;
-    pointValues->SetNumberOfTuples(numberOfPoints);
+    // Flat plane at Z=0 under centers of all cells, a single quad is enough for uniform color
+    vtkNew<vtkPlaneSource> plane;
+    plane->SetOrigin(0, 0, 0);
+    plane->SetPoint1(std::max(nCols - 1, 1), 0, 0); // not degenerated for a single row or column
+    plane->SetPoint2(0, std::max(nRows - 1, 1), 0);
+    plane->SetResolution(1, 1);
+
+    vtkNew<vtkPolyDataMapper> backgroundMapper;
+    backgroundMapper->SetInputConnection(plane->GetOutputPort());
+    backgroundMapper->ScalarVisibilityOff();
+
+    backgroundActor->SetMapper(backgroundMapper);
+    renderer->AddActor(backgroundActor);
+
+    refreshFlatSceneBackground(nRows, nCols, backgroundActor);
+}
+
+void Visualizer::refreshFlatSceneBackground(int /*nRows*/, int /*nCols*/, vtkSmartPointer<vtkActor> backgroundActor)
+{
+    // Validate input
+    if (! backgroundActor || ! backgroundActor->GetMapper())
+    {
+        return;
+    }
+
+    // Keep uniform color from settings - no need to update from cell data
+    const QColor sceneColor = ColorSettings::instance().flatSceneBackgroundColor();
+    backgroundActor->GetProperty()->SetColor(toVtkColor(sceneColor).GetData());
+}
 
-    // Set scalar values - all same value for uniform color
-    for (int row = 0; row < nRows; row++)
+void Visualizer::drawNotLoadedRegions(const std::vector<GridRegion>& regions, int nRows, GridRenderingMode renderingMode, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> placeholderActor)
+{
+    if (! renderer || ! placeholderActor)
     {
-        for (int col = 0; col < nCols; col++)
-        {
-            int pointIndex = row * nCols + col;
-            pointValues->SetValue(pointIndex, 0);  // All points have same value for uniform color
-        }
+        return;
     }
 
-    vtkNew<vtkLookupTable> lut;
-    lut->SetNumberOfTableValues(1);  // Only one color needed
+    // Slightly above the plane of 2D cells (Z=1), so cells of nodes which were not read are covered
+    constexpr double PLACEHOLDER_HEIGHT = 1.05;
 
-    // Set uniform color for the background plane from settings
-    const QColor sceneColor = ColorSettings::instance().flatSceneBackgroundColor();
-    lut->SetTableValue(0, sceneColor.redF(), sceneColor.greenF(), sceneColor.blueF(), 1.0);
+    // Cell (row, column) covers x in [column, column + 1], y in [nRows - 1 - row, nRows - row] (like TextureTiles),
+    // unless cell centers are points of the grid
+    const double cellOffset = (renderingMode == GridRenderingMode::Points) ? -0.5 : 0.0;
 
-    // Create flat plane at Z=0
     vtkNew<vtkPoints> points;
-    for (int row = 0; row < nRows; row++)
+    vtkNew<vtkCellArray> quads;
+    for (const auto& region : regions)
     {
-        for (int col = 0; col < nCols; col++)
-        {
-            // Z=0 for flat background plane
-            points->InsertNextPoint(/*x=*/col, /*y=*/nRows - 1 - row, /*z=*/0);
-        }
+        // rows are drawn from the top
+        const double left = region.firstColumn + cellOffset;
+        const double right = region.endColumn + cellOffset;
+        const double bottom = nRows - region.endRow + cellOffset;
+        const double top = nRows - region.firstRow + cellOffset;
+
+        const vtkIdType firstPoint = points->InsertNextPoint(left, bottom, PLACEHOLDER_HEIGHT);
+        points->InsertNextPoint(right, bottom, PLACEHOLDER_HEIGHT);
+        points->InsertNextPoint(right, top, PLACEHOLDER_HEIGHT);
+        points->InsertNextPoint(left, top, PLACEHOLDER_HEIGHT);
+
+        quads->InsertNextCell(4);
+        for (vtkIdType corner = 0; corner < 4; ++corner)
+            quads->InsertCellPoint(firstPoint + corner);
     }
 
-    vtkNew<vtkStructuredGrid> structuredGrid;
-    structuredGrid->SetDimensions(nCols, nRows, 1);
-    structuredGrid->SetPoints(points);
-    structuredGrid->GetPointData()->SetScalars(pointValues);
+    vtkNew<vtkPolyData> polyData;
+    polyData->SetPoints(points);
+    polyData->SetPolys(quads);
 
-    vtkNew<vtkDataSetMapper> backgroundMapper;
-    backgroundMapper->UpdateDataObject();
-    backgroundMapper->SetInputData(structuredGrid);
-    backgroundMapper->SetLookupTable(lut);
-    backgroundMapper->SetScalarRange(0, 0);  // Single color
+    vtkNew<vtkPolyDataMapper> mapper;
+    mapper->SetInputData(polyData);
+    placeholderActor->SetMapper(mapper);
 
-    backgroundActor->SetMapper(backgroundMapper);
-    renderer->AddActor(backgroundActor);
+    const QColor placeholderColor = ColorSettings::instance().flatSceneBackgroundColor().darker(150);
+    placeholderActor->GetProperty()->SetColor(toVtkColor(placeholderColor).GetData());
+    placeholderActor->GetProperty()->LightingOff();
+    placeholderActor->SetVisibility(! regions.empty());
+
+    if (! renderer->HasViewProp(placeholderActor))
+    {
+        renderer->AddActor(placeholderActor);
+    }
 }
 
-void Visualizer::refreshFlatSceneBackground(int nRows, int nCols, vtkSmartPointer<vtkActor> backgroundActor)
+vtkSmartPointer<vtkUnsignedCharArray> Visualizer::createColorScalars(vtkIdType count)
 {
-    // Validate input
-    if (! backgroundActor || ! backgroundActor->GetMapper())
+    auto colors = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    colors->SetName("Colors");
+    colors->SetNumberOfComponents(3);
+    colors->SetNumberOfTuples(count);
+    return colors;
+}
+
+void Visualizer::addGridActor(vtkDataSet* grid, bool useCellData, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> gridActor)
+{
+    vtkNew<vtkDataSetMapper> gridMapper;
+    gridMapper->UpdateDataObject();
+    gridMapper->SetInputData(grid);
+    // RGB scalars are colors themselves, they are not mapped through a lookup table
+    gridMapper->SetColorModeToDirectScalars();
+    gridMapper->ScalarVisibilityOn();
+    if (useCellData)
+        gridMapper->SetScalarModeToUseCellData();
+    else
+        gridMapper->SetScalarModeToUsePointData();
+    gridMapper->InterpolateScalarsBeforeMappingOff();
+
+    gridActor->SetMapper(gridMapper);
+    renderer->AddActor(gridActor);
+}
+
+vtkUnsignedCharArray* Visualizer::gridColorScalars(vtkActor* gridActor)
+{
+    vtkMapper* mapper = gridActor ? gridActor->GetMapper() : nullptr;
+    vtkDataSet* grid = mapper ? mapper->GetInput() : nullptr;
+    if (! grid)
+        return nullptr;
+
+    vtkDataArray* scalars = grid->GetCellData()->GetScalars();
+    if (! scalars)
+        scalars = grid->GetPointData()->GetScalars();
+    return vtkUnsignedCharArray::SafeDownCast(scalars);
+}
+
+void Visualizer::addTextureTileActors(int nRows, int nCols, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> gridActor)
+{
+    const unsigned char* image = textureColors->GetPointer(0);
+    const auto& tiles = textureTiles->tiles();
+    for (std::size_t tileIndex = 0; tileIndex < tiles.size(); ++tileIndex)
     {
+        const GridRegion& texels = tiles[tileIndex].texels;
+        const int tileColumns = texels.endColumn - texels.firstColumn;
+        const int tileRows = texels.endRow - texels.firstRow;
+
+        const auto tileColors = createColorScalars(static_cast<vtkIdType>(tileRows) * tileColumns);
+        tileColors->FillValue(0);
+        textureTiles->copyChangedTexels(image, tileIndex, tileColors->GetPointer(0));
+
+        vtkNew<vtkImageData> tileImage;
+        tileImage->SetDimensions(tileColumns, tileRows, 1);
+        tileImage->GetPointData()->SetScalars(tileColors);
+
+        // Nearest filtering keeps sharp boundaries of cells at any zoom, RGB bytes are colors themselves
+        vtkNew<vtkTexture> texture;
+        texture->SetInputData(tileImage);
+        texture->InterpolateOff();
+        texture->MipmapOff();
+        texture->RepeatOff();
+        texture->EdgeClampOn();
+        texture->SetColorModeToDirectScalars();
+
+        vtkNew<vtkPolyDataMapper> tileMapper;
+        tileMapper->SetInputData(createTileQuad(tiles[tileIndex]));
+        tileMapper->ScalarVisibilityOff();
+
+        auto tileActor = vtkSmartPointer<vtkActor>::New();
+        tileActor->SetMapper(tileMapper);
+        tileActor->SetTexture(texture);
+        tileActor->GetProperty()->LightingOff(); // texels are not shaded, white color of the actor keeps them exact
+        renderer->AddActor(tileActor);
+        textureTileActors.push_back(tileActor);
+    }
+
+    // The grid actor is hidden, its quad of the whole grid keeps bounds of the grid like in other rendering modes
+    vtkNew<vtkPolyDataMapper> gridMapper;
+    gridMapper->SetInputData(createTileQuad(TextureTiles::Tile{ .maxX = static_cast<double>(nCols), .maxY = static_cast<double>(nRows) }));
+    gridMapper->ScalarVisibilityOff();
+    gridActor->SetMapper(gridMapper);
+    gridActor->VisibilityOff();
+    renderer->AddActor(gridActor);
+
+    textureGridActor = gridActor;
+    textureRenderer = renderer;
+}
+
+void Visualizer::updateTextureTiles()
+{
+    if (! textureTiles || ! textureColors)
         return;
+
+    std::vector<vtkUnsignedCharArray*> texelsOfTiles;
+    texelsOfTiles.reserve(textureTileActors.size());
+    for (const auto& tileActor : textureTileActors)
+        texelsOfTiles.push_back(tileTexels(tileActor));
+
+    // Tiles are compared in parallel, VTK objects of changed tiles are modified afterwards on this thread
+    const unsigned char* image = textureColors->GetPointer(0);
+    std::vector<unsigned char> changedTiles(texelsOfTiles.size(), 0);
+    ThreadPool::instance().parallelFor(texelsOfTiles.size(),
+                                       [&](std::size_t tileIndex)
+                                       {
+                                           changedTiles[tileIndex] = textureTiles->copyChangedTexels(image, tileIndex, texelsOfTiles[tileIndex]->GetPointer(0));
+                                       });
+
+    for (std::size_t tileIndex = 0; tileIndex < changedTiles.size(); ++tileIndex)
+    {
+        if (changedTiles[tileIndex])
+        {
+            // The texture is uploaded again when its image is modified
+            texelsOfTiles[tileIndex]->Modified();
+            textureTileActors[tileIndex]->GetTexture()->GetInput()->Modified();
+        }
     }
+}
 
-    if (vtkLookupTable* lut = dynamic_cast<vtkLookupTable*>(backgroundActor->GetMapper()->GetLookupTable()))
+void Visualizer::removeTextureTiles(vtkActor* gridActor)
+{
+    if (textureRenderer)
     {
-        // Keep uniform color from settings - no need to update from cell data
-        const QColor sceneColor = ColorSettings::instance().flatSceneBackgroundColor();
-        lut->SetTableValue(0, sceneColor.redF(), sceneColor.greenF(), sceneColor.blueF(), 1.0);
-        backgroundActor->GetMapper()->SetLookupTable(lut);
-        backgroundActor->GetMapper()->Update();
+        for (const auto& tileActor : textureTileActors)
+            textureRenderer->RemoveActor(tileActor);
     }
+    textureTileActors.clear();
+    textureTiles.reset();
+    textureColors = nullptr;
+    textureGridActor = nullptr;
+    textureRenderer = nullptr;
+
+    if (gridActor)
+        gridActor->VisibilityOn();
 }
 
 Color Visualizer::flatSceneBackgroundColor() const
@@ -5,15 +5,18 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <vtkActor2D.h>
 #include <vtkCellArray.h>
 #include <vtkCoordinate.h>
 #include <vtkDataSetMapper.h>
 #include <vtkDoubleArray.h>
-#include <vtkLookupTable.h>
+#include <vtkImageData.h>
 #include <vtkNamedColors.h>
 #include <vtkNew.h>
 #include <vtkPointData.h>
@@ -22,19 +25,27 @@
 #include <vtkPolyDataMapper.h>
 #include <vtkPolyDataMapper2D.h>
 #include <vtkProperty2D.h>
+#include <vtkRectilinearGrid.h>
 #include <vtkRenderer.h>
-#include <vtkStructuredGrid.h>
 #include <vtkTextMapper.h>
 #include <vtkTextProperty.h>
 #include <vtkUnsignedCharArray.h>
+#include <vtkWeakPointer.h>
 #include <vtkPolyDataNormals.h>
 #include <vtkCellData.h>
 #include <vtkProperty.h>
 
-#include "core/types.h"    // StepIndex
+#include "core/types.h"    // StepIndex, GridRenderingMode
+#include "data/ActiveTiles.h"
+#include "data/SubstateColumns.h"
+#include "data/SubstatePyramid.h"
 #include "OOpenCAL/base/Cell.h" // Color
+#include "core/ThreadPool.h"
+#include "plugins/CellConcept.hpp" // SerialColoringCell
+#include "visualiser/ColorProgram.h"
 #include "visualiser/SettingParameter.h" // SubstateInfo
 #include "visualiser/Line.h"
+#include "visualiser/TextureTiles.h"
 
 
 /** @brief Converts a color channel value to a normalized range [0, 1].
@@ -59,6 +70,14 @@ inline double toUnitColor(double channel)
     return channel;
 }
 
+/** @brief Converts a color channel value (0–255 or 0–1 range, see toUnitColor()) to a byte of direct RGB scalars.
+ * @param channel The input color component.
+ * @return Color value in the range 0–255. */
+inline unsigned char toByteColor(double channel)
+{
+    return static_cast<unsigned char>(std::lround(std::clamp(toUnitColor(channel), 0.0, 1.0) * 255.0));
+}
+
 
 /** @class Visualizer
  * @brief Handles VTK-based visualization of simulation data.
@@ -70,7 +89,7 @@ class Visualizer
 {
 public:
     template<class Matrix>
-    void drawWithVTK(const Matrix& p, int nRows, int nCols, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos={}, bool useCellRendering=false);
+    void drawWithVTK(const Matrix& p, int nRows, int nCols, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos={}, GridRenderingMode renderingMode=GridRenderingMode::Points);
     template<class Matrix>
     void refreshWindowsVTK(const Matrix& p, int nRows, int nCols, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos);
 
@@ -104,34 +123,118 @@ public:
                                      double minValue,
                                      double maxValue);
 
-    /// @brief Draw flat background plane at Z=0 for 3D visualization.
+    /// @brief Draw flat background plane at Z=0 for 3D visualization (a single quad of uniform color).
     void drawFlatSceneBackground(int nRows, int nCols, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> backgroundActor);
-    /// @brief Refresh flat background plane colors.
+    /// @brief Refresh flat background plane color (from settings).
     void refreshFlatSceneBackground(int nRows, int nCols, vtkSmartPointer<vtkActor> backgroundActor);
 
+    /** @brief Covers parts of the grid, whose nodes were not read yet, with placeholder color (darker flat background color).
+     * The actor is added to the renderer when it is not there yet, it is hidden when there are no such parts.
+     * @param renderingMode Rendering mode of the grid, cells are centered on integer coordinates (Points) or start on them (Cells, Texture) */
+    void drawNotLoadedRegions(const std::vector<GridRegion>& regions, int nRows, GridRenderingMode renderingMode, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> placeholderActor);
+
     void buildLoadBalanceLine(const std::vector<Line>& lines, int nRows, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor2D> actorBuildLine);
     void refreshBuildLoadBalanceLine(const std::vector<Line> &lines, int nRows, vtkActor2D* lineActor);
     vtkTextProperty* buildStepLine(StepIndex step, vtkSmartPointer<vtkTextMapper> singleLineTextB);
     vtkNew<vtkActor2D> buildStepText(StepIndex step, int font_size, vtkSmartPointer<vtkTextMapper> stepLineTextMapper, vtkSmartPointer<vtkRenderer> renderer);
 
+    /** @brief Sets numeric values of substates extracted from the displayed matrix (owned by the caller).
+     *
+     * Substate values are read from the columns instead of converting cells with stringEncoding(),
+     * cells are converted only for fields which were not extracted. */
+    void setSubstateColumns(const SubstateColumns* columns)
+    {
+        substateColumns = columns;
+    }
+
+    /// @brief Sets reduced levels of substates of the displayed matrix (owned by the caller), see setDetailLevel()
+    void setSubstatePyramids(const SubstatePyramids* pyramids)
+    {
+        substatePyramids = pyramids;
+    }
+
+    /** @brief Sets level of detail of next drawWithVTK(): each block of 2^level x 2^level cells is drawn as one cell
+     *  colored by reduced values of substates (SubstatePyramid), 0 draws every cell. */
+    void setDetailLevel(int level)
+    {
+        detailLevel = std::max(level, 0);
+    }
+
 private:
     /// @brief Apply grid color settings to 3D grid lines actor.
     /// @note This function is to decrease dependencies with Qt (Visualiser.hpp is used in module compilation, so we don't want Qt)
     void applyGridColorTo3DGridLinesActor(vtkSmartPointer<vtkActor> gridLinesActor);
 
+    /** @brief Writes colors of cells into RGB scalars of the grid (in place, row after row from the bottom like points of vtkImageData).
+     *
+     * Scalars are mapped by the mapper in direct color mode, so there is neither color index nor lookup table entry per cell
+     * (3 bytes per cell instead of 8 bytes of index and 32 bytes of lookup table). */
+    template<class Matrix>
+    void buidColor(vtkUnsignedCharArray* colors, int nCols, int nRows, const Matrix& p, const std::vector<const SubstateInfo*>& colorSubstateInfos);
+
+    /** @brief Draws blocks of 2^drawnDetailLevel x 2^drawnDetailLevel cells instead of cells (see setDetailLevel()).
+     *  Blocks at the right and the bottom edge of the grid can be smaller. */
+    template<class Matrix>
+    void drawReducedWithVTK(const Matrix& p, int nRows, int nCols, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos, bool useCellRendering);
+
+    /// @brief Colors of blocks drawn by drawReducedWithVTK() (RGB scalars row after row from the bottom)
     template<class Matrix>
-    void buidColor(vtkLookupTable* lut, int nCols, int nRows, const Matrix& p, const std::vector<const SubstateInfo*>& colorSubstateInfos);
+    void buildReducedColor(vtkUnsignedCharArray* colors, int nCols, int nRows, const Matrix& p, const std::vector<const SubstateInfo*>& colorSubstateInfos);
+
+    static constexpr int rowsPerColoringTask = 32; ///< Rows colored by one task of the shared ThreadPool
+
+    /** @brief Calls function(firstRow, endRow) for blocks of rows covering [0, rowsCount), blocks are colored in parallel.
+     *
+     * Colors of cells are independent, so blocks run on the shared ThreadPool. Grids of cells which declare
+     * that their outputValue() is not thread-safe (SerialColoringCell) are colored serially on the calling thread.
+     * @tparam Matrix Type of the colored matrix (its cells decide between parallel and serial coloring) */
+    template<class Matrix, class Function>
+    static void forEachColoringRowBlock(int rowsCount, const Function& function);
+
+    /// @brief Creates RGB scalars (one tuple per cell or block), which are mapped in direct color mode
+    static vtkSmartPointer<vtkUnsignedCharArray> createColorScalars(vtkIdType count);
+
+    /// @brief Writes the color into a tuple of RGB scalars
+    static void setColorScalar(unsigned char* rgb, const Color& color)
+    {
+        rgb[0] = toByteColor(color.getRed());
+        rgb[1] = toByteColor(color.getGreen());
+        rgb[2] = toByteColor(color.getBlue());
+    }
+
+    /** @brief Draws the grid with RGB scalars in direct color mode (no lookup table).
+     *  @param grid Grid with implicit geometry (vtkImageData or vtkRectilinearGrid), so no point of it is stored
+     *  @param useCellData Scalars are colors of cells of the grid, otherwise of its points */
+    static void addGridActor(vtkDataSet* grid, bool useCellData, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> gridActor);
+
+    /// @return RGB scalars of the grid drawn by drawWithVTK() (colors of cells or points), nullptr if the actor does not draw such grid
+    static vtkUnsignedCharArray* gridColorScalars(vtkActor* gridActor);
 
-    /// @brief The method is calculating color for specific cell with substateInfo considered
+    /** @brief Draws colors of the grid as textures of tiles (GridRenderingMode::Texture, see TextureTiles),
+     *  texels are blocks of drawnDetailLevel when levels of detail are used. */
     template<class Matrix>
-    Color calculateCellColor(int row, int column, const Matrix &p, const std::vector<const SubstateInfo*>& colorSubstateInfos);
+    void drawTexturedWithVTK(const Matrix& p, int nRows, int nCols, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos);
+
+    /** @brief Adds textured quads of textureTiles with colors from textureColors to the renderer.
+     *  The grid actor gets a hidden quad of the whole grid, so its bounds (e.g. for ruler axes) are the same as in other modes. */
+    void addTextureTileActors(int nRows, int nCols, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> gridActor);
+
+    /// @brief Copies changed colors from textureColors into tiles, textures of other tiles are not uploaded again
+    void updateTextureTiles();
+
+    /// @brief Removes textured quads of the last texture rendering from the renderer, the grid actor is visible again
+    void removeTextureTiles(vtkActor* gridActor);
 
-    /// @brief Calculate color for a specific cell, returning std::optional<Color>.
-    /// Returns nullopt if the value is out of range, equals noValue, or parsing fails.
-    /// Otherwise returns the calculated color.
-    /// This method is useful for aggregating colors from multiple substates.
+    /// @return true if the grid actor was drawn in texture mode by the last drawWithVTK()
+    bool isTextureGrid(vtkActor* gridActor) const
+    {
+        return gridActor && gridActor == textureGridActor.GetPointer();
+    }
+
+    /** @brief Compiles coloring by the substates for one refresh of the matrix (values of substates from substate columns).
+     *  @param level Level of detail of colored blocks, reduced values of substates of the level are used by ColorProgram::blockColor() */
     template<class Matrix>
-    std::optional<Color> calculateCellColorOptional(int row, int column, const Matrix &p, const SubstateInfo* substateInfo=nullptr);
+    ColorProgram compileColorProgram(const Matrix& p, const std::vector<const SubstateInfo*>& colorSubstateInfos, int level = 0) const;
 
     /** @brief Build 3D quad mesh surface for 3D substate visualization (healed quad approach).
      * 
@@ -170,147 +273,267 @@ private:
 
     /// @brief This function is to decrease dependencies with Qt (Visualiser.hpp is used in module compilation, so we don't want Qt)
     Color flatSceneBackgroundColor() const;
+
+    /// @return Extracted values of the substate field of the matrix or nullptr if they are not available
+    template<class Matrix>
+    const SubstateColumn* findSubstateColumn(const std::string& fieldName, const Matrix& p) const
+    {
+        return substateColumns ? substateColumns->find(fieldName, p) : nullptr;
+    }
+
+    /** @return Reduced levels of the substate reaching the level, nullptr if they are not available or they do not match
+     *  the matrix and the current noValue of the substate (it can be changed without reading the step again) */
+    template<class Matrix>
+    const SubstatePyramid* findSubstatePyramid(const SubstateInfo& substateInfo, int level, const Matrix& p) const
+    {
+        const auto* pyramid = substatePyramids ? substatePyramids->find(substateInfo.name) : nullptr;
+        if (! pyramid || pyramid->levels() < level || p.size() == 0)
+            return nullptr;
+        const double skippedValue = substateInfo.noValueEnabled ? substateInfo.noValue : SubstateColumn::notANumber;
+        if (! pyramid->matches(static_cast<int>(p[0].size()), static_cast<int>(p.size()), skippedValue))
+            return nullptr;
+        return pyramid;
+    }
+
+    /** @return Tiles in which cells can get color of a substate (other cells have background color), std::nullopt if all cells
+     *  have to be colored (default coloring by cells or values of a substate are not available). */
+    template<class Matrix>
+    std::optional<ActiveTiles> findColoredTiles(const Matrix& p, const std::vector<const SubstateInfo*>& colorSubstateInfos) const;
+
+    /** @return Tiles with values of the substate greater than minValue (only such cells have height in 3D),
+     *  std::nullopt if values of the substate are not available. */
+    template<class Matrix>
+    std::optional<ActiveTiles> findRaisedTiles(const Matrix& p, int nRows, int nCols, const std::string& substateFieldName, double minValue) const;
+
+    /// @return Value of the substate field of the cell (from the column if it is available), NaN if it is not a number
+    template<class Matrix>
+    static double substateValue(int row, int column, const Matrix& p, const SubstateColumn* substateColumn, const char* fieldName)
+    {
+        if (substateColumn)
+            return substateColumn->value(row, column);
+        return SubstateColumn::cellValue(p[row][column], fieldName);
+    }
+
     GlobalValueManager* gvm;
+    const SubstateColumns* substateColumns = nullptr;
+    const SubstatePyramids* substatePyramids = nullptr;
+    int detailLevel = 0;      ///< Level used by next drawWithVTK()
+    int drawnDetailLevel = 0; ///< Level of the grid drawn by the last drawWithVTK() (refreshWindowsVTK() updates colors of it)
+
+    std::optional<TextureTiles> textureTiles;                  ///< Tiles of the grid drawn in texture mode
+    std::vector<vtkSmartPointer<vtkActor>> textureTileActors; ///< Textured quads of textureTiles (in the same order)
+    vtkSmartPointer<vtkUnsignedCharArray> textureColors;      ///< Colors of the whole grid, copied into changed tiles
+    vtkWeakPointer<vtkActor> textureGridActor;                ///< Grid actor drawn in texture mode
+    vtkWeakPointer<vtkRenderer> textureRenderer;              ///< Renderer of textureTileActors
 };
 
 ////////////////////////////////////////////////////////////////////
 
 template <class Matrix>
-void Visualizer::drawWithVTK(const Matrix &p, int nRows, int nCols, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos, bool useCellRendering)
+void Visualizer::drawWithVTK(const Matrix &p, int nRows, int nCols, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos, GridRenderingMode renderingMode)
 {
-    // Runtime switch between high-quality cell rendering (true)
-    // and faster point-based rendering (false).
+    // Runtime switch between high-quality cell rendering, faster point-based rendering
+    // and texture rendering of very large grids.
     // This parameter is passed from the GUI to allow user control.
+    const bool useCellRendering = (renderingMode == GridRenderingMode::Cells);
 
-    if (useCellRendering)
-    {
-        const auto numberOfCells = nRows * nCols;
-        vtkNew<vtkDoubleArray> cellValues;
-        cellValues->SetNumberOfTuples(numberOfCells);
+    removeTextureTiles(gridActor);
 
-        // Set scalar values for cells (one color per cell, no interpolation)
-        for (int row = 0; row < nRows; row++)
-        {
-            for (int col = 0; col < nCols; col++)
-            {
-                const int cellId = row * nCols + col;
-                const int colorIndex = (nRows - 1 - row) * nCols + col; // Color index from buidColor()
-                cellValues->SetValue(cellId, colorIndex);
-            }
-        }
+    drawnDetailLevel = detailLevel;
+    if (renderingMode == GridRenderingMode::Texture)
+    {
+        drawTexturedWithVTK(p, nRows, nCols, renderer, gridActor, colorSubstateInfos);
+        return;
+    }
+    if (drawnDetailLevel > 0)
+    {
+        drawReducedWithVTK(p, nRows, nCols, renderer, gridActor, colorSubstateInfos, useCellRendering);
+        return;
+    }
 
-        vtkNew<vtkLookupTable> lut;
-        lut->SetNumberOfTableValues(numberOfCells);
+    const auto colors = createColorScalars(static_cast<vtkIdType>(nRows) * nCols);
+    buidColor(colors, nCols, nRows, p, colorSubstateInfos);
 
-        vtkNew<vtkPoints> points;
-        for (int row = 0; row <= nRows; row++)
-        {
-            for (int col = 0; col <= nCols; col++)
-            {
-                // Insert points with Y inverted to match buidColor() indexing
-                points->InsertNextPoint(/*x=*/col, /*y=*/nRows - row, /*z=*/1); /// z is not used
-            }
-        }
+    // Geometry of the grid is implicit (origin and spacing), rows of the image go from the bottom,
+    // so the first row of the matrix is at the top
+    vtkNew<vtkImageData> image;
+    image->SetOrigin(0, 0, 1); /// z is not used
+    image->SetSpacing(1, 1, 1);
+    if (useCellRendering)
+    {
+        // One color per cell (cell corners are points of the image), no interpolation: sharp cell boundaries for small grids
+        image->SetDimensions(nCols + 1, nRows + 1, 1);
+        image->GetCellData()->SetScalars(colors);
+    }
+    else
+    {
+        // Original point-based rendering (cell centers are points of the image): faster and suitable for large grids.
+        image->SetDimensions(nCols, nRows, 1);
+        image->GetPointData()->SetScalars(colors);
+    }
 
-        vtkNew<vtkStructuredGrid> structuredGrid;
-        structuredGrid->SetDimensions(nCols + 1, nRows + 1, 1);
-        structuredGrid->SetPoints(points);
-        structuredGrid->GetCellData()->SetScalars(cellValues);
+    addGridActor(image, /*useCellData=*/useCellRendering, renderer, gridActor);
+}
 
-        buidColor(lut, nCols, nRows, p, colorSubstateInfos);
+template<class Matrix>
+void Visualizer::refreshWindowsVTK(const Matrix &p, int nRows, int nCols, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos)
+{
+    if (isTextureGrid(gridActor))
+    {
+        // Colors of the whole grid are calculated, but only textures of changed tiles are uploaded
+        if (drawnDetailLevel > 0)
+            buildReducedColor(textureColors, nCols, nRows, p, colorSubstateInfos);
+        else
+            buidColor(textureColors, nCols, nRows, p, colorSubstateInfos);
+        updateTextureTiles();
+        return;
+    }
 
-        vtkNew<vtkDataSetMapper> gridMapper;
-        gridMapper->UpdateDataObject();
-        gridMapper->SetInputData(structuredGrid);
-        gridMapper->SetLookupTable(lut);
-        gridMapper->SetScalarRange(0, numberOfCells - 1);
-        gridMapper->SetScalarModeToUseCellData();
-        gridMapper->InterpolateScalarsBeforeMappingOff(); // Keep sharp cell boundaries for small grids
+    vtkUnsignedCharArray* colors = gridColorScalars(gridActor);
+    if (! colors)
+        throw std::runtime_error("The grid actor has no RGB scalars to refresh!");
 
-        gridActor->SetMapper(gridMapper);
-        renderer->AddActor(gridActor);
-    }
+    // Colors are updated in place, the grid itself is not built again
+    if (drawnDetailLevel > 0)
+        buildReducedColor(colors, nCols, nRows, p, colorSubstateInfos);
     else
-    {
-        // Original point-based rendering: faster and suitable for large grids.
-        const auto numberOfPoints = nRows * nCols;
-        vtkNew<vtkDoubleArray> pointValues;
-        pointValues->SetNumberOfTuples(numberOfPoints);
-
-        // Set scalar values: points are inserted in order (row, col), but colors are indexed by (nRows - 1 - row) * nCols + col
-        // So we need to map point index to color index
-        for (int row = 0; row < nRows; row++)
-        {
-            for (int col = 0; col < nCols; col++)
-            {
-                int pointIndex = row * nCols + col;  // Sequential point index
-                int colorIndex = (nRows - 1 - row) * nCols + col;  // Color index from buidColor()
-                pointValues->SetValue(pointIndex, colorIndex);
-            }
-        }
+        buidColor(colors, nCols, nRows, p, colorSubstateInfos);
+    gridActor->GetMapper()->Update();
+}
+
+template<class Matrix>
+void Visualizer::drawTexturedWithVTK(const Matrix& p, int nRows, int nCols, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos)
+{
+    textureTiles.emplace(nCols, nRows, 1 << drawnDetailLevel);
+    textureColors = createColorScalars(static_cast<vtkIdType>(textureTiles->texelRows()) * textureTiles->texelColumns());
 
-        vtkNew<vtkLookupTable> lut;
-        lut->SetNumberOfTableValues(numberOfPoints);
+    // Texels are colors of cells or blocks, rows from the bottom like in other rendering modes
+    if (drawnDetailLevel > 0)
+        buildReducedColor(textureColors, nCols, nRows, p, colorSubstateInfos);
+    else
+        buidColor(textureColors, nCols, nRows, p, colorSubstateInfos);
 
-        vtkNew<vtkPoints> points;
-        for (int row = 0; row < nRows; row++)
-        {
-            for (int col = 0; col < nCols; col++)
-            {
-                // Insert points with Y inverted to match buidColor() indexing
-                // buidColor() uses (nRows - 1 - row) so points must be positioned accordingly
-                points->InsertNextPoint(/*x=*/col, /*y=*/nRows - 1 - row, /*z=*/1); /// z is not used
-            }
-        }
+    addTextureTileActors(nRows, nCols, renderer, gridActor);
+}
 
-        vtkNew<vtkStructuredGrid> structuredGrid;
-        structuredGrid->SetDimensions(nCols, nRows, 1);
-        structuredGrid->SetPoints(points);
-        structuredGrid->GetPointData()->SetScalars(pointValues);
+template<class Matrix>
+void Visualizer::buidColor(vtkUnsignedCharArray* colors, int nCols, int nRows, const Matrix &p, const std::vector<const SubstateInfo*>& colorSubstateInfos)
+{
+    if (colors->GetNumberOfTuples() != static_cast<vtkIdType>(nRows) * nCols)
+        throw std::runtime_error("Number of RGB scalars does not match dimensions of the grid!");
+
+    // Cells outside of colored tiles (e.g. noValue background of flow simulations) are not calculated
+    const auto coloredTiles = findColoredTiles(p, colorSubstateInfos);
+    const auto colorProgram = compileColorProgram(p, colorSubstateInfos);
+    const auto& backgroundColor = colorProgram.backgroundColor();
+
+    unsigned char* const rgbOfCells = colors->GetPointer(0);
+    forEachColoringRowBlock<Matrix>(nRows,
+                                    [&](int firstRow, int endRow)
+                                    {
+                                        for (int r = firstRow; r < endRow; ++r)
+                                        {
+                                            unsigned char* rgb = rgbOfCells + 3 * static_cast<std::size_t>(nRows - 1 - r) * static_cast<std::size_t>(nCols);
+                                            for (int c = 0; c < nCols; ++c, rgb += 3)
+                                            {
+                                                const bool isBackground = coloredTiles && ! coloredTiles->isActiveCell(r, c);
+                                                setColorScalar(rgb, isBackground ? backgroundColor : colorProgram.cellColor(r, c, p, gvm));
+                                            }
+                                        }
+                                    });
+    colors->Modified();
+}
 
-        buidColor(lut, nCols, nRows, p, colorSubstateInfos);
+template<class Matrix, class Function>
+void Visualizer::forEachColoringRowBlock(int rowsCount, const Function& function)
+{
+    using Cell = std::remove_cvref_t<decltype(std::declval<const Matrix&>()[0][0])>;
 
-        vtkNew<vtkDataSetMapper> gridMapper;
-        gridMapper->UpdateDataObject();
-        gridMapper->SetInputData(structuredGrid);
-        gridMapper->SetLookupTable(lut);
-        gridMapper->SetScalarRange(0, numberOfPoints - 1);
-        gridMapper->InterpolateScalarsBeforeMappingOff();
+    const auto tasksCount = (static_cast<std::size_t>(std::max(rowsCount, 0)) + rowsPerColoringTask - 1) / rowsPerColoringTask;
+    const auto colorRowBlock = [&](std::size_t task)
+    {
+        const int firstRow = static_cast<int>(task) * rowsPerColoringTask;
+        function(firstRow, std::min(rowsCount, firstRow + rowsPerColoringTask));
+    };
 
-        gridActor->SetMapper(gridMapper);
-        renderer->AddActor(gridActor);
+    if (SerialColoringCell<Cell> || tasksCount <= 1)
+    {
+        for (std::size_t task = 0; task < tasksCount; ++task)
+            colorRowBlock(task);
     }
+    else
+        ThreadPool::instance().parallelFor(tasksCount, colorRowBlock);
 }
 
 template<class Matrix>
-void Visualizer::refreshWindowsVTK(const Matrix &p, int nRows, int nCols, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos)
+void Visualizer::drawReducedWithVTK(const Matrix& p, int nRows, int nCols, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos, bool useCellRendering)
 {
-    if (vtkLookupTable* lut = dynamic_cast<vtkLookupTable*>(gridActor->GetMapper()->GetLookupTable()))
+    const int blockSize = 1 << drawnDetailLevel;
+    const int blockColumns = (nCols + blockSize - 1) / blockSize;
+    const int blockRows = (nRows + blockSize - 1) / blockSize;
+    const auto numberOfBlocks = blockRows * blockColumns;
+
+    const auto blockColors = createColorScalars(numberOfBlocks);
+    buildReducedColor(blockColors, nCols, nRows, p, colorSubstateInfos);
+
+    // Blocks at the right and the bottom edge can be smaller, so coordinates of blocks are given per axis
+    // (rectilinear grid, its rows go from the bottom like colors from buildReducedColor())
+    vtkNew<vtkDoubleArray> xCoordinates;
+    vtkNew<vtkDoubleArray> yCoordinates;
+    vtkNew<vtkDoubleArray> zCoordinates;
+    zCoordinates->InsertNextValue(1);
+    vtkNew<vtkRectilinearGrid> grid;
+    if (useCellRendering)
     {
-        buidColor(lut, nCols, nRows, p, colorSubstateInfos);
-        gridActor->GetMapper()->SetLookupTable(lut);
-        gridActor->GetMapper()->Update();
+        // Corners of blocks, the same coordinates as corners of cells in drawWithVTK()
+        for (int col = 0; col <= blockColumns; ++col)
+            xCoordinates->InsertNextValue(std::min(col * blockSize, nCols));
+        for (int row = blockRows; row >= 0; --row)
+            yCoordinates->InsertNextValue(nRows - std::min(row * blockSize, nRows));
+        grid->SetDimensions(blockColumns + 1, blockRows + 1, 1);
+        grid->GetCellData()->SetScalars(blockColors);
     }
     else
-        throw std::runtime_error("Invalid dynamic cast!");
+    {
+        // Centers of blocks, the same coordinates as centers of cells in drawWithVTK()
+        for (int col = 0; col < blockColumns; ++col)
+            xCoordinates->InsertNextValue((col * blockSize + std::min((col + 1) * blockSize, nCols) - 1) / 2.0);
+        for (int row = blockRows - 1; row >= 0; --row)
+            yCoordinates->InsertNextValue(nRows - 1 - (row * blockSize + std::min((row + 1) * blockSize, nRows) - 1) / 2.0);
+        grid->SetDimensions(blockColumns, blockRows, 1);
+        grid->GetPointData()->SetScalars(blockColors);
+    }
+    grid->SetXCoordinates(xCoordinates);
+    grid->SetYCoordinates(yCoordinates);
+    grid->SetZCoordinates(zCoordinates);
+
+    addGridActor(grid, /*useCellData=*/useCellRendering, renderer, gridActor);
 }
 
 template<class Matrix>
-void Visualizer::buidColor(vtkLookupTable* lut, int nCols, int nRows, const Matrix &p, const std::vector<const SubstateInfo*>& colorSubstateInfos)
+void Visualizer::buildReducedColor(vtkUnsignedCharArray* colors, int nCols, int nRows, const Matrix& p, const std::vector<const SubstateInfo*>& colorSubstateInfos)
 {
-    for (int r = 0; r < nRows; ++r)
-    {
-        for (int c = 0; c < nCols; ++c)
-        {
-            const auto color = calculateCellColor(r, c, p, colorSubstateInfos);
-            lut->SetTableValue(
-                (nRows - 1 - r) * nCols + c,
-                toUnitColor(color.getRed()),
-                toUnitColor(color.getGreen()),
-                toUnitColor(color.getBlue())
-            );
-        }
-    }
+    const int blockSize = 1 << drawnDetailLevel;
+    const int blockColumns = (nCols + blockSize - 1) / blockSize;
+    const int blockRows = (nRows + blockSize - 1) / blockSize;
+    if (colors->GetNumberOfTuples() != static_cast<vtkIdType>(blockRows) * blockColumns)
+        throw std::runtime_error("Number of RGB scalars does not match blocks of the grid!");
+
+    const auto colorProgram = compileColorProgram(p, colorSubstateInfos, drawnDetailLevel);
+    unsigned char* const rgbOfBlocks = colors->GetPointer(0);
+    forEachColoringRowBlock<Matrix>(blockRows,
+                                    [&](int firstBlockRow, int endBlockRow)
+                                    {
+                                        for (int blockRow = firstBlockRow; blockRow < endBlockRow; ++blockRow)
+                                        {
+                                            unsigned char* rgb = rgbOfBlocks + 3 * static_cast<std::size_t>(blockRows - 1 - blockRow) * static_cast<std::size_t>(blockColumns);
+                                            for (int blockColumn = 0; blockColumn < blockColumns; ++blockColumn, rgb += 3)
+                                            {
+                                                setColorScalar(rgb, colorProgram.blockColor(drawnDetailLevel, blockRow, blockColumn, p, gvm));
+                                            }
+                                        }
+                                    });
+    colors->Modified();
 }
 
 template<class Matrix>
@@ -384,114 +607,52 @@ void Visualizer::refreshGridLinesOn3DSurface(const Matrix& p,
 }
 
 template<class Matrix>
-Color Visualizer::calculateCellColor(int row, int column, const Matrix &p, const std::vector<const SubstateInfo*>& colorSubstateInfos)
+std::optional<ActiveTiles> Visualizer::findColoredTiles(const Matrix& p, const std::vector<const SubstateInfo*>& colorSubstateInfos) const
 {
     if (colorSubstateInfos.empty())
-    {
-        auto optionalColor = calculateCellColorOptional(row, column, p);
-        if (optionalColor.has_value())
-        {
-            return optionalColor.value();
-        }
-        else
-        {
-            // Return flat scene background color for noValue or out of range
-            return flatSceneBackgroundColor();
-        }
-    }
+        return std::nullopt;
 
-    auto orderCompare = [](const SubstateInfo* lhs, const SubstateInfo* rhs)
+    std::optional<ActiveTiles> coloredTiles;
+    for (const auto substateInfo : colorSubstateInfos)
     {
-        return lhs->order > rhs->order;
-    };
-    auto colorSubstateInfosSorted = colorSubstateInfos; // TODO: GB: It is better to sort once, not for each cell
-    std::ranges::sort(colorSubstateInfosSorted);
+        // Without custom colors cells are colored by outputValue(), which can color any cell
+        if (! substateInfo || substateInfo->minColor.empty() || substateInfo->maxColor.empty())
+            return std::nullopt;
 
-    for (const auto colorSubstateInfo : colorSubstateInfosSorted)
-    {
-        auto optionalColor = calculateCellColorOptional(row, column, p, colorSubstateInfo);
-        if (optionalColor.has_value())
-        {
-            return optionalColor.value();
-        }
-    }
+        const SubstateColumn* substateColumn = findSubstateColumn(substateInfo->name, p);
+        if (! substateColumn)
+            return std::nullopt;
+
+        if (! coloredTiles)
+            coloredTiles.emplace(*substateColumn);
 
-    // Return flat scene background color for noValue or out of range
-    return flatSceneBackgroundColor();
+        // the same conditions as in ColorProgram::Gradient::colorOf()
+        const double noValue = substateInfo->noValueEnabled ? substateInfo->noValue : SubstateColumn::notANumber;
+        coloredTiles->addValuesInRange(*substateColumn, substateInfo->minValue, substateInfo->maxValue, noValue);
+    }
+    return coloredTiles;
 }
 
 template<class Matrix>
-std::optional<Color> Visualizer::calculateCellColorOptional(int row, int column, const Matrix &p, const SubstateInfo* substateInfo)
+std::optional<ActiveTiles> Visualizer::findRaisedTiles(const Matrix& p, int nRows, int nCols, const std::string& substateFieldName, double minValue) const
 {
-    // If substateInfo with colors is provided, use gradient coloring
-    if (substateInfo && ! substateInfo->minColor.empty() && ! substateInfo->maxColor.empty())
-    {
-        // Get substate value for this cell
-        const char* fieldNamePtr = substateInfo->name.empty() ? nullptr : substateInfo->name.c_str();
-        std::string cellValue = p[row][column].stringEncoding(fieldNamePtr);
+    const SubstateColumn* substateColumn = findSubstateColumn(substateFieldName, p);
+    if (! substateColumn || substateColumn->rows() != nRows || substateColumn->columns() != nCols)
+        return std::nullopt;
 
-        try
-        {
-            double value = std::stod(cellValue);
-            double minVal = substateInfo->minValue;
-            double maxVal = substateInfo->maxValue;
-
-            // Check if value is noValue (out of range or equals noValue)
-            if (std::isnan(minVal) || std::isnan(maxVal))
-            {
-                // Min/max not set - return nullopt
-                return std::nullopt;
-            }
-            else if (substateInfo->noValueEnabled && !std::isnan(substateInfo->noValue) && value == substateInfo->noValue)
-            {
-                // Value equals noValue and noValue filtering is enabled
-                return std::nullopt;
-            }
-            else if (value <= minVal || value >= maxVal)
-            {
-                // Value out of range
-                return std::nullopt;
-            }
-
-            // Normalize value to [0, 1]
-            double normalized = (value - minVal) / (maxVal - minVal);
-
-            // Parse min and max colors (hex format: #RRGGBB)
-            auto parseHexColor = [](const std::string& hex) -> std::tuple<int, int, int> {
-                if (hex.length() != 7 || hex[0] != '#')
-                    return {0, 0, 0};
-                int r = std::stoi(hex.substr(1, 2), nullptr, 16);
-                int g = std::stoi(hex.substr(3, 2), nullptr, 16);
-                int b = std::stoi(hex.substr(5, 2), nullptr, 16);
-                return {r, g, b};
-            };
-
-            auto [minR, minG, minB] = parseHexColor(substateInfo->minColor);
-            auto [maxR, maxG, maxB] = parseHexColor(substateInfo->maxColor);
-
-            // Interpolate between min and max colors
-            int r = static_cast<int>(minR + (maxR - minR) * normalized);
-            int g = static_cast<int>(minG + (maxG - minG) * normalized);
-            int b = static_cast<int>(minB + (maxB - minB) * normalized);
+    ActiveTiles raisedTiles(*substateColumn);
+    raisedTiles.addValuesInRange(*substateColumn, minValue, std::numeric_limits<double>::infinity(), SubstateColumn::notANumber);
+    return raisedTiles;
+}
 
-            return Color(static_cast<std::uint8_t>(r), static_cast<std::uint8_t>(g), static_cast<std::uint8_t>(b), 255);
-        }
-        catch (const std::exception&)
-        {
-            // Failed to parse value - return nullopt
-            return std::nullopt;
-        }
-    }
-    else
-    {
-        // No custom colors configured - use outputValue coloring
-        // If substateInfo is provided but no custom colors, use the substate field name
-        // Otherwise use nullptr for default coloring
-        const char* fieldNamePtr = (substateInfo && !substateInfo->name.empty())
-                                       ? substateInfo->name.c_str()
-                                       : nullptr;
-        return p[row][column].outputValue(fieldNamePtr, gvm);
-    }
+template<class Matrix>
+ColorProgram Visualizer::compileColorProgram(const Matrix& p, const std::vector<const SubstateInfo*>& colorSubstateInfos, int level) const
+{
+    return ColorProgram(
+        colorSubstateInfos,
+        flatSceneBackgroundColor(),
+        [&](const SubstateInfo& substateInfo) { return findSubstateColumn(substateInfo.name, p); },
+        [&](const SubstateInfo& substateInfo) { return level > 0 ? findSubstatePyramid(substateInfo, level, p) : nullptr; });
 }
 
 ////////////////////////////////////////////////////////////////////
@@ -513,24 +674,15 @@ vtkSmartPointer<vtkPolyData> Visualizer::build3DSubstateSurfaceQuadMesh(const Ma
     const double eps = 1e-9;
 
     // Helper lambda to get cell value
+    const SubstateColumn* substateColumn = findSubstateColumn(substateFieldName, p);
     auto getCellValue = [&](int row, int col) -> double {
         if (row < 0 || row >= nRows || col < 0 || col >= nCols)
             return minValue;
-        
-        try {
-            std::string cellValueStr = p[row][col].stringEncoding(substateFieldName.c_str());
-            double cellValue = std::stod(cellValueStr);
-            return std::clamp(cellValue, minValue, maxValue);
-        } catch (...) {
-            return minValue;
-        }
-    };
 
-    // Helper lambda to get cell color using calculateCellColor for proper custom color handling
-    auto getCellColor = [&](int row, int col) -> Color {
-        if (row < 0 || row >= nRows || col < 0 || col >= nCols)
-            return Color(0, 0, 0);
-        return calculateCellColor(row, col, p, colorSubstateInfos);
+        const double cellValue = substateValue(row, col, p, substateColumn, substateFieldName.c_str());
+        if (std::isnan(cellValue))
+            return minValue;
+        return std::clamp(cellValue, minValue, maxValue);
     };
 
     // Helper lambda to check if value is valid (not no-data)
@@ -558,21 +710,17 @@ vtkSmartPointer<vtkPolyData> Visualizer::build3DSubstateSurfaceQuadMesh(const Ma
     vtkNew<vtkUnsignedCharArray> cellColors;
     cellColors->SetNumberOfComponents(3);
 
-    // Build base points (one per grid location)
+    // Base points (one per grid location) are inserted when they are used by a quad
     std::vector<vtkIdType> basePointId(nRows * nCols, -1);
-    
-    for (int row = 0; row < nRows; row++)
-    {
-        for (int col = 0; col < nCols; col++)
+    auto getBasePoint = [&](int row, int col) -> vtkIdType {
+        vtkIdType& pid = basePointId[row * nCols + col];
+        if (pid < 0)
         {
-            double z0 = getCellValue(row, col);
-            double height = valueToHeight(z0);
             auto [x, y] = gridToVtk(row, col);
-            
-            vtkIdType pid = points->InsertNextPoint(x, y, height);
-            basePointId[row * nCols + col] = pid;
+            pid = points->InsertNextPoint(x, y, valueToHeight(getCellValue(row, col)));
         }
-    }
+        return pid;
+    };
 
     // Helper lambda to add virtual point (for healed quads)
     auto addVirtualPoint = [&](int row, int col, double zraw) -> vtkIdType {
@@ -581,67 +729,106 @@ vtkSmartPointer<vtkPolyData> Visualizer::build3DSubstateSurfaceQuadMesh(const Ma
         return points->InsertNextPoint(x, y, height);
     };
 
-    // Build quad cells (healed quad approach)
-    for (int row = 0; row + 1 < nRows; row++)
+    // Only quads with a corner in a tile with values above minValue can be valid
+    const auto raisedTiles = findRaisedTiles(p, nRows, nCols, substateFieldName, minValue);
+
+    // Colors of valid corners (the only ones averaged into quads) are calculated at first, in parallel
+    const auto colorProgram = compileColorProgram(p, colorSubstateInfos);
+    std::vector<Color> cornerColors(static_cast<std::size_t>(nRows) * static_cast<std::size_t>(nCols));
+    forEachColoringRowBlock<Matrix>(nRows,
+                                    [&](int firstRow, int endRow)
+                                    {
+                                        for (int row = firstRow; row < endRow; ++row)
+                                        {
+                                            for (int col = 0; col < nCols; ++col)
+                                            {
+                                                if ((! raisedTiles || raisedTiles->isActiveCell(row, col)) && isValidValue(getCellValue(row, col)))
+                                                    cornerColors[static_cast<std::size_t>(row) * nCols + col] = colorProgram.cellColor(row, col, p, gvm);
+                                            }
+                                        }
+                                    });
+    auto getCellColor = [&](int row, int col) -> const Color& {
+        return cornerColors[static_cast<std::size_t>(row) * nCols + col];
+    };
+    constexpr int tileSize = ActiveTiles::tileSize;
+    auto hasQuadsToBuild = [&](int tileRow, int tileCol) -> bool {
+        // quads of the tile have corners also in the tiles on the right and below
+        return ! raisedTiles
+               || raisedTiles->isActiveTile(tileRow, tileCol) || raisedTiles->isActiveTile(tileRow, tileCol + 1)
+               || raisedTiles->isActiveTile(tileRow + 1, tileCol) || raisedTiles->isActiveTile(tileRow + 1, tileCol + 1);
+    };
+
+    // Build quad cells (healed quad approach), tile after tile
+    for (int tileRow = 0; tileRow * tileSize < nRows; ++tileRow)
     {
-        for (int col = 0; col + 1 < nCols; col++)
+        for (int tileCol = 0; tileCol * tileSize < nCols; ++tileCol)
         {
-            // Get the four corner values
-            double z0 = getCellValue(row, col);
-            double z1 = getCellValue(row, col + 1);
-            double z2 = getCellValue(row + 1, col + 1);
-            double z3 = getCellValue(row + 1, col);
-
-            bool v0 = isValidValue(z0);
-            bool v1 = isValidValue(z1);
-            bool v2 = isValidValue(z2);
-            bool v3 = isValidValue(z3);
-
-            int validCount = (int)v0 + (int)v1 + (int)v2 + (int)v3;
-
-            // Healed quad: if at least 2 valid corners, fill missing with average
-            if (validCount < 2)
+            if (! hasQuadsToBuild(tileRow, tileCol))
                 continue;
-
-            // Calculate average of valid corners
-            double sum = 0.0;
-            if (v0) sum += z0;
-            if (v1) sum += z1;
-            if (v2) sum += z2;
-            if (v3) sum += z3;
-            double avg = sum / std::max(1, validCount);
-
-            // Get or create point IDs
-            vtkIdType ids[4];
-            ids[0] = v0 ? basePointId[row * nCols + col] : addVirtualPoint(row, col, avg);
-            ids[1] = v1 ? basePointId[row * nCols + (col + 1)] : addVirtualPoint(row, col + 1, avg);
-            ids[2] = v2 ? basePointId[(row + 1) * nCols + (col + 1)] : addVirtualPoint(row + 1, col + 1, avg);
-            ids[3] = v3 ? basePointId[(row + 1) * nCols + col] : addVirtualPoint(row + 1, col, avg);
-
-            // Create quad cell
-            cells->InsertNextCell(4);
-            cells->InsertCellPoint(ids[0]);
-            cells->InsertCellPoint(ids[1]);
-            cells->InsertCellPoint(ids[2]);
-            cells->InsertCellPoint(ids[3]);
-
-            // Add color (use average of valid corner colors)
-            Color c0 = getCellColor(row, col);
-            Color c1 = getCellColor(row, col + 1);
-            Color c2 = getCellColor(row + 1, col + 1);
-            Color c3 = getCellColor(row + 1, col);
-
-            int rSum = 0, gSum = 0, bSum = 0;
-            if (v0) { rSum += c0.getRed(); gSum += c0.getGreen(); bSum += c0.getBlue(); }
-            if (v1) { rSum += c1.getRed(); gSum += c1.getGreen(); bSum += c1.getBlue(); }
-            if (v2) { rSum += c2.getRed(); gSum += c2.getGreen(); bSum += c2.getBlue(); }
-            if (v3) { rSum += c3.getRed(); gSum += c3.getGreen(); bSum += c3.getBlue(); }
-
-            unsigned char r = static_cast<unsigned char>(rSum / validCount);
-            unsigned char g = static_cast<unsigned char>(gSum / validCount);
-            unsigned char b = static_cast<unsigned char>(bSum / validCount);
-
-            cellColors->InsertNextTuple3(r, g, b);
+            const int lastRow = std::min((tileRow + 1) * tileSize, nRows - 1);
+            const int lastCol = std::min((tileCol + 1) * tileSize, nCols - 1);
+            for (int row = tileRow * tileSize; row < lastRow; row++)
+            {
+                for (int col = tileCol * tileSize; col < lastCol; col++)
+                {
+                    // Get the four corner values
+                    double z0 = getCellValue(row, col);
+                    double z1 = getCellValue(row, col + 1);
+                    double z2 = getCellValue(row + 1, col + 1);
+                    double z3 = getCellValue(row + 1, col);
+
+                    bool v0 = isValidValue(z0);
+                    bool v1 = isValidValue(z1);
+                    bool v2 = isValidValue(z2);
+                    bool v3 = isValidValue(z3);
+
+                    int validCount = (int)v0 + (int)v1 + (int)v2 + (int)v3;
+
+                    // Healed quad: if at least 2 valid corners, fill missing with average
+                    if (validCount < 2)
+                        continue;
+
+                    // Calculate average of valid corners
+                    double sum = 0.0;
+                    if (v0) sum += z0;
+                    if (v1) sum += z1;
+                    if (v2) sum += z2;
+                    if (v3) sum += z3;
+                    double avg = sum / std::max(1, validCount);
+
+                    // Get or create point IDs
+                    vtkIdType ids[4];
+                    ids[0] = v0 ? getBasePoint(row, col) : addVirtualPoint(row, col, avg);
+                    ids[1] = v1 ? getBasePoint(row, col + 1) : addVirtualPoint(row, col + 1, avg);
+                    ids[2] = v2 ? getBasePoint(row + 1, col + 1) : addVirtualPoint(row + 1, col + 1, avg);
+                    ids[3] = v3 ? getBasePoint(row + 1, col) : addVirtualPoint(row + 1, col, avg);
+
+                    // Create quad cell
+                    cells->InsertNextCell(4);
+                    cells->InsertCellPoint(ids[0]);
+                    cells->InsertCellPoint(ids[1]);
+                    cells->InsertCellPoint(ids[2]);
+                    cells->InsertCellPoint(ids[3]);
+
+                    // Add color (use average of valid corner colors)
+                    const Color& c0 = getCellColor(row, col);
+                    const Color& c1 = getCellColor(row, col + 1);
+                    const Color& c2 = getCellColor(row + 1, col + 1);
+                    const Color& c3 = getCellColor(row + 1, col);
+
+                    int rSum = 0, gSum = 0, bSum = 0;
+                    if (v0) { rSum += c0.getRed(); gSum += c0.getGreen(); bSum += c0.getBlue(); }
+                    if (v1) { rSum += c1.getRed(); gSum += c1.getGreen(); bSum += c1.getBlue(); }
+                    if (v2) { rSum += c2.getRed(); gSum += c2.getGreen(); bSum += c2.getBlue(); }
+                    if (v3) { rSum += c3.getRed(); gSum += c3.getGreen(); bSum += c3.getBlue(); }
+
+                    unsigned char r = static_cast<unsigned char>(rSum / validCount);
+                    unsigned char g = static_cast<unsigned char>(gSum / validCount);
+                    unsigned char b = static_cast<unsigned char>(bSum / validCount);
+
+                    cellColors->InsertNextTuple3(r, g, b);
+                }
+            }
         }
     }
 
@@ -688,6 +875,7 @@ vtkSmartPointer<vtkPolyData> Visualizer::buildGridLinesOnSurfacePolyData(const M
     const double valueRange = std::max(1e-12, maxValue - minValue);
     const double heightScale = std::max(nRows, nCols) / 3.0;
     const char* fieldNamePtr = substateFieldName.c_str();
+    const SubstateColumn* substateColumn = findSubstateColumn(substateFieldName, p);
 
     auto getCellValue = [&](int row, int col) -> double {
         if (row < 0 || row >= nRows || col < 0 || col >= nCols)
@@ -695,16 +883,12 @@ vtkSmartPointer<vtkPolyData> Visualizer::buildGridLinesOnSurfacePolyData(const M
             return minValue;
         }
 
-        try
-        {
-            std::string valueStr = p[row][col].stringEncoding(fieldNamePtr);
-            double value = std::stod(valueStr);
-            return std::clamp(value, minValue, maxValue);
-        }
-        catch (...)
+        const double value = substateValue(row, col, p, substateColumn, fieldNamePtr);
+        if (std::isnan(value))
         {
             return minValue;
         }
+        return std::clamp(value, minValue, maxValue);
     };
 
     auto valueToHeight = [&](double val) -> double {
@@ -713,6 +897,10 @@ vtkSmartPointer<vtkPolyData> Visualizer::buildGridLinesOnSurfacePolyData(const M
         return normalized * heightScale;
     };
 
+    // Lines over tiles without values above minValue lie flat at the base
+    const auto raisedTiles = findRaisedTiles(p, nRows, nCols, substateFieldName, minValue);
+    constexpr double HEIGHT_EPSILON = 1e-2;
+
     auto sampleHeight = [&](double gridX, double gridY) -> double {
         const double clampedX = std::clamp(gridX, 0.0, static_cast<double>(nCols - 1));
         const double clampedY = std::clamp(gridY, 0.0, static_cast<double>(nRows - 1));
@@ -725,6 +913,12 @@ vtkSmartPointer<vtkPolyData> Visualizer::buildGridLinesOnSurfacePolyData(const M
         const int col1 = std::min(col0 + 1, nCols - 1);
         const int row1 = std::min(row0 + 1, nRows - 1);
 
+        if (raisedTiles && ! raisedTiles->isActiveCell(row0, col0) && ! raisedTiles->isActiveCell(row0, col1)
+            && ! raisedTiles->isActiveCell(row1, col0) && ! raisedTiles->isActiveCell(row1, col1))
+        {
+            return HEIGHT_EPSILON;
+        }
+
         const double fracX = clampedX - baseX;
         const double fracY = clampedY - baseY;
 
@@ -735,7 +929,6 @@ vtkSmartPointer<vtkPolyData> Visualizer::buildGridLinesOnSurfacePolyData(const M
 
         const double h0 = h00 + (h10 - h00) * fracX;
         const double h1 = h01 + (h11 - h01) * fracX;
-        constexpr double HEIGHT_EPSILON = 1e-2;
         return h0 + (h1 - h0) * fracY + HEIGHT_EPSILON;
     };
 
@@ -798,6 +991,7 @@ void Visualizer::drawWithVTK3DSubstate(const Matrix& p, int nRows, int nCols,
     {
         renderer->RemoveActor(gridActor);
     }
+    removeTextureTiles(gridActor);
 
     // Build quad mesh surface
     vtkSmartPointer<vtkPolyData> surfacePolyData = build3DSubstateSurfaceQuadMesh(p, nRows, nCols, substateFieldName, minValue, maxValue, colorSubstateInfos);
@@ -17,6 +17,8 @@
 
 #pragma once
 
+#include <chrono>
+#include <optional>
 #include <vector>
 #include <vtkRenderer.h>
 
@@ -27,6 +29,7 @@ struct SettingParameter;
 struct Line;
 class Visualizer;
 struct SubstateInfo;
+class SubstateColumn;
 
 /** @interface ISceneWidgetVisualizer
  * @brief Abstract interface defining the contract for all scene widget visualizers.
@@ -56,14 +59,67 @@ public:
      * This should be called before reloading data to avoid duplicate entries. */
     virtual void clearStage() = 0;
 
-    /// @brief Read steps offsets for all nodes from files.
-    virtual void readStepsOffsetsForAllNodesFromFiles(int nNodeX, int nNodeY, int nNodeZ, const std::string& filename) = 0;
+    /** @brief Read steps offsets for all nodes from files.
+     * @param isBinary If true data files are binary (missing index files are rebuilt from them) */
+    virtual void readStepsOffsetsForAllNodesFromFiles(int nNodeX, int nNodeY, int nNodeZ, const std::string& filename, bool isBinary = false) = 0;
 
-    /// @brief Read stage state from files for a specific step.
+    /** @brief Sets how index files are read by readStepsOffsetsForAllNodesFromFiles() (see ModelReader).
+     * @param consolidatedIndex The consolidated index of steps is written and mapped instead of parsing index files on every opening
+     * @param recovery Missing index files are rebuilt from data files
+     * @param staleCheck Index files, which do not cover all steps of data files, are rebuilt too (needs recovery) */
+    virtual void setIndexFilesOptions(bool consolidatedIndex, bool recovery, bool staleCheck) = 0;
+
+    /** @brief Reads only entries appended to index files since they were read (the simulation is still running).
+     * @return Steps, which became available in all nodes (sorted),
+     *         std::nullopt if index files were written again (readStepsOffsetsForAllNodesFromFiles() has to be called) */
+    virtual std::optional<std::vector<StepIndex>> readAppendedStepsOffsets(const std::string& filename) = 0;
+
+    /// @brief Read stage state from files for a specific step (prefetched step is just swapped in).
     virtual void readStageStateFromFilesForStep(SettingParameter* sp, Line* lines) = 0;
 
+    /** @brief Start reading the steps (in order of displaying) in background, previous request is replaced.
+     *
+     * Used during playback, so displaying of the next step does not wait for reading. */
+    virtual void prefetchSteps(const SettingParameter& sp, const std::vector<StepIndex>& steps) = 0;
+
+    /// @brief Number of steps worth reading ahead to keep the interval between frames (based on measured reading time).
+    virtual std::size_t recommendedPrefetchDepth(std::chrono::milliseconds frameInterval) const = 0;
+
+    /** @brief Limits reading of steps to nodes whose part of the grid intersects the region (e.g. the visible part).
+     *
+     * Nodes of the displayed step, which get into the region, are read at once (only them).
+     * @param region Needed part of the grid, std::nullopt to read whole steps
+     * @param sp Settings of the displayed step
+     * @return true if nodes of the displayed step were read (visualization has to be refreshed) */
+    virtual bool setRegionOfInterest(std::optional<GridRegion> region, SettingParameter* sp, Line* lines) = 0;
+
+    /// @brief Parts of the grid covered by nodes of the displayed step, which were not read (see setRegionOfInterest())
+    virtual std::vector<GridRegion> notLoadedRegions(const SettingParameter& sp) const = 0;
+
+    /** @brief Sets the slice of 3D models, which is displayed (a slice is displayed like the grid of 2D models).
+     * @return true if the slice was changed (the step has to be read again, see readStageStateFromFilesForStep()) */
+    virtual bool setDisplayedSlice(int slice) = 0;
+
+    virtual int displayedSlice() const = 0;
+
+    /// @brief If enabled only the displayed slice of 3D models is decoded, otherwise all slices are (displaying another slice of the step does not read files then)
+    virtual void setDecodeDisplayedSliceOnly(bool enabled) = 0;
+
+    /** @brief Enables levels of detail: reduced resolutions (SubstatePyramid) of displayed substates are built after each step is read.
+     * @param enabled If false, levels are released (setDetailLevel() accepts only level 0 then)
+     * @param persistent Levels are written next to data files and read from them when the step is displayed again
+     * @param sp Settings of the displayed step (its levels are built at once) */
+    virtual void setDetailLevelsEnabled(bool enabled, bool persistent, const SettingParameter& sp) = 0;
+
+    /// @brief Number of reduced levels of the displayed grid (0 if levels of detail are disabled or the grid is small)
+    virtual int detailLevelsCount() const = 0;
+
+    /** @brief Sets level of detail used by next drawWithVTK(), blocks of 2^level x 2^level cells are drawn as one cell.
+     * @return true if the level changed (visualization has to be drawn again) */
+    virtual bool setDetailLevel(int level) = 0;
+
     /// @brief Draw the visualization using VTK.
-    virtual void drawWithVTK(int nRows, int nCols, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos, bool useCellRendering = false) = 0;
+    virtual void drawWithVTK(int nRows, int nCols, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos, GridRenderingMode renderingMode = GridRenderingMode::Points) = 0;
 
     /// @brief Refresh the VTK windows.
     virtual void refreshWindowsVTK(int nRows, int nCols, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos) = 0;
@@ -108,4 +164,13 @@ public:
      *                If nullptr or empty, returns the default encoding.
      * @return String representation of the cell via stringEncoding(), or empty string if out of bounds */
     virtual std::string getCellStringEncoding(int row, int col, const char* details = nullptr) const = 0;
+
+    /** @brief Get numeric values of the substate field of all cells of the current step.
+     *
+     * Values of substate fields are extracted once after the step is read (NaN for cells which are not a number),
+     * so consumers do not need to convert every cell with getCellStringEncoding().
+     *
+     * @param fieldName Name of the substate field (e.g., "h", "z")
+     * @return Values of the field or nullptr if they were not extracted (the field is not a substate) */
+    virtual const SubstateColumn* getSubstateColumn(const std::string& fieldName) const = 0;
 };
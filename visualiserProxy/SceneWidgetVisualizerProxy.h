@@ -16,10 +16,22 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <iterator> // std::back_inserter
+#include <optional>
 #include <string>
 #include <vector>
 #include "ISceneWidgetVisualizer.h"
+#include "data/CellGrid.hpp"
+#include "data/CellVolume.hpp"
+#include "data/DecodedStepCache.hpp"
 #include "data/ModelReader.hpp"
+#include "data/StepPrefetcher.hpp"
+#include "data/SubstateColumns.h"
+#include "data/SubstatePyramid.h"
 #include "visualiser/Visualizer.hpp"
 
 struct Line;
@@ -48,13 +60,20 @@ class SceneWidgetVisualizerTemplate : public ISceneWidgetVisualizer
 public:
     explicit SceneWidgetVisualizerTemplate(const std::string& modelName)
         : m_modelName(modelName)
+        , stepPrefetcher{ [this](Matrix& matrix, SettingParameter* sp, Line* lines)
+                          {
+                              std::vector<bool> readNodes;
+                              readStep(matrix, sp, lines, readNodes, /*volume=*/nullptr); // the displayed volume is used only by the main thread
+                          } }
     {
+        visualiser.setSubstateColumns(&substateColumns);
+        visualiser.setSubstatePyramids(&substatePyramids);
     }
 
     /** @brief Initializes the internal matrix with the specified dimensions.
      *
-     * This method resizes the internal 2D vector to match the given dimensions,
-     * creating a grid of default-constructed Cell objects.
+     * This method resizes the internal grid to match the given dimensions,
+     * creating a grid of default-constructed Cell objects (memory of previous grid is reused, see GridArena).
      *
      * @param dimX The width of the grid (number of columns)
      * @param dimY The height of the grid (number of rows)
@@ -62,36 +81,199 @@ public:
      * @note The dimensions must be positive integers. The method will create a grid with dimY rows and dimX columns. */
     void initMatrix(int dimX, int dimY) override
     {
-        p.resize(dimY);
-        for (int i = 0; i < dimY; i++)
-        {
-            p[i].resize(dimX);
-        }
+        stepPrefetcher.clear();
+        clearDecodedSteps();
+        substateColumns.clear();
+        substatePyramids.clear();
+        detailLevel = 0;
+        visualiser.setDetailLevel(detailLevel);
+        loadedNodes.clear();
+        p.resize(dimX, dimY);
     }
 
     void prepareStage(int nNodeX, int nNodeY, int nNodeZ = 1) override
     {
+        stepPrefetcher.clear();
+        clearDecodedSteps();
+        loadedNodes.clear();
         modelReader.prepareStage(nNodeX, nNodeY, nNodeZ);
     }
 
     void clearStage() override
     {
+        stepPrefetcher.clear();
+        clearDecodedSteps();
+        loadedNodes.clear();
         modelReader.clearStage();
     }
 
-    void readStepsOffsetsForAllNodesFromFiles(int nNodeX, int nNodeY, int nNodeZ, const std::string& filename) override
+    void readStepsOffsetsForAllNodesFromFiles(int nNodeX, int nNodeY, int nNodeZ, const std::string& filename, bool isBinary = false) override
+    {
+        stepPrefetcher.clear();
+        clearDecodedSteps();
+        loadedNodes.clear();
+        modelReader.readStepsOffsetsForAllNodesFromFiles(nNodeX, nNodeY, nNodeZ, filename, isBinary);
+    }
+
+    void setIndexFilesOptions(bool consolidatedIndex, bool recovery, bool staleCheck) override
+    {
+        modelReader.setConsolidatedIndexEnabled(consolidatedIndex);
+        modelReader.setIndexRecoveryEnabled(recovery);
+        modelReader.setStaleIndexCheckEnabled(staleCheck);
+    }
+
+    std::optional<std::vector<StepIndex>> readAppendedStepsOffsets(const std::string& filename) override
     {
-        modelReader.readStepsOffsetsForAllNodesFromFiles(nNodeX, nNodeY, nNodeZ, filename);
+        auto update = modelReader.readIndexFilesUpdate(filename);
+        if (! update)
+            return std::nullopt;
+
+        // positions of steps are changed, so reading in background is stopped (decoded steps stay valid)
+        if (update->hasNewRecords())
+            stepPrefetcher.clear();
+        return modelReader.applyIndexFilesUpdate(std::move(*update));
     }
 
     void readStageStateFromFilesForStep(SettingParameter* sp, Line* lines) override
     {
-        modelReader.readStageStateFromFilesForStep(p, sp, lines);
+        const auto substateFields = sp->getSubstateFields();
+        if (modelReader.setDecodedSubstates(substateFields))
+        {
+            // cells of already read steps do not have all displayed substates decoded
+            stepPrefetcher.clear();
+            clearDecodedSteps();
+        }
+
+        const auto linesCount = static_cast<std::size_t>(std::max(sp->numberOfLines, 0));
+        loadedNodes.clear();
+        if (! decodedSteps.get(m_modelName, sp->step, p, lines, linesCount))
+        {
+            if (stepPrefetcher.take(sp->step, p, lines, linesCount))
+                loadedNodes = nodesReadInBackground(*sp);
+            else
+                readStep(p, sp, lines, loadedNodes, &displayedVolume);
+
+            // only whole steps are cached (nodes outside of the region of interest are missing)
+            if (isWholeStepLoaded())
+                decodedSteps.put(m_modelName, sp->step, p, lines, linesCount);
+        }
+
+        substateColumns.extract(p, substateFields);
+        updateSubstatePyramids(*sp);
+    }
+
+    void prefetchSteps(const SettingParameter& sp, const std::vector<StepIndex>& steps) override
+    {
+        std::vector<StepIndex> notCachedSteps;
+        std::ranges::copy_if(steps, std::back_inserter(notCachedSteps),
+                             [this](StepIndex step)
+                             {
+                                 return ! decodedSteps.contains(m_modelName, step);
+                             });
+        stepPrefetcher.prefetch(sp, notCachedSteps);
+    }
+
+    std::size_t recommendedPrefetchDepth(std::chrono::milliseconds frameInterval) const override
+    {
+        return stepPrefetcher.recommendedDepth(frameInterval);
+    }
+
+    bool setRegionOfInterest(std::optional<GridRegion> region, SettingParameter* sp, Line* lines) override
+    {
+        if (region == regionOfInterest)
+            return false;
+
+        stepPrefetcher.clear(); // steps read in background contain nodes of the previous region only
+        regionOfInterest = region;
+        if (isWholeStepLoaded())
+            return false;
+
+        const auto loadedNodesCount = std::ranges::count(loadedNodes, true);
+        const GridRegion wholeGrid{ .endColumn = p.columns(), .endRow = p.rows() };
+        modelReader.readStageStateFromFilesForStepInRegion(p, sp, lines, region.value_or(wholeGrid), loadedNodes);
+        if (std::ranges::count(loadedNodes, true) == loadedNodesCount)
+            return false;
+
+        if (isWholeStepLoaded())
+            decodedSteps.put(m_modelName, sp->step, p, lines, static_cast<std::size_t>(std::max(sp->numberOfLines, 0)));
+        substateColumns.extract(p, sp->getSubstateFields());
+        updateSubstatePyramids(*sp);
+        return true;
+    }
+
+    std::vector<GridRegion> notLoadedRegions(const SettingParameter& sp) const override
+    {
+        std::vector<GridRegion> regions;
+        if (isWholeStepLoaded())
+            return regions;
+
+        const auto nodesRegions = modelReader.nodesRegions(sp);
+        if (! nodesRegions || nodesRegions->size() != loadedNodes.size())
+            return regions;
+
+        for (std::size_t node = 0; node < loadedNodes.size(); ++node)
+        {
+            if (! loadedNodes[node] && ! (*nodesRegions)[node].empty())
+                regions.push_back((*nodesRegions)[node]);
+        }
+        return regions;
+    }
+
+    bool setDisplayedSlice(int slice) override
+    {
+        slice = std::max(slice, 0);
+        if (slice == displayedSliceNumber)
+            return false;
+
+        // steps are displayed and cached as the slice, the decoded volume stays valid
+        stepPrefetcher.clear();
+        decodedSteps.clear();
+        displayedSliceNumber = slice;
+        return true;
+    }
+
+    int displayedSlice() const override
+    {
+        return displayedSliceNumber;
+    }
+
+    void setDecodeDisplayedSliceOnly(bool enabled) override
+    {
+        if (enabled == decodeDisplayedSliceOnly)
+            return;
+
+        stepPrefetcher.clear();
+        decodeDisplayedSliceOnly = enabled;
+        if (decodeDisplayedSliceOnly)
+            displayedVolume = DecodedVolume{}; // memory of other slices is released
+    }
+
+    void setDetailLevelsEnabled(bool enabled, bool persistent, const SettingParameter& sp) override
+    {
+        detailLevelsEnabled = enabled;
+        detailLevelsPersistent = persistent;
+        updateSubstatePyramids(sp);
+    }
+
+    int detailLevelsCount() const override
+    {
+        return detailLevelsEnabled ? SubstatePyramid::levelsCountFor(p.columns(), p.rows()) : 0;
+    }
+
+    bool setDetailLevel(int level) override
+    {
+        level = std::clamp(level, 0, detailLevelsCount());
+        if (level == detailLevel)
+            return false;
+
+        detailLevel = level;
+        visualiser.setDetailLevel(detailLevel);
+        return true;
     }
 
-    void drawWithVTK(int nRows, int nCols, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos, bool useCellRendering = false) override
+    void drawWithVTK(int nRows, int nCols, vtkSmartPointer<vtkRenderer> renderer, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos, GridRenderingMode renderingMode = GridRenderingMode::Points) override
     {
-        visualiser.drawWithVTK(p, nRows, nCols, renderer, gridActor, colorSubstateInfos, useCellRendering);
+        visualiser.drawWithVTK(p, nRows, nCols, renderer, gridActor, colorSubstateInfos, renderingMode);
     }
 
     void refreshWindowsVTK(int nRows, int nCols, vtkSmartPointer<vtkActor> gridActor, const std::vector<const SubstateInfo*>& colorSubstateInfos) override
@@ -154,10 +336,181 @@ public:
         return p[row][col].stringEncoding(details);
     }
 
+    const SubstateColumn* getSubstateColumn(const std::string& fieldName) const override
+    {
+        return substateColumns.find(fieldName, p);
+    }
+
 private:
+    using Matrix = CellGrid<Cell>;
+
+    /// @brief Decoded slices of a step of 3D model
+    struct DecodedVolume
+    {
+        CellVolume<Cell> cells;
+        std::vector<VolumeNodePlacement> nodes;
+        std::optional<StepIndex> step; ///< Not set if the volume does not contain any step
+    };
+
+    /// @brief 3D models (more slices or nodes along Z) are read by slices, see readSliceOfStep()
+    static bool isVolumetric(const SettingParameter& sp)
+    {
+        return sp.numberOfSlicesZ > 1 || sp.nNodeZ > 1;
+    }
+
+    /** @brief Reads the step, only nodes in the region of interest when it is set.
+     * @param volume Slices of 3D models decoded with the step (reused when the step is read again),
+     *        nullptr if nothing but the displayed slice is needed (it is the only decoded slice then)
+     * @note Called also by the prefetcher thread, the region and the slice are changed only after reading in background was stopped. */
+    void readStep(Matrix& matrix, SettingParameter* sp, Line* lines, std::vector<bool>& readNodes, DecodedVolume* volume)
+    {
+        if (isVolumetric(*sp))
+            readSliceOfStep(matrix, *sp, lines, volume);
+        else if (regionOfInterest)
+            modelReader.readStageStateFromFilesForStepInRegion(matrix, sp, lines, *regionOfInterest, readNodes);
+        else
+            modelReader.readStageStateFromFilesForStep(matrix, sp, lines);
+    }
+
+    /** @brief Reads the displayed slice of the step of 3D model into the matrix (slices are displayed like 2D models).
+     *
+     * Only the displayed slice is decoded, unless all slices are decoded into the volume (see setDecodeDisplayedSliceOnly()),
+     * then displaying another slice of the same step copies it from the volume without reading files.
+     * Lines are boundaries of nodes crossing the slice.
+     * @param kept Volume of the displayed step, nullptr when the step is read in background (only the displayed slice is decoded) */
+    void readSliceOfStep(Matrix& matrix, const SettingParameter& sp, Line* lines, DecodedVolume* kept)
+    {
+        const int slice = std::min(displayedSliceNumber, std::max(sp.numberOfSlicesZ - 1, 0));
+        const bool wholeVolume = kept && ! decodeDisplayedSliceOnly;
+        const SliceRange slices = wholeVolume ? SliceRange{ .first = 0, .end = sp.numberOfSlicesZ } : SliceRange{ .first = slice, .end = slice + 1 };
+
+        DecodedVolume sliceOnly;
+        DecodedVolume& volume = kept ? *kept : sliceOnly;
+
+        if (volume.step != sp.step || ! volume.cells.storedSlices().contains(slices))
+        {
+            volume.step.reset(); // the volume is not valid when reading fails
+            volume.nodes = modelReader.readVolumeOfStep(volume.cells, sp, slices);
+            volume.step = sp.step;
+        }
+
+        ReaderHelpers::setVolumeNodesLines(lines, volume.nodes, sp.nNodeX, sp.nNodeY, slice, volume.cells.columns(), volume.cells.rows());
+        volume.cells.copySliceInto(slice, matrix);
+    }
+
+    /// @brief Nodes of the step read by the prefetcher (nodes intersecting the region of interest, which was used for reading)
+    std::vector<bool> nodesReadInBackground(const SettingParameter& sp) const
+    {
+        if (! regionOfInterest || isVolumetric(sp))
+            return {}; // slices of 3D models are read whole
+
+        std::vector<bool> readNodes(sp.nNodeX * sp.nNodeY, false);
+        if (const auto nodesRegions = modelReader.nodesRegions(sp); nodesRegions && nodesRegions->size() == readNodes.size())
+        {
+            for (std::size_t node = 0; node < readNodes.size(); ++node)
+                readNodes[node] = regionOfInterest->intersects((*nodesRegions)[node]);
+        }
+        return readNodes;
+    }
+
+    /** @brief Builds reduced levels of extracted substates of the displayed step (when levels of detail are enabled).
+     * Persistent levels of whole steps are read from the file when it was written for the same data, otherwise they are written. */
+    void updateSubstatePyramids(const SettingParameter& sp)
+    {
+        const int levelsCount = detailLevelsCount();
+        if (0 == levelsCount)
+        {
+            substatePyramids.clear();
+            return;
+        }
+
+        const auto fieldNames = sp.getSubstateFields();
+        substatePyramids.keepOnly(fieldNames);
+
+        // files of levels are named by steps only, so they are not written for slices of 3D models
+        const bool persistent = detailLevelsPersistent && isWholeStepLoaded() && ! isVolumetric(sp);
+        const auto sourceStamp = persistent ? dataFilesStamp(sp) : 0;
+        for (const auto& fieldName : fieldNames)
+        {
+            const auto* column = substateColumns.find(fieldName, p);
+            if (! column)
+                continue;
+
+            const auto substateInfo = sp.substateInfo.find(fieldName);
+            const bool noValueEnabled = substateInfo != sp.substateInfo.end() && substateInfo->second.noValueEnabled;
+            const double skippedValue = noValueEnabled ? substateInfo->second.noValue : SubstateColumn::notANumber;
+
+            auto& pyramid = substatePyramids.pyramid(fieldName);
+            const auto fileName = SubstatePyramid::fileName(sp.outputFileName, sp.step, fieldName);
+            if (persistent && pyramid.load(fileName, sourceStamp, column->columns(), column->rows(), levelsCount, skippedValue))
+                continue;
+
+            pyramid.build(*column, levelsCount, skippedValue);
+            if (persistent)
+            {
+                try
+                {
+                    pyramid.save(fileName, sourceStamp);
+                }
+                catch (const std::exception& e)
+                {
+                    std::cerr << "Warning: " << e.what() << std::endl;
+                }
+            }
+        }
+    }
+
+    /// @brief Latest modification time of data files of nodes (persistent levels of detail of other data are not used)
+    static std::uint64_t dataFilesStamp(const SettingParameter& sp)
+    {
+        std::uint64_t stamp = 0;
+        for (NodeIndex node = 0; node < sp.nNodeX * sp.nNodeY; ++node)
+        {
+            for (const bool isBinary : { false, true })
+            {
+                std::error_code error;
+                const auto writeTime = std::filesystem::last_write_time(ReaderHelpers::giveMeFileName(sp.outputFileName, node, isBinary), error);
+                if (! error)
+                    stamp = std::max(stamp, static_cast<std::uint64_t>(writeTime.time_since_epoch().count()));
+            }
+        }
+        return stamp;
+    }
+
+    bool isWholeStepLoaded() const
+    {
+        return std::ranges::all_of(loadedNodes, [](bool loaded) { return loaded; });
+    }
+
+    void clearDecodedSteps()
+    {
+        if (const auto statistics = decodedSteps.statistics(); DecodedStepCacheSettings::statisticsReported() && statistics.steps > 0)
+        {
+            std::cout << "Cache of decoded steps of " << m_modelName << ": " << statistics.hits << " hits, " << statistics.misses << " misses, "
+                      << statistics.steps << " steps (" << statistics.usedBytes / (1024 * 1024) << " MB) released" << std::endl;
+        }
+        decodedSteps.clear();
+        displayedVolume.step.reset();
+    }
+
     const std::string m_modelName;
 
-    Visualizer visualiser;            ///< The visualizer instance for rendering the model
-    ModelReader<Cell> modelReader;    ///< The reader for loading and managing model data
-    std::vector<std::vector<Cell>> p; ///< 2D vector storing the cell data
+    Visualizer visualiser;                 ///< The visualizer instance for rendering the model
+    ModelReader<Cell> modelReader;         ///< The reader for loading and managing model data
+    Matrix p;                              ///< Contiguous grid storing the cell data
+    DecodedStepCache<Matrix> decodedSteps; ///< Recently displayed steps (revisiting them does not read files)
+    StepPrefetcher<Matrix> stepPrefetcher; ///< Background read-ahead of steps (destroyed before modelReader)
+    DecodedVolume displayedVolume;         ///< Decoded slices of the displayed step of 3D model
+    SubstateColumns substateColumns;       ///< Numeric values of substates of the displayed step (used by visualiser)
+    SubstatePyramids substatePyramids;     ///< Levels of detail of substates of the displayed step (used by visualiser)
+
+    std::optional<GridRegion> regionOfInterest; ///< Only nodes intersecting it are read (whole steps are read if not set)
+    std::vector<bool> loadedNodes;              ///< Nodes of the displayed step read into p, empty when all nodes were read
+
+    bool detailLevelsEnabled = false;    ///< Substate pyramids are built after each step is read
+    bool detailLevelsPersistent = false; ///< Substate pyramids are written next to data files
+    int detailLevel = 0;                 ///< Level of detail of drawing (see Visualizer::setDetailLevel())
+
+    int displayedSliceNumber = 0;         ///< Slice of 3D models, which is displayed (it is clamped to slices of the model)
+    bool decodeDisplayedSliceOnly = true; ///< If false all slices of 3D models are decoded (switching slices does not read files)
 };
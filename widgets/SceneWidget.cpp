@@ -3,9 +3,11 @@
 
 #include <iostream> // std::cout
 #include <cmath> // std::isfinite
+#include <limits>
 #include <filesystem>
 #include <string>
 #include <QApplication>
+#include <QSet>
 #include "core/directoryConstants.h"
 #include "widgets/WaitCursorGuard.h"
 #include <vtkCallbackCommand.h>
@@ -32,6 +34,7 @@
 #include "SceneWidget.h"
 #include "config/Config.h"
 #include "config/ConfigConstants.h"
+#include "data/ModelReader.hpp" // ReaderHelpers::giveMeFileNameIndex()
 #include "visualiser/Line.h"
 #include "visualiser/Visualizer.hpp"
 #include "visualiser/SettingParameter.h"
@@ -48,9 +51,21 @@ public:
     void initMatrix(int, int) override {}
     void prepareStage(int, int, int) override {}
     void clearStage() override {}
-    void readStepsOffsetsForAllNodesFromFiles(int, int, int, const std::string&) override {}
+    void readStepsOffsetsForAllNodesFromFiles(int, int, int, const std::string&, bool) override {}
+    void setIndexFilesOptions(bool, bool, bool) override {}
+    std::optional<std::vector<StepIndex>> readAppendedStepsOffsets(const std::string&) override { return std::vector<StepIndex>{}; }
     void readStageStateFromFilesForStep(SettingParameter*, Line*) override {}
-    void drawWithVTK(int, int, vtkSmartPointer<vtkRenderer>, vtkSmartPointer<vtkActor>, const std::vector<const SubstateInfo*>&, bool) override {}
+    void prefetchSteps(const SettingParameter&, const std::vector<StepIndex>&) override {}
+    std::size_t recommendedPrefetchDepth(std::chrono::milliseconds) const override { return 0; }
+    bool setRegionOfInterest(std::optional<GridRegion>, SettingParameter*, Line*) override { return false; }
+    std::vector<GridRegion> notLoadedRegions(const SettingParameter&) const override { return {}; }
+    bool setDisplayedSlice(int) override { return false; }
+    int displayedSlice() const override { return 0; }
+    void setDecodeDisplayedSliceOnly(bool) override {}
+    void setDetailLevelsEnabled(bool, bool, const SettingParameter&) override {}
+    int detailLevelsCount() const override { return 0; }
+    bool setDetailLevel(int) override { return false; }
+    void drawWithVTK(int, int, vtkSmartPointer<vtkRenderer>, vtkSmartPointer<vtkActor>, const std::vector<const SubstateInfo*>&, GridRenderingMode) override {}
     void refreshWindowsVTK(int, int, vtkSmartPointer<vtkActor>, const std::vector<const SubstateInfo*>&) override {}
     void drawWithVTK3DSubstate(int, int, vtkSmartPointer<vtkRenderer>, vtkSmartPointer<vtkActor>, const std::string&, double, double, const std::vector<const SubstateInfo*>&) override {}
     void refreshWindowsVTK3DSubstate(int, int, vtkSmartPointer<vtkActor>, const std::string&, double, double, const std::vector<const SubstateInfo*>&) override {}
@@ -79,6 +94,11 @@ public:
     {
         return {};
     }
+
+    const SubstateColumn* getSubstateColumn(const std::string&) const override
+    {
+        return nullptr;
+    }
 };
 
 /** @brief Checks if the given directory already contains data files matching the output name pattern
@@ -152,9 +172,20 @@ SceneWidget::SceneWidget(QWidget* parent)
     , backgroundActor{ vtkSmartPointer<vtkActor>::New() }
     , actorBuildLine{ vtkSmartPointer<vtkActor2D>::New() }
     , gridLinesOnSurfaceActor{ vtkSmartPointer<vtkActor>::New() }
+    , notLoadedNodesActor{ vtkSmartPointer<vtkActor>::New() }
 {
     enableToolTipWhenMouseAboveWidget();
 
+    cameraChangeTimer.setSingleShot(true);
+    cameraChangeTimer.setInterval(200);
+    connect(&cameraChangeTimer, &QTimer::timeout, this, &SceneWidget::onCameraChangeSettled);
+
+    indexFilesChangeTimer.setSingleShot(true);
+    indexFilesChangeTimer.setInterval(100);
+    connect(&indexFilesChangeTimer, &QTimer::timeout, this, &SceneWidget::readAppendedSteps);
+    connect(&indexFilesWatcher, &QFileSystemWatcher::fileChanged, this, [this] { indexFilesChangeTimer.start(); });
+    connect(&indexFilesPollingTimer, &QTimer::timeout, this, &SceneWidget::readAppendedSteps);
+
     connect(&ColorSettings::instance(), &ColorSettings::colorsChanged, this, &SceneWidget::onColorsReloadRequested);
 }
 
@@ -341,6 +372,8 @@ void SceneWidget::loadAndUpdateVisualizationForCurrentStep()
         sceneWidgetVisualizerProxy->getVisualizer().refreshBuildLoadBalanceLine(lines,
                                                                                 settingParameter->numberOfRowsY + 1,
                                                                                 actorBuildLine);
+
+        updateNotLoadedNodesPlaceholder();
     }
 
     // Update step number display
@@ -431,7 +464,7 @@ void SceneWidget::drawVisualizationWithOptional3DSubstate()
 
     // Fallback to regular 2D visualization
     const auto colorSubstateInfos = getColorSubstateInfos();
-    sceneWidgetVisualizerProxy->drawWithVTK(settingParameter->numberOfRowsY, settingParameter->numberOfColumnX, renderer, gridActor, colorSubstateInfos, useCellRendering);
+    sceneWidgetVisualizerProxy->drawWithVTK(settingParameter->numberOfRowsY, settingParameter->numberOfColumnX, renderer, gridActor, colorSubstateInfos, gridRenderingMode);
     updateCameraPivotFromBounds();
 }
 
@@ -582,6 +615,15 @@ void SceneWidget::readSettingsFromConfigFile(const std::string& filename)
         /// Notice: there are much more params, which are not used: e.g. border_size_x, border_size_y, border_size_z
     }
 
+    {
+        // Load balancing steps are used only to reuse dimensions of nodes between steps (when they can not change)
+        ConfigCategory* loadBalancingContext = config.getConfigCategory(ConfigConstants::CATEGORY_LOAD_BALANCING);
+        auto firstLBParam = loadBalancingContext ? loadBalancingContext->getConfigParameter(ConfigConstants::PARAM_FIRST_LB) : nullptr;
+        auto stepLBParam = loadBalancingContext ? loadBalancingContext->getConfigParameter(ConfigConstants::PARAM_STEP_LB) : nullptr;
+        settingParameter->firstLB = firstLBParam ? firstLBParam->getValue<int>() : -1;
+        settingParameter->stepLB = stepLBParam ? stepLBParam->getValue<int>() : -1;
+    }
+
     {
         ConfigCategory* visualizationContext = config.getConfigCategory(ConfigConstants::CATEGORY_VISUALIZATION);
         if (visualizationContext)
@@ -748,6 +790,192 @@ void SceneWidget::connectCameraCallback()
     cameraCallback->SetCallback(SceneWidget::cameraCallbackFunction);
     cameraCallback->SetClientData(this);
     interactor()->AddObserver(vtkCommand::EndInteractionEvent, cameraCallback);
+
+    // Every camera change (also zooming and panning) can show nodes which were not read yet
+    if (vtkCamera* camera = renderer->GetActiveCamera())
+    {
+        vtkNew<vtkCallbackCommand> cameraModifiedCallback;
+        cameraModifiedCallback->SetCallback(SceneWidget::cameraModifiedCallbackFunction);
+        cameraModifiedCallback->SetClientData(this);
+        camera->AddObserver(vtkCommand::ModifiedEvent, cameraModifiedCallback);
+    }
+}
+
+std::optional<GridRegion> SceneWidget::visibleGridRegion() const
+{
+    if (! renderer || ! renderWindow() || ! settingParameter)
+    {
+        return std::nullopt;
+    }
+
+    const int nColumns = settingParameter->numberOfColumnX;
+    const int nRows = settingParameter->numberOfRowsY;
+    const int* size = renderWindow()->GetSize();
+    if (nColumns <= 0 || nRows <= 0 || size[0] <= 0 || size[1] <= 0)
+    {
+        return std::nullopt;
+    }
+
+    const auto displayToWorld = [this](double x, double y, double depth)
+    {
+        double displayPoint[3] = { x, y, depth };
+        renderer->SetDisplayPoint(displayPoint);
+        renderer->DisplayToWorld();
+        std::array<double, 4> worldPoint{};
+        renderer->GetWorldPoint(worldPoint.data());
+        if (worldPoint[3] != 0.0)
+        {
+            for (int i = 0; i < 3; ++i)
+                worldPoint[i] /= worldPoint[3];
+        }
+        return worldPoint;
+    };
+
+    // Rays of corners of the viewport (from near to far clipping plane) are intersected with plane of cells (Z=0)
+    double minX = std::numeric_limits<double>::max(), maxX = std::numeric_limits<double>::lowest();
+    double minY = std::numeric_limits<double>::max(), maxY = std::numeric_limits<double>::lowest();
+    const double width = static_cast<double>(size[0]);
+    const double height = static_cast<double>(size[1]);
+    const double corners[4][2] = { { 0.0, 0.0 }, { width, 0.0 }, { 0.0, height }, { width, height } };
+    for (const auto& corner : corners)
+    {
+        const auto nearPoint = displayToWorld(corner[0], corner[1], 0.0);
+        const auto farPoint = displayToWorld(corner[0], corner[1], 1.0);
+        const double dz = farPoint[2] - nearPoint[2];
+        if (std::abs(dz) < 1e-12)
+        {
+            return std::nullopt; // the ray is parallel with the plane
+        }
+
+        const double t = -nearPoint[2] / dz;
+        if (t < 0.0)
+        {
+            return std::nullopt; // the corner looks away from the plane (e.g. above horizon)
+        }
+
+        const double x = nearPoint[0] + t * (farPoint[0] - nearPoint[0]);
+        const double y = nearPoint[1] + t * (farPoint[1] - nearPoint[1]);
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+    }
+
+    // Margin lets small camera moves show cells which were already read
+    constexpr double marginFraction = 0.1;
+    const double marginX = std::max(1.0, (maxX - minX) * marginFraction);
+    const double marginY = std::max(1.0, (maxY - minY) * marginFraction);
+
+    if (maxX + marginX < -0.5 || minX - marginX > nColumns - 0.5 || maxY + marginY < -0.5 || minY - marginY > nRows - 0.5)
+    {
+        return GridRegion{}; // the grid is not visible at all
+    }
+
+    // Cell (row, column) is centered on (column, nRows - 1 - row)
+    const auto toIndex = [](double value, int limit)
+    {
+        return static_cast<int>(std::clamp(std::floor(value), 0.0, static_cast<double>(limit)));
+    };
+
+    GridRegion region;
+    region.firstColumn = toIndex(minX - marginX + 0.5, nColumns);
+    region.endColumn = toIndex(maxX + marginX + 0.5, nColumns - 1) + 1;
+    region.firstRow = toIndex(nRows - 1 - maxY - marginY + 0.5, nRows);
+    region.endRow = toIndex(nRows - 1 - minY + marginY + 0.5, nRows - 1) + 1;
+    return region;
+}
+
+void SceneWidget::updateRegionOfInterest()
+{
+    if (! settingParameter || settingParameter->numberOfLines <= 0)
+    {
+        return;
+    }
+
+    std::optional<GridRegion> region;
+    if (loadVisibleNodesOnly)
+    {
+        region = visibleGridRegion();
+    }
+
+    try
+    {
+        lines.resize(settingParameter->numberOfLines);
+        if (! sceneWidgetVisualizerProxy->setRegionOfInterest(region, settingParameter.get(), &lines[0]))
+        {
+            return;
+        }
+
+        refreshVisualizationWithOptional3DSubstate();
+        updateNotLoadedNodesPlaceholder();
+        triggerRenderUpdate();
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Error occurred while reading visible nodes: " << ex.what() << std::endl;
+    }
+}
+
+int SceneWidget::detailLevelForCurrentView() const
+{
+    const int levelsCount = sceneWidgetVisualizerProxy->detailLevelsCount();
+    if (! useDetailLevels || levelsCount <= 0 || ! activeSubstateFor3D.empty() || ! renderer || ! renderWindow())
+    {
+        return 0;
+    }
+
+    vtkCamera* camera = renderer->GetActiveCamera();
+    const int* size = renderWindow()->GetSize();
+    if (! camera || size[1] <= 0)
+    {
+        return 0;
+    }
+
+    // Height of the view in world coordinates (cells) at the focal point
+    const double viewHeight = camera->GetParallelProjection()
+                                  ? 2.0 * camera->GetParallelScale()
+                                  : 2.0 * camera->GetDistance() * std::tan(vtkMath::RadiansFromDegrees(camera->GetViewAngle()) / 2.0);
+    const double cellsPerPixel = viewHeight / size[1];
+    if (! std::isfinite(cellsPerPixel) || cellsPerPixel < 2.0)
+    {
+        return 0;
+    }
+
+    return std::min(levelsCount, static_cast<int>(std::floor(std::log2(cellsPerPixel))));
+}
+
+void SceneWidget::updateDetailLevel()
+{
+    if (! settingParameter || settingParameter->numberOfLines <= 0)
+    {
+        return;
+    }
+
+    if (sceneWidgetVisualizerProxy->setDetailLevel(detailLevelForCurrentView()))
+    {
+        drawVisualizationWithOptional3DSubstate();
+        triggerRenderUpdate();
+    }
+}
+
+void SceneWidget::onCameraChangeSettled()
+{
+    updateDetailLevel();
+    updateRegionOfInterest();
+}
+
+void SceneWidget::updateNotLoadedNodesPlaceholder()
+{
+    if (! settingParameter || ! notLoadedNodesActor)
+    {
+        return;
+    }
+
+    sceneWidgetVisualizerProxy->getVisualizer().drawNotLoadedRegions(sceneWidgetVisualizerProxy->notLoadedRegions(*settingParameter),
+                                                                     settingParameter->numberOfRowsY,
+                                                                     gridRenderingMode,
+                                                                     renderer,
+                                                                     notLoadedNodesActor);
 }
 
 void SceneWidget::keypressCallbackFunction(vtkObject* caller, long unsigned int eventId, void* clientData, void* callData)
@@ -844,6 +1072,19 @@ void SceneWidget::cameraCallbackFunction(vtkObject* caller, long unsigned int ev
     }
 }
 
+void SceneWidget::cameraModifiedCallbackFunction(vtkObject* caller, long unsigned int eventId, void* clientData, void* callData)
+{
+    Q_UNUSED(caller);
+    Q_UNUSED(eventId);
+    Q_UNUSED(callData);
+
+    auto* self = static_cast<SceneWidget*>(clientData);
+    if (self && (self->loadVisibleNodesOnly || self->useDetailLevels) && ! self->cameraChangeTimer.isActive())
+    {
+        self->cameraChangeTimer.start();
+    }
+}
+
 void SceneWidget::mouseCallbackFunction(vtkObject* caller, long unsigned int eventId, void* clientData, void* callData)
 {
     auto interactor = static_cast<vtkRenderWindowInteractor*>(caller);
@@ -912,9 +1153,11 @@ void SceneWidget::renderVtkScene()
     sceneWidgetVisualizerProxy->readStepsOffsetsForAllNodesFromFiles(settingParameter->nNodeX,
                                                                      settingParameter->nNodeY,
                                                                      settingParameter->nNodeZ,
-                                                                     settingParameter->outputFileName);
+                                                                     settingParameter->outputFileName,
+                                                                     settingParameter->readMode == "binary");
 
     emit availableStepsReadFromConfigFile(sceneWidgetVisualizerProxy->availableSteps());
+    watchIndexFiles();
 
     lines.resize(settingParameter->numberOfLines);
     sceneWidgetVisualizerProxy->readStageStateFromFilesForStep(settingParameter.get(), &lines[0]);
@@ -927,6 +1170,8 @@ void SceneWidget::renderVtkScene()
                                                                      renderer,
                                                                      actorBuildLine);
 
+    updateNotLoadedNodesPlaceholder();
+
     // Apply grid lines visibility and semi-transparency settings
     applyGridLinesSettings();
 
@@ -1147,6 +1392,14 @@ QString SceneWidget::cellValueAtThisPositionAsText() const
         tooltipText += "\nSubstates:";
         for (const auto& field : substateFields)
         {
+            // Numeric values were extracted when the step was read, other fields are shown as encoded by the cell
+            const SubstateColumn* substateColumn = sceneWidgetVisualizerProxy->getSubstateColumn(field);
+            if (substateColumn && substateColumn->contains(row, col) && ! std::isnan(substateColumn->value(row, col)))
+            {
+                tooltipText += QString("\n\t%1: %2").arg(QString::fromStdString(field)).arg(substateColumn->value(row, col), 0, 'g', 10);
+                continue;
+            }
+
             std::string fieldValue = sceneWidgetVisualizerProxy->getCellStringEncoding(row, col, field.c_str());
             if (!fieldValue.empty())
             {
@@ -1164,6 +1417,19 @@ void SceneWidget::selectedStepParameter(StepIndex stepNumber)
     upgradeModelInCentralPanel();
 }
 
+void SceneWidget::prefetchSteps(const std::vector<StepIndex>& steps)
+{
+    if (settingParameter->numberOfLines <= 0)
+        return;
+
+    sceneWidgetVisualizerProxy->prefetchSteps(*settingParameter, steps);
+}
+
+std::size_t SceneWidget::recommendedPrefetchDepth(std::chrono::milliseconds frameInterval) const
+{
+    return sceneWidgetVisualizerProxy->recommendedPrefetchDepth(frameInterval);
+}
+
 void SceneWidget::upgradeModelInCentralPanel()
 {
     if (! settingParameter->changed)
@@ -1214,6 +1480,9 @@ void SceneWidget::switchModel(const std::string& modelName)
 
     // Reinitialize the matrix with current dimensions
     sceneWidgetVisualizerProxy->initMatrix(settingParameter->numberOfColumnX, settingParameter->numberOfRowsY);
+    sceneWidgetVisualizerProxy->setDetailLevelsEnabled(useDetailLevels, persistDetailLevels, *settingParameter);
+    sceneWidgetVisualizerProxy->setDecodeDisplayedSliceOnly(decodeDisplayedSliceOnly);
+    sceneWidgetVisualizerProxy->setIndexFilesOptions(useConsolidatedIndex, recoverIndexFiles, checkStaleIndexFiles);
 
     std::cout << "Switched to model: " << sceneWidgetVisualizerProxy->getModelName() << std::endl;
 }
@@ -1233,8 +1502,11 @@ void SceneWidget::reloadData()
             settingParameter->nNodeX,
             settingParameter->nNodeY,
             settingParameter->nNodeZ,
-            settingParameter->outputFileName
+            settingParameter->outputFileName,
+            settingParameter->readMode == "binary"
         );
+        emit availableStepsReadFromConfigFile(sceneWidgetVisualizerProxy->availableSteps());
+        watchIndexFiles();
 
         // Force a full refresh
         settingParameter->changed = true;
@@ -1263,6 +1535,7 @@ void SceneWidget::clearScene()
     backgroundActor = vtkSmartPointer<vtkActor>::New();
     actorBuildLine = vtkSmartPointer<vtkActor2D>::New();
     gridLinesOnSurfaceActor = vtkSmartPointer<vtkActor>::New();
+    notLoadedNodesActor = vtkSmartPointer<vtkActor>::New();
 }
 
 void SceneWidget::loadNewConfiguration(const std::string& configFileName, int stepNumber)
@@ -1293,6 +1566,7 @@ void SceneWidget::onColorsReloadRequested()
     refreshBackgroundColorFromSettings();
     refreshStepNumberTextColorFromSettings();
     refreshGridColorFromSettings();
+    updateNotLoadedNodesPlaceholder();
 }
 void SceneWidget::refreshBackgroundColorFromSettings()
 {
@@ -1469,12 +1743,138 @@ void SceneWidget::setFlatSceneBackgroundVisible(bool visible)
     triggerRenderUpdate();
 }
 
-void SceneWidget::setUseCellRendering(bool useCellRenderingMode)
+void SceneWidget::setGridRenderingMode(GridRenderingMode renderingMode)
 {
-    useCellRendering = useCellRenderingMode;
+    gridRenderingMode = renderingMode;
     // No need to trigger render update here - caller will call refreshVisualization
 }
 
+void SceneWidget::setLoadVisibleNodesOnly(bool loadVisibleNodesOnlyMode)
+{
+    loadVisibleNodesOnly = loadVisibleNodesOnlyMode;
+
+    // Disabling reads all nodes which were skipped
+    updateRegionOfInterest();
+}
+
+void SceneWidget::setUseDetailLevels(bool useDetailLevelsMode, bool persistDetailLevelsMode)
+{
+    useDetailLevels = useDetailLevelsMode;
+    persistDetailLevels = persistDetailLevelsMode;
+
+    sceneWidgetVisualizerProxy->setDetailLevelsEnabled(useDetailLevels, persistDetailLevels, *settingParameter);
+    updateDetailLevel();
+}
+
+void SceneWidget::setDisplayedSlice(int slice)
+{
+    slice = std::clamp(slice, 0, getSlicesCount() - 1);
+    if (! sceneWidgetVisualizerProxy->setDisplayedSlice(slice))
+        return;
+
+    loadAndUpdateVisualizationForCurrentStep();
+    emit displayedSliceChanged(slice, getSlicesCount());
+}
+
+int SceneWidget::getDisplayedSlice() const
+{
+    return sceneWidgetVisualizerProxy->displayedSlice();
+}
+
+int SceneWidget::getSlicesCount() const
+{
+    return settingParameter ? std::max(settingParameter->numberOfSlicesZ, 1) : 1;
+}
+
+void SceneWidget::setDecodeDisplayedSliceOnly(bool decodeDisplayedSliceOnlyMode)
+{
+    decodeDisplayedSliceOnly = decodeDisplayedSliceOnlyMode;
+    sceneWidgetVisualizerProxy->setDecodeDisplayedSliceOnly(decodeDisplayedSliceOnly);
+}
+
+void SceneWidget::setIndexFilesOptions(bool consolidatedIndex, bool recovery, bool staleCheck)
+{
+    useConsolidatedIndex = consolidatedIndex;
+    recoverIndexFiles = recovery;
+    checkStaleIndexFiles = staleCheck;
+
+    // Applied when data are read next time (see reloadData())
+    sceneWidgetVisualizerProxy->setIndexFilesOptions(useConsolidatedIndex, recoverIndexFiles, checkStaleIndexFiles);
+}
+
+void SceneWidget::setFollowLiveData(bool followLiveDataMode)
+{
+    followLiveData = followLiveDataMode;
+    watchIndexFiles();
+
+    // Steps written since the data were read are available at once
+    readAppendedSteps();
+}
+
+void SceneWidget::watchIndexFiles()
+{
+    const NodeIndex nodesCount = settingParameter->nNodeX * settingParameter->nNodeY * std::max(settingParameter->nNodeZ, NodeIndex{ 1 });
+    if (! followLiveData || settingParameter->outputFileName.empty() || 0 == nodesCount)
+    {
+        if (const auto watchedFiles = indexFilesWatcher.files(); ! watchedFiles.isEmpty())
+            indexFilesWatcher.removePaths(watchedFiles);
+        indexFilesChangeTimer.stop();
+        indexFilesPollingTimer.stop();
+        return;
+    }
+
+    QSet<QString> indexFiles;
+    indexFiles.reserve(static_cast<qsizetype>(nodesCount));
+    for (NodeIndex node = 0; node < nodesCount; ++node)
+        indexFiles.insert(QString::fromStdString(ReaderHelpers::giveMeFileNameIndex(settingParameter->outputFileName, node)));
+
+    // index files, which were written again (replaced), are not watched any more, so they are added again
+    QStringList filesToAdd, filesToRemove;
+    const auto watchedFiles = indexFilesWatcher.files();
+    const QSet<QString> watchedFilesSet(watchedFiles.begin(), watchedFiles.end());
+    for (const auto& file : watchedFiles)
+    {
+        if (! indexFiles.contains(file))
+            filesToRemove.append(file);
+    }
+    for (const auto& file : indexFiles)
+    {
+        if (! watchedFilesSet.contains(file))
+            filesToAdd.append(file);
+    }
+    if (! filesToRemove.isEmpty())
+        indexFilesWatcher.removePaths(filesToRemove);
+    const auto notWatchedFiles = filesToAdd.isEmpty() ? QStringList{} : indexFilesWatcher.addPaths(filesToAdd);
+
+    indexFilesPollingTimer.setInterval(notWatchedFiles.isEmpty() ? 5000 : 1000);
+    if (! indexFilesPollingTimer.isActive())
+        indexFilesPollingTimer.start();
+}
+
+void SceneWidget::readAppendedSteps()
+{
+    if (! followLiveData)
+        return;
+
+    try
+    {
+        const auto newSteps = sceneWidgetVisualizerProxy->readAppendedStepsOffsets(settingParameter->outputFileName);
+        if (! newSteps)
+        {
+            std::cout << "Index files were written again (the simulation was started again?), all of them are read again" << std::endl;
+            reloadData();
+            return;
+        }
+        if (! newSteps->empty())
+            emit newStepsAvailable(*newSteps);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Warning: reading of steps appended to index files failed: " << e.what() << std::endl;
+    }
+    watchIndexFiles();
+}
+
 void SceneWidget::setActiveSubstateFor3D(const std::string& fieldName)
 {
     activeSubstateFor3D = fieldName;
@@ -1718,6 +2118,8 @@ void SceneWidget::initializeAndDraw3DSubstateVisualization()
                                                                                 actorBuildLine);
     }
 
+    updateNotLoadedNodesPlaceholder();
+
     // Update step number display
     sceneWidgetVisualizerProxy->getVisualizer().buildStepLine(settingParameter->step, singleLineTextStep);
 
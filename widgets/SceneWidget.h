@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <QFileSystemWatcher>
 #include <QMouseEvent>
 #include <QTimer>
 #include <QToolTip>
@@ -60,6 +61,13 @@ public:
     /// @brief Updates the visualization widget to show the specified step number
     void selectedStepParameter(StepIndex stepNumber);
 
+    /** @brief Starts reading of the steps in background, so they are displayed without waiting for reading.
+     *  @param steps Steps in order in which they are going to be displayed (previous request is replaced) */
+    void prefetchSteps(const std::vector<StepIndex>& steps);
+
+    /// @brief Number of steps worth reading ahead to display a new step every frameInterval
+    std::size_t recommendedPrefetchDepth(std::chrono::milliseconds frameInterval) const;
+
     /** @brief Switch to a different model by name.
      * 
      * This method allows changing the visualization model at runtime.
@@ -139,16 +147,79 @@ public:
         return gridLinesVisible;
     }
 
-    /// @brief Set cell rendering mode (high quality vs fast point-based)
-    /// @param useCellRendering If true, uses cell-based rendering (better quality); if false, uses point-based (faster)
-    void setUseCellRendering(bool useCellRendering);
+    /// @brief Set rendering mode of 2D grid (fast point-based, high quality cell-based or texture-based for very large grids)
+    /// @param renderingMode Mode used by the next drawing of the grid
+    void setGridRenderingMode(GridRenderingMode renderingMode);
+
+    /// @brief Get the current rendering mode of 2D grid
+    GridRenderingMode getGridRenderingMode() const
+    {
+        return gridRenderingMode;
+    }
+
+    /** @brief Set reading of nodes intersecting visible part of the grid only.
+     *  Nodes which were not read are covered with placeholder, they are read when the camera shows them.
+     *  @param loadVisibleNodesOnly If true, only visible nodes are read; if false, whole steps are read */
+    void setLoadVisibleNodesOnly(bool loadVisibleNodesOnly);
+
+    /// @brief Get the current state of reading of visible nodes only
+    bool getLoadVisibleNodesOnly() const
+    {
+        return loadVisibleNodesOnly;
+    }
+
+    /** @brief Set levels of detail for large grids: blocks of cells are drawn as one cell when many cells fall into one pixel.
+     *  The level matching on-screen density of cells is picked when the camera changes, zooming in draws every cell again.
+     *  @param useDetailLevels If true, reduced levels of displayed substates are built after each step is read
+     *  @param persistDetailLevels If true, reduced levels are written next to data files and reused */
+    void setUseDetailLevels(bool useDetailLevels, bool persistDetailLevels);
+
+    /// @brief Get the current state of levels of detail
+    bool getUseDetailLevels() const
+    {
+        return useDetailLevels;
+    }
 
-    /// @brief Get the current cell rendering mode
-    bool getUseCellRendering() const
+    /// @brief Get the current state of writing of levels of detail next to data files
+    bool getPersistDetailLevels() const
     {
-        return useCellRendering;
+        return persistDetailLevels;
     }
 
+    /** @brief Set following of the simulation, which is still writing data.
+     *  Index files are watched (inotify on Linux) and only entries appended to them are read,
+     *  steps which became available in all nodes are announced by newStepsAvailable().
+     *  Index files are also checked periodically, because writes of other machines to network file systems are not reported.
+     *  @param followLiveData If true, index files are watched */
+    void setFollowLiveData(bool followLiveData);
+
+    /// @brief Get the current state of following of the simulation
+    bool getFollowLiveData() const
+    {
+        return followLiveData;
+    }
+
+    /** @brief Set the slice of 3D models, which is displayed (it is clamped to slices of the model).
+     *  The step is read again, displayedSliceChanged() is emitted when the slice changes. */
+    void setDisplayedSlice(int slice);
+
+    /// @brief Get the displayed slice of 3D models (0 for 2D models)
+    int getDisplayedSlice() const;
+
+    /// @brief Get number of slices of the model (1 for 2D models)
+    int getSlicesCount() const;
+
+    /** @brief Set decoding of slices of 3D models.
+     *  @param decodeDisplayedSliceOnly If true, only the displayed slice is decoded (less time and memory for large models),
+     *         otherwise all slices of the step are decoded and displaying another slice of the step does not read files */
+    void setDecodeDisplayedSliceOnly(bool decodeDisplayedSliceOnly);
+
+    /** @brief Set reading of index files of nodes, it is used when data are read next time (see ISceneWidgetVisualizer::setIndexFilesOptions()).
+     *  @param consolidatedIndex The consolidated index of steps is used instead of parsing index files on every opening
+     *  @param recovery Missing index files are rebuilt from data files
+     *  @param staleCheck Index files, which do not cover all steps of data files, are rebuilt too */
+    void setIndexFilesOptions(bool consolidatedIndex, bool recovery, bool staleCheck);
+
     /// @brief Set camera azimuth (rotation around Z axis) in degrees
     void setCameraAzimuth(double angle);
 
@@ -294,6 +365,17 @@ public:
      * @param callData     Additional event-specific data (unused). */
     static void cameraCallbackFunction(vtkObject* caller, long unsigned int eventId, void* clientData, void* callData);
 
+    /** @brief Callback function for VTK camera ModifiedEvent (every change of the camera, also zooming and panning).
+     *
+     * When only visible nodes are read or levels of detail are used, it starts the timer updating them (unless it is running already),
+     * so moving camera reads nodes and draws the grid at most once per the timer interval.
+     *
+     * @param caller       The VTK camera object that was modified.
+     * @param eventId      The ID of the event (vtkCommand::ModifiedEvent).
+     * @param clientData   Pointer to user data (the owning SceneWidget instance).
+     * @param callData     Additional event-specific data (unused). */
+    static void cameraModifiedCallbackFunction(vtkObject* caller, long unsigned int eventId, void* clientData, void* callData);
+
 signals:
     /** @brief Signal emitted when step number is changed using keyboard keys (sent from method keypressCallbackFunction)
      *  @param stepNumber The new step number */
@@ -307,6 +389,15 @@ signals:
      *  @param availableSteps Vector of available step numbers */
     void availableStepsReadFromConfigFile(std::vector<StepIndex> availableSteps);
 
+    /** @brief Signal emitted when steps available in all nodes were appended to index files (see setFollowLiveData()).
+     *  @param newSteps Sorted numbers of the new steps */
+    void newStepsAvailable(std::vector<StepIndex> newSteps);
+
+    /** @brief Signal emitted when another slice of 3D model is displayed (see setDisplayedSlice()).
+     *  @param slice The displayed slice
+     *  @param slicesCount Number of slices of the model */
+    void displayedSliceChanged(int slice, int slicesCount);
+
     /** @brief Signal emitted when camera orientation changes (e.g., via mouse interaction).
      * 
      * This allows UI elements (like sliders) to update when the user rotates the camera.
@@ -378,6 +469,33 @@ protected:
     /// @brief Connects the VTK camera modified callback to track camera changes
     void connectCameraCallback();
 
+    /** @brief Part of the grid visible in the viewport (with margin), found by intersecting rays of corners of the viewport with plane Z=0.
+     *  @return std::nullopt if the whole grid should be considered visible (e.g. some corner does not look at the plane) */
+    std::optional<GridRegion> visibleGridRegion() const;
+
+    /** @brief Passes visible part of the grid to the visualizer (only when reading of visible nodes only is enabled),
+     *  the visualization is refreshed when nodes were read. */
+    void updateRegionOfInterest();
+
+    /// @brief Covers parts of the grid, whose nodes were not read yet, with placeholder
+    void updateNotLoadedNodesPlaceholder();
+
+    /** @brief Level of detail matching on-screen density of cells: level L is used when at least 2^L cells fall into one pixel.
+     *  @return 0 (every cell is drawn) when levels of detail are disabled or a substate is displayed in 3D */
+    int detailLevelForCurrentView() const;
+
+    /// @brief Passes level of detail for the current view to the visualizer, the grid is drawn again when the level changed
+    void updateDetailLevel();
+
+    /// @brief Updates level of detail and region of interest, when the camera stopped changing for a while
+    void onCameraChangeSettled();
+
+    /// @brief Watches index files of all nodes of the displayed data when following of the simulation is enabled, otherwise stops watching
+    void watchIndexFiles();
+
+    /// @brief Reads entries appended to index files, all index files are read again when they were written again
+    void readAppendedSteps();
+
     /// @brief Updates the 2D ruler axes bounds based on current data
     void update2DRulerAxesBounds();
 
@@ -538,8 +656,42 @@ protected:
     /// @brief Flat scene background visibility state (shown in 3D mode)
     bool flatSceneBackgroundVisible = true;
 
-    /// @brief Cell rendering mode (true = high quality cell-based, false = fast point-based)
-    bool useCellRendering = false;
+    /// @brief Rendering mode of 2D grid (fast point-based by default)
+    GridRenderingMode gridRenderingMode = GridRenderingMode::Points;
+
+    /// @brief Only nodes intersecting visible part of the grid are read (see setLoadVisibleNodesOnly())
+    bool loadVisibleNodesOnly = false;
+
+    /// @brief Levels of detail are used for large grids (see setUseDetailLevels())
+    bool useDetailLevels = false;
+
+    /// @brief Levels of detail are written next to data files
+    bool persistDetailLevels = false;
+
+    /** @brief Delays updates depending on the camera (region of interest and level of detail) after camera changes (single shot),
+     *  so nodes are not read and the grid is not drawn again for every intermediate camera position during zooming and panning */
+    QTimer cameraChangeTimer;
+
+    /// @brief Only the displayed slice of 3D models is decoded (see setDecodeDisplayedSliceOnly())
+    bool decodeDisplayedSliceOnly = true;
+
+    /// @brief Options of reading index files of nodes (see setIndexFilesOptions())
+    bool useConsolidatedIndex = true;
+    bool recoverIndexFiles = true;
+    bool checkStaleIndexFiles = false;
+
+    /// @brief Index files are watched and appended steps are read (see setFollowLiveData())
+    bool followLiveData = false;
+
+    /// @brief Watches index files of nodes for appended entries
+    QFileSystemWatcher indexFilesWatcher;
+
+    /** @brief Delays reading of appended entries after an index file changed (single shot),
+     *  so entries written by all nodes for one step are read together */
+    QTimer indexFilesChangeTimer;
+
+    /// @brief Checks index files periodically (often when some of them can not be watched, e.g. they do not exist yet)
+    QTimer indexFilesPollingTimer;
 
     /// @brief Name of the substate field currently used for 3D visualization (empty if none)
     std::string activeSubstateFor3D;
@@ -585,6 +737,10 @@ protected:
      *  @note: The type is vtkSmartPointer instead of auto-maintained vtkNew because we need to be able to reset the object */
     vtkSmartPointer<vtkActor> gridLinesOnSurfaceActor;
 
+    /** @brief Actor for placeholder covering parts of the grid whose nodes were not read yet (see loadVisibleNodesOnly).
+     *  @note: The type is vtkSmartPointer instead of auto-maintained vtkNew because we need to be able to reset the object */
+    vtkSmartPointer<vtkActor> notLoadedNodesActor;
+
     /// @brief Text mapper for step display: This text mapper is responsible for rendering the step number in the scene.
     vtkNew<vtkTextMapper> singleLineTextStep;
 
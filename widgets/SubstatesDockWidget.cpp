@@ -1,7 +1,6 @@
 /** @file SubstatesDockWidget.cpp
  * @brief Implementation of SubstatesDockWidget. */
 
-#include <cmath> // std::isnan
 #include <QVBoxLayout>
 #include <QLabel>
 #include <QFrame>
@@ -227,149 +226,62 @@ void SubstatesDockWidget::onMinMaxValuesChanged(const std::string& fieldName, do
 
 void SubstatesDockWidget::onCalculateMinimumRequested(const std::string& fieldName)
 {
-    if (!m_currentSettingParameter || !m_currentVisualizer)
-        return;
-
-    double minValue = std::numeric_limits<double>::max();
-    bool found = false;
-
-    // Get noValue if enabled
-    double noValue = std::numeric_limits<double>::quiet_NaN();
-    bool noValueEnabled = false;
-    auto substateIt = m_currentSettingParameter->substateInfo.find(fieldName);
-    if (substateIt != m_currentSettingParameter->substateInfo.end())
-    {
-        noValue = substateIt->second.noValue;
-        noValueEnabled = substateIt->second.noValueEnabled;
-    }
-
-    // Iterate through all cells in current step
-    for (int row = 0; row < m_currentSettingParameter->numberOfRowsY; ++row)
-    {
-        for (int col = 0; col < m_currentSettingParameter->numberOfColumnX; ++col)
-        {
-            try
-            {
-                std::string cellValueStr = m_currentVisualizer->getCellStringEncoding(row, col, fieldName.c_str());
-                double cellValue = std::stod(cellValueStr);
-                
-                // Skip noValue if it's enabled
-                if (noValueEnabled && !std::isnan(noValue) && cellValue == noValue)
-                    continue;
-                
-                minValue = std::min(minValue, cellValue);
-                found = true;
-            }
-            catch (const std::exception&)
-            {
-                // Skip cells that can't be parsed
-            }
-        }
-    }
-
-    if (found)
+    if (const auto range = calculateValueRange(fieldName, /*skipNoValue=*/true, /*onlyPositive=*/false))
     {
         // Update the widget
         auto it = m_substateWidgets.find(fieldName);
         if (it != m_substateWidgets.end())
         {
-            it->second->setMinValue(minValue);
+            it->second->setMinValue(range->min);
         }
     }
 }
 
 void SubstatesDockWidget::onCalculateMinimumGreaterThanZeroRequested(const std::string& fieldName)
 {
-    if (!m_currentSettingParameter || !m_currentVisualizer)
-        return;
-
-    double minValue = std::numeric_limits<double>::max();
-    bool found = false;
-
-    // Iterate through all cells in current step
-    for (int row = 0; row < m_currentSettingParameter->numberOfRowsY; ++row)
+    if (const auto range = calculateValueRange(fieldName, /*skipNoValue=*/false, /*onlyPositive=*/true))
     {
-        for (int col = 0; col < m_currentSettingParameter->numberOfColumnX; ++col)
+        // Update the widget
+        auto it = m_substateWidgets.find(fieldName);
+        if (it != m_substateWidgets.end())
         {
-            try
-            {
-                std::string cellValueStr = m_currentVisualizer->getCellStringEncoding(row, col, fieldName.c_str());
-                double cellValue = std::stod(cellValueStr);
-                if (cellValue > 0.0)
-                {
-                    minValue = std::min(minValue, cellValue);
-                    found = true;
-                }
-            }
-            catch (const std::exception&)
-            {
-                // Skip cells that can't be parsed
-            }
+            it->second->setMinValue(range->min);
         }
     }
+}
 
-    if (found)
+void SubstatesDockWidget::onCalculateMaximumRequested(const std::string& fieldName)
+{
+    if (const auto range = calculateValueRange(fieldName, /*skipNoValue=*/true, /*onlyPositive=*/false))
     {
         // Update the widget
         auto it = m_substateWidgets.find(fieldName);
         if (it != m_substateWidgets.end())
         {
-            it->second->setMinValue(minValue);
+            it->second->setMaxValue(range->max);
         }
     }
 }
 
-void SubstatesDockWidget::onCalculateMaximumRequested(const std::string& fieldName)
+std::optional<SubstateColumn::ValueRange> SubstatesDockWidget::calculateValueRange(const std::string& fieldName, bool skipNoValue, bool onlyPositive) const
 {
     if (!m_currentSettingParameter || !m_currentVisualizer)
-        return;
+        return std::nullopt;
 
-    double maxValue = std::numeric_limits<double>::lowest();
-    bool found = false;
+    // Values of the field in current step (extracted once when the step was read)
+    const SubstateColumn* substateColumn = m_currentVisualizer->getSubstateColumn(fieldName);
+    if (!substateColumn)
+        return std::nullopt;
 
     // Get noValue if enabled
-    double noValue = std::numeric_limits<double>::quiet_NaN();
-    bool noValueEnabled = false;
+    double noValue = SubstateColumn::notANumber;
     auto substateIt = m_currentSettingParameter->substateInfo.find(fieldName);
-    if (substateIt != m_currentSettingParameter->substateInfo.end())
+    if (skipNoValue && substateIt != m_currentSettingParameter->substateInfo.end() && substateIt->second.noValueEnabled)
     {
         noValue = substateIt->second.noValue;
-        noValueEnabled = substateIt->second.noValueEnabled;
     }
 
-    // Iterate through all cells in current step
-    for (int row = 0; row < m_currentSettingParameter->numberOfRowsY; ++row)
-    {
-        for (int col = 0; col < m_currentSettingParameter->numberOfColumnX; ++col)
-        {
-            try
-            {
-                std::string cellValueStr = m_currentVisualizer->getCellStringEncoding(row, col, fieldName.c_str());
-                double cellValue = std::stod(cellValueStr);
-                
-                // Skip noValue if it's enabled
-                if (noValueEnabled && !std::isnan(noValue) && cellValue == noValue)
-                    continue;
-                
-                maxValue = std::max(maxValue, cellValue);
-                found = true;
-            }
-            catch (const std::exception&)
-            {
-                // Skip cells that can't be parsed
-            }
-        }
-    }
-
-    if (found)
-    {
-        // Update the widget
-        auto it = m_substateWidgets.find(fieldName);
-        if (it != m_substateWidgets.end())
-        {
-            it->second->setMaxValue(maxValue);
-        }
-    }
+    return substateColumn->valueRange(noValue, onlyPositive);
 }
 
 void SubstatesDockWidget::onDeactivateClicked()
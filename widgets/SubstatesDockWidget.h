@@ -7,10 +7,12 @@
 #pragma once
 
 #include <map>
+#include <optional>
 #include <string>
 #include <QDockWidget>
 #include <QScrollArea>
 #include <QVBoxLayout>
+#include "data/SubstateColumns.h"
 
 class QDragEnterEvent;
 class QDropEvent;
@@ -182,6 +184,16 @@ private:
      * Updates the order field in SubstateInfo based on current widget layout. */
     void saveFieldOrder();
 
+    /** @brief Calculate range of values of a field in the current step.
+     * 
+     * Values are taken from numeric values of the field extracted when the step was read.
+     * 
+     * @param fieldName The name of the field
+     * @param skipNoValue Skip noValue of the field if it is enabled
+     * @param onlyPositive Consider only values greater than zero
+     * @return Range of values or std::nullopt if the field does not have any such value */
+    std::optional<SubstateColumn::ValueRange> calculateValueRange(const std::string& fieldName, bool skipNoValue, bool onlyPositive) const;
+
     QScrollArea* m_scrollArea;
     QWidget* m_containerWidget;
     QVBoxLayout* m_containerLayout;